@@ -1937,6 +1937,89 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
         Ok(Some((result, receiver_type.clone())))
     }
 
+    /// Compile `x := x.append(v)` / `x := x.prepend(v)` on a local IntMatrix/Matrix
+    /// (v1.9). The runtime `*_inplace` variants take over x's reference and grow
+    /// its buffer in place when nothing else holds it, so an append loop is
+    /// amortized O(1) instead of copying the whole array on every call.
+    ///
+    /// Only variables owned by the current function qualify: parameters (and
+    /// closure parameters) are borrowed, so a ref_count of 1 there does not
+    /// mean the array is unshared. Returns false when the pattern does not
+    /// apply and the assignment should be compiled the usual way.
+    pub(crate) fn compile_array_inplace_assign(
+        &mut self,
+        target: &Expr,
+        value: &Expr,
+    ) -> CodegenResult<bool> {
+        use parser::ast::ExprKind;
+
+        let ExprKind::Identifier(name) = &target.kind else {
+            return Ok(false);
+        };
+        let ExprKind::Call { func, args } = &value.kind else {
+            return Ok(false);
+        };
+        let ExprKind::FieldAccess {
+            target: receiver,
+            field,
+        } = &func.kind
+        else {
+            return Ok(false);
+        };
+        if args.len() != 1 || !matches!(field.as_str(), "append" | "prepend") {
+            return Ok(false);
+        }
+        if !matches!(&receiver.kind, ExprKind::Identifier(r) if r == name) {
+            return Ok(false);
+        }
+        let Some((var_ptr, var_type)) = self.variables.get(name).cloned() else {
+            return Ok(false);
+        };
+        if !matches!(var_type, BrixType::Matrix | BrixType::IntMatrix) {
+            return Ok(false);
+        }
+        let in_closure = self
+            .current_function
+            .map(|f| f.get_name().to_string_lossy().starts_with("__closure_"))
+            .unwrap_or(false);
+        if in_closure || !self.function_scope_vars.iter().any(|(n, _)| n == name) {
+            return Ok(false);
+        }
+
+        let is_int = var_type == BrixType::IntMatrix;
+        let (arg_val, arg_type) = self.compile_expr(&args[0])?;
+        let scalar: inkwell::values::BasicMetadataValueEnum<'ctx> = if is_int {
+            self.coerce_to_i64(arg_val, &arg_type, field)?.into()
+        } else {
+            self.coerce_to_f64(arg_val, &arg_type)?.into()
+        };
+        let func = match (field.as_str(), is_int) {
+            ("append", true) => self.get_intmatrix_append_inplace(),
+            ("append", false) => self.get_matrix_append_inplace(),
+            (_, true) => self.get_intmatrix_prepend_inplace(),
+            (_, false) => self.get_matrix_prepend_inplace(),
+        };
+
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let old = self
+            .builder
+            .build_load(ptr_type, var_ptr, "inplace_old")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_load".to_string(),
+                details: format!("Failed to load '{}' for in-place {}", name, field),
+                span: Some(target.span.clone()),
+            })?;
+        let result = self.call_array_scalar(func, old, scalar, field, &value.span)?;
+        self.builder
+            .build_store(var_ptr, result)
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_store".to_string(),
+                details: format!("Failed to store '{}' after in-place {}", name, field),
+                span: Some(target.span.clone()),
+            })?;
+        Ok(true)
+    }
+
     /// Compile `.count()` on IntMatrix/Matrix (v1.7 Group B). Returns rows*cols as Int.
     fn compile_array_count(
         &mut self,
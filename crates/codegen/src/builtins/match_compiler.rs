@@ -132,43 +132,8 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                                 .add_function("str_eq", fn_type, Some(Linkage::External))
                         });
 
-                        // Create literal string
-                        let raw_str =
-                            self.builder
-                                .build_global_string_ptr(s, "pat_str")
-                                .map_err(|_| CodegenError::LLVMError {
-                                    operation: "build_global_string_ptr".to_string(),
-                                    details: "Failed to create pattern string".to_string(),
-                                    span: None,
-                                })?;
-                        let str_new_fn_type = ptr_type.fn_type(&[ptr_type.into()], false);
-                        let str_new_fn = self.module.get_function("str_new").unwrap_or_else(|| {
-                            self.module.add_function(
-                                "str_new",
-                                str_new_fn_type,
-                                Some(Linkage::External),
-                            )
-                        });
-
-                        let call = self
-                            .builder
-                            .build_call(
-                                str_new_fn,
-                                &[raw_str.as_pointer_value().into()],
-                                "pat_lit_str",
-                            )
-                            .map_err(|_| CodegenError::LLVMError {
-                                operation: "build_call".to_string(),
-                                details: "Failed to call str_new for pattern".to_string(),
-                                span: None,
-                            })?;
-                        let literal_str = call.try_as_basic_value().left().ok_or_else(|| {
-                            CodegenError::MissingValue {
-                                what: "str_new result".to_string(),
-                                context: "pattern string literal".to_string(),
-                                span: None,
-                            }
-                        })?;
+                        // Literal side is an immortal constant (v1.9): no str_new per arm
+                        let literal_str = self.compile_static_string(s);
 
                         // Compare strings
                         let call = self
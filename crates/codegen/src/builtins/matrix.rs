@@ -77,6 +77,20 @@ pub trait MatrixFunctions<'ctx> {
     /// Get or declare: IntMatrix* intmatrix_prepend(IntMatrix*, long)
     fn get_intmatrix_prepend(&self) -> inkwell::values::FunctionValue<'ctx>;
 
+    // ===== In-place Append/Prepend (v1.9) =====
+
+    /// Get or declare: Matrix* matrix_append_inplace(Matrix*, double)
+    fn get_matrix_append_inplace(&self) -> inkwell::values::FunctionValue<'ctx>;
+
+    /// Get or declare: IntMatrix* intmatrix_append_inplace(IntMatrix*, long)
+    fn get_intmatrix_append_inplace(&self) -> inkwell::values::FunctionValue<'ctx>;
+
+    /// Get or declare: Matrix* matrix_prepend_inplace(Matrix*, double)
+    fn get_matrix_prepend_inplace(&self) -> inkwell::values::FunctionValue<'ctx>;
+
+    /// Get or declare: IntMatrix* intmatrix_prepend_inplace(IntMatrix*, long)
+    fn get_intmatrix_prepend_inplace(&self) -> inkwell::values::FunctionValue<'ctx>;
+
     // ===== Slice (v1.7 Group C) =====
 
     /// Get or declare: Matrix* matrix_slice(Matrix*, long start, long end)
@@ -275,6 +289,53 @@ impl<'a, 'ctx> MatrixFunctions<'ctx> for Compiler<'a, 'ctx> {
             .add_function("intmatrix_prepend", fn_type, Some(Linkage::External))
     }
 
+    fn get_matrix_append_inplace(&self) -> inkwell::values::FunctionValue<'ctx> {
+        if let Some(func) = self.module.get_function("matrix_append_inplace") {
+            return func;
+        }
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let f64_type = self.context.f64_type();
+        let fn_type = ptr_type.fn_type(&[ptr_type.into(), f64_type.into()], false);
+        self.module
+            .add_function("matrix_append_inplace", fn_type, Some(Linkage::External))
+    }
+
+    fn get_intmatrix_append_inplace(&self) -> inkwell::values::FunctionValue<'ctx> {
+        if let Some(func) = self.module.get_function("intmatrix_append_inplace") {
+            return func;
+        }
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let i64_type = self.context.i64_type();
+        let fn_type = ptr_type.fn_type(&[ptr_type.into(), i64_type.into()], false);
+        self.module
+            .add_function("intmatrix_append_inplace", fn_type, Some(Linkage::External))
+    }
+
+    fn get_matrix_prepend_inplace(&self) -> inkwell::values::FunctionValue<'ctx> {
+        if let Some(func) = self.module.get_function("matrix_prepend_inplace") {
+            return func;
+        }
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let f64_type = self.context.f64_type();
+        let fn_type = ptr_type.fn_type(&[ptr_type.into(), f64_type.into()], false);
+        self.module
+            .add_function("matrix_prepend_inplace", fn_type, Some(Linkage::External))
+    }
+
+    fn get_intmatrix_prepend_inplace(&self) -> inkwell::values::FunctionValue<'ctx> {
+        if let Some(func) = self.module.get_function("intmatrix_prepend_inplace") {
+            return func;
+        }
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let i64_type = self.context.i64_type();
+        let fn_type = ptr_type.fn_type(&[ptr_type.into(), i64_type.into()], false);
+        self.module.add_function(
+            "intmatrix_prepend_inplace",
+            fn_type,
+            Some(Linkage::External),
+        )
+    }
+
     fn get_matrix_slice(&self) -> inkwell::values::FunctionValue<'ctx> {
         if let Some(func) = self.module.get_function("matrix_slice") {
             return func;
@@ -23,6 +23,7 @@ pub mod linalg;
 pub mod match_compiler;
 pub mod math;
 pub mod matrix;
+pub mod segments;
 pub mod stats;
 pub mod string;
 pub mod test;
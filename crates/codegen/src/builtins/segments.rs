@@ -0,0 +1,756 @@
+// Lazy string splitting for Brix (v1.9)
+//
+// `s.split_iter(delim)` and `s.lines()` never build a StringMatrix up front.
+// They compile to a loop over brix_str_segment_begin / brix_str_next_segment
+// (runtime.c, "Lazy splitting") that holds one segment — a slice of s — at a
+// time:
+//   - `for part in s.split_iter(",")` / `for line in s.lines()`;
+//   - `.find(pred)`, `.any(pred)`, `.all(pred)` and `.nth(i)` stop at the
+//     first segment that decides the answer; `.count()` allocates nothing;
+//   - `.filter(pred)` keeps only the matching segments and `.map(fn)` sizes
+//     its result with brix_str_segment_count, so neither materializes the
+//     full split;
+//   - used as a plain value, the segments are collected into a StringMatrix.
+//
+// Implemented as an inherent impl block on Compiler, reaching the sibling
+// helpers in lib.rs (compile_expr, compile_stmt, insert_release, etc.).
+
+use crate::helpers::HelperFunctions;
+use crate::{BrixType, CodegenError, CodegenResult, Compiler};
+use inkwell::basic_block::BasicBlock;
+use inkwell::module::Linkage;
+use inkwell::types::{BasicMetadataTypeEnum, BasicType, BasicTypeEnum};
+use inkwell::values::{BasicMetadataValueEnum, BasicValueEnum, FunctionValue, PointerValue};
+use inkwell::{AddressSpace, IntPredicate};
+use parser::ast::{Expr, ExprKind, Stmt};
+
+/// Methods that consume split_iter()/lines() without materializing them.
+pub(crate) const SEGMENT_METHODS: &[&str] =
+    &["find", "any", "all", "nth", "count", "filter", "map"];
+
+/// Operands of a split_iter()/lines() source, owned for the loop's lifetime.
+/// `delim` is null for lines().
+struct SegmentSource<'ctx> {
+    text: PointerValue<'ctx>,
+    delim: PointerValue<'ctx>,
+    owns_delim: bool,
+}
+
+impl<'a, 'ctx> Compiler<'a, 'ctx> {
+    /// Recognize `s.split_iter(delim)` and `s.lines()`, returning the
+    /// receiver, the method name and its arguments. A receiver statically
+    /// known not to be a string (e.g. a struct with its own `lines()`
+    /// method) is left to the regular method dispatch.
+    pub(crate) fn string_segments_source<'e>(
+        &self,
+        expr: &'e Expr,
+    ) -> Option<(&'e Expr, &'e str, &'e [Expr])> {
+        let ExprKind::Call { func, args } = &expr.kind else {
+            return None;
+        };
+        let ExprKind::FieldAccess { target, field } = &func.kind else {
+            return None;
+        };
+        if !matches!(field.as_str(), "split_iter" | "lines") {
+            return None;
+        }
+        match self.infer_expr_type_static(target, &[]) {
+            Some(BrixType::String) | None => {
+                Some((target.as_ref(), field.as_str(), args.as_slice()))
+            }
+            Some(_) => None,
+        }
+    }
+
+    /// Compile the receiver and delimiter of a split_iter()/lines() call,
+    /// retaining borrowed values so the segments' buffer outlives any
+    /// reassignment inside the loop body.
+    fn compile_segment_source(&mut self, source: &Expr) -> CodegenResult<SegmentSource<'ctx>> {
+        let (text, method, args) =
+            self.string_segments_source(source)
+                .ok_or_else(|| CodegenError::InvalidOperation {
+                    operation: "lazy split".to_string(),
+                    reason: "expected s.split_iter(delim) or s.lines()".to_string(),
+                    span: Some(source.span.clone()),
+                })?;
+        let expected = if method == "split_iter" { 1 } else { 0 };
+        if args.len() != expected {
+            return Err(CodegenError::InvalidOperation {
+                operation: format!("{}()", method),
+                reason: format!("Expected {} argument(s), got {}", expected, args.len()),
+                span: Some(source.span.clone()),
+            });
+        }
+
+        let mut operands = Vec::with_capacity(2);
+        for (operand, context) in std::iter::once((text, "receiver"))
+            .chain(args.first().map(|delim| (delim, "delimiter")))
+        {
+            let (val, ty) = self.compile_expr(operand)?;
+            if ty != BrixType::String {
+                return Err(CodegenError::TypeError {
+                    expected: "string".to_string(),
+                    found: format!("{:?}", ty),
+                    context: format!("{}() {}", method, context),
+                    span: Some(operand.span.clone()),
+                });
+            }
+            if Self::is_borrowed_ref_expr(&operand.kind) {
+                self.insert_retain(val, &BrixType::String)?;
+            }
+            operands.push(val.into_pointer_value());
+        }
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        Ok(SegmentSource {
+            text: operands[0],
+            delim: operands.get(1).copied().unwrap_or(ptr_type.const_null()),
+            owns_delim: operands.len() == 2,
+        })
+    }
+
+    /// Emit the segment loop. The alloca named `cur_name` owns the current
+    /// segment: it is released before the next one is fetched and once more
+    /// when the loop ends, so `body` may branch to the done block at any
+    /// point. `body` receives (cur alloca, segment, next block, done block)
+    /// and either terminates its block or falls through to the next
+    /// segment. Leaves the builder after the loop.
+    fn compile_segment_loop<F>(
+        &mut self,
+        src: &SegmentSource<'ctx>,
+        cur_name: &str,
+        site: &Expr,
+        mut body: F,
+    ) -> CodegenResult<()>
+    where
+        F: FnMut(
+            &mut Self,
+            PointerValue<'ctx>,
+            PointerValue<'ctx>,
+            BasicBlock<'ctx>,
+            BasicBlock<'ctx>,
+        ) -> CodegenResult<()>,
+    {
+        let i64_type = self.context.i64_type();
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let function = self.current_function()?;
+
+        let pos_alloca = self.create_entry_block_alloca(i64_type.into(), "_seg_pos")?;
+        let cur_alloca = self.create_entry_block_alloca(ptr_type.into(), cur_name)?;
+        let begin = self.call_runtime(
+            "brix_str_segment_begin",
+            i64_type.into(),
+            &[ptr_type.into(), ptr_type.into()],
+            &[src.text.into(), src.delim.into()],
+            site,
+        )?;
+        for (slot, val) in [
+            (pos_alloca, begin),
+            (cur_alloca, ptr_type.const_null().into()),
+        ] {
+            self.builder
+                .build_store(slot, val)
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_store".to_string(),
+                    details: "Failed to init segment loop".to_string(),
+                    span: None,
+                })?;
+        }
+
+        let cond_bb = self.context.append_basic_block(function, "seg_cond");
+        let body_bb = self.context.append_basic_block(function, "seg_body");
+        let done_bb = self.context.append_basic_block(function, "seg_done");
+        self.builder
+            .build_unconditional_branch(cond_bb)
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_unconditional_branch".to_string(),
+                details: "Failed segment loop init branch".to_string(),
+                span: None,
+            })?;
+
+        // --- COND: pos < 0 once the last segment has been handed out ---
+        self.builder.position_at_end(cond_bb);
+        let pos = self
+            .builder
+            .build_load(i64_type, pos_alloca, "seg_pos")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_load".to_string(),
+                details: "Failed to load segment position".to_string(),
+                span: None,
+            })?
+            .into_int_value();
+        let more = self
+            .builder
+            .build_int_compare(
+                IntPredicate::SGE,
+                pos,
+                i64_type.const_int(0, false),
+                "seg_more",
+            )
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_int_compare".to_string(),
+                details: "Failed segment loop cond".to_string(),
+                span: None,
+            })?;
+        self.builder
+            .build_conditional_branch(more, body_bb, done_bb)
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_conditional_branch".to_string(),
+                details: "Failed segment loop cond branch".to_string(),
+                span: None,
+            })?;
+
+        // --- BODY: drop the previous segment, fetch the next ---
+        self.builder.position_at_end(body_bb);
+        self.release_segment(cur_alloca)?;
+        let seg = self
+            .call_ptr_runtime(
+                "brix_str_next_segment",
+                &[ptr_type.into(), ptr_type.into(), ptr_type.into()],
+                &[src.text.into(), src.delim.into(), pos_alloca.into()],
+                site,
+            )?
+            .into_pointer_value();
+        self.builder
+            .build_store(cur_alloca, seg)
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_store".to_string(),
+                details: "Failed to store segment".to_string(),
+                span: None,
+            })?;
+        body(self, cur_alloca, seg, cond_bb, done_bb)?;
+        if self
+            .builder
+            .get_insert_block()
+            .and_then(|b| b.get_terminator())
+            .is_none()
+        {
+            self.builder
+                .build_unconditional_branch(cond_bb)
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_unconditional_branch".to_string(),
+                    details: "Failed segment loop body branch".to_string(),
+                    span: None,
+                })?;
+        }
+
+        // --- DONE ---
+        self.builder.position_at_end(done_bb);
+        self.release_segment(cur_alloca)?;
+        self.insert_release(src.text, &BrixType::String)?;
+        if src.owns_delim {
+            self.insert_release(src.delim, &BrixType::String)?;
+        }
+        Ok(())
+    }
+
+    /// Release the segment held in `cur` (string_release ignores null).
+    fn release_segment(&mut self, cur: PointerValue<'ctx>) -> CodegenResult<()> {
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let seg = self
+            .builder
+            .build_load(ptr_type, cur, "seg_prev")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_load".to_string(),
+                details: "Failed to load segment for release".to_string(),
+                span: None,
+            })?
+            .into_pointer_value();
+        self.insert_release(seg, &BrixType::String)
+    }
+
+    /// Compile `for part in s.split_iter(delim)` / `for line in s.lines()`
+    /// (v1.9). The loop variable owns its segment for one iteration, so
+    /// `break`, `continue` and reassigning it need no extra cleanup.
+    pub(crate) fn compile_string_segments_for(
+        &mut self,
+        var_names: &[String],
+        source: &Expr,
+        body: &Stmt,
+        function: FunctionValue<'ctx>,
+        stmt: &Stmt,
+    ) -> CodegenResult<()> {
+        if var_names.len() != 1 {
+            return Err(CodegenError::InvalidOperation {
+                operation: "Lazy split iteration".to_string(),
+                reason: format!("yields 1 variable, found {}", var_names.len()),
+                span: Some(stmt.span.clone()),
+            });
+        }
+        let var_name = &var_names[0];
+        let src = self.compile_segment_source(source)?;
+        let mut old_var = None;
+        self.compile_segment_loop(&src, var_name, source, |this, cur, _, next_bb, done_bb| {
+            old_var = Some(this.variables.remove(var_name));
+            this.variables
+                .insert(var_name.clone(), (cur, BrixType::String));
+            let old_break = this.current_break_block.replace(done_bb);
+            let old_continue = this.current_continue_block.replace(next_bb);
+            this.compile_stmt(body, function)?;
+            this.current_break_block = old_break;
+            this.current_continue_block = old_continue;
+            Ok(())
+        })?;
+        match old_var.flatten() {
+            Some(old) => {
+                self.variables.insert(var_name.clone(), old);
+            }
+            None => {
+                self.variables.remove(var_name);
+            }
+        }
+        Ok(())
+    }
+
+    /// Compile a bare `s.split_iter(delim)` / `s.lines()` used as a value:
+    /// the segments are collected into a StringMatrix.
+    pub(crate) fn compile_string_segments_collect(
+        &mut self,
+        source: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let i64_type = self.context.i64_type();
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let src = self.compile_segment_source(source)?;
+        let result = self.call_ptr_runtime(
+            "string_matrix_new",
+            &[i64_type.into()],
+            &[i64_type.const_int(0, false).into()],
+            source,
+        )?;
+        self.compile_segment_loop(&src, "_seg_cur", source, |this, _, seg, _, _| {
+            this.call_void_segment_runtime(
+                "brix_str_matrix_push",
+                &[ptr_type.into(), ptr_type.into()],
+                &[result.into(), seg.into()],
+                source,
+            )
+        })?;
+        Ok((result, BrixType::StringMatrix))
+    }
+
+    /// Compile `.find/.any/.all/.nth/.count/.filter/.map` on
+    /// `s.split_iter(delim)` / `s.lines()` (v1.9). Callbacks take the
+    /// segment as a borrowed string.
+    pub(crate) fn compile_string_segments_method(
+        &mut self,
+        source: &Expr,
+        method: &str,
+        args: &[Expr],
+        call_expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let i64_type = self.context.i64_type();
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let span = &call_expr.span;
+        let zero = i64_type.const_int(0, false);
+        let one = i64_type.const_int(1, false);
+
+        let expected = if method == "count" { 0 } else { 1 };
+        if args.len() != expected {
+            return Err(CodegenError::InvalidOperation {
+                operation: method.to_string(),
+                reason: format!("Expected {} argument(s), got {}", expected, args.len()),
+                span: Some(span.clone()),
+            });
+        }
+
+        match method {
+            "count" => {
+                let src = self.compile_segment_source(source)?;
+                let count_alloca = self.create_entry_block_alloca(i64_type.into(), "_seg_n")?;
+                self.store_segment_state(count_alloca, zero.into())?;
+                self.compile_segment_loop(&src, "_seg_cur", source, |this, _, _, _, _| {
+                    this.bump_segment_counter(count_alloca)?;
+                    Ok(())
+                })?;
+                let count = self.load_segment_state(i64_type.into(), count_alloca)?;
+                Ok((count, BrixType::Int))
+            }
+
+            "nth" => {
+                let (index, index_type) = self.compile_expr(&args[0])?;
+                if index_type != BrixType::Int {
+                    return Err(CodegenError::TypeError {
+                        expected: "int".to_string(),
+                        found: format!("{:?}", index_type),
+                        context: "nth() index".to_string(),
+                        span: Some(args[0].span.clone()),
+                    });
+                }
+                let src = self.compile_segment_source(source)?;
+                // Past the last segment, nth() is "" like char_at().
+                let result_alloca = self.create_entry_block_alloca(ptr_type.into(), "_seg_nth")?;
+                let empty = self.compile_static_string("");
+                self.store_segment_state(result_alloca, empty.into())?;
+                let ix_alloca = self.create_entry_block_alloca(i64_type.into(), "_seg_ix")?;
+                self.store_segment_state(ix_alloca, zero.into())?;
+                self.compile_segment_loop(
+                    &src,
+                    "_seg_cur",
+                    source,
+                    |this, _, seg, next_bb, done_bb| {
+                        let ix = this.bump_segment_counter(ix_alloca)?;
+                        let hit = this
+                            .builder
+                            .build_int_compare(
+                                IntPredicate::EQ,
+                                ix,
+                                index.into_int_value(),
+                                "nth_hit",
+                            )
+                            .map_err(|_| CodegenError::LLVMError {
+                                operation: "build_int_compare".to_string(),
+                                details: "Failed nth() index check".to_string(),
+                                span: None,
+                            })?;
+                        let function = this.current_function()?;
+                        let hit_bb = this.context.append_basic_block(function, "nth_hit");
+                        this.branch_segment(hit, hit_bb, next_bb)?;
+                        this.builder.position_at_end(hit_bb);
+                        let kept = this.insert_retain(seg.into(), &BrixType::String)?;
+                        this.store_segment_state(result_alloca, kept)?;
+                        this.jump_segment(done_bb)
+                    },
+                )?;
+                let result = self.load_segment_state(ptr_type.into(), result_alloca)?;
+                Ok((result, BrixType::String))
+            }
+
+            "any" | "all" | "find" | "filter" => {
+                let (closure_val, _) = self.compile_expr(&args[0])?;
+                let (fn_ptr, env_ptr) = self.load_closure_fn_env(closure_val, span)?;
+                let src = self.compile_segment_source(source)?;
+
+                // any: 0 until a segment passes; all: 1 until one fails;
+                // find: nil until a segment passes; filter: the kept segments.
+                let union_type = BrixType::Union(vec![BrixType::String, BrixType::Nil]);
+                let (state_llvm, init, result_type): (BasicTypeEnum, BasicValueEnum, BrixType) =
+                    match method {
+                        "any" => (i64_type.into(), zero.into(), BrixType::Int),
+                        "all" => (i64_type.into(), one.into(), BrixType::Int),
+                        "find" => {
+                            let union_llvm = self.brix_type_to_llvm(&union_type);
+                            let nil = union_llvm
+                                .into_struct_type()
+                                .const_named_struct(&[one.into(), ptr_type.const_null().into()]);
+                            (union_llvm, nil.into(), union_type)
+                        }
+                        _ => {
+                            let matrix = self.call_ptr_runtime(
+                                "string_matrix_new",
+                                &[i64_type.into()],
+                                &[zero.into()],
+                                call_expr,
+                            )?;
+                            (ptr_type.into(), matrix, BrixType::StringMatrix)
+                        }
+                    };
+                let state_alloca = self.create_entry_block_alloca(state_llvm, "_seg_result")?;
+                self.store_segment_state(state_alloca, init)?;
+
+                self.compile_segment_loop(
+                    &src,
+                    "_seg_cur",
+                    source,
+                    |this, _, seg, next_bb, done_bb| {
+                        let pred = this
+                            .builder
+                            .build_indirect_call(
+                                i64_type.fn_type(&[ptr_type.into(), ptr_type.into()], false),
+                                fn_ptr,
+                                &[env_ptr.into(), seg.into()],
+                                "seg_pred",
+                            )
+                            .map_err(|_| CodegenError::LLVMError {
+                                operation: "build_indirect_call".to_string(),
+                                details: format!("Failed {} predicate call", method),
+                                span: Some(span.clone()),
+                            })?
+                            .try_as_basic_value()
+                            .left()
+                            .ok_or_else(|| CodegenError::MissingValue {
+                                what: "predicate result".to_string(),
+                                context: method.to_string(),
+                                span: Some(span.clone()),
+                            })?
+                            .into_int_value();
+                        let passed = this
+                            .builder
+                            .build_int_compare(IntPredicate::NE, pred, zero, "seg_pass")
+                            .map_err(|_| CodegenError::LLVMError {
+                                operation: "build_int_compare".to_string(),
+                                details: format!("Failed {} predicate check", method),
+                                span: None,
+                            })?;
+                        let function = this.current_function()?;
+                        let decide_bb = this.context.append_basic_block(function, "seg_decide");
+                        // all() decides on the first failure, the rest on a pass.
+                        if method == "all" {
+                            this.branch_segment(passed, next_bb, decide_bb)?;
+                        } else {
+                            this.branch_segment(passed, decide_bb, next_bb)?;
+                        }
+                        this.builder.position_at_end(decide_bb);
+                        match method {
+                            "any" => this.store_segment_state(state_alloca, one.into())?,
+                            "all" => this.store_segment_state(state_alloca, zero.into())?,
+                            "find" => {
+                                let kept = this.insert_retain(seg.into(), &BrixType::String)?;
+                                let mut found = state_llvm.into_struct_type().get_undef();
+                                for (i, field) in [zero.into(), kept].into_iter().enumerate() {
+                                    found = this
+                                        .builder
+                                        .build_insert_value(found, field, i as u32, "find_field")
+                                        .map_err(|_| CodegenError::LLVMError {
+                                            operation: "build_insert_value".to_string(),
+                                            details: "Failed to build find() result".to_string(),
+                                            span: None,
+                                        })?
+                                        .into_struct_value();
+                                }
+                                this.store_segment_state(state_alloca, found.into())?;
+                            }
+                            _ => {
+                                this.call_void_segment_runtime(
+                                    "brix_str_matrix_push",
+                                    &[ptr_type.into(), ptr_type.into()],
+                                    &[init.into(), seg.into()],
+                                    call_expr,
+                                )?;
+                                return this.jump_segment(next_bb);
+                            }
+                        }
+                        this.jump_segment(done_bb)
+                    },
+                )?;
+                let result = self.load_segment_state(state_llvm, state_alloca)?;
+                Ok((result, result_type))
+            }
+
+            "map" => {
+                let ret_type = self.infer_closure_return_type(&args[0]);
+                let (elem_llvm, result_type, alloc_fn): (BasicTypeEnum, BrixType, &str) =
+                    match ret_type {
+                        BrixType::String => {
+                            (ptr_type.into(), BrixType::StringMatrix, "string_matrix_new")
+                        }
+                        BrixType::Float => (
+                            self.context.f64_type().into(),
+                            BrixType::Matrix,
+                            "matrix_new",
+                        ),
+                        BrixType::Int => (i64_type.into(), BrixType::IntMatrix, "intmatrix_new"),
+                        other => {
+                            return Err(CodegenError::TypeError {
+                                expected: "int, float or string".to_string(),
+                                found: format!("{:?}", other),
+                                context: "map() callback on split_iter()/lines()".to_string(),
+                                span: Some(args[0].span.clone()),
+                            });
+                        }
+                    };
+                let (closure_val, _) = self.compile_expr(&args[0])?;
+                let (fn_ptr, env_ptr) = self.load_closure_fn_env(closure_val, span)?;
+                let src = self.compile_segment_source(source)?;
+
+                // One counting pass (no allocation) sizes the result exactly.
+                let count = self.call_runtime(
+                    "brix_str_segment_count",
+                    i64_type.into(),
+                    &[ptr_type.into(), ptr_type.into()],
+                    &[src.text.into(), src.delim.into()],
+                    call_expr,
+                )?;
+                let result = if result_type == BrixType::StringMatrix {
+                    self.call_ptr_runtime(alloc_fn, &[i64_type.into()], &[count.into()], call_expr)?
+                } else {
+                    self.call_ptr_runtime(
+                        alloc_fn,
+                        &[i64_type.into(), i64_type.into()],
+                        &[one.into(), count.into()],
+                        call_expr,
+                    )?
+                };
+                let data = if result_type == BrixType::StringMatrix {
+                    None
+                } else {
+                    let matrix_type = if result_type == BrixType::Matrix {
+                        self.get_matrix_type()
+                    } else {
+                        self.get_intmatrix_type()
+                    };
+                    let data_field = self
+                        .builder
+                        .build_struct_gep(
+                            matrix_type,
+                            result.into_pointer_value(),
+                            3,
+                            "map_data_ptr",
+                        )
+                        .map_err(|_| CodegenError::LLVMError {
+                            operation: "build_struct_gep".to_string(),
+                            details: "Failed to get map result data".to_string(),
+                            span: Some(span.clone()),
+                        })?;
+                    Some(
+                        self.load_segment_state(ptr_type.into(), data_field)?
+                            .into_pointer_value(),
+                    )
+                };
+                let ix_alloca = self.create_entry_block_alloca(i64_type.into(), "_seg_ix")?;
+                self.store_segment_state(ix_alloca, zero.into())?;
+
+                self.compile_segment_loop(&src, "_seg_cur", source, |this, _, seg, _, _| {
+                    let mapped = this
+                        .builder
+                        .build_indirect_call(
+                            elem_llvm.fn_type(&[ptr_type.into(), ptr_type.into()], false),
+                            fn_ptr,
+                            &[env_ptr.into(), seg.into()],
+                            "seg_map",
+                        )
+                        .map_err(|_| CodegenError::LLVMError {
+                            operation: "build_indirect_call".to_string(),
+                            details: "Failed map callback call".to_string(),
+                            span: Some(span.clone()),
+                        })?
+                        .try_as_basic_value()
+                        .left()
+                        .ok_or_else(|| CodegenError::MissingValue {
+                            what: "map callback result".to_string(),
+                            context: "map".to_string(),
+                            span: Some(span.clone()),
+                        })?;
+                    let ix = this.bump_segment_counter(ix_alloca)?;
+                    match data {
+                        // string_matrix_set retains: the callback may hand
+                        // back its (borrowed) argument.
+                        None => this.call_void_segment_runtime(
+                            "string_matrix_set",
+                            &[ptr_type.into(), i64_type.into(), ptr_type.into()],
+                            &[result.into(), ix.into(), mapped.into()],
+                            call_expr,
+                        ),
+                        Some(data) => {
+                            let slot = unsafe {
+                                this.builder
+                                    .build_gep(elem_llvm, data, &[ix], "map_slot")
+                                    .map_err(|_| CodegenError::LLVMError {
+                                        operation: "build_gep".to_string(),
+                                        details: "Failed to index map result".to_string(),
+                                        span: None,
+                                    })?
+                            };
+                            this.store_segment_state(slot, mapped)
+                        }
+                    }
+                })?;
+                Ok((result, result_type))
+            }
+
+            _ => Err(CodegenError::InvalidOperation {
+                operation: method.to_string(),
+                reason: "not available on split_iter()/lines()".to_string(),
+                span: Some(span.clone()),
+            }),
+        }
+    }
+
+    /// Load `counter`, store counter + 1 and return the old value.
+    fn bump_segment_counter(
+        &mut self,
+        counter: PointerValue<'ctx>,
+    ) -> CodegenResult<inkwell::values::IntValue<'ctx>> {
+        let i64_type = self.context.i64_type();
+        let cur = self
+            .load_segment_state(i64_type.into(), counter)?
+            .into_int_value();
+        let next = self
+            .builder
+            .build_int_add(cur, i64_type.const_int(1, false), "seg_next_ix")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_int_add".to_string(),
+                details: "Failed to advance segment counter".to_string(),
+                span: None,
+            })?;
+        self.store_segment_state(counter, next.into())?;
+        Ok(cur)
+    }
+
+    fn load_segment_state(
+        &mut self,
+        ty: BasicTypeEnum<'ctx>,
+        slot: PointerValue<'ctx>,
+    ) -> CodegenResult<BasicValueEnum<'ctx>> {
+        self.builder
+            .build_load(ty, slot, "seg_state")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_load".to_string(),
+                details: "Failed to load segment loop state".to_string(),
+                span: None,
+            })
+    }
+
+    fn store_segment_state(
+        &mut self,
+        slot: PointerValue<'ctx>,
+        val: BasicValueEnum<'ctx>,
+    ) -> CodegenResult<()> {
+        self.builder
+            .build_store(slot, val)
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_store".to_string(),
+                details: "Failed to store segment loop state".to_string(),
+                span: None,
+            })?;
+        Ok(())
+    }
+
+    fn branch_segment(
+        &mut self,
+        cond: inkwell::values::IntValue<'ctx>,
+        then_bb: BasicBlock<'ctx>,
+        else_bb: BasicBlock<'ctx>,
+    ) -> CodegenResult<()> {
+        self.builder
+            .build_conditional_branch(cond, then_bb, else_bb)
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_conditional_branch".to_string(),
+                details: "Failed segment loop branch".to_string(),
+                span: None,
+            })?;
+        Ok(())
+    }
+
+    fn jump_segment(&mut self, target: BasicBlock<'ctx>) -> CodegenResult<()> {
+        self.builder
+            .build_unconditional_branch(target)
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_unconditional_branch".to_string(),
+                details: "Failed segment loop jump".to_string(),
+                span: None,
+            })?;
+        Ok(())
+    }
+
+    /// Declare (once) and call a void runtime function.
+    fn call_void_segment_runtime(
+        &mut self,
+        c_fn: &str,
+        param_types: &[BasicMetadataTypeEnum<'ctx>],
+        call_args: &[BasicMetadataValueEnum<'ctx>],
+        expr: &Expr,
+    ) -> CodegenResult<()> {
+        let fn_type = self.context.void_type().fn_type(param_types, false);
+        let rt_fn = self.module.get_function(c_fn).unwrap_or_else(|| {
+            self.module
+                .add_function(c_fn, fn_type, Some(Linkage::External))
+        });
+        self.builder
+            .build_call(rt_fn, call_args, "")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_call".to_string(),
+                details: format!("Failed to call {}", c_fn),
+                span: Some(expr.span.clone()),
+            })?;
+        Ok(())
+    }
+}
@@ -71,41 +71,9 @@ impl<'a, 'ctx> ExpressionCompiler<'ctx> for Compiler<'a, 'ctx> {
                 Ok((val.into(), BrixType::Float))
             }
             Literal::String(s) => {
-                let raw_str = self
-                    .builder
-                    .build_global_string_ptr(s, "raw_str")
-                    .map_err(|_| CodegenError::LLVMError {
-                        operation: "build_global_string_ptr".to_string(),
-                        details: format!("Failed to create global string for '{}'", s),
-                        span: None,
-                    })?;
-
-                let ptr_type = self.context.ptr_type(AddressSpace::default());
-                let fn_type = ptr_type.fn_type(&[ptr_type.into()], false);
-                let str_new_fn = self.module.get_function("str_new").unwrap_or_else(|| {
-                    self.module
-                        .add_function("str_new", fn_type, Some(Linkage::External))
-                });
-
-                let call = self
-                    .builder
-                    .build_call(str_new_fn, &[raw_str.as_pointer_value().into()], "new_str")
-                    .map_err(|_| CodegenError::LLVMError {
-                        operation: "build_call".to_string(),
-                        details: "Failed to call str_new".to_string(),
-                        span: None,
-                    })?;
-
-                let value =
-                    call.try_as_basic_value()
-                        .left()
-                        .ok_or_else(|| CodegenError::LLVMError {
-                            operation: "try_as_basic_value".to_string(),
-                            details: "str_new call did not return a value".to_string(),
-                            span: None,
-                        })?;
-
-                Ok((value, BrixType::String))
+                // Immortal constant (v1.9): no str_new, nothing to free.
+                let value = self.compile_static_string(s);
+                Ok((value.into(), BrixType::String))
             }
             Literal::Bool(b) => {
                 let bool_val = self.context.bool_type().const_int(*b as u64, false);
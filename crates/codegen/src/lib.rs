@@ -35,6 +35,7 @@ use helpers::HelperFunctions;
 // Note: These traits are imported in respective modules (stmt.rs, expr.rs)
 // and made available on Compiler via trait implementations
 use builtins::matrix::MatrixFunctions;
+use builtins::segments::SEGMENT_METHODS;
 use builtins::string::StringFunctions;
 
 // Import statement compiler trait
@@ -371,6 +372,43 @@ pub(crate) fn extract_async_stmts(stmts: &[Stmt], outer_vars: &[String]) -> Vec<
     result
 }
 
+/// The runtime's string hash (str_hash_bytes in runtime.c), bit for bit.
+/// Literal BrixStrings are read-only constants, so their cached hash is
+/// computed here at compile time (v1.9).
+pub(crate) fn brix_string_hash(bytes: &[u8]) -> u64 {
+    const K0: u64 = 0xa0761d6478bd642f;
+    const K1: u64 = 0xe7037ed1a0b428db;
+    const K2: u64 = 0x8ebc6af09c88c6e3;
+    const K3: u64 = 0x589965cc75374cc3;
+    fn read64(p: &[u8]) -> u64 {
+        u64::from_le_bytes(p[..8].try_into().unwrap())
+    }
+    fn mum(a: u64, b: u64) -> u64 {
+        let r = (a as u128) * (b as u128);
+        (r as u64) ^ ((r >> 64) as u64)
+    }
+
+    let n = bytes.len();
+    let mut h = K0 ^ n as u64;
+    let mut i = 0;
+    while i + 16 <= n {
+        h = mum(read64(&bytes[i..]) ^ K1, read64(&bytes[i + 8..]) ^ h);
+        i += 16;
+    }
+    let (mut a, mut b) = (0u64, 0u64);
+    if n - i >= 8 {
+        a = read64(&bytes[i..]);
+        b = read64(&bytes[n - 8..]);
+    } else {
+        for (j, &byte) in bytes[i..].iter().enumerate() {
+            a |= (byte as u64) << (8 * j);
+        }
+    }
+    h = mum(a ^ K2, b ^ h);
+    h = mum(h ^ K3, n as u64 ^ K1);
+    if h == 0 { 1 } else { h }
+}
+
 pub struct Compiler<'a, 'ctx> {
     pub context: &'ctx Context,
     pub builder: &'a Builder<'ctx>,
@@ -409,6 +447,23 @@ pub struct Compiler<'a, 'ctx> {
     // Loop control flow (v1.6)
     pub current_break_block: Option<inkwell::basic_block::BasicBlock<'ctx>>,
     pub current_continue_block: Option<inkwell::basic_block::BasicBlock<'ctx>>,
+    // References a loop holds across its body (e.g. the string a for-in walks).
+    // The loop releases them on exit; `return` inside the body releases the
+    // entries of the current function.
+    pub loop_owned_refs: Vec<(
+        inkwell::values::FunctionValue<'ctx>,
+        PointerValue<'ctx>,
+        BrixType,
+    )>,
+    // IntMatrix/Matrix parameter slots paired with a null-initialized slot that
+    // owns the copy compile_array_unshare makes when the argument is a static
+    // array literal (v1.9). Released with the function's scope variables.
+    pub param_cow_slots: Vec<(
+        inkwell::values::FunctionValue<'ctx>,
+        PointerValue<'ctx>,
+        PointerValue<'ctx>,
+        BrixType,
+    )>,
 
     // Async state machine tracking (v1.6 Phase 3)
     // Maps async fn name -> poll_fn / create_fn FunctionValue.
@@ -448,6 +503,8 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
             async_fn_names: HashSet::new(),
             current_break_block: None,
             current_continue_block: None,
+            loop_owned_refs: Vec::new(),
+            param_cow_slots: Vec::new(),
             async_poll_fns: HashMap::new(),
             async_create_fns: HashMap::new(),
         }
@@ -509,6 +566,7 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
             return match base_type_str {
                 "int" | "int64" => BrixType::IntMatrix,
                 "float" | "float64" => BrixType::Matrix,
+                "float32" | "f32" => BrixType::Matrix32,
                 _ => BrixType::IntMatrix, // default to IntMatrix for unknown array types
             };
         }
@@ -630,6 +688,12 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
             "string" => BrixType::String,
             "matrix" => BrixType::Matrix,
             "intmatrix" => BrixType::IntMatrix,
+            "sparsematrix" => BrixType::SparseMatrix,
+            "matrix32" => BrixType::Matrix32,
+            "lufactor" => BrixType::LUFactor,
+            "choleskyfactor" => BrixType::CholeskyFactor,
+            "qrfactor" => BrixType::QRFactor,
+            "StringBuilder" => BrixType::StringBuilder,
             "complex" => BrixType::Complex,
             "nil" => BrixType::Nil,
             "error" => BrixType::Error,
@@ -694,6 +758,22 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                 // Pointer to runtime struct
                 self.context.ptr_type(AddressSpace::default()).into()
             }
+            BrixType::SparseMatrix => {
+                // SparseMatrix is a pointer to the heap CSR struct.
+                self.context.ptr_type(AddressSpace::default()).into()
+            }
+            BrixType::Matrix32 => {
+                // Matrix32 is a pointer to the heap f32 matrix struct.
+                self.context.ptr_type(AddressSpace::default()).into()
+            }
+            BrixType::LUFactor | BrixType::CholeskyFactor | BrixType::QRFactor => {
+                // All factor types share the runtime Factorization struct.
+                self.context.ptr_type(AddressSpace::default()).into()
+            }
+            BrixType::StringBuilder => {
+                // StringBuilder is a pointer to the heap BrixStringBuilder struct.
+                self.context.ptr_type(AddressSpace::default()).into()
+            }
             BrixType::Vector(_) => {
                 // Vector<T> is a pointer to the heap BrixVector struct.
                 self.context.ptr_type(AddressSpace::default()).into()
@@ -911,6 +991,7 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                     details: format!("Failed to store parameter '{}'", param_name),
                     span: None,
                 })?;
+            self.track_array_param(llvm_function, alloca, &param_type, param_name)?;
             self.variables
                 .insert(param_name.clone(), (alloca, param_type));
         }
@@ -1134,6 +1215,7 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                     details: format!("Failed to store parameter '{}'", param_name),
                     span: None,
                 })?;
+            self.track_array_param(llvm_function, alloca, &param_type, param_name)?;
             self.variables
                 .insert(param_name.clone(), (alloca, param_type));
         }
@@ -1145,6 +1227,7 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
         if ret_types.is_empty() {
             if let Some(block) = self.builder.get_insert_block() {
                 if block.get_terminator().is_none() {
+                    self.release_param_cow_slots()?;
                     self.builder
                         .build_return(None)
                         .map_err(|_| CodegenError::LLVMError {
@@ -1203,7 +1286,8 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
         // 2. Create field value map from field_inits
         let mut field_values: HashMap<String, BasicValueEnum> = HashMap::new();
         for (field_name, field_expr) in field_inits {
-            let (value, _) = self.compile_expr(field_expr)?;
+            let (value, value_type) = self.compile_expr(field_expr)?;
+            let value = self.compile_array_owned(value, &value_type, field_expr)?;
             field_values.insert(field_name.clone(), value);
         }
 
@@ -1215,8 +1299,8 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                 *val
             } else if let Some(default_expr) = default {
                 // Use default value
-                let (val, _) = self.compile_expr(default_expr)?;
-                val
+                let (val, val_type) = self.compile_expr(default_expr)?;
+                self.compile_array_owned(val, &val_type, default_expr)?
             } else {
                 return Err(CodegenError::InvalidOperation {
                     operation: format!("struct initialization for '{}'", actual_struct_name),
@@ -1254,6 +1338,12 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                 | BrixType::IntMatrix
                 | BrixType::StringMatrix
                 | BrixType::ComplexMatrix
+                | BrixType::SparseMatrix
+                | BrixType::Matrix32
+                | BrixType::LUFactor
+                | BrixType::CholeskyFactor
+                | BrixType::QRFactor
+                | BrixType::StringBuilder
                 | BrixType::Vector(_)
                 | BrixType::Stack(_)
                 | BrixType::Queue(_)
@@ -1310,6 +1400,12 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
             BrixType::IntMatrix => "intmatrix_retain",
             BrixType::StringMatrix => "string_matrix_retain",
             BrixType::ComplexMatrix => "complexmatrix_retain",
+            BrixType::SparseMatrix => "sparsematrix_retain",
+            BrixType::Matrix32 => "matrix32_retain",
+            BrixType::LUFactor | BrixType::CholeskyFactor | BrixType::QRFactor => {
+                "factorization_retain"
+            }
+            BrixType::StringBuilder => "stringbuilder_retain",
             BrixType::Vector(_) => "brix_vector_retain",
             // Stack<T> IS a BrixVector* underneath — reuse the vector symbol.
             BrixType::Stack(_) => "brix_vector_retain",
@@ -1368,6 +1464,12 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
             BrixType::IntMatrix => "intmatrix_release",
             BrixType::StringMatrix => "string_matrix_release",
             BrixType::ComplexMatrix => "complexmatrix_release",
+            BrixType::SparseMatrix => "sparsematrix_release",
+            BrixType::Matrix32 => "matrix32_release",
+            BrixType::LUFactor | BrixType::CholeskyFactor | BrixType::QRFactor => {
+                "factorization_release"
+            }
+            BrixType::StringBuilder => "stringbuilder_release",
             BrixType::Vector(_) => "brix_vector_release",
             // Stack<T> IS a BrixVector* underneath — reuse the vector symbol.
             BrixType::Stack(_) => "brix_vector_release",
@@ -1555,6 +1657,84 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
             }
         }
 
+        self.release_param_cow_slots()
+    }
+
+    /// Register an IntMatrix/Matrix parameter slot with a null-initialized
+    /// slot for the copy compile_array_unshare makes when the argument is a
+    /// static array literal (v1.9). Parameters are borrowed, so that copy is
+    /// the only thing the function must release for them.
+    fn track_array_param(
+        &mut self,
+        function: inkwell::values::FunctionValue<'ctx>,
+        slot: PointerValue<'ctx>,
+        param_type: &BrixType,
+        param_name: &str,
+    ) -> CodegenResult<()> {
+        if !matches!(param_type, BrixType::Matrix | BrixType::IntMatrix) {
+            return Ok(());
+        }
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let cow_slot = self
+            .create_null_init_entry_block_alloca(ptr_type.into(), &format!("{}_cow", param_name))?;
+        self.param_cow_slots
+            .push((function, slot, cow_slot, param_type.clone()));
+        Ok(())
+    }
+
+    /// ARC: Release the static-literal copies written into the current
+    /// function's array parameters (see track_array_param).
+    fn release_param_cow_slots(&mut self) -> CodegenResult<()> {
+        let Some(current) = self.current_function else {
+            return Ok(());
+        };
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let slots: Vec<_> = self
+            .param_cow_slots
+            .iter()
+            .filter(|(f, _, _, _)| *f == current)
+            .map(|(_, _, cow, t)| (*cow, t.clone()))
+            .collect();
+        for (cow_slot, ty) in slots {
+            let copy = self
+                .builder
+                .build_load(ptr_type, cow_slot, "param_cow")
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_load".to_string(),
+                    details: "Failed to load parameter copy for release".to_string(),
+                    span: None,
+                })?
+                .into_pointer_value();
+            self.insert_release(copy, &ty)?;
+        }
+        Ok(())
+    }
+
+    /// The slot owning the static-literal copy written into `slot`, when
+    /// `slot` is an array parameter of the current function.
+    fn param_cow_slot(&self, slot: PointerValue<'ctx>) -> Option<PointerValue<'ctx>> {
+        let current = self.current_function?;
+        self.param_cow_slots
+            .iter()
+            .find(|(f, p, _, _)| *f == current && *p == slot)
+            .map(|(_, _, cow, _)| *cow)
+    }
+
+    /// ARC: Release the references held by the enclosing loops of the current
+    /// function, before a `return` leaves them early.
+    fn release_loop_owned_refs(&mut self) -> CodegenResult<()> {
+        let Some(current) = self.current_function else {
+            return Ok(());
+        };
+        let held: Vec<_> = self
+            .loop_owned_refs
+            .iter()
+            .filter(|(f, _, _)| *f == current)
+            .map(|(_, p, t)| (*p, t.clone()))
+            .collect();
+        for (ptr, ty) in held.into_iter().rev() {
+            self.insert_release(ptr, &ty)?;
+        }
         Ok(())
     }
 
@@ -2086,6 +2266,262 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
         Ok((result, receiver_type.clone()))
     }
 
+    /// Compile an array literal made only of numeric constants (v1.9) as
+    /// static data: the elements become a private constant global and the
+    /// Matrix/IntMatrix header another, with ref_count BRIX_RC_STATIC so ARC
+    /// leaves it alone. Evaluating the literal is then just its address - no
+    /// matrix_new and no per-element stores, however often it runs. Writes go
+    /// through compile_array_unshare, which copies first. Returns None when
+    /// some element is not a constant.
+    fn compile_static_array_literal(
+        &mut self,
+        elements: &[Expr],
+    ) -> CodegenResult<Option<(BasicValueEnum<'ctx>, BrixType)>> {
+        fn constant(expr: &Expr) -> Option<(bool, i64, f64)> {
+            match &expr.kind {
+                ExprKind::Literal(Literal::Int(i)) => Some((true, *i, *i as f64)),
+                ExprKind::Literal(Literal::Float(f)) => Some((false, 0, *f)),
+                ExprKind::Unary {
+                    op: UnaryOp::Negate,
+                    expr,
+                } => constant(expr).map(|(is_int, i, f)| (is_int, i.wrapping_neg(), -f)),
+                _ => None,
+            }
+        }
+
+        if elements.is_empty() {
+            return Ok(None);
+        }
+        let Some(values) = elements.iter().map(constant).collect::<Option<Vec<_>>>() else {
+            return Ok(None);
+        };
+        let all_int = values.iter().all(|(is_int, _, _)| *is_int);
+        let n = values.len() as u64;
+        let i64_type = self.context.i64_type();
+
+        let (data_init, header_type, brix_type) = if all_int {
+            let elems: Vec<_> = values
+                .iter()
+                .map(|(_, i, _)| i64_type.const_int(*i as u64, true))
+                .collect();
+            (
+                i64_type.const_array(&elems),
+                self.get_intmatrix_type(),
+                BrixType::IntMatrix,
+            )
+        } else {
+            let f64_type = self.context.f64_type();
+            let elems: Vec<_> = values
+                .iter()
+                .map(|(_, _, f)| f64_type.const_float(*f))
+                .collect();
+            (
+                f64_type.const_array(&elems),
+                self.get_matrix_type(),
+                BrixType::Matrix,
+            )
+        };
+
+        let data = self
+            .module
+            .add_global(data_init.get_type(), None, "array_lit_data");
+        data.set_initializer(&data_init);
+        data.set_constant(true);
+        data.set_linkage(Linkage::Private);
+        data.set_unnamed_addr(true);
+
+        // { ref_count = BRIX_RC_STATIC, rows, cols, data, capacity, head }
+        let header_init = header_type.const_named_struct(&[
+            i64_type.const_all_ones().into(),
+            i64_type.const_int(1, false).into(),
+            i64_type.const_int(n, false).into(),
+            data.as_pointer_value().into(),
+            i64_type.const_int(n, false).into(),
+            i64_type.const_int(0, false).into(),
+        ]);
+        let header = self.module.add_global(header_type, None, "array_lit");
+        header.set_initializer(&header_init);
+        header.set_constant(true);
+        header.set_linkage(Linkage::Private);
+
+        Ok(Some((header.as_pointer_value().into(), brix_type)))
+    }
+
+    /// Emit a string literal as an immortal BrixString (v1.9): the bytes and
+    /// the { ref_count = BRIX_RC_STATIC, len, data, capacity = 0, no owner,
+    /// hash, no code-point index } header are both private constant globals,
+    /// so using the literal allocates nothing and string_retain/string_release
+    /// leave it alone.
+    /// `len` stops at the first NUL, matching what str_new measured with
+    /// strlen. The header is read-only, so its hash is filled in here.
+    fn compile_static_string(&self, s: &str) -> PointerValue<'ctx> {
+        let i64_type = self.context.i64_type();
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let len = s.find('\0').unwrap_or(s.len()) as u64;
+
+        let bytes = self.context.const_string(s.as_bytes(), true);
+        let data = self
+            .module
+            .add_global(bytes.get_type(), None, "str_lit_data");
+        data.set_initializer(&bytes);
+        data.set_constant(true);
+        data.set_linkage(Linkage::Private);
+        data.set_unnamed_addr(true);
+
+        let header_type = self.get_string_type();
+        let header_init = header_type.const_named_struct(&[
+            i64_type.const_all_ones().into(),
+            i64_type.const_int(len, false).into(),
+            data.as_pointer_value().into(),
+            i64_type.const_zero().into(),
+            ptr_type.const_null().into(),
+            ptr_type.const_null().into(),
+            i64_type
+                .const_int(brix_string_hash(&s.as_bytes()[..len as usize]), false)
+                .into(),
+            ptr_type.const_null().into(),
+        ]);
+        let header = self.module.add_global(header_type, None, "str_lit");
+        header.set_initializer(&header_init);
+        header.set_constant(true);
+        header.set_linkage(Linkage::Private);
+        header.set_unnamed_addr(true);
+
+        header.as_pointer_value()
+    }
+
+    /// Copy-on-write guard before writing through an array (v1.9). Constant
+    /// array literals are static data (ref_count BRIX_RC_STATIC in runtime.c)
+    /// shared by every evaluation, so a write first swaps one for a private
+    /// copy; when the array lives in a variable or struct field the copy is
+    /// stored back there. Mutable bindings already hold heap copies (see
+    /// compile_array_owned), so this only fires for const bindings, parameters
+    /// and temporaries. The ref_count test is inline, so writes to heap arrays
+    /// stay on the fast path.
+    fn compile_array_unshare(
+        &mut self,
+        array_expr: &Expr,
+        array_ptr: PointerValue<'ctx>,
+        array_type: &BrixType,
+    ) -> CodegenResult<PointerValue<'ctx>> {
+        let i64_type = self.context.i64_type();
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let (header_type, c_fn) = if *array_type == BrixType::IntMatrix {
+            (self.get_intmatrix_type(), "intmatrix_unshare")
+        } else {
+            (self.get_matrix_type(), "matrix_unshare")
+        };
+
+        let rc_ptr = self
+            .builder
+            .build_struct_gep(header_type, array_ptr, 0, "rc_ptr")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_struct_gep".to_string(),
+                details: "Failed to get array ref_count pointer".to_string(),
+                span: Some(array_expr.span.clone()),
+            })?;
+        let rc = self
+            .builder
+            .build_load(i64_type, rc_ptr, "rc")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_load".to_string(),
+                details: "Failed to load array ref_count".to_string(),
+                span: Some(array_expr.span.clone()),
+            })?
+            .into_int_value();
+        let is_static = self
+            .builder
+            .build_int_compare(IntPredicate::EQ, rc, i64_type.const_all_ones(), "is_static")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_int_compare".to_string(),
+                details: "Failed to test for a static array".to_string(),
+                span: Some(array_expr.span.clone()),
+            })?;
+
+        let function = self.current_function()?;
+        let entry_bb = self
+            .builder
+            .get_insert_block()
+            .ok_or_else(|| CodegenError::LLVMError {
+                operation: "get_insert_block".to_string(),
+                details: "No current block for array copy-on-write".to_string(),
+                span: Some(array_expr.span.clone()),
+            })?;
+        let copy_bb = self.context.append_basic_block(function, "cow_copy");
+        let cont_bb = self.context.append_basic_block(function, "cow_cont");
+        self.builder
+            .build_conditional_branch(is_static, copy_bb, cont_bb)
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_conditional_branch".to_string(),
+                details: "Failed to branch on static array".to_string(),
+                span: Some(array_expr.span.clone()),
+            })?;
+
+        self.builder.position_at_end(copy_bb);
+        let copy = self
+            .call_ptr_runtime(c_fn, &[ptr_type.into()], &[array_ptr.into()], array_expr)?
+            .into_pointer_value();
+        if matches!(
+            array_expr.kind,
+            ExprKind::Identifier(_) | ExprKind::FieldAccess { .. }
+        ) {
+            if let Ok((slot, _)) = self.compile_lvalue_addr(array_expr) {
+                // A parameter slot is borrowed: its copy is also recorded
+                // for release when the function returns.
+                let owners = std::iter::once(slot).chain(self.param_cow_slot(slot));
+                for owner in owners.collect::<Vec<_>>() {
+                    self.builder
+                        .build_store(owner, copy)
+                        .map_err(|_| CodegenError::LLVMError {
+                            operation: "build_store".to_string(),
+                            details: "Failed to store unshared array".to_string(),
+                            span: Some(array_expr.span.clone()),
+                        })?;
+                }
+            }
+        }
+        let copy_end_bb = self.builder.get_insert_block().unwrap_or(copy_bb);
+        self.builder
+            .build_unconditional_branch(cont_bb)
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_unconditional_branch".to_string(),
+                details: "Failed to leave array copy-on-write block".to_string(),
+                span: Some(array_expr.span.clone()),
+            })?;
+
+        self.builder.position_at_end(cont_bb);
+        let phi =
+            self.builder
+                .build_phi(ptr_type, "unshared")
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_phi".to_string(),
+                    details: "Failed to merge unshared array".to_string(),
+                    span: Some(array_expr.span.clone()),
+                })?;
+        phi.add_incoming(&[(&array_ptr, entry_bb), (&copy, copy_end_bb)]);
+        Ok(phi.as_basic_value().into_pointer_value())
+    }
+
+    /// Heap copy of a static array literal about to be bound to a variable,
+    /// struct field or assignment target (v1.9). Copy-on-write only updates
+    /// the written slot, so a static array shared by two mutable names would
+    /// let a write through one stay invisible through the other. Heap arrays
+    /// (and other types) pass through unchanged.
+    fn compile_array_owned(
+        &mut self,
+        val: BasicValueEnum<'ctx>,
+        val_type: &BrixType,
+        expr: &Expr,
+    ) -> CodegenResult<BasicValueEnum<'ctx>> {
+        let c_fn = match val_type {
+            BrixType::Matrix => "matrix_unshare",
+            BrixType::IntMatrix => "intmatrix_unshare",
+            _ => return Ok(val),
+        };
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        self.call_ptr_runtime(c_fn, &[ptr_type.into()], &[val.into()], expr)
+    }
+
     fn compile_lvalue_addr(
         &mut self,
         expr: &Expr,
@@ -2117,7 +2553,11 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                 }
 
                 let is_int_matrix = target_type == BrixType::IntMatrix;
-                let matrix_ptr = target_val.into_pointer_value();
+                let matrix_ptr = self.compile_array_unshare(
+                    array,
+                    target_val.into_pointer_value(),
+                    &target_type,
+                )?;
                 let matrix_type = if is_int_matrix {
                     self.get_intmatrix_type()
                 } else {
@@ -2336,9 +2776,9 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                 name,
                 type_hint,
                 value,
-                is_const: _,
+                is_const,
             } => {
-                self.compile_variable_decl_stmt(name, type_hint, value)?;
+                self.compile_variable_decl_stmt(name, type_hint, value, *is_const)?;
                 Ok(())
             }
 
@@ -2621,6 +3061,10 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                         self.variables.remove(var_name);
                         Ok(())
                     }
+                } else if self.string_segments_source(iterable).is_some() {
+                    self.compile_string_segments_for(var_names, iterable, body, function, stmt)
+                } else if let Some((text, unit)) = Self::string_units_iterable(iterable) {
+                    self.compile_string_units_for(var_names, text, unit, body, function, stmt)
                 } else {
                     // For iterating over arrays/matrices
                     let (iterable_val, iterable_type) = self.compile_expr(iterable)?;
@@ -3723,7 +4167,13 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                             Ok(())
                         }
                         BrixType::String => {
-                            // String iteration: for ch in "hello" → ch is a 1-char string
+                            // String iteration: for ch in "héllo" → ch is a string
+                            // holding one code point. The loop walks byte offsets
+                            // and brix_str_next_char returns the character at
+                            // each one (an immortal cached string for ASCII, a
+                            // small copy otherwise); its len is the step to the next.
+                            // .chars()/.bytes() avoid the strings altogether
+                            // (compile_string_units_for).
                             if var_names.len() != 1 {
                                 return Err(CodegenError::InvalidOperation {
                                     operation: "String iteration".to_string(),
@@ -3737,11 +4187,11 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                             let i64_type = self.context.i64_type();
                             let ptr_type = self.context.ptr_type(AddressSpace::default());
 
-                            // Get string length via brix_length()
-                            let length_fn = self.get_length();
+                            // Iterate over byte offsets: brix_byte_size()
+                            let byte_size_fn = self.get_byte_size();
                             let len_call = self
                                 .builder
-                                .build_call(length_fn, &[string_ptr.into()], "str_len")
+                                .build_call(byte_size_fn, &[string_ptr.into()], "str_len")
                                 .map_err(|_| CodegenError::LLVMError {
                                     operation: "build_call".to_string(),
                                     details: "Failed to get string length for iteration"
@@ -3758,8 +4208,7 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                                 })?
                                 .into_int_value();
 
-                            // Get char_at function
-                            let char_at_fn = self.get_str_char_at();
+                            let string_type = self.get_string_type();
 
                             // Index alloca
                             let idx_alloca =
@@ -3830,25 +4279,49 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                                     span: None,
                                 })?
                                 .into_int_value();
-                            let ch_call = self
+                            let ch_val = self.call_ptr_runtime(
+                                "brix_str_next_char",
+                                &[ptr_type.into(), i64_type.into()],
+                                &[string_ptr.into(), cur_idx.into()],
+                                iterable,
+                            )?;
+                            let ch_len_ptr = self
                                 .builder
-                                .build_call(
-                                    char_at_fn,
-                                    &[string_ptr.into(), cur_idx.into()],
-                                    "str_ch",
+                                .build_struct_gep(
+                                    string_type,
+                                    ch_val.into_pointer_value(),
+                                    1,
+                                    "str_ch_len_ptr",
                                 )
                                 .map_err(|_| CodegenError::LLVMError {
-                                    operation: "build_call".to_string(),
-                                    details: "Failed char_at call".to_string(),
+                                    operation: "build_struct_gep".to_string(),
+                                    details: "Failed to get char byte width".to_string(),
+                                    span: None,
+                                })?;
+                            let ch_len = self
+                                .builder
+                                .build_load(i64_type, ch_len_ptr, "str_ch_len")
+                                .map_err(|_| CodegenError::LLVMError {
+                                    operation: "build_load".to_string(),
+                                    details: "Failed to load char byte width".to_string(),
+                                    span: None,
+                                })?
+                                .into_int_value();
+                            let next_idx = self
+                                .builder
+                                .build_int_add(cur_idx, ch_len, "str_next_idx")
+                                .map_err(|_| CodegenError::LLVMError {
+                                    operation: "build_int_add".to_string(),
+                                    details: "Failed str iter advance".to_string(),
+                                    span: None,
+                                })?;
+                            self.builder
+                                .build_store(idx_alloca, next_idx)
+                                .map_err(|_| CodegenError::LLVMError {
+                                    operation: "build_store".to_string(),
+                                    details: "Failed str iter advance store".to_string(),
                                     span: None,
                                 })?;
-                            let ch_val = ch_call.try_as_basic_value().left().ok_or_else(|| {
-                                CodegenError::MissingValue {
-                                    what: "char value".to_string(),
-                                    context: "for-in string".to_string(),
-                                    span: Some(stmt.span.clone()),
-                                }
-                            })?;
                             self.builder.build_store(var_alloca, ch_val).map_err(|_| {
                                 CodegenError::LLVMError {
                                     operation: "build_store".to_string(),
@@ -3877,36 +4350,8 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                                     })?;
                             }
 
-                            // --- INC ---
+                            // --- INC --- (the index was advanced in the body)
                             self.builder.position_at_end(inc_bb);
-                            let tmp_idx = self
-                                .builder
-                                .build_load(i64_type, idx_alloca, "str_inc_idx")
-                                .map_err(|_| CodegenError::LLVMError {
-                                    operation: "build_load".to_string(),
-                                    details: "Failed str iter inc load".to_string(),
-                                    span: None,
-                                })?
-                                .into_int_value();
-                            let next_idx = self
-                                .builder
-                                .build_int_add(
-                                    tmp_idx,
-                                    i64_type.const_int(1, false),
-                                    "str_next_idx",
-                                )
-                                .map_err(|_| CodegenError::LLVMError {
-                                    operation: "build_int_add".to_string(),
-                                    details: "Failed str iter inc add".to_string(),
-                                    span: None,
-                                })?;
-                            self.builder
-                                .build_store(idx_alloca, next_idx)
-                                .map_err(|_| CodegenError::LLVMError {
-                                    operation: "build_store".to_string(),
-                                    details: "Failed str iter inc store".to_string(),
-                                    span: None,
-                                })?;
                             self.builder
                                 .build_unconditional_branch(cond_bb)
                                 .map_err(|_| CodegenError::LLVMError {
@@ -4157,6 +4602,70 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                                 })?;
                             Ok((val, BrixType::ComplexMatrix))
                         }
+                        BrixType::SparseMatrix => {
+                            // Load the pointer to the CSR sparsematrix struct
+                            let val = self
+                                .builder
+                                .build_load(
+                                    self.context.ptr_type(AddressSpace::default()),
+                                    *ptr,
+                                    name,
+                                )
+                                .map_err(|_| CodegenError::LLVMError {
+                                    operation: "unwrap".to_string(),
+                                    details: "Failed in compile_expr".to_string(),
+                                    span: None,
+                                })?;
+                            Ok((val, BrixType::SparseMatrix))
+                        }
+                        BrixType::Matrix32 => {
+                            // Load the pointer to the f32 matrix32 struct
+                            let val = self
+                                .builder
+                                .build_load(
+                                    self.context.ptr_type(AddressSpace::default()),
+                                    *ptr,
+                                    name,
+                                )
+                                .map_err(|_| CodegenError::LLVMError {
+                                    operation: "unwrap".to_string(),
+                                    details: "Failed in compile_expr".to_string(),
+                                    span: None,
+                                })?;
+                            Ok((val, BrixType::Matrix32))
+                        }
+                        BrixType::LUFactor | BrixType::CholeskyFactor | BrixType::QRFactor => {
+                            // Load the pointer to the shared Factorization struct
+                            let val = self
+                                .builder
+                                .build_load(
+                                    self.context.ptr_type(AddressSpace::default()),
+                                    *ptr,
+                                    name,
+                                )
+                                .map_err(|_| CodegenError::LLVMError {
+                                    operation: "unwrap".to_string(),
+                                    details: "Failed in compile_expr".to_string(),
+                                    span: None,
+                                })?;
+                            Ok((val, brix_type.clone()))
+                        }
+                        BrixType::StringBuilder => {
+                            // Load the pointer to the BrixStringBuilder struct
+                            let val = self
+                                .builder
+                                .build_load(
+                                    self.context.ptr_type(AddressSpace::default()),
+                                    *ptr,
+                                    name,
+                                )
+                                .map_err(|_| CodegenError::LLVMError {
+                                    operation: "unwrap".to_string(),
+                                    details: "Failed in compile_expr".to_string(),
+                                    span: None,
+                                })?;
+                            Ok((val, BrixType::StringBuilder))
+                        }
                         BrixType::Tuple(types) => {
                             // Check if this is a closure (Tuple with 3 Int fields = {ref_count, fn_ptr, env_ptr})
                             if types.len() == 3
@@ -4831,6 +5340,23 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                     }
                 }
 
+                // --- MATRIX32 ARITHMETIC (v1.9) ---
+                if is_arithmetic_op
+                    && (lhs_type == BrixType::Matrix32 || rhs_type == BrixType::Matrix32)
+                {
+                    return self
+                        .compile_matrix32_binary(op, lhs_val, &lhs_type, rhs_val, &rhs_type, expr);
+                }
+
+                // --- COMPLEXMATRIX ARITHMETIC (v1.9) ---
+                if is_arithmetic_op
+                    && (lhs_type == BrixType::ComplexMatrix || rhs_type == BrixType::ComplexMatrix)
+                {
+                    return self.compile_complexmatrix_binary(
+                        op, lhs_val, &lhs_type, rhs_val, &rhs_type, expr,
+                    );
+                }
+
                 // --- MATRIX ARITHMETIC OPERATIONS (v1.1) ---
                 // Handle Matrix/IntMatrix operations with scalars and other matrices
                 if is_arithmetic_op {
@@ -5951,6 +6477,14 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                         // Check if this is a math module function
                         let fn_name = field.as_str();
 
+                        let is_regex = self
+                            .imported_modules
+                            .iter()
+                            .any(|(m, p)| m == "regex" && p == _module_name);
+                        if is_regex {
+                            return self.compile_regex_call(fn_name, args, expr);
+                        }
+
                         // LAPACK decompositions that return several matrices as a
                         // Brix tuple (math.lu/qr/svd). Handled here (not via the
                         // generic math dispatch below) because the C wrapper
@@ -5968,7 +6502,9 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                                         "lu",
                                         "math_lu",
                                         &[BrixType::Matrix, BrixType::Matrix, BrixType::IntMatrix],
-                                        args,
+                                        1,
+                                        false,
+                                        args,
                                         expr,
                                     );
                                 }
@@ -5977,6 +6513,8 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                                         "qr",
                                         "math_qr",
                                         &[BrixType::Matrix, BrixType::Matrix],
+                                        1,
+                                        false,
                                         args,
                                         expr,
                                     );
@@ -5986,6 +6524,54 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                                         "svd",
                                         "math_svd",
                                         &[BrixType::Matrix, BrixType::Matrix, BrixType::Matrix],
+                                        1,
+                                        false,
+                                        args,
+                                        expr,
+                                    );
+                                }
+                                "eigh" => {
+                                    return self.compile_math_matrix_tuple(
+                                        "eigh",
+                                        "math_eigh",
+                                        &[BrixType::Matrix, BrixType::Matrix],
+                                        1,
+                                        true,
+                                        args,
+                                        expr,
+                                    );
+                                }
+                                "lstsq" => {
+                                    return self.compile_math_matrix_tuple(
+                                        "lstsq",
+                                        "math_lstsq",
+                                        &[BrixType::Matrix, BrixType::Matrix, BrixType::Int],
+                                        2,
+                                        false,
+                                        args,
+                                        expr,
+                                    );
+                                }
+                                "linreg" => {
+                                    return self.compile_math_matrix_tuple(
+                                        "linreg",
+                                        "math_linreg",
+                                        &[BrixType::Matrix, BrixType::Matrix, BrixType::Matrix],
+                                        2,
+                                        false,
+                                        args,
+                                        expr,
+                                    );
+                                }
+                                "eigvalsh" => {
+                                    return self.compile_math_eigvalsh(args, expr);
+                                }
+                                "eigvals" | "eigvecs" => {
+                                    return self.compile_math_simple_builtin(
+                                        fn_name,
+                                        &format!("brix_{}", fn_name),
+                                        1,
+                                        BrixType::ComplexMatrix,
                                         args,
                                         expr,
                                     );
@@ -6023,6 +6609,46 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                                 "norm_mat" => {
                                     return self.compile_math_norm_mat(args, expr);
                                 }
+                                "dot" | "axpy" | "axpy_inplace" | "cov" | "corrcoef" => {
+                                    return self.compile_math_blas(fn_name, args, expr);
+                                }
+                                "cg" | "bicgstab" | "gmres" => {
+                                    return self.compile_math_krylov(fn_name, args, expr);
+                                }
+                                "lu_factor" => {
+                                    return self.compile_math_simple_builtin(
+                                        "lu_factor",
+                                        "math_lu_factor",
+                                        1,
+                                        BrixType::LUFactor,
+                                        args,
+                                        expr,
+                                    );
+                                }
+                                "cholesky_factor" => {
+                                    return self.compile_math_simple_builtin(
+                                        "cholesky_factor",
+                                        "math_cholesky_factor",
+                                        1,
+                                        BrixType::CholeskyFactor,
+                                        args,
+                                        expr,
+                                    );
+                                }
+                                "qr_factor" => {
+                                    return self.compile_math_simple_builtin(
+                                        "qr_factor",
+                                        "math_qr_factor",
+                                        1,
+                                        BrixType::QRFactor,
+                                        args,
+                                        expr,
+                                    );
+                                }
+                                "fft" | "ifft" | "fft2" | "ifft2" | "rfft" | "fft_inplace"
+                                | "ifft_inplace" => {
+                                    return self.compile_math_fft(fn_name, args, expr);
+                                }
                                 _ => {}
                             }
                         }
@@ -6106,6 +6732,17 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
 
                     // Check if this is a method call (e.g., obj.method(args))
                     if let ExprKind::FieldAccess { target, field } = &func.kind {
+                        // Lazy split (v1.9): s.split_iter(d) / s.lines() are consumed
+                        // one segment at a time, or collected when used as a value.
+                        if SEGMENT_METHODS.contains(&field.as_str())
+                            && self.string_segments_source(target).is_some()
+                        {
+                            return self.compile_string_segments_method(target, field, args, expr);
+                        }
+                        if self.string_segments_source(expr).is_some() {
+                            return self.compile_string_segments_collect(expr);
+                        }
+
                         // Check for iterator/array methods on IntMatrix/Matrix and string
                         // methods. `reverse` overlaps both sets, so the target is compiled
                         // once here and dispatched by its actual type to avoid double-eval.
@@ -6179,8 +6816,33 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                             field.as_str(),
                             "set" | "get" | "has" | "delete" | "len" | "keys"
                         );
+                        // SparseMatrix methods (v1.9).
+                        let is_sparse_method =
+                            matches!(field.as_str(), "mul" | "to_dense" | "transpose");
+                        // Matrix32 methods (v1.9).
+                        let is_matrix32_method = matches!(
+                            field.as_str(),
+                            "sum" | "mean" | "min" | "max" | "map" | "filter" | "reduce"
+                        );
+                        // LUFactor / CholeskyFactor / QRFactor methods (v1.9).
+                        let is_factor_method = matches!(field.as_str(), "solve" | "det" | "inv");
+                        // StringBuilder methods (v1.9).
+                        let is_sb_method = matches!(
+                            field.as_str(),
+                            "append"
+                                | "append_int"
+                                | "append_float"
+                                | "append_char"
+                                | "reserve"
+                                | "len"
+                                | "build"
+                        );
                         if is_iter_method
                             || is_str_method
+                            || is_sparse_method
+                            || is_matrix32_method
+                            || is_factor_method
+                            || is_sb_method
                             || is_vector_method
                             || is_stack_method
                             || is_queue_method
@@ -6248,6 +6910,42 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                                     );
                                 }
                             }
+                            if is_sb_method && receiver_type == BrixType::StringBuilder {
+                                return self.compile_stringbuilder_method(
+                                    receiver_val,
+                                    field,
+                                    args,
+                                    expr,
+                                );
+                            }
+                            if is_sparse_method && receiver_type == BrixType::SparseMatrix {
+                                return self.compile_sparse_method(receiver_val, field, args, expr);
+                            }
+                            if is_factor_method
+                                && matches!(
+                                    receiver_type,
+                                    BrixType::LUFactor
+                                        | BrixType::CholeskyFactor
+                                        | BrixType::QRFactor
+                                )
+                            {
+                                return self.compile_factor_method(
+                                    receiver_val,
+                                    &receiver_type,
+                                    target,
+                                    field,
+                                    args,
+                                    expr,
+                                );
+                            }
+                            if is_matrix32_method && receiver_type == BrixType::Matrix32 {
+                                return self.compile_matrix32_method(
+                                    receiver_val,
+                                    field,
+                                    args,
+                                    expr,
+                                );
+                            }
                             if is_hashmap_method {
                                 if let BrixType::HashMap(key_type, val_type) = &receiver_type {
                                     let key_type = key_type.as_ref().clone();
@@ -6470,6 +7168,12 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                             BrixType::Complex => "complex".to_string(),
                             BrixType::ComplexArray => "complexarray".to_string(),
                             BrixType::ComplexMatrix => "complexmatrix".to_string(),
+                            BrixType::SparseMatrix => "sparsematrix".to_string(),
+                            BrixType::Matrix32 => "matrix32".to_string(),
+                            BrixType::LUFactor => "lufactor".to_string(),
+                            BrixType::CholeskyFactor => "choleskyfactor".to_string(),
+                            BrixType::QRFactor => "qrfactor".to_string(),
+                            BrixType::StringBuilder => "stringbuilder".to_string(),
                             BrixType::FloatPtr => "float_ptr".to_string(),
                             BrixType::Void => "void".to_string(),
                             BrixType::Tuple(_) => "tuple".to_string(),
@@ -6609,28 +7313,7 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
 
                                 // Extract char* from BrixString
                                 let struct_ptr = val.into_pointer_value();
-                                let str_type = self.get_string_type();
-                                let data_ptr_ptr = self
-                                    .builder
-                                    .build_struct_gep(str_type, struct_ptr, 2, "str_data_ptr")
-                                    .map_err(|_| CodegenError::LLVMError {
-                                        operation: "build_struct_gep".to_string(),
-                                        details: "Failed to get string data ptr for int()"
-                                            .to_string(),
-                                        span: Some(expr.span.clone()),
-                                    })?;
-                                let data_ptr = self
-                                    .builder
-                                    .build_load(
-                                        self.context.ptr_type(AddressSpace::default()),
-                                        data_ptr_ptr,
-                                        "str_data",
-                                    )
-                                    .map_err(|_| CodegenError::LLVMError {
-                                        operation: "build_load".to_string(),
-                                        details: "Failed to load string data for int()".to_string(),
-                                        span: Some(expr.span.clone()),
-                                    })?;
+                                let data_ptr = self.string_cstr(struct_ptr)?;
 
                                 let call = self
                                     .builder
@@ -6711,29 +7394,7 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
 
                                 // Extract char* from BrixString
                                 let struct_ptr = val.into_pointer_value();
-                                let str_type = self.get_string_type();
-                                let data_ptr_ptr = self
-                                    .builder
-                                    .build_struct_gep(str_type, struct_ptr, 2, "str_data_ptr")
-                                    .map_err(|_| CodegenError::LLVMError {
-                                        operation: "build_struct_gep".to_string(),
-                                        details: "Failed to get string data ptr for float()"
-                                            .to_string(),
-                                        span: Some(expr.span.clone()),
-                                    })?;
-                                let data_ptr = self
-                                    .builder
-                                    .build_load(
-                                        self.context.ptr_type(AddressSpace::default()),
-                                        data_ptr_ptr,
-                                        "str_data",
-                                    )
-                                    .map_err(|_| CodegenError::LLVMError {
-                                        operation: "build_load".to_string(),
-                                        details: "Failed to load string data for float()"
-                                            .to_string(),
-                                        span: Some(expr.span.clone()),
-                                    })?;
+                                let data_ptr = self.string_cstr(struct_ptr)?;
 
                                 let call = self
                                     .builder
@@ -7676,25 +8337,7 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
 
                         // Extract char* from BrixString struct
                         let str_struct_ptr = msg_val.into_pointer_value();
-                        let str_type = self.get_string_type();
-                        let data_ptr_ptr = self
-                            .builder
-                            .build_struct_gep(str_type, str_struct_ptr, 1, "str_data_ptr")
-                            .map_err(|_| CodegenError::LLVMError {
-                                operation: "build_struct_gep".to_string(),
-                                details: "Failed to get string data pointer for error()"
-                                    .to_string(),
-                                span: Some(expr.span.clone()),
-                            })?;
-                        let char_ptr = self
-                            .builder
-                            .build_load(ptr_type, data_ptr_ptr, "str_data")
-                            .map_err(|_| CodegenError::LLVMError {
-                                operation: "build_load".to_string(),
-                                details: "Failed to load string data for error()".to_string(),
-                                span: Some(expr.span.clone()),
-                            })?
-                            .into_pointer_value();
+                        let char_ptr = self.string_cstr(str_struct_ptr)?;
 
                         // Call brix_error_new(char_ptr)
                         let call = self
@@ -7731,6 +8374,17 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                         let (re_val, re_type) = self.compile_expr(&args[0])?;
                         let (im_val, im_type) = self.compile_expr(&args[1])?;
 
+                        // complex(re, im) over matrices -> ComplexMatrix (v1.9)
+                        let is_real_matrix =
+                            |t: &BrixType| matches!(t, BrixType::Matrix | BrixType::IntMatrix);
+                        if is_real_matrix(&re_type) || is_real_matrix(&im_type) {
+                            return self.compile_complexmatrix_from_parts(
+                                (re_val, re_type, &args[0]),
+                                (im_val, im_type, &args[1]),
+                                expr,
+                            );
+                        }
+
                         // Convert to float if needed
                         let re_float = if re_type == BrixType::Int {
                             self.builder
@@ -7803,6 +8457,9 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                         }
 
                         let (val, val_type) = self.compile_expr(&args[0])?;
+                        if val_type == BrixType::ComplexMatrix {
+                            return self.compile_complexmatrix_unary("real", val, &args[0], expr);
+                        }
                         if val_type != BrixType::Complex {
                             return Err(CodegenError::TypeError {
                                 expected: "Complex".to_string(),
@@ -7833,6 +8490,9 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                         }
 
                         let (val, val_type) = self.compile_expr(&args[0])?;
+                        if val_type == BrixType::ComplexMatrix {
+                            return self.compile_complexmatrix_unary("imag", val, &args[0], expr);
+                        }
                         if val_type != BrixType::Complex {
                             return Err(CodegenError::TypeError {
                                 expected: "Complex".to_string(),
@@ -7870,6 +8530,11 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                         }
 
                         let (val, val_type) = self.compile_expr(&args[0])?;
+                        if val_type == BrixType::ComplexMatrix
+                            && (fn_name == "conj" || fn_name == "exp")
+                        {
+                            return self.compile_complexmatrix_unary(fn_name, val, &args[0], expr);
+                        }
                         if val_type != BrixType::Complex {
                             return Err(CodegenError::TypeError {
                                 expected: "Complex".to_string(),
@@ -7924,6 +8589,9 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                         }
 
                         let (val, val_type) = self.compile_expr(&args[0])?;
+                        if val_type == BrixType::ComplexMatrix && fn_name == "abs" {
+                            return self.compile_complexmatrix_unary("abs", val, &args[0], expr);
+                        }
                         if val_type != BrixType::Complex {
                             return Err(CodegenError::TypeError {
                                 expected: "Complex".to_string(),
@@ -7972,6 +8640,9 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                             CodegenError::General("input() call failed".to_string())
                         });
                     }
+                    if fn_name == "matrix" && args.len() == 1 {
+                        return self.compile_matrix32_widen(&args[0], expr);
+                    }
                     if fn_name == "matrix" {
                         let val = self.compile_matrix_constructor(args).ok_or_else(|| {
                             CodegenError::General("matrix() constructor failed".to_string())
@@ -8016,6 +8687,92 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                         let val = self.compile_irand(args)?;
                         return Ok((val, BrixType::IntMatrix));
                     }
+                    // Random distributions (v1.9): distribution parameters first,
+                    // then the shape — (n) for 1×n or (r, c) for 2D, like rand().
+                    if fn_name == "randn" {
+                        let val = self.compile_rand_distribution(
+                            "randn",
+                            "brix_rand_normal_matrix",
+                            0,
+                            &[0.0, 1.0],
+                            args,
+                        )?;
+                        return Ok((val, BrixType::Matrix));
+                    }
+                    if fn_name == "rand_normal" {
+                        let val = self.compile_rand_distribution(
+                            "rand_normal",
+                            "brix_rand_normal_matrix",
+                            2,
+                            &[],
+                            args,
+                        )?;
+                        return Ok((val, BrixType::Matrix));
+                    }
+                    if fn_name == "rand_uniform" {
+                        let val = self.compile_rand_distribution(
+                            "rand_uniform",
+                            "brix_rand_uniform_matrix",
+                            2,
+                            &[],
+                            args,
+                        )?;
+                        return Ok((val, BrixType::Matrix));
+                    }
+                    if fn_name == "rand_exp" {
+                        let val = self.compile_rand_distribution(
+                            "rand_exp",
+                            "brix_rand_exp_matrix",
+                            1,
+                            &[],
+                            args,
+                        )?;
+                        return Ok((val, BrixType::Matrix));
+                    }
+                    if fn_name == "rand_gamma" {
+                        let val = self.compile_rand_distribution(
+                            "rand_gamma",
+                            "brix_rand_gamma_matrix",
+                            2,
+                            &[],
+                            args,
+                        )?;
+                        return Ok((val, BrixType::Matrix));
+                    }
+                    if fn_name == "rand_poisson" {
+                        let val = self.compile_rand_distribution(
+                            "rand_poisson",
+                            "brix_rand_poisson_matrix",
+                            1,
+                            &[],
+                            args,
+                        )?;
+                        return Ok((val, BrixType::IntMatrix));
+                    }
+                    if fn_name == "rand_seed" {
+                        self.compile_rand_seed(args)?;
+                        let dummy = self.context.i64_type().const_int(0, false);
+                        return Ok((dummy.into(), BrixType::Void));
+                    }
+                    if fn_name == "sparse" {
+                        return self.compile_sparse_new(args, expr);
+                    }
+                    if fn_name == "StringBuilder" {
+                        return self.compile_stringbuilder_new(args, expr);
+                    }
+                    // Matrix32 (v1.9): f32 storage, same shapes as the f64 constructors.
+                    if fn_name == "matrix32" {
+                        return self.compile_matrix32_new(args, expr);
+                    }
+                    if fn_name == "zeros32" {
+                        return self.compile_matrix32_shape("zeros32", "brix_zeros32", args, expr);
+                    }
+                    if fn_name == "ones32" {
+                        return self.compile_matrix32_shape("ones32", "brix_ones32", args, expr);
+                    }
+                    if fn_name == "rand32" {
+                        return self.compile_matrix32_shape("rand32", "brix_rand32", args, expr);
+                    }
                     if fn_name == "panic" {
                         if args.len() != 1 {
                             return Err(CodegenError::InvalidOperation {
@@ -8773,6 +9530,118 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                     )));
                 }
 
+                if target_type == BrixType::SparseMatrix {
+                    // { ref_count, rows, cols, nnz, row_ptr, col_idx, vals }
+                    let index = match field.as_str() {
+                        "rows" => 1,
+                        "cols" => 2,
+                        "nnz" => 3,
+                        _ => {
+                            return Err(CodegenError::General(format!(
+                                "unknown field '{}' on SparseMatrix",
+                                field
+                            )))
+                        }
+                    };
+                    let field_ptr = self
+                        .builder
+                        .build_struct_gep(
+                            self.get_sparsematrix_type(),
+                            target_val.into_pointer_value(),
+                            index,
+                            "sp_field_ptr",
+                        )
+                        .map_err(|_| CodegenError::LLVMError {
+                            operation: "build_struct_gep".to_string(),
+                            details: format!("Failed to get sparse field '{}' pointer", field),
+                            span: Some(expr.span.clone()),
+                        })?;
+                    let v = self
+                        .builder
+                        .build_load(self.context.i64_type(), field_ptr, "sp_field")
+                        .map_err(|_| CodegenError::LLVMError {
+                            operation: "build_load".to_string(),
+                            details: format!("Failed to load sparse field '{}'", field),
+                            span: Some(expr.span.clone()),
+                        })?;
+                    return Ok((v, BrixType::Int));
+                }
+
+                if matches!(
+                    target_type,
+                    BrixType::LUFactor | BrixType::CholeskyFactor | BrixType::QRFactor
+                ) {
+                    // Factorization { ref_count, rows, cols, kind, ... } — same prefix as Matrix
+                    let index = match field.as_str() {
+                        "rows" => 1,
+                        "cols" => 2,
+                        _ => {
+                            return Err(CodegenError::General(format!(
+                                "unknown field '{}' on {:?}",
+                                field, target_type
+                            )));
+                        }
+                    };
+                    let field_ptr = self
+                        .builder
+                        .build_struct_gep(
+                            self.get_matrix_type(),
+                            target_val.into_pointer_value(),
+                            index,
+                            "factor_field_ptr",
+                        )
+                        .map_err(|_| CodegenError::LLVMError {
+                            operation: "build_struct_gep".to_string(),
+                            details: format!("Failed to get factor field '{}' pointer", field),
+                            span: Some(expr.span.clone()),
+                        })?;
+                    let v = self
+                        .builder
+                        .build_load(self.context.i64_type(), field_ptr, "factor_field")
+                        .map_err(|_| CodegenError::LLVMError {
+                            operation: "build_load".to_string(),
+                            details: format!("Failed to load factor field '{}'", field),
+                            span: Some(expr.span.clone()),
+                        })?;
+                    return Ok((v, BrixType::Int));
+                }
+
+                if target_type == BrixType::Matrix32 {
+                    // { ref_count, rows, cols, float* data } — same prefix as Matrix
+                    let index = match field.as_str() {
+                        "rows" => 1,
+                        "cols" => 2,
+                        _ => {
+                            return Err(CodegenError::General(format!(
+                                "unknown field '{}' on Matrix32",
+                                field
+                            )));
+                        }
+                    };
+                    let field_ptr = self
+                        .builder
+                        .build_struct_gep(
+                            self.get_matrix_type(),
+                            target_val.into_pointer_value(),
+                            index,
+                            "m32_field_ptr",
+                        )
+                        .map_err(|_| CodegenError::LLVMError {
+                            operation: "build_struct_gep".to_string(),
+                            details: format!("Failed to get Matrix32 field '{}' pointer", field),
+                            span: Some(expr.span.clone()),
+                        })?;
+                    let v = self
+                        .builder
+                        .build_load(self.context.i64_type(), field_ptr, "m32_field")
+                        .map_err(|_| CodegenError::LLVMError {
+                            operation: "build_load".to_string(),
+                            details: format!("Failed to load Matrix32 field '{}'", field),
+                            span: Some(expr.span.clone()),
+                        })?;
+                    return Ok((v, BrixType::Int));
+                }
+
                 if target_type == BrixType::Matrix || target_type == BrixType::IntMatrix {
                     let target_ptr = target_val.into_pointer_value();
                     let matrix_type = if target_type == BrixType::Matrix {
@@ -8941,6 +9810,13 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                     );
                 }
 
+                if target_type == BrixType::Matrix32 {
+                    return self.compile_matrix32_index(target_val, indices, expr);
+                }
+                if target_type == BrixType::ComplexMatrix {
+                    return self.compile_complexmatrix_index(target_val, indices, expr);
+                }
+
                 // Support both Matrix (f64*) and IntMatrix (i64*)
                 if target_type != BrixType::Matrix && target_type != BrixType::IntMatrix {
                     eprintln!("Error: Trying to index something that is not a matrix or tuple.");
@@ -9144,6 +10020,10 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                     }
                 }
 
+                if let Some(result) = self.compile_static_array_literal(elements)? {
+                    return Ok(result);
+                }
+
                 let n = elements.len() as u64;
                 let i64_type = self.context.i64_type();
 
@@ -9786,144 +10666,15 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                 }
             }
 
-            ExprKind::FString { parts } => {
-                use parser::ast::FStringPart;
+            ExprKind::FString { parts } => self.compile_fstring(parts, expr),
 
-                if parts.is_empty() {
-                    // Empty f-string -> empty string
-                    let raw_str = self
-                        .builder
-                        .build_global_string_ptr("", "empty_fstr")
-                        .map_err(|_| CodegenError::LLVMError {
-                            operation: "build_global_string_ptr".to_string(),
-                            details: "Failed to create empty f-string literal".to_string(),
-                            span: Some(expr.span.clone()),
-                        })?;
-                    let ptr_type = self.context.ptr_type(AddressSpace::default());
-                    let fn_type = ptr_type.fn_type(&[ptr_type.into()], false);
-                    let str_new_fn = self.module.get_function("str_new").unwrap_or_else(|| {
-                        self.module
-                            .add_function("str_new", fn_type, Some(Linkage::External))
-                    });
-                    let call = self
-                        .builder
-                        .build_call(
-                            str_new_fn,
-                            &[raw_str.as_pointer_value().into()],
-                            "empty_str",
-                        )
-                        .map_err(|_| CodegenError::LLVMError {
-                            operation: "build_call".to_string(),
-                            details: "Failed to call str_new for empty f-string".to_string(),
-                            span: Some(expr.span.clone()),
-                        })?;
-                    let val = call.try_as_basic_value().left().ok_or_else(|| {
-                        CodegenError::MissingValue {
-                            what: "return value from str_new".to_string(),
-                            context: "empty f-string".to_string(),
-                            span: Some(expr.span.clone()),
-                        }
-                    })?;
-                    return Ok((val, BrixType::String));
-                }
+            ExprKind::StructInit {
+                struct_name,
+                type_args,
+                fields,
+            } => self.compile_struct_init(struct_name, type_args, fields, expr),
 
-                // Compile each part and convert to string
-                let mut string_parts = Vec::new();
-
-                for part in parts {
-                    let str_val = match part {
-                        FStringPart::Text(text) => {
-                            // Create string from text literal
-                            let raw_str = self
-                                .builder
-                                .build_global_string_ptr(text, "fstr_text")
-                                .map_err(|_| CodegenError::LLVMError {
-                                operation: "build_global_string_ptr".to_string(),
-                                details: "Failed to create f-string text literal".to_string(),
-                                span: Some(expr.span.clone()),
-                            })?;
-                            let ptr_type = self.context.ptr_type(AddressSpace::default());
-                            let fn_type = ptr_type.fn_type(&[ptr_type.into()], false);
-                            let str_new_fn =
-                                self.module.get_function("str_new").unwrap_or_else(|| {
-                                    self.module.add_function(
-                                        "str_new",
-                                        fn_type,
-                                        Some(Linkage::External),
-                                    )
-                                });
-                            let call = self
-                                .builder
-                                .build_call(
-                                    str_new_fn,
-                                    &[raw_str.as_pointer_value().into()],
-                                    "text_str",
-                                )
-                                .map_err(|_| CodegenError::LLVMError {
-                                    operation: "build_call".to_string(),
-                                    details: "Failed to call str_new for f-string text part"
-                                        .to_string(),
-                                    span: Some(expr.span.clone()),
-                                })?;
-                            call.try_as_basic_value().left().ok_or_else(|| {
-                                CodegenError::MissingValue {
-                                    what: "return value from str_new".to_string(),
-                                    context: "f-string text part".to_string(),
-                                    span: Some(expr.span.clone()),
-                                }
-                            })?
-                        }
-                        FStringPart::Expr { expr, format } => {
-                            // Compile expression and convert to string with optional format
-                            let (val, typ) = self.compile_expr(expr)?;
-                            self.value_to_string(val, &typ, format.as_deref())?
-                        }
-                    };
-                    string_parts.push(str_val);
-                }
-
-                // Concatenate all parts
-                let mut result = string_parts[0];
-                for part in &string_parts[1..] {
-                    let ptr_type = self.context.ptr_type(AddressSpace::default());
-                    let fn_type = ptr_type.fn_type(&[ptr_type.into(), ptr_type.into()], false);
-                    let str_concat_fn =
-                        self.module.get_function("str_concat").unwrap_or_else(|| {
-                            self.module
-                                .add_function("str_concat", fn_type, Some(Linkage::External))
-                        });
-                    let call = self
-                        .builder
-                        .build_call(
-                            str_concat_fn,
-                            &[result.into(), (*part).into()],
-                            "concat_fstr",
-                        )
-                        .map_err(|_| CodegenError::LLVMError {
-                            operation: "build_call".to_string(),
-                            details: "Failed to call str_concat for f-string concatenation"
-                                .to_string(),
-                            span: Some(expr.span.clone()),
-                        })?;
-                    result = call.try_as_basic_value().left().ok_or_else(|| {
-                        CodegenError::MissingValue {
-                            what: "return value from str_concat".to_string(),
-                            context: "f-string concatenation".to_string(),
-                            span: Some(expr.span.clone()),
-                        }
-                    })?;
-                }
-
-                Ok((result, BrixType::String))
-            }
-
-            ExprKind::StructInit {
-                struct_name,
-                type_args,
-                fields,
-            } => self.compile_struct_init(struct_name, type_args, fields, expr),
-
-            ExprKind::Closure(closure) => self.compile_closure(closure, expr),
+            ExprKind::Closure(closure) => self.compile_closure(closure, expr),
 
             ExprKind::Await { .. } => {
                 // 'await' is only valid inside an 'async fn' body.
@@ -9977,6 +10728,165 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
         }
     }
 
+    /// Compile an f-string (v1.9) into a single brix_fstring call. Every part
+    /// becomes one { kind, conv, prec, value } record of four i64 in an entry
+    /// block array; the runtime sizes one buffer and formats each part into
+    /// it once, instead of a sprintf + str_new per part and a str_concat (and
+    /// full recopy) per join. Kinds and format letters mirror BrixFmtPart in
+    /// runtime.c; Int and Float keep the printf meanings of `x`/`X`/`o` and
+    /// `.Nf`/`.Ne`/`.NE`/`e`/`E`/`f`/`g`/`G`, and any other type is rendered
+    /// by value_to_string and passed as a string.
+    fn compile_fstring(
+        &mut self,
+        parts: &[parser::ast::FStringPart],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        use parser::ast::FStringPart;
+
+        const FMT_STR: u64 = 0;
+        const FMT_STR_OWNED: u64 = 1;
+        const FMT_INT: u64 = 2;
+        const FMT_FLOAT: u64 = 3;
+
+        // No interpolation: the f-string is just a static literal
+        if parts.iter().all(|p| matches!(p, FStringPart::Text(_))) {
+            let text: String = parts
+                .iter()
+                .map(|p| match p {
+                    FStringPart::Text(t) => t.as_str(),
+                    FStringPart::Expr { .. } => "",
+                })
+                .collect();
+            return Ok((self.compile_static_string(&text).into(), BrixType::String));
+        }
+
+        let i64_type = self.context.i64_type();
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let slots = i64_type.array_type((parts.len() * 4) as u32);
+        let parts_ptr = self.create_entry_block_alloca(slots.into(), "fstr_parts")?;
+
+        for (i, part) in parts.iter().enumerate() {
+            let (kind, conv, prec, value): (u64, u8, i64, BasicValueEnum<'ctx>) = match part {
+                FStringPart::Text(text) => (FMT_STR, 0, 0, self.compile_static_string(text).into()),
+                FStringPart::Expr { expr, format } => {
+                    let (val, typ) = self.compile_expr(expr)?;
+                    let format = format.as_deref();
+                    match typ {
+                        BrixType::Int => {
+                            let conv = match format {
+                                Some("x") => b'x',
+                                Some("X") => b'X',
+                                Some("o") => b'o',
+                                _ => b'd',
+                            };
+                            (FMT_INT, conv, -1, val)
+                        }
+                        BrixType::Float => {
+                            let (conv, prec) = match format {
+                                Some(f)
+                                    if f.starts_with('.')
+                                        && (f.ends_with('f')
+                                            || f.ends_with('e')
+                                            || f.ends_with('E')) =>
+                                {
+                                    // ".2f" -> conv 'f', prec 2 (".f" is prec 0)
+                                    let digits = &f[1..f.len() - 1];
+                                    let conv = f.as_bytes()[f.len() - 1];
+                                    if digits.is_empty() {
+                                        (conv, 0)
+                                    } else {
+                                        match digits.parse::<i64>() {
+                                            Ok(p) => (conv, p),
+                                            Err(_) => (b'g', -1),
+                                        }
+                                    }
+                                }
+                                Some("e") => (b'e', -1),
+                                Some("E") => (b'E', -1),
+                                Some("f") => (b'f', -1),
+                                Some("G") => (b'G', -1),
+                                _ => (b'g', -1),
+                            };
+                            (FMT_FLOAT, conv, prec, val)
+                        }
+                        BrixType::String => (FMT_STR, 0, 0, val),
+                        BrixType::Matrix
+                        | BrixType::IntMatrix
+                        | BrixType::StringMatrix
+                        | BrixType::Complex
+                        | BrixType::ComplexMatrix
+                        | BrixType::Matrix32 => {
+                            // value_to_string built a fresh string; the runtime frees it
+                            let s = self.value_to_string(val, &typ, format)?;
+                            (FMT_STR_OWNED, 0, 0, s)
+                        }
+                        _ => (FMT_STR, 0, 0, self.value_to_string(val, &typ, format)?),
+                    }
+                }
+            };
+
+            let fields: [BasicValueEnum<'ctx>; 4] = [
+                i64_type.const_int(kind, false).into(),
+                i64_type.const_int(conv as u64, false).into(),
+                i64_type.const_int(prec as u64, true).into(),
+                value,
+            ];
+            for (j, field) in fields.into_iter().enumerate() {
+                let slot = unsafe {
+                    self.builder
+                        .build_gep(
+                            i64_type,
+                            parts_ptr,
+                            &[i64_type.const_int((i * 4 + j) as u64, false)],
+                            "fstr_slot",
+                        )
+                        .map_err(|_| CodegenError::LLVMError {
+                            operation: "build_gep".to_string(),
+                            details: "Failed to address f-string part".to_string(),
+                            span: Some(expr.span.clone()),
+                        })?
+                };
+                self.builder
+                    .build_store(slot, field)
+                    .map_err(|_| CodegenError::LLVMError {
+                        operation: "build_store".to_string(),
+                        details: "Failed to store f-string part".to_string(),
+                        span: Some(expr.span.clone()),
+                    })?;
+            }
+        }
+
+        let fstring_fn = self.module.get_function("brix_fstring").unwrap_or_else(|| {
+            let fn_type = ptr_type.fn_type(&[ptr_type.into(), i64_type.into()], false);
+            self.module
+                .add_function("brix_fstring", fn_type, Some(Linkage::External))
+        });
+        let call = self
+            .builder
+            .build_call(
+                fstring_fn,
+                &[
+                    parts_ptr.into(),
+                    i64_type.const_int(parts.len() as u64, false).into(),
+                ],
+                "fstr",
+            )
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_call".to_string(),
+                details: "Failed to call brix_fstring".to_string(),
+                span: Some(expr.span.clone()),
+            })?;
+        let result =
+            call.try_as_basic_value()
+                .left()
+                .ok_or_else(|| CodegenError::MissingValue {
+                    what: "return value from brix_fstring".to_string(),
+                    context: "f-string".to_string(),
+                    span: Some(expr.span.clone()),
+                })?;
+        Ok((result, BrixType::String))
+    }
+
     fn value_to_string(
         &self,
         val: BasicValueEnum<'ctx>,
@@ -11908,6 +12818,38 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                 Ok(final_str)
             }
 
+            BrixType::Matrix32 => {
+                // Runtime builds the whole "[a, b, c]" BrixString in one pass
+                let ptr_type = self.context.ptr_type(AddressSpace::default());
+                let to_string_fn = self
+                    .module
+                    .get_function("matrix32_to_string")
+                    .unwrap_or_else(|| {
+                        let fn_type = ptr_type.fn_type(&[ptr_type.into()], false);
+                        self.module.add_function(
+                            "matrix32_to_string",
+                            fn_type,
+                            Some(Linkage::External),
+                        )
+                    });
+                let brix_string = self
+                    .builder
+                    .build_call(to_string_fn, &[val.into()], "m32_str")
+                    .map_err(|_| CodegenError::LLVMError {
+                        operation: "build_call".to_string(),
+                        details: "Failed to call matrix32_to_string".to_string(),
+                        span: None,
+                    })?
+                    .try_as_basic_value()
+                    .left()
+                    .ok_or_else(|| CodegenError::LLVMError {
+                        operation: "try_as_basic_value".to_string(),
+                        details: "Function did not return a value".to_string(),
+                        span: None,
+                    })?;
+                Ok(brix_string)
+            }
+
             BrixType::Nil => {
                 // Convert nil to string "nil"
                 let nil_str = self
@@ -12384,27 +13326,50 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
     fn get_matrix_type(&self) -> inkwell::types::StructType<'ctx> {
         let i64_type = self.context.i64_type();
         let ptr_type = self.context.ptr_type(AddressSpace::default());
-        // Struct { ref_count: i64, rows: i64, cols: i64, data: f64* }
+        // Struct { ref_count: i64, rows: i64, cols: i64, data: f64*, capacity: i64, head: i64 }
         self.context.struct_type(
             &[
                 i64_type.into(),
                 i64_type.into(),
                 i64_type.into(),
                 ptr_type.into(),
+                i64_type.into(),
+                i64_type.into(),
             ],
             false,
         )
     }
 
     fn get_intmatrix_type(&self) -> inkwell::types::StructType<'ctx> {
-        // Same structure as Matrix: { ref_count: i64, rows: i64, cols: i64, data: i64* }
+        // Same structure as Matrix:
+        // { ref_count: i64, rows: i64, cols: i64, data: i64*, capacity: i64, head: i64 }
+        let i64_type = self.context.i64_type();
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        self.context.struct_type(
+            &[
+                i64_type.into(),
+                i64_type.into(),
+                i64_type.into(),
+                ptr_type.into(),
+                i64_type.into(),
+                i64_type.into(),
+            ],
+            false,
+        )
+    }
+
+    fn get_sparsematrix_type(&self) -> inkwell::types::StructType<'ctx> {
         let i64_type = self.context.i64_type();
         let ptr_type = self.context.ptr_type(AddressSpace::default());
+        // Struct { ref_count, rows, cols, nnz: i64, row_ptr: i64*, col_idx: i64*, vals: f64* }
         self.context.struct_type(
             &[
                 i64_type.into(),
                 i64_type.into(),
                 i64_type.into(),
+                i64_type.into(),
+                ptr_type.into(),
+                ptr_type.into(),
                 ptr_type.into(),
             ],
             false,
@@ -12414,9 +13379,53 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
     fn get_string_type(&self) -> inkwell::types::StructType<'ctx> {
         let i64_type = self.context.i64_type();
         let ptr_type = self.context.ptr_type(AddressSpace::default());
-        // Struct { ref_count: i64, len: i64, data: char* }
-        self.context
-            .struct_type(&[i64_type.into(), i64_type.into(), ptr_type.into()], false)
+        // Struct { ref_count: i64, len: i64, data: char*, capacity: i64,
+        //          owner: BrixString*, slices/slot: ptr, hash: i64,
+        //          cps: BrixStrIndex* }
+        self.context.struct_type(
+            &[
+                i64_type.into(),
+                i64_type.into(),
+                ptr_type.into(),
+                i64_type.into(),
+                ptr_type.into(),
+                ptr_type.into(),
+                i64_type.into(),
+                ptr_type.into(),
+            ],
+            false,
+        )
+    }
+
+    /// NUL-terminated char* of a BrixString, for C APIs such as printf and
+    /// atoi (v1.9). Slices are not NUL-terminated, so brix_str_cstr first
+    /// moves a slice onto its own buffer.
+    fn string_cstr(&self, str_ptr: PointerValue<'ctx>) -> CodegenResult<PointerValue<'ctx>> {
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let cstr_fn = self
+            .module
+            .get_function("brix_str_cstr")
+            .unwrap_or_else(|| {
+                let fn_type = ptr_type.fn_type(&[ptr_type.into()], false);
+                self.module
+                    .add_function("brix_str_cstr", fn_type, Some(Linkage::External))
+            });
+        let call = self
+            .builder
+            .build_call(cstr_fn, &[str_ptr.into()], "str_cstr")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_call".to_string(),
+                details: "Failed to call brix_str_cstr".to_string(),
+                span: None,
+            })?;
+        call.try_as_basic_value()
+            .left()
+            .map(|v| v.into_pointer_value())
+            .ok_or_else(|| CodegenError::MissingValue {
+                what: "brix_str_cstr result".to_string(),
+                context: "string to C string".to_string(),
+                span: None,
+            })
     }
 
     fn get_string_matrix_type(&self) -> inkwell::types::StructType<'ctx> {
@@ -12763,99 +13772,1931 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
         let ptr_type = self.context.ptr_type(AddressSpace::default());
         let fn_type = ptr_type.fn_type(&[i64_type.into(), i64_type.into()], false);
 
-        let brix_rand_fn = self
-            .module
-            .get_function("brix_rand_matrix")
-            .unwrap_or_else(|| {
-                self.module
-                    .add_function("brix_rand_matrix", fn_type, Some(Linkage::External))
-            });
+        let brix_rand_fn = self
+            .module
+            .get_function("brix_rand_matrix")
+            .unwrap_or_else(|| {
+                self.module
+                    .add_function("brix_rand_matrix", fn_type, Some(Linkage::External))
+            });
+
+        let (rows_val, cols_val) = if args.len() == 1 {
+            let (n_val, _) = self.compile_expr(&args[0])?;
+            (i64_type.const_int(1, false), n_val.into_int_value())
+        } else if args.len() == 2 {
+            let (r_val, _) = self.compile_expr(&args[0])?;
+            let (c_val, _) = self.compile_expr(&args[1])?;
+            (r_val.into_int_value(), c_val.into_int_value())
+        } else {
+            return Err(CodegenError::InvalidOperation {
+                operation: "rand()".to_string(),
+                reason: format!("Expected 1 or 2 arguments, got {}", args.len()),
+                span: None,
+            });
+        };
+
+        let call = self
+            .builder
+            .build_call(
+                brix_rand_fn,
+                &[rows_val.into(), cols_val.into()],
+                "rand_matrix",
+            )
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_call".to_string(),
+                details: "Failed to call brix_rand_matrix".to_string(),
+                span: None,
+            })?;
+
+        call.try_as_basic_value()
+            .left()
+            .ok_or_else(|| CodegenError::LLVMError {
+                operation: "try_as_basic_value".to_string(),
+                details: "brix_rand_matrix did not return a value".to_string(),
+                span: None,
+            })
+    }
+
+    pub(crate) fn compile_irand(&mut self, args: &[Expr]) -> CodegenResult<BasicValueEnum<'ctx>> {
+        // irand(n, max_val) → IntMatrix 1×n with random ints in [0, max_val)
+        if args.len() != 2 {
+            return Err(CodegenError::InvalidOperation {
+                operation: "irand()".to_string(),
+                reason: format!("Expected 2 arguments (n, max_val), got {}", args.len()),
+                span: None,
+            });
+        }
+
+        let i64_type = self.context.i64_type();
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let fn_type = ptr_type.fn_type(&[i64_type.into(), i64_type.into()], false);
+
+        let brix_irand_fn = self
+            .module
+            .get_function("brix_irand_matrix")
+            .unwrap_or_else(|| {
+                self.module
+                    .add_function("brix_irand_matrix", fn_type, Some(Linkage::External))
+            });
+
+        let (n_val, _) = self.compile_expr(&args[0])?;
+        let (max_val, _) = self.compile_expr(&args[1])?;
+
+        let call = self
+            .builder
+            .build_call(
+                brix_irand_fn,
+                &[
+                    n_val.into_int_value().into(),
+                    max_val.into_int_value().into(),
+                ],
+                "irand_matrix",
+            )
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_call".to_string(),
+                details: "Failed to call brix_irand_matrix".to_string(),
+                span: None,
+            })?;
+
+        call.try_as_basic_value()
+            .left()
+            .ok_or_else(|| CodegenError::LLVMError {
+                operation: "try_as_basic_value".to_string(),
+                details: "brix_irand_matrix did not return a value".to_string(),
+                span: None,
+            })
+    }
+
+    /// Compile a bulk random-distribution constructor (randn, rand_normal,
+    /// rand_uniform, rand_exp, rand_gamma, rand_poisson).
+    ///
+    /// Call shape: `name(p1, .., pk, n)` → 1×n, or `name(p1, .., pk, r, c)`.
+    /// The first `n_params` arguments are the distribution parameters (Int is
+    /// promoted to Float); `preset` supplies fixed parameters for the shorthand
+    /// forms (randn = rand_normal(0.0, 1.0, ...)). The runtime kernel is
+    /// `<Matrix*|IntMatrix*> c_fn(i64 rows, i64 cols, f64 params...)`.
+    pub(crate) fn compile_rand_distribution(
+        &mut self,
+        op_name: &str,
+        c_fn: &str,
+        n_params: usize,
+        preset: &[f64],
+        args: &[Expr],
+    ) -> CodegenResult<BasicValueEnum<'ctx>> {
+        if args.len() != n_params + 1 && args.len() != n_params + 2 {
+            return Err(CodegenError::InvalidOperation {
+                operation: format!("{}()", op_name),
+                reason: format!(
+                    "Expected {} parameter(s) followed by (n) or (rows, cols), got {} arguments",
+                    n_params,
+                    args.len()
+                ),
+                span: None,
+            });
+        }
+
+        let i64_type = self.context.i64_type();
+        let f64_type = self.context.f64_type();
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+
+        let mut param_types: Vec<BasicMetadataTypeEnum> = vec![i64_type.into(), i64_type.into()];
+        for _ in 0..(n_params + preset.len()) {
+            param_types.push(f64_type.into());
+        }
+        let fn_type = ptr_type.fn_type(&param_types, false);
+        let dist_fn = self.module.get_function(c_fn).unwrap_or_else(|| {
+            self.module
+                .add_function(c_fn, fn_type, Some(Linkage::External))
+        });
+
+        let mut param_vals: Vec<BasicMetadataValueEnum> = Vec::new();
+        for arg in &args[..n_params] {
+            let (raw, ty) = self.compile_expr(arg)?;
+            param_vals.push(self.coerce_to_f64(raw, &ty)?.into());
+        }
+        for p in preset {
+            param_vals.push(f64_type.const_float(*p).into());
+        }
+
+        let shape_ctx = format!("{}() shape argument", op_name);
+        let (rows_val, cols_val) = if args.len() == n_params + 1 {
+            let (n_raw, n_ty) = self.compile_expr(&args[n_params])?;
+            let n_val = self.coerce_to_i64(n_raw, &n_ty, &shape_ctx)?;
+            (i64_type.const_int(1, false), n_val)
+        } else {
+            let (r_raw, r_ty) = self.compile_expr(&args[n_params])?;
+            let (c_raw, c_ty) = self.compile_expr(&args[n_params + 1])?;
+            (
+                self.coerce_to_i64(r_raw, &r_ty, &shape_ctx)?,
+                self.coerce_to_i64(c_raw, &c_ty, &shape_ctx)?,
+            )
+        };
+
+        let mut call_args: Vec<BasicMetadataValueEnum> = vec![rows_val.into(), cols_val.into()];
+        call_args.extend(param_vals);
+
+        let call = self
+            .builder
+            .build_call(dist_fn, &call_args, "rand_dist_matrix")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_call".to_string(),
+                details: format!("Failed to call {}", c_fn),
+                span: None,
+            })?;
+
+        call.try_as_basic_value()
+            .left()
+            .ok_or_else(|| CodegenError::LLVMError {
+                operation: "try_as_basic_value".to_string(),
+                details: format!("{} did not return a value", c_fn),
+                span: None,
+            })
+    }
+
+    /// Compile `rand_seed(n)` → `void brix_rand_seed(i64)`. Reseeds the single
+    /// runtime generator shared by rand/irand and every distribution.
+    pub(crate) fn compile_rand_seed(&mut self, args: &[Expr]) -> CodegenResult<()> {
+        if args.len() != 1 {
+            return Err(CodegenError::InvalidOperation {
+                operation: "rand_seed()".to_string(),
+                reason: format!("Expected 1 argument (seed), got {}", args.len()),
+                span: None,
+            });
+        }
+
+        let i64_type = self.context.i64_type();
+        let fn_type = self.context.void_type().fn_type(&[i64_type.into()], false);
+        let seed_fn = self
+            .module
+            .get_function("brix_rand_seed")
+            .unwrap_or_else(|| {
+                self.module
+                    .add_function("brix_rand_seed", fn_type, Some(Linkage::External))
+            });
+
+        let (seed_raw, seed_ty) = self.compile_expr(&args[0])?;
+        let seed_val = self.coerce_to_i64(seed_raw, &seed_ty, "rand_seed() argument")?;
+
+        self.builder
+            .build_call(seed_fn, &[seed_val.into()], "")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_call".to_string(),
+                details: "Failed to call brix_rand_seed".to_string(),
+                span: None,
+            })?;
+        Ok(())
+    }
+
+    /// Declare (once) and call a runtime function returning a pointer.
+    fn call_ptr_runtime(
+        &mut self,
+        c_fn: &str,
+        param_types: &[BasicMetadataTypeEnum<'ctx>],
+        call_args: &[BasicMetadataValueEnum<'ctx>],
+        expr: &Expr,
+    ) -> CodegenResult<BasicValueEnum<'ctx>> {
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        self.call_runtime(c_fn, ptr_type.into(), param_types, call_args, expr)
+    }
+
+    /// Declare (once) and call a runtime function with a non-void return type.
+    fn call_runtime(
+        &mut self,
+        c_fn: &str,
+        ret_type: BasicTypeEnum<'ctx>,
+        param_types: &[BasicMetadataTypeEnum<'ctx>],
+        call_args: &[BasicMetadataValueEnum<'ctx>],
+        expr: &Expr,
+    ) -> CodegenResult<BasicValueEnum<'ctx>> {
+        let fn_type = ret_type.fn_type(param_types, false);
+        let rt_fn = self.module.get_function(c_fn).unwrap_or_else(|| {
+            self.module
+                .add_function(c_fn, fn_type, Some(Linkage::External))
+        });
+        let call = self
+            .builder
+            .build_call(rt_fn, call_args, "rt_call")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_call".to_string(),
+                details: format!("Failed to call {}", c_fn),
+                span: Some(expr.span.clone()),
+            })?;
+        call.try_as_basic_value()
+            .left()
+            .ok_or_else(|| CodegenError::MissingValue {
+                what: format!("{} result", c_fn),
+                context: "runtime call".to_string(),
+                span: Some(expr.span.clone()),
+            })
+    }
+
+    /// Compile a float-matrix argument (sparse API, rfft). An IntMatrix is
+    /// promoted through `intmatrix_to_matrix` so `[4, -1, -1]` literals work.
+    /// Returns the Matrix* and whether it is an owned temporary that the
+    /// caller must release after the runtime call.
+    fn compile_f64_matrix_arg(
+        &mut self,
+        arg: &Expr,
+        context: &str,
+    ) -> CodegenResult<(PointerValue<'ctx>, bool)> {
+        let (val, ty) = self.compile_expr(arg)?;
+        let owned = !Self::is_borrowed_ref_expr(&arg.kind);
+        match ty {
+            BrixType::Matrix => Ok((val.into_pointer_value(), owned)),
+            BrixType::IntMatrix => {
+                let ptr_type = self.context.ptr_type(AddressSpace::default());
+                let promoted = self.call_ptr_runtime(
+                    "intmatrix_to_matrix",
+                    &[ptr_type.into()],
+                    &[val.into()],
+                    arg,
+                )?;
+                if owned {
+                    self.insert_release(val.into_pointer_value(), &BrixType::IntMatrix)?;
+                }
+                Ok((promoted.into_pointer_value(), true))
+            }
+            other => Err(CodegenError::TypeError {
+                expected: "Matrix or IntMatrix".to_string(),
+                found: format!("{:?}", other),
+                context: context.to_string(),
+                span: Some(arg.span.clone()),
+            }),
+        }
+    }
+
+    /// Compile `sparse(...)` -> SparseMatrix (v1.9).
+    ///   sparse(m)                        — compress a dense Matrix
+    ///   sparse(rows, cols, ri, ci, vals) — COO triplets (ri/ci: int[]),
+    ///                                      duplicates are summed
+    fn compile_sparse_new(
+        &mut self,
+        args: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let i64_type = self.context.i64_type();
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+
+        match args.len() {
+            1 => {
+                let (m_ptr, owned) = self.compile_f64_matrix_arg(&args[0], "sparse() argument")?;
+                let result = self.call_ptr_runtime(
+                    "brix_sparse_from_dense",
+                    &[ptr_type.into()],
+                    &[m_ptr.into()],
+                    expr,
+                )?;
+                if owned {
+                    self.insert_release(m_ptr, &BrixType::Matrix)?;
+                }
+                Ok((result, BrixType::SparseMatrix))
+            }
+            5 => {
+                let (r_raw, r_ty) = self.compile_expr(&args[0])?;
+                let rows = self.coerce_to_i64(r_raw, &r_ty, "sparse() rows")?;
+                let (c_raw, c_ty) = self.compile_expr(&args[1])?;
+                let cols = self.coerce_to_i64(c_raw, &c_ty, "sparse() cols")?;
+
+                let mut idx_ptrs = Vec::with_capacity(2);
+                for (arg, what) in [(&args[2], "row"), (&args[3], "column")] {
+                    let (v, t) = self.compile_expr(arg)?;
+                    if t != BrixType::IntMatrix {
+                        return Err(CodegenError::TypeError {
+                            expected: "IntMatrix (int[])".to_string(),
+                            found: format!("{:?}", t),
+                            context: format!("sparse() {} indices", what),
+                            span: Some(arg.span.clone()),
+                        });
+                    }
+                    idx_ptrs.push((
+                        v.into_pointer_value(),
+                        !Self::is_borrowed_ref_expr(&arg.kind),
+                    ));
+                }
+                let (vals_ptr, vals_owned) =
+                    self.compile_f64_matrix_arg(&args[4], "sparse() values")?;
+
+                let result = self.call_ptr_runtime(
+                    "brix_sparse_from_coo",
+                    &[
+                        i64_type.into(),
+                        i64_type.into(),
+                        ptr_type.into(),
+                        ptr_type.into(),
+                        ptr_type.into(),
+                    ],
+                    &[
+                        rows.into(),
+                        cols.into(),
+                        idx_ptrs[0].0.into(),
+                        idx_ptrs[1].0.into(),
+                        vals_ptr.into(),
+                    ],
+                    expr,
+                )?;
+
+                for (p, owned) in idx_ptrs {
+                    if owned {
+                        self.insert_release(p, &BrixType::IntMatrix)?;
+                    }
+                }
+                if vals_owned {
+                    self.insert_release(vals_ptr, &BrixType::Matrix)?;
+                }
+                Ok((result, BrixType::SparseMatrix))
+            }
+            n => Err(CodegenError::InvalidOperation {
+                operation: "sparse()".to_string(),
+                reason: format!(
+                    "expected (matrix) or (rows, cols, row_idx, col_idx, vals), got {} arguments",
+                    n
+                ),
+                span: Some(expr.span.clone()),
+            }),
+        }
+    }
+
+    /// Compile a method call on a SparseMatrix receiver (v1.9).
+    /// API: mul(x) -> Matrix / to_dense() -> Matrix / transpose() -> SparseMatrix.
+    fn compile_sparse_method(
+        &mut self,
+        receiver: BasicValueEnum<'ctx>,
+        method: &str,
+        args: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let s_ptr = receiver.into_pointer_value();
+
+        match method {
+            "mul" => {
+                if args.len() != 1 {
+                    return Err(CodegenError::InvalidOperation {
+                        operation: "SparseMatrix.mul".to_string(),
+                        reason: format!("expects 1 argument (matrix), got {}", args.len()),
+                        span: Some(expr.span.clone()),
+                    });
+                }
+                let (x_ptr, owned) =
+                    self.compile_f64_matrix_arg(&args[0], "SparseMatrix.mul argument")?;
+                let result = self.call_ptr_runtime(
+                    "brix_sparse_mul",
+                    &[ptr_type.into(), ptr_type.into()],
+                    &[s_ptr.into(), x_ptr.into()],
+                    expr,
+                )?;
+                if owned {
+                    self.insert_release(x_ptr, &BrixType::Matrix)?;
+                }
+                Ok((result, BrixType::Matrix))
+            }
+            "to_dense" | "transpose" => {
+                if !args.is_empty() {
+                    return Err(CodegenError::InvalidOperation {
+                        operation: format!("SparseMatrix.{}", method),
+                        reason: "takes no arguments".to_string(),
+                        span: Some(expr.span.clone()),
+                    });
+                }
+                let (c_fn, ret_type) = if method == "to_dense" {
+                    ("brix_sparse_to_dense", BrixType::Matrix)
+                } else {
+                    ("brix_sparse_transpose", BrixType::SparseMatrix)
+                };
+                let result =
+                    self.call_ptr_runtime(c_fn, &[ptr_type.into()], &[s_ptr.into()], expr)?;
+                Ok((result, ret_type))
+            }
+            other => Err(CodegenError::General(format!(
+                "SparseMatrix method '{}' not supported",
+                other
+            ))),
+        }
+    }
+
+    /// Compile `math.cg` / `math.bicgstab` / `math.gmres` (v1.9):
+    ///   (A, b[, tol[, max_iter[, precond]]]) -> Matrix
+    /// A may be a SparseMatrix, a dense Matrix, or a closure `(v: Matrix) -> Matrix`
+    /// applying the operator matrix-free. `precond` is an optional closure
+    /// applying M^-1; without one, Jacobi scaling is used when A is explicit.
+    fn compile_math_krylov(
+        &mut self,
+        method: &str,
+        args: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let name = format!("math.{}", method);
+        if args.len() < 2 || args.len() > 5 {
+            return Err(CodegenError::InvalidOperation {
+                operation: name,
+                reason: format!(
+                    "expected (A, b[, tol[, max_iter[, precond]]]), got {} args",
+                    args.len()
+                ),
+                span: Some(expr.span.clone()),
+            });
+        }
+
+        let i64_type = self.context.i64_type();
+        let f64_type = self.context.f64_type();
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let null = ptr_type.const_null();
+
+        // Must match KRYLOV_* in runtime.c.
+        let method_id = match method {
+            "cg" => 0,
+            "bicgstab" => 1,
+            _ => 2,
+        };
+
+        let (a_val, a_ty) = self.compile_expr(&args[0])?;
+        let (kind, a_ptr, op_fn, op_env) = match &a_ty {
+            BrixType::SparseMatrix => (0, a_val.into_pointer_value(), null, null),
+            BrixType::Matrix => (1, a_val.into_pointer_value(), null, null),
+            t if Compiler::is_closure_type(t) => {
+                let ret = self.infer_closure_return_type(&args[0]);
+                if ret != BrixType::Matrix {
+                    return Err(CodegenError::TypeError {
+                        expected: "closure returning Matrix".to_string(),
+                        found: format!("{:?}", ret),
+                        context: format!("{} operator", name),
+                        span: Some(args[0].span.clone()),
+                    });
+                }
+                let (fn_ptr, env_ptr) = self.load_closure_fn_env(a_val, &args[0].span)?;
+                (2, null, fn_ptr, env_ptr)
+            }
+            other => {
+                return Err(CodegenError::TypeError {
+                    expected: "SparseMatrix, Matrix or closure".to_string(),
+                    found: format!("{:?}", other),
+                    context: format!("{} operator", name),
+                    span: Some(args[0].span.clone()),
+                });
+            }
+        };
+        let (b_ptr, b_owned) = self.compile_f64_matrix_arg(&args[1], &format!("{} RHS", name))?;
+
+        let tol = if args.len() >= 3 {
+            let (raw, ty) = self.compile_expr(&args[2])?;
+            self.coerce_to_f64(raw, &ty)?
+        } else {
+            f64_type.const_float(1e-10)
+        };
+        let max_iter = if args.len() >= 4 {
+            let (raw, ty) = self.compile_expr(&args[3])?;
+            self.coerce_to_i64(raw, &ty, &format!("{} max_iter", name))?
+        } else {
+            i64_type.const_int(0, false)
+        };
+        let (pc_fn, pc_env) = if args.len() == 5 {
+            let (raw, ty) = self.compile_expr(&args[4])?;
+            if !Compiler::is_closure_type(&ty) {
+                return Err(CodegenError::TypeError {
+                    expected: "closure (r: Matrix) -> Matrix".to_string(),
+                    found: format!("{:?}", ty),
+                    context: format!("{} preconditioner", name),
+                    span: Some(args[4].span.clone()),
+                });
+            }
+            self.load_closure_fn_env(raw, &args[4].span)?
+        } else {
+            (null, null)
+        };
+
+        let result = self.call_ptr_runtime(
+            "math_krylov",
+            &[
+                i64_type.into(),
+                i64_type.into(),
+                ptr_type.into(),
+                ptr_type.into(),
+                ptr_type.into(),
+                ptr_type.into(),
+                f64_type.into(),
+                i64_type.into(),
+                ptr_type.into(),
+                ptr_type.into(),
+            ],
+            &[
+                i64_type.const_int(method_id, false).into(),
+                i64_type.const_int(kind, false).into(),
+                a_ptr.into(),
+                op_fn.into(),
+                op_env.into(),
+                b_ptr.into(),
+                tol.into(),
+                max_iter.into(),
+                pc_fn.into(),
+                pc_env.into(),
+            ],
+            expr,
+        )?;
+
+        if kind < 2 && !Self::is_borrowed_ref_expr(&args[0].kind) {
+            self.insert_release(a_ptr, &a_ty)?;
+        }
+        if b_owned {
+            self.insert_release(b_ptr, &BrixType::Matrix)?;
+        }
+        Ok((result, BrixType::Matrix))
+    }
+
+    /// Compile a method call on an LUFactor / CholeskyFactor / QRFactor
+    /// receiver (v1.9). The factorization is reused across calls:
+    ///   solve(b) -> Matrix (least squares for a tall QRFactor)
+    ///   det()    -> float
+    ///   inv()    -> Matrix
+    fn compile_factor_method(
+        &mut self,
+        receiver: BasicValueEnum<'ctx>,
+        receiver_type: &BrixType,
+        receiver_expr: &Expr,
+        method: &str,
+        args: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let f_ptr = receiver.into_pointer_value();
+        let expected_args = if method == "solve" { 1 } else { 0 };
+        if args.len() != expected_args {
+            return Err(CodegenError::InvalidOperation {
+                operation: format!("{:?}.{}", receiver_type, method),
+                reason: format!("expects {} argument(s), got {}", expected_args, args.len()),
+                span: Some(expr.span.clone()),
+            });
+        }
+
+        let result = match method {
+            "solve" => {
+                let context = format!("{:?}.solve argument", receiver_type);
+                let (b_ptr, owned) = self.compile_f64_matrix_arg(&args[0], &context)?;
+                let x = self.call_ptr_runtime(
+                    "factorization_solve",
+                    &[ptr_type.into(), ptr_type.into()],
+                    &[f_ptr.into(), b_ptr.into()],
+                    expr,
+                )?;
+                if owned {
+                    self.insert_release(b_ptr, &BrixType::Matrix)?;
+                }
+                (x, BrixType::Matrix)
+            }
+            "det" => {
+                let f64_type = self.context.f64_type();
+                let d = self.call_runtime(
+                    "factorization_det",
+                    f64_type.into(),
+                    &[ptr_type.into()],
+                    &[f_ptr.into()],
+                    expr,
+                )?;
+                (d, BrixType::Float)
+            }
+            _ => {
+                let inv = self.call_ptr_runtime(
+                    "factorization_inv",
+                    &[ptr_type.into()],
+                    &[f_ptr.into()],
+                    expr,
+                )?;
+                (inv, BrixType::Matrix)
+            }
+        };
+
+        if !Self::is_borrowed_ref_expr(&receiver_expr.kind) {
+            self.insert_release(f_ptr, receiver_type)?;
+        }
+        Ok(result)
+    }
+
+    /// Compile the FFT family (v1.9). Transforms run along each row, so a
+    /// 1×n vector is a plain 1D transform.
+    ///   math.fft(x) / math.ifft(X)   — Matrix/IntMatrix/ComplexMatrix -> ComplexMatrix
+    ///   math.fft2(x) / math.ifft2(X) — 2D transform (rows, then columns)
+    ///   math.rfft(x)                 — real input -> n/2+1 bins per row
+    ///   math.fft_inplace(X) / math.ifft_inplace(X) — overwrite a ComplexMatrix
+    fn compile_math_fft(
+        &mut self,
+        name: &str,
+        args: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        if args.len() != 1 {
+            return Err(CodegenError::InvalidOperation {
+                operation: format!("math.{}", name),
+                reason: format!("expected 1 argument, got {}", args.len()),
+                span: Some(expr.span.clone()),
+            });
+        }
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let c_fn = format!("math_{}", name);
+
+        if name == "rfft" {
+            let (x_ptr, owned) = self.compile_f64_matrix_arg(&args[0], "math.rfft argument")?;
+            let result = self.call_ptr_runtime(&c_fn, &[ptr_type.into()], &[x_ptr.into()], expr)?;
+            if owned {
+                self.insert_release(x_ptr, &BrixType::Matrix)?;
+            }
+            return Ok((result, BrixType::ComplexMatrix));
+        }
+
+        let (val, ty) = self.compile_expr(&args[0])?;
+        let owned = !Self::is_borrowed_ref_expr(&args[0].kind);
+
+        if name.ends_with("_inplace") {
+            if ty != BrixType::ComplexMatrix {
+                return Err(CodegenError::TypeError {
+                    expected: "ComplexMatrix".to_string(),
+                    found: format!("{:?}", ty),
+                    context: format!("math.{} argument", name),
+                    span: Some(args[0].span.clone()),
+                });
+            }
+            let fn_type = self.context.void_type().fn_type(&[ptr_type.into()], false);
+            let rt_fn = self.module.get_function(&c_fn).unwrap_or_else(|| {
+                self.module
+                    .add_function(&c_fn, fn_type, Some(Linkage::External))
+            });
+            self.builder
+                .build_call(rt_fn, &[val.into()], "")
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_call".to_string(),
+                    details: format!("Failed to call {}", c_fn),
+                    span: Some(expr.span.clone()),
+                })?;
+            if owned {
+                self.insert_release(val.into_pointer_value(), &ty)?;
+            }
+            return Ok((
+                self.context.i64_type().const_int(0, false).into(),
+                BrixType::Void,
+            ));
+        }
+
+        // Real input is promoted to a complex temporary first.
+        let (x_ptr, x_owned) = match ty {
+            BrixType::ComplexMatrix => (val.into_pointer_value(), owned),
+            BrixType::Matrix | BrixType::IntMatrix => {
+                let c_promote = if ty == BrixType::Matrix {
+                    "complexmatrix_from_real"
+                } else {
+                    "complexmatrix_from_intmatrix"
+                };
+                let promoted =
+                    self.call_ptr_runtime(c_promote, &[ptr_type.into()], &[val.into()], expr)?;
+                if owned {
+                    self.insert_release(val.into_pointer_value(), &ty)?;
+                }
+                (promoted.into_pointer_value(), true)
+            }
+            other => {
+                return Err(CodegenError::TypeError {
+                    expected: "Matrix, IntMatrix or ComplexMatrix".to_string(),
+                    found: format!("{:?}", other),
+                    context: format!("math.{} argument", name),
+                    span: Some(args[0].span.clone()),
+                });
+            }
+        };
+        let result = self.call_ptr_runtime(&c_fn, &[ptr_type.into()], &[x_ptr.into()], expr)?;
+        if x_owned {
+            self.insert_release(x_ptr, &BrixType::ComplexMatrix)?;
+        }
+        Ok((result, BrixType::ComplexMatrix))
+    }
+
+    /// Compile `zeros32(...)` / `ones32(...)` / `rand32(...)` -> Matrix32 (v1.9).
+    /// Shape is (n) for 1×n or (r, c), like the f64 constructors.
+    fn compile_matrix32_shape(
+        &mut self,
+        name: &str,
+        c_fn: &str,
+        args: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let i64_type = self.context.i64_type();
+        let (rows, cols) = match args.len() {
+            1 => {
+                let (n_raw, n_ty) = self.compile_expr(&args[0])?;
+                let n = self.coerce_to_i64(n_raw, &n_ty, &format!("{}() size", name))?;
+                (i64_type.const_int(1, false), n)
+            }
+            2 => {
+                let (r_raw, r_ty) = self.compile_expr(&args[0])?;
+                let r = self.coerce_to_i64(r_raw, &r_ty, &format!("{}() rows", name))?;
+                let (c_raw, c_ty) = self.compile_expr(&args[1])?;
+                let c = self.coerce_to_i64(c_raw, &c_ty, &format!("{}() cols", name))?;
+                (r, c)
+            }
+            n => {
+                return Err(CodegenError::InvalidOperation {
+                    operation: format!("{}()", name),
+                    reason: format!("Expected 1 or 2 arguments, got {}", n),
+                    span: Some(expr.span.clone()),
+                });
+            }
+        };
+        let result = self.call_ptr_runtime(
+            c_fn,
+            &[i64_type.into(), i64_type.into()],
+            &[rows.into(), cols.into()],
+            expr,
+        )?;
+        Ok((result, BrixType::Matrix32))
+    }
+
+    /// Compile `matrix32(...)` -> Matrix32 (v1.9).
+    ///   matrix32(m)          — narrow a Matrix / IntMatrix to f32
+    ///   matrix32(rows, cols) — zero-filled, like matrix(rows, cols)
+    fn compile_matrix32_new(
+        &mut self,
+        args: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        if args.len() == 2 {
+            return self.compile_matrix32_shape("matrix32", "brix_zeros32", args, expr);
+        }
+        if args.len() != 1 {
+            return Err(CodegenError::InvalidOperation {
+                operation: "matrix32()".to_string(),
+                reason: format!(
+                    "expected (matrix) or (rows, cols), got {} arguments",
+                    args.len()
+                ),
+                span: Some(expr.span.clone()),
+            });
+        }
+
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let (val, ty) = self.compile_expr(&args[0])?;
+        let owned = !Self::is_borrowed_ref_expr(&args[0].kind);
+        let c_fn = match ty {
+            BrixType::Matrix => "matrix32_from_matrix",
+            BrixType::IntMatrix => "matrix32_from_intmatrix",
+            BrixType::Matrix32 => {
+                // Already f32: share the value instead of copying it.
+                let shared = if owned {
+                    val
+                } else {
+                    self.insert_retain(val, &BrixType::Matrix32)?
+                };
+                return Ok((shared, BrixType::Matrix32));
+            }
+            other => {
+                return Err(CodegenError::TypeError {
+                    expected: "Matrix or IntMatrix".to_string(),
+                    found: format!("{:?}", other),
+                    context: "matrix32() argument".to_string(),
+                    span: Some(args[0].span.clone()),
+                });
+            }
+        };
+        let result = self.call_ptr_runtime(c_fn, &[ptr_type.into()], &[val.into()], expr)?;
+        if owned {
+            self.insert_release(val.into_pointer_value(), &ty)?;
+        }
+        Ok((result, BrixType::Matrix32))
+    }
+
+    /// Compile `matrix(m32)` -> Matrix: widen a Matrix32 back to f64 (v1.9).
+    fn compile_matrix32_widen(
+        &mut self,
+        arg: &Expr,
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let (val, ty) = self.compile_expr(arg)?;
+        if ty != BrixType::Matrix32 {
+            return Err(CodegenError::TypeError {
+                expected: "Matrix32".to_string(),
+                found: format!("{:?}", ty),
+                context: "matrix() with one argument".to_string(),
+                span: Some(arg.span.clone()),
+            });
+        }
+        let result = self.call_ptr_runtime(
+            "matrix32_to_matrix",
+            &[ptr_type.into()],
+            &[val.into()],
+            expr,
+        )?;
+        if !Self::is_borrowed_ref_expr(&arg.kind) {
+            self.insert_release(val.into_pointer_value(), &BrixType::Matrix32)?;
+        }
+        Ok((result, BrixType::Matrix))
+    }
+
+    /// Compile `+ - * /` where at least one side is a Matrix32 (v1.9).
+    /// Matrix32 combines with another Matrix32 (same shape) or an int/float
+    /// scalar; mixing with f64 matrices needs an explicit matrix32()/matrix().
+    fn compile_matrix32_binary(
+        &mut self,
+        op: &BinaryOp,
+        lhs_val: BasicValueEnum<'ctx>,
+        lhs_type: &BrixType,
+        rhs_val: BasicValueEnum<'ctx>,
+        rhs_type: &BrixType,
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let f64_type = self.context.f64_type();
+        let is_scalar = |t: &BrixType| matches!(t, BrixType::Int | BrixType::Float);
+        let op_name = match op {
+            BinaryOp::Add => "add",
+            BinaryOp::Sub => "sub",
+            BinaryOp::Mul => "mul",
+            BinaryOp::Div => "div",
+            _ => "",
+        };
+        let unsupported = |reason: &str| CodegenError::InvalidOperation {
+            operation: format!("{:?} {:?} {:?}", lhs_type, op, rhs_type),
+            reason: reason.to_string(),
+            span: Some(expr.span.clone()),
+        };
+        if op_name.is_empty() {
+            return Err(unsupported("Matrix32 supports only + - * /"));
+        }
+
+        let result = if *lhs_type == BrixType::Matrix32 && *rhs_type == BrixType::Matrix32 {
+            self.call_ptr_runtime(
+                &format!("matrix32_{}_matrix32", op_name),
+                &[ptr_type.into(), ptr_type.into()],
+                &[lhs_val.into(), rhs_val.into()],
+                expr,
+            )?
+        } else if *lhs_type == BrixType::Matrix32 && is_scalar(rhs_type) {
+            let s = self.coerce_to_f64(rhs_val, rhs_type)?;
+            self.call_ptr_runtime(
+                &format!("matrix32_{}_scalar", op_name),
+                &[ptr_type.into(), f64_type.into()],
+                &[lhs_val.into(), s.into()],
+                expr,
+            )?
+        } else if is_scalar(lhs_type) && *rhs_type == BrixType::Matrix32 {
+            let s = self.coerce_to_f64(lhs_val, lhs_type)?;
+            match op {
+                // Commutative: reuse the matrix-first kernel
+                BinaryOp::Add | BinaryOp::Mul => self.call_ptr_runtime(
+                    &format!("matrix32_{}_scalar", op_name),
+                    &[ptr_type.into(), f64_type.into()],
+                    &[rhs_val.into(), s.into()],
+                    expr,
+                )?,
+                _ => self.call_ptr_runtime(
+                    &format!("scalar_{}_matrix32", op_name),
+                    &[f64_type.into(), ptr_type.into()],
+                    &[s.into(), rhs_val.into()],
+                    expr,
+                )?,
+            }
+        } else {
+            return Err(unsupported(
+                "Matrix32 combines only with Matrix32 or scalars; convert with matrix32() or matrix()",
+            ));
+        };
+        Ok((result, BrixType::Matrix32))
+    }
+
+    /// Compile `m32[i]` / `m32[r][c]` -> Float (v1.9). Flat indices may be
+    /// negative, like Matrix.
+    fn compile_matrix32_index(
+        &mut self,
+        m_val: BasicValueEnum<'ctx>,
+        indices: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let i64_type = self.context.i64_type();
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let f64_type = self.context.f64_type();
+        let idx = self.compile_flat_or_2d_indices(indices, expr)?;
+        let c_fn = if idx.len() == 1 {
+            "matrix32_get"
+        } else {
+            "matrix32_get2"
+        };
+        let mut param_types: Vec<BasicMetadataTypeEnum<'ctx>> = vec![ptr_type.into()];
+        let mut call_args: Vec<BasicMetadataValueEnum<'ctx>> = vec![m_val.into()];
+        for i in idx {
+            param_types.push(i64_type.into());
+            call_args.push(i.into());
+        }
+        let v = self.call_runtime(c_fn, f64_type.into(), &param_types, &call_args, expr)?;
+        Ok((v, BrixType::Float))
+    }
+
+    /// Compile `m32[i] = v` / `m32[r][c] = v` (v1.9). The value is narrowed
+    /// to f32 by the runtime.
+    fn compile_matrix32_store(
+        &mut self,
+        m_val: BasicValueEnum<'ctx>,
+        indices: &[Expr],
+        value: &Expr,
+        expr: &Expr,
+    ) -> CodegenResult<()> {
+        let i64_type = self.context.i64_type();
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let f64_type = self.context.f64_type();
+        let idx = self.compile_flat_or_2d_indices(indices, expr)?;
+        let c_fn = if idx.len() == 1 {
+            "matrix32_set"
+        } else {
+            "matrix32_set2"
+        };
+        let (v_raw, v_ty) = self.compile_expr(value)?;
+        let v = self.coerce_to_f64(v_raw, &v_ty)?;
+
+        let mut param_types: Vec<BasicMetadataTypeEnum<'ctx>> = vec![ptr_type.into()];
+        let mut call_args: Vec<BasicMetadataValueEnum<'ctx>> = vec![m_val.into()];
+        for i in idx {
+            param_types.push(i64_type.into());
+            call_args.push(i.into());
+        }
+        param_types.push(f64_type.into());
+        call_args.push(v.into());
+
+        let fn_type = self.context.void_type().fn_type(&param_types, false);
+        let set_fn = self.module.get_function(c_fn).unwrap_or_else(|| {
+            self.module
+                .add_function(c_fn, fn_type, Some(Linkage::External))
+        });
+        self.builder
+            .build_call(set_fn, &call_args, "m32_set")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_call".to_string(),
+                details: format!("Failed to call {}", c_fn),
+                span: Some(expr.span.clone()),
+            })?;
+        Ok(())
+    }
+
+    /// Compile the 1 or 2 indices of a runtime-backed matrix access to i64.
+    fn compile_flat_or_2d_indices(
+        &mut self,
+        indices: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<Vec<IntValue<'ctx>>> {
+        if indices.is_empty() || indices.len() > 2 {
+            return Err(CodegenError::InvalidOperation {
+                operation: "matrix index".to_string(),
+                reason: format!("expects 1 or 2 indices, got {}", indices.len()),
+                span: Some(expr.span.clone()),
+            });
+        }
+        let mut idx = Vec::with_capacity(indices.len());
+        for index in indices {
+            let (raw, ty) = self.compile_expr(index)?;
+            idx.push(self.coerce_to_i64(raw, &ty, "matrix index")?);
+        }
+        Ok(idx)
+    }
+
+    /// Compile a method call on a Matrix32 receiver (v1.9).
+    /// API: sum() / mean() / min() / max() -> float,
+    ///      map(fn) -> Matrix32 / filter(fn) -> Matrix32 (1×k) / reduce(init, fn) -> float.
+    /// Callbacks are ordinary float closures; elements are widened on the way in.
+    fn compile_matrix32_method(
+        &mut self,
+        receiver: BasicValueEnum<'ctx>,
+        method: &str,
+        args: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let f64_type = self.context.f64_type();
+        let expected_args = match method {
+            "map" | "filter" => 1,
+            "reduce" => 2,
+            _ => 0,
+        };
+        if args.len() != expected_args {
+            return Err(CodegenError::InvalidOperation {
+                operation: format!("Matrix32.{}", method),
+                reason: format!("expects {} argument(s), got {}", expected_args, args.len()),
+                span: Some(expr.span.clone()),
+            });
+        }
+
+        match method {
+            "sum" | "mean" | "min" | "max" => {
+                let c_fn = format!("matrix32_{}", method);
+                let v = self.call_runtime(
+                    &c_fn,
+                    f64_type.into(),
+                    &[ptr_type.into()],
+                    &[receiver.into()],
+                    expr,
+                )?;
+                Ok((v, BrixType::Float))
+            }
+            "map" | "filter" => {
+                let ret_type = self.infer_closure_return_type(&args[0]);
+                if method == "map" && ret_type != BrixType::Float {
+                    return Err(CodegenError::TypeError {
+                        expected: "closure returning float".to_string(),
+                        found: format!("{:?}", ret_type),
+                        context: "Matrix32.map callback".to_string(),
+                        span: Some(args[0].span.clone()),
+                    });
+                }
+                let (closure_val, _) = self.compile_expr(&args[0])?;
+                let (fn_ptr, env_ptr) = self.load_closure_fn_env(closure_val, &expr.span)?;
+                let v = self.call_ptr_runtime(
+                    &format!("matrix32_{}", method),
+                    &[ptr_type.into(), ptr_type.into(), ptr_type.into()],
+                    &[receiver.into(), fn_ptr.into(), env_ptr.into()],
+                    expr,
+                )?;
+                Ok((v, BrixType::Matrix32))
+            }
+            "reduce" => {
+                let (init_raw, init_ty) = self.compile_expr(&args[0])?;
+                if !matches!(init_ty, BrixType::Int | BrixType::Float) {
+                    return Err(CodegenError::TypeError {
+                        expected: "float".to_string(),
+                        found: format!("{:?}", init_ty),
+                        context: "Matrix32.reduce initial value".to_string(),
+                        span: Some(args[0].span.clone()),
+                    });
+                }
+                let init = self.coerce_to_f64(init_raw, &init_ty)?;
+                let (closure_val, _) = self.compile_expr(&args[1])?;
+                let (fn_ptr, env_ptr) = self.load_closure_fn_env(closure_val, &expr.span)?;
+                let v = self.call_runtime(
+                    "matrix32_reduce",
+                    f64_type.into(),
+                    &[
+                        ptr_type.into(),
+                        f64_type.into(),
+                        ptr_type.into(),
+                        ptr_type.into(),
+                    ],
+                    &[receiver.into(), init.into(), fn_ptr.into(), env_ptr.into()],
+                    expr,
+                )?;
+                Ok((v, BrixType::Float))
+            }
+            other => Err(CodegenError::General(format!(
+                "Matrix32 method '{}' not supported",
+                other
+            ))),
+        }
+    }
+
+    /// Compile `StringBuilder()` / `StringBuilder(capacity)` (v1.9). The
+    /// optional argument pre-sizes the buffer in bytes.
+    fn compile_stringbuilder_new(
+        &mut self,
+        args: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let i64_type = self.context.i64_type();
+        let capacity = match args.len() {
+            0 => i64_type.const_int(64, false),
+            1 => {
+                let (raw, ty) = self.compile_expr(&args[0])?;
+                self.coerce_to_i64(raw, &ty, "StringBuilder() capacity")?
+            }
+            n => {
+                return Err(CodegenError::InvalidOperation {
+                    operation: "StringBuilder()".to_string(),
+                    reason: format!("expects at most 1 argument (capacity), got {}", n),
+                    span: Some(expr.span.clone()),
+                });
+            }
+        };
+        let sb =
+            self.call_ptr_runtime("brix_sb_new", &[i64_type.into()], &[capacity.into()], expr)?;
+        Ok((sb, BrixType::StringBuilder))
+    }
+
+    /// Compile a method call on a StringBuilder receiver (v1.9).
+    /// API: append(s) / append_int(n) / append_float(x) / append_char(code_point)
+    /// / reserve(n) -> void, len() -> int, build() -> string. build() moves the
+    /// buffer into the returned string and leaves the builder empty.
+    fn compile_stringbuilder_method(
+        &mut self,
+        receiver: BasicValueEnum<'ctx>,
+        method: &str,
+        args: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let i64_type = self.context.i64_type();
+        let f64_type = self.context.f64_type();
+        let expected_args = match method {
+            "len" | "build" => 0,
+            _ => 1,
+        };
+        if args.len() != expected_args {
+            return Err(CodegenError::InvalidOperation {
+                operation: format!("StringBuilder.{}", method),
+                reason: format!("expects {} argument(s), got {}", expected_args, args.len()),
+                span: Some(expr.span.clone()),
+            });
+        }
+
+        let (c_fn, arg, arg_type): (
+            &str,
+            BasicMetadataValueEnum<'ctx>,
+            BasicMetadataTypeEnum<'ctx>,
+        ) = match method {
+            "len" => {
+                let v = self.call_runtime(
+                    "brix_sb_len",
+                    i64_type.into(),
+                    &[ptr_type.into()],
+                    &[receiver.into()],
+                    expr,
+                )?;
+                return Ok((v, BrixType::Int));
+            }
+            "build" => {
+                let v = self.call_ptr_runtime(
+                    "brix_sb_build",
+                    &[ptr_type.into()],
+                    &[receiver.into()],
+                    expr,
+                )?;
+                return Ok((v, BrixType::String));
+            }
+            "append" => {
+                let (val, ty) = self.compile_expr(&args[0])?;
+                if ty != BrixType::String {
+                    return Err(CodegenError::TypeError {
+                        expected: "string (use append_int/append_float for numbers)".to_string(),
+                        found: format!("{:?}", ty),
+                        context: "StringBuilder.append".to_string(),
+                        span: Some(args[0].span.clone()),
+                    });
+                }
+                let append_fn = self
+                    .module
+                    .get_function("brix_sb_append")
+                    .unwrap_or_else(|| {
+                        let fn_type = self
+                            .context
+                            .void_type()
+                            .fn_type(&[ptr_type.into(), ptr_type.into()], false);
+                        self.module
+                            .add_function("brix_sb_append", fn_type, Some(Linkage::External))
+                    });
+                self.builder
+                    .build_call(append_fn, &[receiver.into(), val.into()], "")
+                    .map_err(|_| CodegenError::LLVMError {
+                        operation: "build_call".to_string(),
+                        details: "Failed to call brix_sb_append".to_string(),
+                        span: Some(expr.span.clone()),
+                    })?;
+                // The bytes were copied; drop an owned temporary (concat, call result).
+                if !Self::is_borrowed_ref_expr(&args[0].kind) {
+                    self.insert_release(val.into_pointer_value(), &BrixType::String)?;
+                }
+                return Ok((i64_type.const_int(0, false).into(), BrixType::Void));
+            }
+            "append_int" | "append_char" | "reserve" => {
+                let (raw, ty) = self.compile_expr(&args[0])?;
+                let v = self.coerce_to_i64(raw, &ty, &format!("StringBuilder.{}", method))?;
+                let c_fn = match method {
+                    "append_int" => "brix_sb_append_int",
+                    "append_char" => "brix_sb_append_char",
+                    _ => "brix_sb_reserve",
+                };
+                (c_fn, v.into(), i64_type.into())
+            }
+            "append_float" => {
+                let (raw, ty) = self.compile_expr(&args[0])?;
+                if !matches!(ty, BrixType::Int | BrixType::Float) {
+                    return Err(CodegenError::TypeError {
+                        expected: "float".to_string(),
+                        found: format!("{:?}", ty),
+                        context: "StringBuilder.append_float".to_string(),
+                        span: Some(args[0].span.clone()),
+                    });
+                }
+                let v = self.coerce_to_f64(raw, &ty)?;
+                ("brix_sb_append_float", v.into(), f64_type.into())
+            }
+            other => {
+                return Err(CodegenError::General(format!(
+                    "StringBuilder method '{}' not supported",
+                    other
+                )));
+            }
+        };
+
+        let sb_fn = self.module.get_function(c_fn).unwrap_or_else(|| {
+            let fn_type = self
+                .context
+                .void_type()
+                .fn_type(&[ptr_type.into(), arg_type], false);
+            self.module
+                .add_function(c_fn, fn_type, Some(Linkage::External))
+        });
+        self.builder
+            .build_call(sb_fn, &[receiver.into(), arg], "")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_call".to_string(),
+                details: format!("Failed to call {}", c_fn),
+                span: Some(expr.span.clone()),
+            })?;
+        Ok((i64_type.const_int(0, false).into(), BrixType::Void))
+    }
+
+    /// Compile `s := s + x` / `s += x` on a local String (v1.9).
+    /// str_append_inplace takes over s's reference and appends into its spare
+    /// capacity when nothing else holds it, so a concatenation loop is
+    /// amortized O(n) overall instead of copying the whole string every time.
+    ///
+    /// Same ownership rules as compile_array_inplace_assign: only variables
+    /// owned by the current function qualify. Returns false when the pattern
+    /// does not apply and the assignment should be compiled the usual way.
+    pub(crate) fn compile_string_inplace_append(
+        &mut self,
+        target: &Expr,
+        value: &Expr,
+    ) -> CodegenResult<bool> {
+        let ExprKind::Identifier(name) = &target.kind else {
+            return Ok(false);
+        };
+        let ExprKind::Binary {
+            op: BinaryOp::Add,
+            lhs,
+            rhs,
+        } = &value.kind
+        else {
+            return Ok(false);
+        };
+        if !matches!(&lhs.kind, ExprKind::Identifier(l) if l == name) {
+            return Ok(false);
+        }
+        let Some((var_ptr, BrixType::String)) = self.variables.get(name).cloned() else {
+            return Ok(false);
+        };
+        if self.infer_expr_type_static(rhs, &[]) != Some(BrixType::String) {
+            return Ok(false);
+        }
+        let in_closure = self
+            .current_function
+            .map(|f| f.get_name().to_string_lossy().starts_with("__closure_"))
+            .unwrap_or(false);
+        if in_closure || !self.function_scope_vars.iter().any(|(n, _)| n == name) {
+            return Ok(false);
+        }
+
+        let (rhs_val, rhs_type) = self.compile_expr(rhs)?;
+        if rhs_type != BrixType::String {
+            return Err(CodegenError::TypeError {
+                expected: "string".to_string(),
+                found: format!("{:?}", rhs_type),
+                context: "String concatenation".to_string(),
+                span: Some(rhs.span.clone()),
+            });
+        }
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let old = self
+            .builder
+            .build_load(ptr_type, var_ptr, "inplace_old")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_load".to_string(),
+                details: format!("Failed to load '{}' for in-place append", name),
+                span: Some(target.span.clone()),
+            })?;
+        let result = self.call_ptr_runtime(
+            "str_append_inplace",
+            &[ptr_type.into(), ptr_type.into()],
+            &[old.into(), rhs_val.into()],
+            value,
+        )?;
+        // The bytes were copied; drop an owned temporary (concat, call result).
+        if !Self::is_borrowed_ref_expr(&rhs.kind) {
+            self.insert_release(rhs_val.into_pointer_value(), &BrixType::String)?;
+        }
+        self.builder
+            .build_store(var_ptr, result)
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_store".to_string(),
+                details: format!("Failed to store '{}' after in-place append", name),
+                span: Some(target.span.clone()),
+            })?;
+        Ok(true)
+    }
+
+    /// Recognize `s.chars()`, `s.bytes()` and `s.char_indices()` as a for-in
+    /// iterable, returning the receiver and the method name.
+    fn string_units_iterable(iterable: &Expr) -> Option<(&Expr, &str)> {
+        let ExprKind::Call { func, args } = &iterable.kind else {
+            return None;
+        };
+        let ExprKind::FieldAccess { target, field } = &func.kind else {
+            return None;
+        };
+        if !args.is_empty() || !matches!(field.as_str(), "chars" | "bytes" | "char_indices") {
+            return None;
+        }
+        Some((target.as_ref(), field.as_str()))
+    }
+
+    /// Compile `for c in s.chars()` / `for b in s.bytes()` /
+    /// `for i, c in s.char_indices()` (v1.9).
+    ///
+    /// The loop walks s's bytes directly and yields ints: code points for
+    /// chars() (i = code-point index for char_indices()), raw bytes for
+    /// bytes().
+    /// ASCII is decoded inline; only multi-byte sequences call
+    /// brix_utf8_decode. Nothing is allocated per iteration.
+    ///
+    /// The loop holds a reference to s, so reassigning or appending to the
+    /// variable inside the body cannot free or move the bytes being walked.
+    fn compile_string_units_for(
+        &mut self,
+        var_names: &[String],
+        text: &Expr,
+        unit: &str,
+        body: &Stmt,
+        function: inkwell::values::FunctionValue<'ctx>,
+        stmt: &Stmt,
+    ) -> CodegenResult<()> {
+        let expected_vars = if unit == "char_indices" { 2 } else { 1 };
+        if var_names.len() != expected_vars {
+            return Err(CodegenError::InvalidOperation {
+                operation: format!("String {}() iteration", unit),
+                reason: format!(
+                    "{}() yields {} variable(s), found {}",
+                    unit,
+                    expected_vars,
+                    var_names.len()
+                ),
+                span: Some(stmt.span.clone()),
+            });
+        }
+        let (text_val, text_type) = self.compile_expr(text)?;
+        if text_type != BrixType::String {
+            return Err(CodegenError::TypeError {
+                expected: "string".to_string(),
+                found: format!("{:?}", text_type),
+                context: format!("{}() receiver", unit),
+                span: Some(text.span.clone()),
+            });
+        }
+        if Self::is_borrowed_ref_expr(&text.kind) {
+            self.insert_retain(text_val, &BrixType::String)?;
+        }
+
+        let i64_type = self.context.i64_type();
+        let i8_type = self.context.i8_type();
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let string_type = self.get_string_type();
+        let text_ptr = text_val.into_pointer_value();
+
+        let len_ptr = self
+            .builder
+            .build_struct_gep(string_type, text_ptr, 1, "units_len_ptr")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_struct_gep".to_string(),
+                details: "Failed to get string len for iteration".to_string(),
+                span: None,
+            })?;
+        let byte_len = self
+            .builder
+            .build_load(i64_type, len_ptr, "units_len")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_load".to_string(),
+                details: "Failed to load string len for iteration".to_string(),
+                span: None,
+            })?
+            .into_int_value();
+        let data_field = self
+            .builder
+            .build_struct_gep(string_type, text_ptr, 2, "units_data_ptr")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_struct_gep".to_string(),
+                details: "Failed to get string data for iteration".to_string(),
+                span: None,
+            })?;
+
+        let pos_alloca = self.create_entry_block_alloca(i64_type.into(), "_units_pos")?;
+        let width_alloca = self.create_entry_block_alloca(i64_type.into(), "_units_width")?;
+        // char_indices() counts code points alongside the byte position, so
+        // its index agrees with substring()/char_at()/index_of().
+        let ix_alloca = if unit == "char_indices" {
+            Some(self.create_entry_block_alloca(i64_type.into(), "_units_ix")?)
+        } else {
+            None
+        };
+        for slot in std::iter::once(pos_alloca).chain(ix_alloca) {
+            self.builder
+                .build_store(slot, i64_type.const_int(0, false))
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_store".to_string(),
+                    details: "Failed to init string iter position".to_string(),
+                    span: None,
+                })?;
+        }
+
+        // Loop variables: [index,] unit — all ints.
+        let mut old_vars = Vec::with_capacity(var_names.len());
+        let mut var_allocas = Vec::with_capacity(var_names.len());
+        for name in var_names {
+            let alloca = self.create_entry_block_alloca(i64_type.into(), name)?;
+            old_vars.push((name.clone(), self.variables.remove(name)));
+            self.variables.insert(name.clone(), (alloca, BrixType::Int));
+            var_allocas.push(alloca);
+        }
+
+        let cond_bb = self.context.append_basic_block(function, "units_cond");
+        let body_bb = self.context.append_basic_block(function, "units_body");
+        let after_bb = self.context.append_basic_block(function, "units_after");
+
+        self.builder
+            .build_unconditional_branch(cond_bb)
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_unconditional_branch".to_string(),
+                details: "Failed string iter init branch".to_string(),
+                span: None,
+            })?;
+
+        // --- COND ---
+        self.builder.position_at_end(cond_bb);
+        let pos = self
+            .builder
+            .build_load(i64_type, pos_alloca, "units_pos")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_load".to_string(),
+                details: "Failed to load string iter position".to_string(),
+                span: None,
+            })?
+            .into_int_value();
+        let in_range = self
+            .builder
+            .build_int_compare(IntPredicate::SLT, pos, byte_len, "units_check")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_int_compare".to_string(),
+                details: "Failed string iter cond".to_string(),
+                span: None,
+            })?;
+        self.builder
+            .build_conditional_branch(in_range, body_bb, after_bb)
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_conditional_branch".to_string(),
+                details: "Failed string iter cond branch".to_string(),
+                span: None,
+            })?;
+
+        // --- BODY: decode the unit at pos, then advance pos past it ---
+        // data is reloaded every iteration: the body may pass the string to
+        // brix_str_cstr, which moves a slice's bytes to a fresh buffer.
+        self.builder.position_at_end(body_bb);
+        let data = self
+            .builder
+            .build_load(ptr_type, data_field, "units_data")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_load".to_string(),
+                details: "Failed to load string data for iteration".to_string(),
+                span: None,
+            })?
+            .into_pointer_value();
+        let byte_ptr = unsafe {
+            self.builder
+                .build_gep(i8_type, data, &[pos], "units_byte_ptr")
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_gep".to_string(),
+                    details: "Failed to index string data".to_string(),
+                    span: None,
+                })?
+        };
+        let byte = self
+            .builder
+            .build_load(i8_type, byte_ptr, "units_byte")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_load".to_string(),
+                details: "Failed to load string byte".to_string(),
+                span: None,
+            })?
+            .into_int_value();
+        let byte = self
+            .builder
+            .build_int_z_extend(byte, i64_type, "units_byte64")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_int_z_extend".to_string(),
+                details: "Failed to widen string byte".to_string(),
+                span: None,
+            })?;
+
+        let (unit_val, width) = if unit == "bytes" {
+            (byte, i64_type.const_int(1, false))
+        } else {
+            let ascii_bb = self.context.append_basic_block(function, "units_ascii");
+            let multi_bb = self.context.append_basic_block(function, "units_multi");
+            let join_bb = self.context.append_basic_block(function, "units_join");
+            let is_ascii = self
+                .builder
+                .build_int_compare(
+                    IntPredicate::ULT,
+                    byte,
+                    i64_type.const_int(0x80, false),
+                    "units_is_ascii",
+                )
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_int_compare".to_string(),
+                    details: "Failed ASCII check".to_string(),
+                    span: None,
+                })?;
+            self.builder
+                .build_conditional_branch(is_ascii, ascii_bb, multi_bb)
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_conditional_branch".to_string(),
+                    details: "Failed ASCII branch".to_string(),
+                    span: None,
+                })?;
+
+            self.builder.position_at_end(ascii_bb);
+            self.builder
+                .build_unconditional_branch(join_bb)
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_unconditional_branch".to_string(),
+                    details: "Failed ASCII join branch".to_string(),
+                    span: None,
+                })?;
+
+            self.builder.position_at_end(multi_bb);
+            let remaining = self
+                .builder
+                .build_int_sub(byte_len, pos, "units_remaining")
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_int_sub".to_string(),
+                    details: "Failed to compute remaining bytes".to_string(),
+                    span: None,
+                })?;
+            let decoded = self
+                .call_runtime(
+                    "brix_utf8_decode",
+                    i64_type.into(),
+                    &[ptr_type.into(), i64_type.into(), ptr_type.into()],
+                    &[byte_ptr.into(), remaining.into(), width_alloca.into()],
+                    text,
+                )?
+                .into_int_value();
+            let decoded_width = self
+                .builder
+                .build_load(i64_type, width_alloca, "units_width")
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_load".to_string(),
+                    details: "Failed to load UTF-8 width".to_string(),
+                    span: None,
+                })?
+                .into_int_value();
+            let multi_end_bb = self.builder.get_insert_block().unwrap_or(multi_bb);
+            self.builder
+                .build_unconditional_branch(join_bb)
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_unconditional_branch".to_string(),
+                    details: "Failed UTF-8 join branch".to_string(),
+                    span: None,
+                })?;
+
+            self.builder.position_at_end(join_bb);
+            let unit_phi = self.builder.build_phi(i64_type, "units_cp").map_err(|_| {
+                CodegenError::LLVMError {
+                    operation: "build_phi".to_string(),
+                    details: "Failed to merge decoded code point".to_string(),
+                    span: None,
+                }
+            })?;
+            unit_phi.add_incoming(&[(&byte, ascii_bb), (&decoded, multi_end_bb)]);
+            let width_phi = self.builder.build_phi(i64_type, "units_w").map_err(|_| {
+                CodegenError::LLVMError {
+                    operation: "build_phi".to_string(),
+                    details: "Failed to merge UTF-8 width".to_string(),
+                    span: None,
+                }
+            })?;
+            let one = i64_type.const_int(1, false);
+            width_phi.add_incoming(&[(&one, ascii_bb), (&decoded_width, multi_end_bb)]);
+            (
+                unit_phi.as_basic_value().into_int_value(),
+                width_phi.as_basic_value().into_int_value(),
+            )
+        };
+
+        let next_pos = self
+            .builder
+            .build_int_add(pos, width, "units_next")
+            .map_err(|_| CodegenError::LLVMError {
+                operation: "build_int_add".to_string(),
+                details: "Failed to advance string iter".to_string(),
+                span: None,
+            })?;
+        let mut stores = vec![(pos_alloca, next_pos)];
+        if let Some(ix_alloca) = ix_alloca {
+            let ix = self
+                .builder
+                .build_load(i64_type, ix_alloca, "units_ix")
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_load".to_string(),
+                    details: "Failed to load string iter index".to_string(),
+                    span: None,
+                })?
+                .into_int_value();
+            let next_ix = self
+                .builder
+                .build_int_add(ix, i64_type.const_int(1, false), "units_next_ix")
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_int_add".to_string(),
+                    details: "Failed to advance string iter index".to_string(),
+                    span: None,
+                })?;
+            stores.push((ix_alloca, next_ix));
+            stores.push((var_allocas[0], ix));
+        }
+        stores.push((var_allocas[var_allocas.len() - 1], unit_val));
+        for (slot, val) in stores {
+            self.builder
+                .build_store(slot, val)
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_store".to_string(),
+                    details: "Failed to store string iter state".to_string(),
+                    span: None,
+                })?;
+        }
+
+        // pos already points past this unit, so `continue` goes straight to
+        // the condition.
+        let old_break = self.current_break_block.replace(after_bb);
+        let old_continue = self.current_continue_block.replace(cond_bb);
+        self.loop_owned_refs
+            .push((function, text_ptr, BrixType::String));
+        self.compile_stmt(body, function)?;
+        self.loop_owned_refs.pop();
+        self.current_break_block = old_break;
+        self.current_continue_block = old_continue;
+        if self
+            .builder
+            .get_insert_block()
+            .and_then(|b| b.get_terminator())
+            .is_none()
+        {
+            self.builder
+                .build_unconditional_branch(cond_bb)
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_unconditional_branch".to_string(),
+                    details: "Failed string iter body branch".to_string(),
+                    span: None,
+                })?;
+        }
+
+        // --- AFTER ---
+        self.builder.position_at_end(after_bb);
+        self.insert_release(text_ptr, &BrixType::String)?;
+        for (name, old) in old_vars {
+            if let Some(old) = old {
+                self.variables.insert(name, old);
+            } else {
+                self.variables.remove(&name);
+            }
+        }
+        Ok(())
+    }
+
+    /// Compile `complex(re, im)` with matrix parts -> ComplexMatrix (v1.9).
+    /// Both parts must be Matrix/IntMatrix of the same shape; this is the
+    /// entry point for data kept as split real/imag arrays.
+    fn compile_complexmatrix_from_parts(
+        &mut self,
+        re: (BasicValueEnum<'ctx>, BrixType, &Expr),
+        im: (BasicValueEnum<'ctx>, BrixType, &Expr),
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let mut parts = Vec::with_capacity(2);
+        for (val, ty, arg) in [re, im] {
+            let owned = !Self::is_borrowed_ref_expr(&arg.kind);
+            match ty {
+                BrixType::Matrix => parts.push((val.into_pointer_value(), owned)),
+                BrixType::IntMatrix => {
+                    let promoted = self.call_ptr_runtime(
+                        "intmatrix_to_matrix",
+                        &[ptr_type.into()],
+                        &[val.into()],
+                        arg,
+                    )?;
+                    if owned {
+                        self.insert_release(val.into_pointer_value(), &BrixType::IntMatrix)?;
+                    }
+                    parts.push((promoted.into_pointer_value(), true));
+                }
+                other => {
+                    return Err(CodegenError::TypeError {
+                        expected: "Matrix or IntMatrix".to_string(),
+                        found: format!("{:?}", other),
+                        context: "complex() with matrix parts".to_string(),
+                        span: Some(arg.span.clone()),
+                    });
+                }
+            }
+        }
+        let result = self.call_ptr_runtime(
+            "complexmatrix_from_parts",
+            &[ptr_type.into(), ptr_type.into()],
+            &[parts[0].0.into(), parts[1].0.into()],
+            expr,
+        )?;
+        for (p, owned) in parts {
+            if owned {
+                self.insert_release(p, &BrixType::Matrix)?;
+            }
+        }
+        Ok((result, BrixType::ComplexMatrix))
+    }
+
+    /// Compile `real/imag/abs/conj/exp(cm)` on a ComplexMatrix (v1.9).
+    /// real/imag/abs return a Matrix; conj/exp return a ComplexMatrix.
+    fn compile_complexmatrix_unary(
+        &mut self,
+        name: &str,
+        val: BasicValueEnum<'ctx>,
+        arg: &Expr,
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let ret_type = match name {
+            "conj" | "exp" => BrixType::ComplexMatrix,
+            _ => BrixType::Matrix,
+        };
+        let result = self.call_ptr_runtime(
+            &format!("complexmatrix_{}", name),
+            &[ptr_type.into()],
+            &[val.into()],
+            expr,
+        )?;
+        if !Self::is_borrowed_ref_expr(&arg.kind) {
+            self.insert_release(val.into_pointer_value(), &BrixType::ComplexMatrix)?;
+        }
+        Ok((result, ret_type))
+    }
+
+    /// Split a Complex/Float/Int scalar into (re, im) f64 values.
+    fn complex_scalar_parts(
+        &mut self,
+        val: BasicValueEnum<'ctx>,
+        ty: &BrixType,
+    ) -> CodegenResult<(FloatValue<'ctx>, FloatValue<'ctx>)> {
+        if *ty == BrixType::Complex {
+            let mut parts = [self.context.f64_type().const_zero(); 2];
+            for (i, part) in parts.iter_mut().enumerate() {
+                *part = self
+                    .builder
+                    .build_extract_value(val.into_struct_value(), i as u32, "cm_scalar")
+                    .map_err(|_| CodegenError::LLVMError {
+                        operation: "build_extract_value".to_string(),
+                        details: "Failed to split complex scalar".to_string(),
+                        span: None,
+                    })?
+                    .into_float_value();
+            }
+            return Ok((parts[0], parts[1]));
+        }
+        let re = self.coerce_to_f64(val, ty)?;
+        Ok((re, self.context.f64_type().const_zero()))
+    }
+
+    /// Compile `+ - * /` where at least one side is a ComplexMatrix (v1.9).
+    /// The other side is a ComplexMatrix of the same shape or a
+    /// complex/float/int scalar.
+    fn compile_complexmatrix_binary(
+        &mut self,
+        op: &BinaryOp,
+        lhs_val: BasicValueEnum<'ctx>,
+        lhs_type: &BrixType,
+        rhs_val: BasicValueEnum<'ctx>,
+        rhs_type: &BrixType,
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let f64_type = self.context.f64_type();
+        let is_scalar =
+            |t: &BrixType| matches!(t, BrixType::Int | BrixType::Float | BrixType::Complex);
+        let op_name = match op {
+            BinaryOp::Add => "add",
+            BinaryOp::Sub => "sub",
+            BinaryOp::Mul => "mul",
+            BinaryOp::Div => "div",
+            _ => {
+                return Err(CodegenError::InvalidOperation {
+                    operation: format!("{:?} {:?} {:?}", lhs_type, op, rhs_type),
+                    reason: "ComplexMatrix supports only + - * /".to_string(),
+                    span: Some(expr.span.clone()),
+                });
+            }
+        };
 
-        let (rows_val, cols_val) = if args.len() == 1 {
-            let (n_val, _) = self.compile_expr(&args[0])?;
-            (i64_type.const_int(1, false), n_val.into_int_value())
-        } else if args.len() == 2 {
-            let (r_val, _) = self.compile_expr(&args[0])?;
-            let (c_val, _) = self.compile_expr(&args[1])?;
-            (r_val.into_int_value(), c_val.into_int_value())
+        let result = if *lhs_type == BrixType::ComplexMatrix && *rhs_type == BrixType::ComplexMatrix
+        {
+            self.call_ptr_runtime(
+                &format!("complexmatrix_{}_complexmatrix", op_name),
+                &[ptr_type.into(), ptr_type.into()],
+                &[lhs_val.into(), rhs_val.into()],
+                expr,
+            )?
+        } else if *lhs_type == BrixType::ComplexMatrix && is_scalar(rhs_type) {
+            let (re, im) = self.complex_scalar_parts(rhs_val, rhs_type)?;
+            self.call_ptr_runtime(
+                &format!("complexmatrix_{}_scalar", op_name),
+                &[ptr_type.into(), f64_type.into(), f64_type.into()],
+                &[lhs_val.into(), re.into(), im.into()],
+                expr,
+            )?
+        } else if is_scalar(lhs_type) && *rhs_type == BrixType::ComplexMatrix {
+            let (re, im) = self.complex_scalar_parts(lhs_val, lhs_type)?;
+            match op {
+                // Commutative: reuse the matrix-first kernel
+                BinaryOp::Add | BinaryOp::Mul => self.call_ptr_runtime(
+                    &format!("complexmatrix_{}_scalar", op_name),
+                    &[ptr_type.into(), f64_type.into(), f64_type.into()],
+                    &[rhs_val.into(), re.into(), im.into()],
+                    expr,
+                )?,
+                _ => self.call_ptr_runtime(
+                    &format!("scalar_{}_complexmatrix", op_name),
+                    &[f64_type.into(), f64_type.into(), ptr_type.into()],
+                    &[re.into(), im.into(), rhs_val.into()],
+                    expr,
+                )?,
+            }
         } else {
             return Err(CodegenError::InvalidOperation {
-                operation: "rand()".to_string(),
-                reason: format!("Expected 1 or 2 arguments, got {}", args.len()),
-                span: None,
+                operation: format!("{:?} {:?} {:?}", lhs_type, op, rhs_type),
+                reason: "ComplexMatrix combines only with ComplexMatrix or scalars".to_string(),
+                span: Some(expr.span.clone()),
             });
         };
-
-        let call = self
-            .builder
-            .build_call(
-                brix_rand_fn,
-                &[rows_val.into(), cols_val.into()],
-                "rand_matrix",
-            )
-            .map_err(|_| CodegenError::LLVMError {
-                operation: "build_call".to_string(),
-                details: "Failed to call brix_rand_matrix".to_string(),
-                span: None,
-            })?;
-
-        call.try_as_basic_value()
-            .left()
-            .ok_or_else(|| CodegenError::LLVMError {
-                operation: "try_as_basic_value".to_string(),
-                details: "brix_rand_matrix did not return a value".to_string(),
-                span: None,
-            })
+        Ok((result, BrixType::ComplexMatrix))
     }
 
-    pub(crate) fn compile_irand(&mut self, args: &[Expr]) -> CodegenResult<BasicValueEnum<'ctx>> {
-        // irand(n, max_val) → IntMatrix 1×n with random ints in [0, max_val)
-        if args.len() != 2 {
-            return Err(CodegenError::InvalidOperation {
-                operation: "irand()".to_string(),
-                reason: format!("Expected 2 arguments (n, max_val), got {}", args.len()),
-                span: None,
-            });
-        }
-
+    /// Compile `cm[i]` / `cm[r][c]` -> Complex (v1.9).
+    fn compile_complexmatrix_index(
+        &mut self,
+        m_val: BasicValueEnum<'ctx>,
+        indices: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
         let i64_type = self.context.i64_type();
         let ptr_type = self.context.ptr_type(AddressSpace::default());
-        let fn_type = ptr_type.fn_type(&[i64_type.into(), i64_type.into()], false);
-
-        let brix_irand_fn = self
-            .module
-            .get_function("brix_irand_matrix")
-            .unwrap_or_else(|| {
-                self.module
-                    .add_function("brix_irand_matrix", fn_type, Some(Linkage::External))
-            });
-
-        let (n_val, _) = self.compile_expr(&args[0])?;
-        let (max_val, _) = self.compile_expr(&args[1])?;
-
-        let call = self
-            .builder
-            .build_call(
-                brix_irand_fn,
-                &[
-                    n_val.into_int_value().into(),
-                    max_val.into_int_value().into(),
-                ],
-                "irand_matrix",
-            )
-            .map_err(|_| CodegenError::LLVMError {
-                operation: "build_call".to_string(),
-                details: "Failed to call brix_irand_matrix".to_string(),
-                span: None,
-            })?;
-
-        call.try_as_basic_value()
-            .left()
-            .ok_or_else(|| CodegenError::LLVMError {
-                operation: "try_as_basic_value".to_string(),
-                details: "brix_irand_matrix did not return a value".to_string(),
-                span: None,
-            })
+        let idx = self.compile_flat_or_2d_indices(indices, expr)?;
+        let c_fn = if idx.len() == 1 {
+            "complexmatrix_get"
+        } else {
+            "complexmatrix_get2"
+        };
+        let mut param_types: Vec<BasicMetadataTypeEnum<'ctx>> = vec![ptr_type.into()];
+        let mut call_args: Vec<BasicMetadataValueEnum<'ctx>> = vec![m_val.into()];
+        for i in idx {
+            param_types.push(i64_type.into());
+            call_args.push(i.into());
+        }
+        let complex_type = self.brix_type_to_llvm(&BrixType::Complex);
+        let v = self.call_runtime(c_fn, complex_type, &param_types, &call_args, expr)?;
+        Ok((v, BrixType::Complex))
     }
 
     /// Coerces a compiled value to f64, converting Int→Float if needed.
@@ -12904,55 +15745,99 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
     }
 
     /// Compile a LAPACK decomposition builtin that returns several matrices as
-    /// a Brix tuple (math.lu / math.qr / math.svd).
+    /// a Brix tuple (math.lu / qr / svd / eigh / lstsq / linreg).
+    ///
+    /// The call takes `n_matrices` Matrix arguments. With `int_opt`, an
+    /// optional trailing Int argument is passed on as an i64 (0 when
+    /// omitted), e.g. the top-k count of `math.eigh(A, k)`.
     ///
-    /// The C wrapper `c_fn` returns a heap struct whose layout is a plain
-    /// `{ ptr, ptr, ... }` of `field_types.len()` matrix pointers. We load the
-    /// fields, assemble the Brix tuple value (whose LLVM type is the same
-    /// `{ ptr, ... }`), and free the container shell. Each returned matrix keeps
-    /// ref_count = 1 and becomes owned by whatever binds the tuple (see the
-    /// fresh-tuple ownership handling in compile_destructuring_decl_stmt).
+    /// The C wrapper `c_fn` returns a heap struct with one field per entry of
+    /// `field_types`: a matrix pointer, or a `long` for an Int field (the rank
+    /// of math.lstsq). We load the fields, assemble the Brix tuple value
+    /// (whose LLVM type has the same layout), and free the container shell.
+    /// Each returned matrix keeps ref_count = 1 and becomes owned by whatever
+    /// binds the tuple (see the fresh-tuple ownership handling in
+    /// compile_destructuring_decl_stmt).
     fn compile_math_matrix_tuple(
         &mut self,
         method_name: &str, // "lu" / "qr" / "svd" (diagnostics only)
         c_fn: &str,        // "math_lu" / "math_qr" / "math_svd"
         field_types: &[BrixType],
+        n_matrices: usize,
+        int_opt: bool,
         args: &[Expr],
         expr: &Expr,
     ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
         use inkwell::AddressSpace;
 
-        if args.len() != 1 {
+        let max_args = n_matrices + int_opt as usize;
+        if args.len() < n_matrices || args.len() > max_args {
             return Err(CodegenError::InvalidOperation {
                 operation: format!("math.{}", method_name),
-                reason: format!("expected 1 argument (a matrix), got {}", args.len()),
-                span: Some(expr.span.clone()),
-            });
-        }
-
-        let (matrix_val, matrix_type) = self.compile_expr(&args[0])?;
-        if matrix_type != BrixType::Matrix {
-            return Err(CodegenError::TypeError {
-                expected: "Matrix (float)".to_string(),
-                found: format!("{:?}", matrix_type),
-                context: format!("math.{} argument", method_name),
+                reason: if int_opt {
+                    format!(
+                        "expected (matrix) or (matrix, int), got {} args",
+                        args.len()
+                    )
+                } else {
+                    format!(
+                        "expected {} matrix argument(s), got {}",
+                        n_matrices,
+                        args.len()
+                    )
+                },
                 span: Some(expr.span.clone()),
             });
         }
 
         let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let i64_type = self.context.i64_type();
         let n = field_types.len();
 
-        // Declare `<Result>* c_fn(Matrix*)` on demand (opaque-pointer ABI).
+        let mut call_args: Vec<BasicMetadataValueEnum> = Vec::with_capacity(max_args);
+        let mut param_types: Vec<BasicMetadataTypeEnum> = Vec::with_capacity(max_args);
+        for arg in &args[..n_matrices] {
+            let (matrix_val, matrix_type) = self.compile_expr(arg)?;
+            if matrix_type != BrixType::Matrix {
+                return Err(CodegenError::TypeError {
+                    expected: "Matrix (float)".to_string(),
+                    found: format!("{:?}", matrix_type),
+                    context: format!("math.{} argument", method_name),
+                    span: Some(expr.span.clone()),
+                });
+            }
+            call_args.push(matrix_val.into());
+            param_types.push(ptr_type.into());
+        }
+        if int_opt {
+            let opt_val = if args.len() == max_args {
+                let (v, t) = self.compile_expr(&args[n_matrices])?;
+                if t != BrixType::Int {
+                    return Err(CodegenError::TypeError {
+                        expected: "Int".to_string(),
+                        found: format!("{:?}", t),
+                        context: format!("math.{} second argument", method_name),
+                        span: Some(expr.span.clone()),
+                    });
+                }
+                v.into_int_value()
+            } else {
+                i64_type.const_int(0, false)
+            };
+            call_args.push(opt_val.into());
+            param_types.push(i64_type.into());
+        }
+
+        // Declare `<Result>* c_fn(Matrix*, ...[, i64])` on demand (opaque-pointer ABI).
         let decomp_fn = self.module.get_function(c_fn).unwrap_or_else(|| {
-            let fn_type = ptr_type.fn_type(&[ptr_type.into()], false);
+            let fn_type = ptr_type.fn_type(&param_types, false);
             self.module
                 .add_function(c_fn, fn_type, Some(Linkage::External))
         });
 
         let call = self
             .builder
-            .build_call(decomp_fn, &[matrix_val.into()], "decomp_call")
+            .build_call(decomp_fn, &call_args, "decomp_call")
             .map_err(|_| CodegenError::LLVMError {
                 operation: "build_call".to_string(),
                 details: format!("Failed to call {}", c_fn),
@@ -12968,10 +15853,12 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
             })?
             .into_pointer_value();
 
-        // Result container layout: N matrix pointers == { ptr, ptr, ... }.
-        let ptr_fields: Vec<inkwell::types::BasicTypeEnum> =
-            (0..n).map(|_| ptr_type.into()).collect();
-        let result_struct_type = self.context.struct_type(&ptr_fields, false);
+        // Result container layout: one field per tuple element, in order.
+        let llvm_fields: Vec<inkwell::types::BasicTypeEnum> = field_types
+            .iter()
+            .map(|t| self.brix_type_to_llvm(t))
+            .collect();
+        let result_struct_type = self.context.struct_type(&llvm_fields, false);
 
         let mut fields = Vec::with_capacity(n);
         for i in 0..n {
@@ -12986,7 +15873,7 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                 })?;
             let loaded = self
                 .builder
-                .build_load(ptr_type, field_ptr, &fname)
+                .build_load(llvm_fields[i], field_ptr, &fname)
                 .map_err(|_| CodegenError::LLVMError {
                     operation: "build_load".to_string(),
                     details: format!("Failed to load {} field {}", c_fn, i),
@@ -13098,6 +15985,239 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
         Ok((result, ret_type))
     }
 
+    /// Compile a `regex` module call (v1.9): `is_match(p, s)` -> Int,
+    /// `find(p, s)` -> String ("" when nothing matches), `find_all`,
+    /// `captures` and `split` -> StringMatrix, `replace_all(p, s, repl)` ->
+    /// String. The runtime compiles the pattern on first use and caches it,
+    /// so a literal pattern in a loop is parsed once.
+    fn compile_regex_call(
+        &mut self,
+        name: &str,
+        args: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let (n_args, ret_type) = match name {
+            "is_match" => (2, BrixType::Int),
+            "find" => (2, BrixType::String),
+            "find_all" | "captures" | "split" => (2, BrixType::StringMatrix),
+            "replace_all" => (3, BrixType::String),
+            _ => {
+                return Err(CodegenError::UndefinedSymbol {
+                    name: format!("regex.{}", name),
+                    context: "regex module".to_string(),
+                    span: Some(expr.span.clone()),
+                });
+            }
+        };
+        if args.len() != n_args {
+            return Err(CodegenError::InvalidOperation {
+                operation: format!("regex.{}", name),
+                reason: format!("expected {} string arguments, got {}", n_args, args.len()),
+                span: Some(expr.span.clone()),
+            });
+        }
+
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let mut call_args: Vec<BasicMetadataValueEnum<'ctx>> = Vec::with_capacity(n_args);
+        let mut temps = Vec::new();
+        for arg in args {
+            let (val, ty) = self.compile_expr(arg)?;
+            if ty != BrixType::String {
+                return Err(CodegenError::TypeError {
+                    expected: "String".to_string(),
+                    found: format!("{:?}", ty),
+                    context: format!("regex.{} argument", name),
+                    span: Some(arg.span.clone()),
+                });
+            }
+            if !Self::is_borrowed_ref_expr(&arg.kind) {
+                temps.push(val.into_pointer_value());
+            }
+            call_args.push(val.into());
+        }
+
+        let ret_llvm: BasicTypeEnum<'ctx> = if ret_type == BrixType::Int {
+            self.context.i64_type().into()
+        } else {
+            ptr_type.into()
+        };
+        let param_types: Vec<BasicMetadataTypeEnum<'ctx>> =
+            (0..n_args).map(|_| ptr_type.into()).collect();
+        let result = self.call_runtime(
+            &format!("brix_regex_{}", name),
+            ret_llvm,
+            &param_types,
+            &call_args,
+            expr,
+        )?;
+        for temp in temps {
+            self.insert_release(temp, &BrixType::String)?;
+        }
+        Ok((result, ret_type))
+    }
+
+    /// Compile the BLAS-backed math builtins (v1.9):
+    /// `dot(a, b)` -> Float, `cov(X)` / `corrcoef(X)` -> Matrix,
+    /// `axpy(alpha, x, y)` -> Matrix and `axpy_inplace(alpha, x, y)` -> Void.
+    /// Matrix operands accept IntMatrix through `compile_f64_matrix_arg`,
+    /// except the in-place target, which must already be a float Matrix.
+    fn compile_math_blas(
+        &mut self,
+        name: &str,
+        args: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        let expected = match name {
+            "dot" => 2,
+            "cov" | "corrcoef" => 1,
+            _ => 3, // axpy / axpy_inplace
+        };
+        if args.len() != expected {
+            return Err(CodegenError::InvalidOperation {
+                operation: format!("math.{}", name),
+                reason: format!("expected {} argument(s), got {}", expected, args.len()),
+                span: Some(expr.span.clone()),
+            });
+        }
+
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let f64_type = self.context.f64_type();
+        let c_fn = format!("math_{}", name);
+        let context = format!("math.{} argument", name);
+
+        if name == "cov" || name == "corrcoef" {
+            let (x, x_owned) = self.compile_f64_matrix_arg(&args[0], &context)?;
+            let result = self.call_ptr_runtime(&c_fn, &[ptr_type.into()], &[x.into()], expr)?;
+            if x_owned {
+                self.insert_release(x, &BrixType::Matrix)?;
+            }
+            return Ok((result, BrixType::Matrix));
+        }
+
+        if name == "dot" {
+            let (a, a_owned) = self.compile_f64_matrix_arg(&args[0], &context)?;
+            let (b, b_owned) = self.compile_f64_matrix_arg(&args[1], &context)?;
+            let result = self.call_runtime(
+                &c_fn,
+                f64_type.into(),
+                &[ptr_type.into(), ptr_type.into()],
+                &[a.into(), b.into()],
+                expr,
+            )?;
+            for (m, owned) in [(a, a_owned), (b, b_owned)] {
+                if owned {
+                    self.insert_release(m, &BrixType::Matrix)?;
+                }
+            }
+            return Ok((result, BrixType::Float));
+        }
+
+        let (alpha_val, alpha_ty) = self.compile_expr(&args[0])?;
+        let alpha = self.coerce_to_f64(alpha_val, &alpha_ty)?;
+        let (x, x_owned) = self.compile_f64_matrix_arg(&args[1], &context)?;
+        let params = [f64_type.into(), ptr_type.into(), ptr_type.into()];
+
+        if name == "axpy_inplace" {
+            let (y_val, y_ty) = self.compile_expr(&args[2])?;
+            if y_ty != BrixType::Matrix {
+                return Err(CodegenError::TypeError {
+                    expected: "Matrix (float)".to_string(),
+                    found: format!("{:?}", y_ty),
+                    context: "math.axpy_inplace target".to_string(),
+                    span: Some(args[2].span.clone()),
+                });
+            }
+            let y = self.compile_array_unshare(&args[2], y_val.into_pointer_value(), &y_ty)?;
+            let fn_type = self.context.void_type().fn_type(&params, false);
+            let rt_fn = self.module.get_function(&c_fn).unwrap_or_else(|| {
+                self.module
+                    .add_function(&c_fn, fn_type, Some(Linkage::External))
+            });
+            self.builder
+                .build_call(rt_fn, &[alpha.into(), x.into(), y.into()], "")
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_call".to_string(),
+                    details: format!("Failed to call {}", c_fn),
+                    span: Some(expr.span.clone()),
+                })?;
+            if x_owned {
+                self.insert_release(x, &BrixType::Matrix)?;
+            }
+            if !Self::is_borrowed_ref_expr(&args[2].kind) {
+                self.insert_release(y, &BrixType::Matrix)?;
+            }
+            return Ok((
+                self.context.i64_type().const_int(0, false).into(),
+                BrixType::Void,
+            ));
+        }
+
+        let (y, y_owned) = self.compile_f64_matrix_arg(&args[2], &context)?;
+        let result =
+            self.call_ptr_runtime(&c_fn, &params, &[alpha.into(), x.into(), y.into()], expr)?;
+        for (m, owned) in [(x, x_owned), (y, y_owned)] {
+            if owned {
+                self.insert_release(m, &BrixType::Matrix)?;
+            }
+        }
+        Ok((result, BrixType::Matrix))
+    }
+
+    /// Compile `math.eigvalsh(A)` / `math.eigvalsh(A, k)` -> Matrix (m x 1).
+    /// Eigenvalues of a symmetric matrix; k > 0 keeps the k largest, largest
+    /// first (see math_eigh in the runtime).
+    fn compile_math_eigvalsh(
+        &mut self,
+        args: &[Expr],
+        expr: &Expr,
+    ) -> CodegenResult<(BasicValueEnum<'ctx>, BrixType)> {
+        if args.is_empty() || args.len() > 2 {
+            return Err(CodegenError::InvalidOperation {
+                operation: "math.eigvalsh".to_string(),
+                reason: format!(
+                    "expected (matrix) or (matrix, int), got {} args",
+                    args.len()
+                ),
+                span: Some(expr.span.clone()),
+            });
+        }
+
+        let (mat_val, mat_type) = self.compile_expr(&args[0])?;
+        if mat_type != BrixType::Matrix {
+            return Err(CodegenError::TypeError {
+                expected: "Matrix (float)".to_string(),
+                found: format!("{:?}", mat_type),
+                context: "math.eigvalsh argument".to_string(),
+                span: Some(expr.span.clone()),
+            });
+        }
+
+        let i64_type = self.context.i64_type();
+        let k_val = if args.len() == 2 {
+            let (k, kt) = self.compile_expr(&args[1])?;
+            if kt != BrixType::Int {
+                return Err(CodegenError::TypeError {
+                    expected: "Int".to_string(),
+                    found: format!("{:?}", kt),
+                    context: "math.eigvalsh k argument".to_string(),
+                    span: Some(expr.span.clone()),
+                });
+            }
+            k.into_int_value()
+        } else {
+            i64_type.const_int(0, false) // full spectrum
+        };
+
+        let ptr_type = self.context.ptr_type(AddressSpace::default());
+        let result = self.call_ptr_runtime(
+            "math_eigvalsh",
+            &[ptr_type.into(), i64_type.into()],
+            &[mat_val.into(), k_val.into()],
+            expr,
+        )?;
+        Ok((result, BrixType::Matrix))
+    }
+
     /// Compile `math.norm_mat(A)` / `math.norm_mat(A, code)` -> Float.
     /// code: 0 = Frobenius (default), 1 = 1-norm, 2 = inf-norm.
     fn compile_math_norm_mat(
@@ -16306,12 +19426,41 @@ impl<'a, 'ctx> Compiler<'a, 'ctx> {
                 // Method calls: .split() on a String returns StringMatrix;
                 // v1.7 Group B array methods return based on the receiver's element type.
                 if let ExprKind::FieldAccess { target, field } = &func.kind {
+                    if let ExprKind::Identifier(module) = &target.kind {
+                        if self
+                            .imported_modules
+                            .iter()
+                            .any(|(m, p)| m == "regex" && p == module)
+                        {
+                            return match field.as_str() {
+                                "is_match" => Some(BrixType::Int),
+                                "find" | "replace_all" => Some(BrixType::String),
+                                "find_all" | "captures" | "split" => Some(BrixType::StringMatrix),
+                                _ => None,
+                            };
+                        }
+                    }
                     if field == "split" {
                         if let Some(BrixType::String) = self.infer_expr_type_static(target, params)
                         {
                             return Some(BrixType::StringMatrix);
                         }
                     }
+                    if self.string_segments_source(target).is_some() {
+                        return match field.as_str() {
+                            "nth" => Some(BrixType::String),
+                            "count" | "any" | "all" => Some(BrixType::Int),
+                            "filter" => Some(BrixType::StringMatrix),
+                            "find" => Some(BrixType::Union(vec![BrixType::String, BrixType::Nil])),
+                            _ => None,
+                        };
+                    }
+                    if matches!(field.as_str(), "split_iter" | "lines") {
+                        if let Some(BrixType::String) = self.infer_expr_type_static(target, params)
+                        {
+                            return Some(BrixType::StringMatrix);
+                        }
+                    }
                     if matches!(
                         field.as_str(),
                         "sort"
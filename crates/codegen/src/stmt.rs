@@ -74,6 +74,7 @@ pub trait StatementCompiler<'ctx> {
         name: &str,
         type_hint: &Option<String>,
         value: &Expr,
+        is_const: bool,
     ) -> CodegenResult<()>;
 
     /// Compile destructuring declaration (tuple unpacking)
@@ -106,27 +107,7 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
 
         // Extract char* from BrixString
         let struct_ptr = str_val.into_pointer_value();
-        let str_type = self.get_string_type();
-        let data_ptr_ptr = self
-            .builder
-            .build_struct_gep(str_type, struct_ptr, 2, "str_data_ptr")
-            .map_err(|_| CodegenError::LLVMError {
-                operation: "build_struct_gep".to_string(),
-                details: "Failed to get string data pointer".to_string(),
-                span: None,
-            })?;
-        let data_ptr = self
-            .builder
-            .build_load(
-                self.context.ptr_type(AddressSpace::default()),
-                data_ptr_ptr,
-                "str_data",
-            )
-            .map_err(|_| CodegenError::LLVMError {
-                operation: "build_load".to_string(),
-                details: "Failed to load string data".to_string(),
-                span: None,
-            })?;
+        let data_ptr = self.string_cstr(struct_ptr)?;
 
         self.builder
             .build_call(
@@ -169,27 +150,7 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
 
         // Extract char* from BrixString
         let struct_ptr = str_val.into_pointer_value();
-        let str_type = self.get_string_type();
-        let data_ptr_ptr = self
-            .builder
-            .build_struct_gep(str_type, struct_ptr, 2, "str_data_ptr")
-            .map_err(|_| CodegenError::LLVMError {
-                operation: "build_struct_gep".to_string(),
-                details: "Failed to get string data pointer".to_string(),
-                span: None,
-            })?;
-        let data_ptr = self
-            .builder
-            .build_load(
-                self.context.ptr_type(AddressSpace::default()),
-                data_ptr_ptr,
-                "str_data",
-            )
-            .map_err(|_| CodegenError::LLVMError {
-                operation: "build_load".to_string(),
-                details: "Failed to load string data".to_string(),
-                span: None,
-            })?;
+        let data_ptr = self.string_cstr(struct_ptr)?;
 
         self.builder
             .build_call(
@@ -233,27 +194,7 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
             match brix_type {
                 BrixType::String => {
                     let struct_ptr = val.into_pointer_value();
-                    let str_type = self.get_string_type();
-                    let data_ptr_ptr = self
-                        .builder
-                        .build_struct_gep(str_type, struct_ptr, 2, "str_data_ptr")
-                        .map_err(|_| CodegenError::LLVMError {
-                            operation: "build_struct_gep".to_string(),
-                            details: "Failed to get string data pointer".to_string(),
-                            span: None,
-                        })?;
-                    let data_ptr = self
-                        .builder
-                        .build_load(
-                            self.context.ptr_type(AddressSpace::default()),
-                            data_ptr_ptr,
-                            "str_data",
-                        )
-                        .map_err(|_| CodegenError::LLVMError {
-                            operation: "build_load".to_string(),
-                            details: "Failed to load string data".to_string(),
-                            span: None,
-                        })?;
+                    let data_ptr = self.string_cstr(struct_ptr)?;
                     compiled_args.push(data_ptr.into());
                 }
                 BrixType::Matrix => compiled_args.push(val.into()),
@@ -497,6 +438,7 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
 
         if values.is_empty() {
             // ARC: Release all ref-counted variables before explicit void return
+            self.release_loop_owned_refs()?;
             self.release_function_scope_vars()?;
 
             self.builder
@@ -508,7 +450,13 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
                 })?;
         } else if values.len() == 1 {
             // Single return
-            let (val, _) = self.compile_expr(&values[0])?;
+            let (val, val_type) = self.compile_expr(&values[0])?;
+            self.release_loop_owned_refs()?;
+            // A scalar result cannot be an array parameter's static-literal
+            // copy, so that copy can go too.
+            if matches!(val_type, BrixType::Int | BrixType::Float) {
+                self.release_param_cow_slots()?;
+            }
             self.builder
                 .build_return(Some(&val))
                 .map_err(|_| CodegenError::LLVMError {
@@ -526,6 +474,13 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
                 compiled_values.push(val);
                 value_types.push(val_type);
             }
+            self.release_loop_owned_refs()?;
+            if value_types
+                .iter()
+                .all(|t| matches!(t, BrixType::Int | BrixType::Float))
+            {
+                self.release_param_cow_slots()?;
+            }
 
             // Create struct type
             let tuple_type = BrixType::Tuple(value_types);
@@ -564,6 +519,7 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
         name: &str,
         type_hint: &Option<String>,
         value: &Expr,
+        is_const: bool,
     ) -> CodegenResult<()> {
         use crate::BrixType;
         use inkwell::types::BasicTypeEnum;
@@ -808,8 +764,16 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
                         // val_type remains as-is (Error or Nil)
                     }
                     _ => {
-                        // Allow matrix, intmatrix, complex, and struct types
-                        if hint != "matrix" && hint != "intmatrix" && hint != "complex" {
+                        // Allow matrix, intmatrix, sparsematrix, matrix32, factor, complex, and struct types
+                        if hint != "matrix"
+                            && hint != "intmatrix"
+                            && hint != "sparsematrix"
+                            && hint != "matrix32"
+                            && hint != "lufactor"
+                            && hint != "choleskyfactor"
+                            && hint != "qrfactor"
+                            && hint != "complex"
+                        {
                             // Check if it's a struct, intersection, or type alias
                             if !matches!(val_type, BrixType::Struct(_) | BrixType::Intersection(_))
                             {
@@ -835,6 +799,12 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
             | BrixType::IntMatrix
             | BrixType::StringMatrix
             | BrixType::ComplexMatrix
+            | BrixType::SparseMatrix
+            | BrixType::Matrix32
+            | BrixType::LUFactor
+            | BrixType::CholeskyFactor
+            | BrixType::QRFactor
+            | BrixType::StringBuilder
             | BrixType::FloatPtr
             | BrixType::Nil
             | BrixType::Vector(_)
@@ -900,6 +870,10 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
         if should_retain {
             final_val = self.insert_retain(final_val, &val_type)?;
         }
+        // A mutable binding never holds a static array literal (v1.9).
+        if !is_const {
+            final_val = self.compile_array_owned(final_val, &val_type, value)?;
+        }
 
         let alloca = if Compiler::is_ref_counted(&val_type) {
             // Ref-counted types use null-initialized alloca so that:
@@ -965,9 +939,9 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
         let (val, val_type) = self.compile_expr(value)?;
 
         // Ownership. Only builtins that PROVABLY return freshly-allocated
-        // ref-counted objects (math.lu, and later qr/svd) transfer ownership to
-        // the destructured bindings — no retain, and an ignored `_` field is
-        // released. Every other source is handled the safe way (retain each
+        // ref-counted objects (math.lu/qr/svd/eigh/lstsq/linreg) transfer
+        // ownership to the destructured bindings — no retain, and an ignored
+        // `_` field is released. Every other source is handled the safe way (retain each
         // binding, never release `_`): a plain `ExprKind::Call` is NOT enough,
         // because a user function may return aliases of existing values
         // (`fn dup(m) -> (m, m)`) which the multi-return path packs without
@@ -982,7 +956,10 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
                         self.imported_modules
                             .iter()
                             .any(|(m, p)| m == "math" && p == module)
-                            && matches!(field.as_str(), "lu" | "qr" | "svd")
+                            && matches!(
+                                field.as_str(),
+                                "lu" | "qr" | "svd" | "eigh" | "lstsq" | "linreg"
+                            )
                     } else {
                         false
                     }
@@ -1028,6 +1005,17 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
                         }
                         continue;
                     }
+                    // ARC: a ref-counted binding is released at function-scope
+                    // end. For a temporary source, ownership transfers (no
+                    // retain — it arrives with ref_count = 1). For a borrowed
+                    // source, the binding is an independent owner, so retain to
+                    // balance that release. Either way the binding never holds
+                    // a static array literal (v1.9).
+                    let mut extracted = extracted;
+                    if Self::is_ref_counted(field_type) && !is_owned_fresh_tuple {
+                        extracted = self.insert_retain(extracted, field_type)?;
+                    }
+                    let extracted = self.compile_array_owned(extracted, field_type, value)?;
                     let llvm_type = self.brix_type_to_llvm(field_type);
                     let alloca = self.builder.build_alloca(llvm_type, name).map_err(|_| {
                         CodegenError::LLVMError {
@@ -1045,15 +1033,7 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
                     })?;
                     self.variables
                         .insert(name.clone(), (alloca, field_type.clone()));
-                    // ARC: register a ref-counted binding for release at
-                    // function-scope end. For a temporary source, ownership
-                    // transfers (no retain — it arrives with ref_count = 1). For
-                    // a borrowed source, the binding is an independent owner, so
-                    // retain to balance the release below.
                     if Self::is_ref_counted(field_type) {
-                        if !is_owned_fresh_tuple {
-                            self.insert_retain(extracted, field_type)?;
-                        }
                         self.function_scope_vars
                             .push((name.clone(), field_type.clone()));
                     }
@@ -1228,6 +1208,20 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
                 )?;
                 return Ok(());
             }
+            // Matrix32 element store (v1.9): f32 storage has no f64 lvalue
+            // address, so it goes through the runtime setter instead.
+            if map_type == BrixType::Matrix32 {
+                return self.compile_matrix32_store(map_val, indices, value, target);
+            }
+        }
+
+        // `x := x.append(v)` grows x in place when x is uniquely owned (v1.9).
+        if self.compile_array_inplace_assign(target, value)? {
+            return Ok(());
+        }
+        // `s := s + x` appends into s's buffer when s is uniquely owned (v1.9).
+        if self.compile_string_inplace_append(target, value)? {
+            return Ok(());
         }
 
         let (target_ptr, target_type) = self.compile_lvalue_addr(target)?;
@@ -1359,6 +1353,7 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
         // Skip retain for Union types (already wrapped)
         if !matches!(target_type, BrixType::Union(_)) {
             final_val = self.insert_retain(final_val, &final_type)?;
+            final_val = self.compile_array_owned(final_val, &final_type, value)?;
         }
 
         // ARC: release the OLD target value now — after the RHS was compiled and
@@ -1404,6 +1399,18 @@ impl<'a, 'ctx> StatementCompiler<'ctx> for Compiler<'a, 'ctx> {
                 details: "Failed to store value in assignment target".to_string(),
                 span: None,
             })?;
+        // The old value released above may have been the parameter's
+        // static-literal copy; the function no longer owns it.
+        if let Some(cow_slot) = self.param_cow_slot(target_ptr) {
+            let ptr_type = self.context.ptr_type(AddressSpace::default());
+            self.builder
+                .build_store(cow_slot, ptr_type.const_null())
+                .map_err(|_| CodegenError::LLVMError {
+                    operation: "build_store".to_string(),
+                    details: "Failed to clear parameter copy".to_string(),
+                    span: None,
+                })?;
+        }
 
         Ok(())
     }
@@ -1468,6 +1468,94 @@ fn test_math_norm_mat() {
     ));
 }
 
+#[test]
+fn test_math_blas_kernels() {
+    // BLAS-backed builtins (v1.9): dot(a, b), cov(X), corrcoef(X).
+    let b = Expr::dummy(ExprKind::Call {
+        func: Box::new(Expr::dummy(ExprKind::Identifier("zeros".to_string()))),
+        args: vec![
+            Expr::dummy(ExprKind::Literal(Literal::Int(2))),
+            Expr::dummy(ExprKind::Literal(Literal::Int(2))),
+        ],
+    });
+    assert!(compile_math_linalg_call("dot", vec![b]));
+    assert!(compile_math_linalg_call("cov", vec![]));
+    assert!(compile_math_linalg_call("corrcoef", vec![]));
+}
+
+#[test]
+fn test_math_axpy() {
+    // axpy(alpha, x, y) with an Int alpha (promoted) and array literals.
+    for field in ["axpy", "axpy_inplace"] {
+        let program = Program {
+            statements: vec![
+                Stmt::dummy(StmtKind::Import {
+                    module: "math".to_string(),
+                    alias: None,
+                }),
+                Stmt::dummy(StmtKind::VariableDecl {
+                    name: "y".to_string(),
+                    type_hint: None,
+                    value: Expr::dummy(ExprKind::Array(vec![
+                        Expr::dummy(ExprKind::Literal(Literal::Float(1.0))),
+                        Expr::dummy(ExprKind::Literal(Literal::Float(2.0))),
+                    ])),
+                    is_const: false,
+                }),
+                Stmt::dummy(StmtKind::Expr(Expr::dummy(ExprKind::Call {
+                    func: Box::new(Expr::dummy(ExprKind::FieldAccess {
+                        target: Box::new(Expr::dummy(ExprKind::Identifier("math".to_string()))),
+                        field: field.to_string(),
+                    })),
+                    args: vec![
+                        Expr::dummy(ExprKind::Literal(Literal::Int(2))),
+                        Expr::dummy(ExprKind::Array(vec![
+                            Expr::dummy(ExprKind::Literal(Literal::Float(3.0))),
+                            Expr::dummy(ExprKind::Literal(Literal::Float(4.0))),
+                        ])),
+                        Expr::dummy(ExprKind::Identifier("y".to_string())),
+                    ],
+                }))),
+            ],
+        };
+        assert!(compile_program(program).is_ok());
+    }
+}
+
+#[test]
+fn test_math_lstsq_linreg() {
+    // Two matrix arguments; lstsq's tuple carries an Int rank field (v1.9).
+    for field in ["lstsq", "linreg"] {
+        let b = Expr::dummy(ExprKind::Call {
+            func: Box::new(Expr::dummy(ExprKind::Identifier("zeros".to_string()))),
+            args: vec![
+                Expr::dummy(ExprKind::Literal(Literal::Int(2))),
+                Expr::dummy(ExprKind::Literal(Literal::Int(1))),
+            ],
+        });
+        assert!(compile_math_linalg_call(field, vec![b]));
+    }
+}
+
+#[test]
+fn test_math_eigh() {
+    // Full spectrum, then the top-k form with an Int count (v1.9).
+    assert!(compile_math_linalg_call("eigh", vec![]));
+    assert!(compile_math_linalg_call(
+        "eigh",
+        vec![Expr::dummy(ExprKind::Literal(Literal::Int(1)))]
+    ));
+}
+
+#[test]
+fn test_math_eigvalsh() {
+    assert!(compile_math_linalg_call("eigvalsh", vec![]));
+    assert!(compile_math_linalg_call(
+        "eigvalsh",
+        vec![Expr::dummy(ExprKind::Literal(Literal::Int(1)))]
+    ));
+}
+
 #[test]
 fn test_math_eigvecs() {
     let program = Program {
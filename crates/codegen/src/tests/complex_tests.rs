@@ -466,3 +466,143 @@ fn test_complex_matrix_indexing() {
     let result = compile_program(program);
     assert!(result.is_ok());
 }
+
+// =========================================================
+// ComplexMatrix elementwise kernels (v1.9)
+// =========================================================
+
+fn float_array(values: &[f64]) -> Expr {
+    Expr::dummy(ExprKind::Array(
+        values
+            .iter()
+            .map(|v| Expr::dummy(ExprKind::Literal(Literal::Float(*v))))
+            .collect(),
+    ))
+}
+
+fn call(name: &str, args: Vec<Expr>) -> Expr {
+    Expr::dummy(ExprKind::Call {
+        func: Box::new(Expr::dummy(ExprKind::Identifier(name.to_string()))),
+        args,
+    })
+}
+
+// import math; var z := complex([1.0, 2.0], [3.0, 4.0]) followed by `tail`.
+fn compile_with_complexmatrix(tail: Expr) -> String {
+    compile_program(Program {
+        statements: vec![
+            Stmt::dummy(StmtKind::Import {
+                module: "math".to_string(),
+                alias: None,
+            }),
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "z".to_string(),
+                type_hint: None,
+                value: call(
+                    "complex",
+                    vec![float_array(&[1.0, 2.0]), float_array(&[3.0, 4.0])],
+                ),
+                is_const: false,
+            }),
+            Stmt::dummy(StmtKind::Expr(tail)),
+        ],
+    })
+    .unwrap()
+}
+
+fn z() -> Expr {
+    Expr::dummy(ExprKind::Identifier("z".to_string()))
+}
+
+#[test]
+fn test_complexmatrix_from_split_parts() {
+    let ir = compile_with_complexmatrix(Expr::dummy(ExprKind::Literal(Literal::Int(0))));
+    assert!(ir.contains("complexmatrix_from_parts"));
+    assert!(ir.contains("complexmatrix_release"));
+}
+
+#[test]
+fn test_complexmatrix_binary_ops() {
+    let ir = compile_with_complexmatrix(Expr::dummy(ExprKind::Binary {
+        op: BinaryOp::Mul,
+        lhs: Box::new(z()),
+        rhs: Box::new(z()),
+    }));
+    assert!(ir.contains("complexmatrix_mul_complexmatrix"));
+
+    let ir = compile_with_complexmatrix(Expr::dummy(ExprKind::Binary {
+        op: BinaryOp::Div,
+        lhs: Box::new(Expr::dummy(ExprKind::Literal(Literal::Complex(1.0, 1.0)))),
+        rhs: Box::new(z()),
+    }));
+    assert!(ir.contains("scalar_div_complexmatrix"));
+
+    let ir = compile_with_complexmatrix(Expr::dummy(ExprKind::Binary {
+        op: BinaryOp::Add,
+        lhs: Box::new(z()),
+        rhs: Box::new(Expr::dummy(ExprKind::Literal(Literal::Float(2.0)))),
+    }));
+    assert!(ir.contains("complexmatrix_add_scalar"));
+}
+
+#[test]
+fn test_complexmatrix_unary_functions() {
+    for (name, c_fn) in [
+        ("abs", "complexmatrix_abs"),
+        ("conj", "complexmatrix_conj"),
+        ("exp", "complexmatrix_exp"),
+        ("real", "complexmatrix_real"),
+        ("imag", "complexmatrix_imag"),
+    ] {
+        let ir = compile_with_complexmatrix(call(name, vec![z()]));
+        assert!(ir.contains(c_fn), "expected {} in IR for {}()", c_fn, name);
+    }
+}
+
+#[test]
+fn test_complexmatrix_index() {
+    let ir = compile_with_complexmatrix(Expr::dummy(ExprKind::Index {
+        array: Box::new(z()),
+        indices: vec![Expr::dummy(ExprKind::Literal(Literal::Int(1)))],
+    }));
+    assert!(ir.contains("complexmatrix_get"));
+}
+
+// ==================== FFT ====================
+
+fn math_call(name: &str, args: Vec<Expr>) -> Expr {
+    Expr::dummy(ExprKind::Call {
+        func: Box::new(Expr::dummy(ExprKind::FieldAccess {
+            target: Box::new(Expr::dummy(ExprKind::Identifier("math".to_string()))),
+            field: name.to_string(),
+        })),
+        args,
+    })
+}
+
+#[test]
+fn test_fft_complex_input() {
+    for name in [
+        "fft",
+        "ifft",
+        "fft2",
+        "ifft2",
+        "fft_inplace",
+        "ifft_inplace",
+    ] {
+        let ir = compile_with_complexmatrix(math_call(name, vec![z()]));
+        let c_fn = format!("math_{}", name);
+        assert!(ir.contains(&c_fn), "expected {} in IR", c_fn);
+    }
+}
+
+#[test]
+fn test_fft_promotes_real_input() {
+    let ir = compile_with_complexmatrix(math_call("fft", vec![float_array(&[1.0, 0.0, -1.0])]));
+    assert!(ir.contains("complexmatrix_from_real"));
+    assert!(ir.contains("math_fft"));
+
+    let ir = compile_with_complexmatrix(math_call("rfft", vec![float_array(&[1.0, 0.0, -1.0])]));
+    assert!(ir.contains("math_rfft"));
+    assert!(!ir.contains("complexmatrix_from_real"));
+}
@@ -1695,6 +1695,463 @@ fn test_irand() {
     assert!(result.is_ok());
 }
 
+// Helper: a single builtin call statement `name(args...)` compiled to IR.
+fn compile_builtin_call(name: &str, args: Vec<Expr>) -> Result<String, String> {
+    compile_program(Program {
+        statements: vec![Stmt::dummy(StmtKind::Expr(Expr::dummy(ExprKind::Call {
+            func: Box::new(Expr::dummy(ExprKind::Identifier(name.to_string()))),
+            args,
+        })))],
+    })
+}
+
+#[test]
+fn test_randn_1d_and_2d() {
+    let ir = compile_builtin_call(
+        "randn",
+        vec![Expr::dummy(ExprKind::Literal(Literal::Int(5)))],
+    )
+    .unwrap();
+    assert!(ir.contains("brix_rand_normal_matrix"));
+    let result = compile_builtin_call(
+        "randn",
+        vec![
+            Expr::dummy(ExprKind::Literal(Literal::Int(2))),
+            Expr::dummy(ExprKind::Literal(Literal::Int(3))),
+        ],
+    );
+    assert!(result.is_ok());
+}
+
+#[test]
+fn test_rand_distributions_with_params() {
+    // Parameters first (Int promoted to Float), then the shape.
+    let ir = compile_builtin_call(
+        "rand_uniform",
+        vec![
+            Expr::dummy(ExprKind::Literal(Literal::Int(-1))),
+            Expr::dummy(ExprKind::Literal(Literal::Float(1.0))),
+            Expr::dummy(ExprKind::Literal(Literal::Int(4))),
+        ],
+    )
+    .unwrap();
+    assert!(ir.contains("brix_rand_uniform_matrix"));
+    let ir = compile_builtin_call(
+        "rand_gamma",
+        vec![
+            Expr::dummy(ExprKind::Literal(Literal::Float(2.0))),
+            Expr::dummy(ExprKind::Literal(Literal::Float(0.5))),
+            Expr::dummy(ExprKind::Literal(Literal::Int(3))),
+            Expr::dummy(ExprKind::Literal(Literal::Int(3))),
+        ],
+    )
+    .unwrap();
+    assert!(ir.contains("brix_rand_gamma_matrix"));
+    let ir = compile_builtin_call(
+        "rand_poisson",
+        vec![
+            Expr::dummy(ExprKind::Literal(Literal::Float(4.0))),
+            Expr::dummy(ExprKind::Literal(Literal::Int(10))),
+        ],
+    )
+    .unwrap();
+    assert!(ir.contains("brix_rand_poisson_matrix"));
+}
+
+#[test]
+fn test_rand_seed() {
+    let ir = compile_builtin_call(
+        "rand_seed",
+        vec![Expr::dummy(ExprKind::Literal(Literal::Int(42)))],
+    )
+    .unwrap();
+    assert!(ir.contains("brix_rand_seed"));
+}
+
+// =========================================================
+// SECTION: SparseMatrix Tests (v1.9)
+// =========================================================
+
+fn int_array(values: &[i64]) -> Expr {
+    Expr::dummy(ExprKind::Array(
+        values
+            .iter()
+            .map(|v| Expr::dummy(ExprKind::Literal(Literal::Int(*v))))
+            .collect(),
+    ))
+}
+
+fn float_array(values: &[f64]) -> Expr {
+    Expr::dummy(ExprKind::Array(
+        values
+            .iter()
+            .map(|v| Expr::dummy(ExprKind::Literal(Literal::Float(*v))))
+            .collect(),
+    ))
+}
+
+// var s := sparse(2, 2, [0, 1], [0, 1], [4.0, 5.0]) followed by `tail`.
+fn compile_with_sparse(tail: Expr) -> Result<String, String> {
+    compile_program(Program {
+        statements: vec![
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "s".to_string(),
+                type_hint: None,
+                value: Expr::dummy(ExprKind::Call {
+                    func: Box::new(Expr::dummy(ExprKind::Identifier("sparse".to_string()))),
+                    args: vec![
+                        Expr::dummy(ExprKind::Literal(Literal::Int(2))),
+                        Expr::dummy(ExprKind::Literal(Literal::Int(2))),
+                        int_array(&[0, 1]),
+                        int_array(&[0, 1]),
+                        float_array(&[4.0, 5.0]),
+                    ],
+                }),
+                is_const: false,
+            }),
+            Stmt::dummy(StmtKind::Expr(tail)),
+        ],
+    })
+}
+
+fn sparse_method(method: &str, args: Vec<Expr>) -> Expr {
+    Expr::dummy(ExprKind::Call {
+        func: Box::new(Expr::dummy(ExprKind::FieldAccess {
+            target: Box::new(Expr::dummy(ExprKind::Identifier("s".to_string()))),
+            field: method.to_string(),
+        })),
+        args,
+    })
+}
+
+#[test]
+fn test_sparse_from_coo() {
+    let ir = compile_with_sparse(Expr::dummy(ExprKind::Literal(Literal::Int(0)))).unwrap();
+    assert!(ir.contains("brix_sparse_from_coo"));
+    assert!(ir.contains("sparsematrix_release"));
+}
+
+#[test]
+fn test_sparse_from_dense() {
+    let ir = compile_builtin_call(
+        "sparse",
+        vec![Expr::dummy(ExprKind::Call {
+            func: Box::new(Expr::dummy(ExprKind::Identifier("eye".to_string()))),
+            args: vec![Expr::dummy(ExprKind::Literal(Literal::Int(3)))],
+        })],
+    )
+    .unwrap();
+    assert!(ir.contains("brix_sparse_from_dense"));
+}
+
+#[test]
+fn test_sparse_mul_and_conversions() {
+    let ir = compile_with_sparse(sparse_method("mul", vec![float_array(&[1.0, 2.0])])).unwrap();
+    assert!(ir.contains("brix_sparse_mul"));
+    let ir = compile_with_sparse(sparse_method("to_dense", vec![])).unwrap();
+    assert!(ir.contains("brix_sparse_to_dense"));
+    let ir = compile_with_sparse(sparse_method("transpose", vec![])).unwrap();
+    assert!(ir.contains("brix_sparse_transpose"));
+}
+
+#[test]
+fn test_sparse_nnz_field() {
+    let ir = compile_with_sparse(Expr::dummy(ExprKind::FieldAccess {
+        target: Box::new(Expr::dummy(ExprKind::Identifier("s".to_string()))),
+        field: "nnz".to_string(),
+    }))
+    .unwrap();
+    assert!(ir.contains("sp_field"));
+}
+
+// import math; var s := sparse(eye(2)) followed by `tail`.
+fn compile_with_krylov(tail: Expr) -> Result<String, String> {
+    let eye2 = Expr::dummy(ExprKind::Call {
+        func: Box::new(ident("eye")),
+        args: vec![Expr::dummy(ExprKind::Literal(Literal::Int(2)))],
+    });
+    compile_program(Program {
+        statements: vec![
+            Stmt::dummy(StmtKind::Import {
+                module: "math".to_string(),
+                alias: None,
+            }),
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "s".to_string(),
+                type_hint: None,
+                value: Expr::dummy(ExprKind::Call {
+                    func: Box::new(ident("sparse")),
+                    args: vec![eye2],
+                }),
+                is_const: false,
+            }),
+            Stmt::dummy(StmtKind::Expr(tail)),
+        ],
+    })
+}
+
+#[test]
+fn test_krylov_operators() {
+    // Sparse, dense and matrix-free (closure) operators all lower to math_krylov.
+    let operators = [
+        ident("s"),
+        Expr::dummy(ExprKind::Call {
+            func: Box::new(ident("eye")),
+            args: vec![Expr::dummy(ExprKind::Literal(Literal::Int(2)))],
+        }),
+        make_unary_closure("v", "matrix", "matrix", ident("v")),
+    ];
+    for method in ["cg", "bicgstab", "gmres"] {
+        for op in operators.iter() {
+            let call = math_call(method, vec![op.clone(), float_array(&[1.0, 2.0])]);
+            let ir = compile_with_krylov(call).unwrap();
+            assert!(
+                ir.contains("math_krylov"),
+                "expected math_krylov for {}",
+                method
+            );
+        }
+    }
+}
+
+#[test]
+fn test_krylov_preconditioner_and_bad_operator() {
+    let pc = make_unary_closure("r", "matrix", "matrix", ident("r"));
+    let call = math_call(
+        "gmres",
+        vec![
+            ident("s"),
+            float_array(&[1.0, 2.0]),
+            Expr::dummy(ExprKind::Literal(Literal::Float(1e-8))),
+            Expr::dummy(ExprKind::Literal(Literal::Int(50))),
+            pc,
+        ],
+    );
+    assert!(compile_with_krylov(call).unwrap().contains("math_krylov"));
+
+    // A closure that does not return a Matrix is rejected.
+    let bad = make_unary_closure(
+        "v",
+        "matrix",
+        "float",
+        Expr::dummy(ExprKind::Literal(Literal::Float(0.0))),
+    );
+    assert!(compile_with_krylov(math_call("cg", vec![bad, float_array(&[1.0])])).is_err());
+}
+
+// =========================================================
+// SECTION: Matrix32 Tests (v1.9)
+// =========================================================
+
+fn ident(name: &str) -> Expr {
+    Expr::dummy(ExprKind::Identifier(name.to_string()))
+}
+
+// var f := ones32(2, 2) followed by `tail`.
+fn matrix32_program(tail: Expr) -> Program {
+    Program {
+        statements: vec![
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "f".to_string(),
+                type_hint: None,
+                value: Expr::dummy(ExprKind::Call {
+                    func: Box::new(ident("ones32")),
+                    args: vec![
+                        Expr::dummy(ExprKind::Literal(Literal::Int(2))),
+                        Expr::dummy(ExprKind::Literal(Literal::Int(2))),
+                    ],
+                }),
+                is_const: false,
+            }),
+            Stmt::dummy(StmtKind::Expr(tail)),
+        ],
+    }
+}
+
+fn compile_with_matrix32(tail: Expr) -> Result<String, String> {
+    compile_program(matrix32_program(tail))
+}
+
+fn matrix32_method(method: &str, args: Vec<Expr>) -> Expr {
+    Expr::dummy(ExprKind::Call {
+        func: Box::new(Expr::dummy(ExprKind::FieldAccess {
+            target: Box::new(ident("f")),
+            field: method.to_string(),
+        })),
+        args,
+    })
+}
+
+fn matrix32_binary(op: BinaryOp, lhs: Expr, rhs: Expr) -> Expr {
+    Expr::dummy(ExprKind::Binary {
+        op,
+        lhs: Box::new(lhs),
+        rhs: Box::new(rhs),
+    })
+}
+
+#[test]
+fn test_matrix32_constructors() {
+    let ir = compile_with_matrix32(Expr::dummy(ExprKind::Literal(Literal::Int(0)))).unwrap();
+    assert!(ir.contains("brix_ones32"));
+    assert!(ir.contains("matrix32_release"));
+    let ir = compile_builtin_call(
+        "rand32",
+        vec![Expr::dummy(ExprKind::Literal(Literal::Int(8)))],
+    )
+    .unwrap();
+    assert!(ir.contains("brix_rand32"));
+    let ir = compile_builtin_call("matrix32", vec![float_array(&[1.0, 2.0])]).unwrap();
+    assert!(ir.contains("matrix32_from_matrix"));
+    let ir = compile_builtin_call("matrix32", vec![int_array(&[1, 2])]).unwrap();
+    assert!(ir.contains("matrix32_from_intmatrix"));
+}
+
+#[test]
+fn test_matrix32_arithmetic() {
+    let two = Expr::dummy(ExprKind::Literal(Literal::Int(2)));
+    let ir =
+        compile_with_matrix32(matrix32_binary(BinaryOp::Mul, ident("f"), two.clone())).unwrap();
+    assert!(ir.contains("matrix32_mul_scalar"));
+    let ir = compile_with_matrix32(matrix32_binary(BinaryOp::Add, ident("f"), ident("f"))).unwrap();
+    assert!(ir.contains("matrix32_add_matrix32"));
+    let ir = compile_with_matrix32(matrix32_binary(BinaryOp::Div, two, ident("f"))).unwrap();
+    assert!(ir.contains("scalar_div_matrix32"));
+}
+
+#[test]
+fn test_matrix32_mixed_with_matrix_rejected() {
+    let result = compile_program_checked(matrix32_program(matrix32_binary(
+        BinaryOp::Add,
+        ident("f"),
+        float_array(&[1.0, 2.0, 3.0, 4.0]),
+    )));
+    assert!(result.is_err());
+}
+
+#[test]
+fn test_matrix32_methods_and_access() {
+    let ir = compile_with_matrix32(matrix32_method("sum", vec![])).unwrap();
+    assert!(ir.contains("matrix32_sum"));
+    let double = make_unary_closure(
+        "x",
+        "float",
+        "float",
+        matrix32_binary(
+            BinaryOp::Mul,
+            ident("x"),
+            Expr::dummy(ExprKind::Literal(Literal::Float(2.0))),
+        ),
+    );
+    let ir = compile_with_matrix32(matrix32_method("map", vec![double])).unwrap();
+    assert!(ir.contains("matrix32_map"));
+    let ir = compile_with_matrix32(Expr::dummy(ExprKind::Index {
+        array: Box::new(ident("f")),
+        indices: vec![
+            Expr::dummy(ExprKind::Literal(Literal::Int(1))),
+            Expr::dummy(ExprKind::Literal(Literal::Int(0))),
+        ],
+    }))
+    .unwrap();
+    assert!(ir.contains("matrix32_get2"));
+    let ir = compile_with_matrix32(Expr::dummy(ExprKind::Call {
+        func: Box::new(ident("matrix")),
+        args: vec![ident("f")],
+    }))
+    .unwrap();
+    assert!(ir.contains("matrix32_to_matrix"));
+}
+
+// =========================================================
+// SECTION: Factorization Tests (v1.9)
+// =========================================================
+
+fn math_call(name: &str, args: Vec<Expr>) -> Expr {
+    Expr::dummy(ExprKind::Call {
+        func: Box::new(Expr::dummy(ExprKind::FieldAccess {
+            target: Box::new(ident("math")),
+            field: name.to_string(),
+        })),
+        args,
+    })
+}
+
+// import math; var F := math.<factor>(eye(2)) followed by `tail`.
+fn compile_with_factor(factor: &str, tail: Expr) -> Result<String, String> {
+    compile_program(Program {
+        statements: vec![
+            Stmt::dummy(StmtKind::Import {
+                module: "math".to_string(),
+                alias: None,
+            }),
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "F".to_string(),
+                type_hint: None,
+                value: math_call(
+                    factor,
+                    vec![Expr::dummy(ExprKind::Call {
+                        func: Box::new(ident("eye")),
+                        args: vec![Expr::dummy(ExprKind::Literal(Literal::Int(2)))],
+                    })],
+                ),
+                is_const: false,
+            }),
+            Stmt::dummy(StmtKind::Expr(tail)),
+        ],
+    })
+}
+
+fn factor_method(method: &str, args: Vec<Expr>) -> Expr {
+    Expr::dummy(ExprKind::Call {
+        func: Box::new(Expr::dummy(ExprKind::FieldAccess {
+            target: Box::new(ident("F")),
+            field: method.to_string(),
+        })),
+        args,
+    })
+}
+
+#[test]
+fn test_factor_constructors() {
+    for (factor, c_fn) in [
+        ("lu_factor", "math_lu_factor"),
+        ("cholesky_factor", "math_cholesky_factor"),
+        ("qr_factor", "math_qr_factor"),
+    ] {
+        let ir =
+            compile_with_factor(factor, Expr::dummy(ExprKind::Literal(Literal::Int(0)))).unwrap();
+        assert!(ir.contains(c_fn), "expected {} in IR", c_fn);
+        assert!(ir.contains("factorization_release"));
+    }
+}
+
+#[test]
+fn test_factor_methods() {
+    let ir = compile_with_factor(
+        "lu_factor",
+        factor_method("solve", vec![float_array(&[1.0, 2.0])]),
+    )
+    .unwrap();
+    assert!(ir.contains("factorization_solve"));
+    let ir = compile_with_factor("cholesky_factor", factor_method("det", vec![])).unwrap();
+    assert!(ir.contains("factorization_det"));
+    let ir = compile_with_factor("qr_factor", factor_method("inv", vec![])).unwrap();
+    assert!(ir.contains("factorization_inv"));
+}
+
+#[test]
+fn test_factor_rows_field() {
+    let ir = compile_with_factor(
+        "lu_factor",
+        Expr::dummy(ExprKind::FieldAccess {
+            target: Box::new(ident("F")),
+            field: "rows".to_string(),
+        }),
+    )
+    .unwrap();
+    assert!(ir.contains("factor_field"));
+}
+
 // =========================================================
 // SECTION: 2D Matrix Iterator Tests (Phase 2b)
 // =========================================================
@@ -2149,6 +2606,145 @@ fn test_array_prepend_intmatrix() {
     assert!(ir.contains("intmatrix_prepend"));
 }
 
+#[test]
+fn test_array_self_append_is_inplace() {
+    // var a := [1.0, 2.0]; a := a.append(3.0); a := a.prepend(0.0); var b := a.append(4.0)
+    let self_call = |field: &str, v: f64| {
+        Stmt::dummy(StmtKind::Assignment {
+            target: Expr::dummy(ExprKind::Identifier("a".to_string())),
+            value: Expr::dummy(ExprKind::Call {
+                func: Box::new(Expr::dummy(ExprKind::FieldAccess {
+                    target: Box::new(Expr::dummy(ExprKind::Identifier("a".to_string()))),
+                    field: field.to_string(),
+                })),
+                args: vec![Expr::dummy(ExprKind::Literal(Literal::Float(v)))],
+            }),
+        })
+    };
+    let program = Program {
+        statements: vec![
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "a".to_string(),
+                type_hint: None,
+                value: float_array_literal(&[1.0, 2.0]),
+                is_const: false,
+            }),
+            self_call("append", 3.0),
+            self_call("prepend", 0.0),
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "b".to_string(),
+                type_hint: None,
+                value: Expr::dummy(ExprKind::Call {
+                    func: Box::new(Expr::dummy(ExprKind::FieldAccess {
+                        target: Box::new(Expr::dummy(ExprKind::Identifier("a".to_string()))),
+                        field: "append".to_string(),
+                    })),
+                    args: vec![Expr::dummy(ExprKind::Literal(Literal::Float(4.0)))],
+                }),
+                is_const: false,
+            }),
+        ],
+    };
+    let ir = compile_program(program).unwrap();
+    assert!(ir.contains("matrix_append_inplace"));
+    assert!(ir.contains("matrix_prepend_inplace"));
+    // Binding the result to a different name keeps the copying form.
+    assert!(ir.contains("@matrix_append("));
+}
+
+#[test]
+fn test_constant_array_literal_is_static() {
+    // var a := [1.0, 2.0, 3.0]; var b := [1, 2]; var c := [a[0], 2.0]; a[0] := 5.0
+    let program = Program {
+        statements: vec![
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "a".to_string(),
+                type_hint: None,
+                value: float_array_literal(&[1.0, 2.0, 3.0]),
+                is_const: false,
+            }),
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "b".to_string(),
+                type_hint: None,
+                value: int_array_literal(&[1, 2]),
+                is_const: false,
+            }),
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "c".to_string(),
+                type_hint: None,
+                value: Expr::dummy(ExprKind::Array(vec![
+                    Expr::dummy(ExprKind::Index {
+                        array: Box::new(Expr::dummy(ExprKind::Identifier("a".to_string()))),
+                        indices: vec![Expr::dummy(ExprKind::Literal(Literal::Int(0)))],
+                    }),
+                    Expr::dummy(ExprKind::Literal(Literal::Float(2.0))),
+                ])),
+                is_const: false,
+            }),
+            Stmt::dummy(StmtKind::Assignment {
+                target: Expr::dummy(ExprKind::Index {
+                    array: Box::new(Expr::dummy(ExprKind::Identifier("a".to_string()))),
+                    indices: vec![Expr::dummy(ExprKind::Literal(Literal::Int(0)))],
+                }),
+                value: Expr::dummy(ExprKind::Literal(Literal::Float(5.0))),
+            }),
+        ],
+    };
+    let ir = compile_program(program).unwrap();
+    assert!(ir.contains("@array_lit"));
+    assert!(ir.contains("@array_lit_data"));
+    // Only the literal with a non-constant element is heap-allocated.
+    assert_eq!(ir.matches("call ptr @matrix_new(").count(), 1);
+    assert!(!ir.contains("call ptr @intmatrix_new("));
+    // Element stores go through the copy-on-write guard.
+    assert!(ir.contains("@matrix_unshare"));
+}
+
+#[test]
+fn test_static_array_bindings_and_params() {
+    // function set0(xs: int[]) { xs[0] := 7 }; const c := [1, 2]; var v := [3, 4]
+    let program = Program {
+        statements: vec![
+            Stmt::dummy(StmtKind::FunctionDef {
+                is_async: false,
+                type_params: vec![],
+                name: "set0".to_string(),
+                params: vec![("xs".to_string(), "int[]".to_string(), None)],
+                return_type: None,
+                body: Box::new(Stmt::dummy(StmtKind::Block(vec![Stmt::dummy(
+                    StmtKind::Assignment {
+                        target: Expr::dummy(ExprKind::Index {
+                            array: Box::new(Expr::dummy(ExprKind::Identifier("xs".to_string()))),
+                            indices: vec![Expr::dummy(ExprKind::Literal(Literal::Int(0)))],
+                        }),
+                        value: Expr::dummy(ExprKind::Literal(Literal::Int(7))),
+                    },
+                )]))),
+            }),
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "c".to_string(),
+                type_hint: None,
+                value: int_array_literal(&[1, 2]),
+                is_const: true,
+            }),
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "v".to_string(),
+                type_hint: None,
+                value: int_array_literal(&[3, 4]),
+                is_const: false,
+            }),
+        ],
+    };
+    let ir = compile_program(program).unwrap();
+    // The write inside set0 copies a static argument into xs and xs_cow,
+    // and xs_cow is released on return.
+    assert!(ir.contains("%xs_cow"));
+    assert!(ir.contains("@intmatrix_release"));
+    // Only the mutable binding takes a heap copy at declaration: one call in
+    // main, one in set0's copy-on-write guard.
+    assert_eq!(ir.matches("call ptr @intmatrix_unshare(").count(), 2);
+}
+
 #[test]
 fn test_array_count() {
     // [1, 2, 3, 4].count()
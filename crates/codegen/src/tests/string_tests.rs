@@ -202,6 +202,33 @@ fn test_fstring_multiple_formats_in_one() {
     assert!(result.is_ok());
 }
 
+#[test]
+fn test_fstring_builds_in_one_call() {
+    // f"n={7}, x={2.5:.2f}" -> one brix_fstring call, no per-part concat
+    let program = Program {
+        statements: vec![Stmt::dummy(StmtKind::Expr(Expr::dummy(
+            ExprKind::FString {
+                parts: vec![
+                    FStringPart::Text("n=".to_string()),
+                    FStringPart::Expr {
+                        expr: Box::new(Expr::dummy(ExprKind::Literal(Literal::Int(7)))),
+                        format: None,
+                    },
+                    FStringPart::Text(", x=".to_string()),
+                    FStringPart::Expr {
+                        expr: Box::new(Expr::dummy(ExprKind::Literal(Literal::Float(2.5)))),
+                        format: Some(".2f".to_string()),
+                    },
+                ],
+            },
+        )))],
+    };
+    let ir = compile_program(program).unwrap();
+    assert_eq!(ir.matches("call ptr @brix_fstring(").count(), 1);
+    assert!(!ir.contains("@str_concat"));
+    assert!(!ir.contains("@sprintf"));
+}
+
 #[test]
 fn test_fstring_format_with_variable() {
     // var x := 42;
@@ -803,3 +830,299 @@ fn test_split_returns_string_matrix() {
         ir
     );
 }
+
+#[test]
+fn test_string_self_concat_is_inplace() {
+    // var s := "a"; s := s + "b"; var t := s + "c"
+    let ident = |n: &str| Box::new(Expr::dummy(ExprKind::Identifier(n.to_string())));
+    let lit = |s: &str| {
+        Box::new(Expr::dummy(ExprKind::Literal(Literal::String(
+            s.to_string(),
+        ))))
+    };
+    let program = Program {
+        statements: vec![
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "s".to_string(),
+                type_hint: None,
+                value: Expr::dummy(ExprKind::Literal(Literal::String("a".to_string()))),
+                is_const: false,
+            }),
+            Stmt::dummy(StmtKind::Assignment {
+                target: Expr::dummy(ExprKind::Identifier("s".to_string())),
+                value: Expr::dummy(ExprKind::Binary {
+                    op: BinaryOp::Add,
+                    lhs: ident("s"),
+                    rhs: lit("b"),
+                }),
+            }),
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "t".to_string(),
+                type_hint: None,
+                value: Expr::dummy(ExprKind::Binary {
+                    op: BinaryOp::Add,
+                    lhs: ident("s"),
+                    rhs: lit("c"),
+                }),
+                is_const: false,
+            }),
+        ],
+    };
+    let ir = compile_program(program).unwrap();
+    assert_eq!(ir.matches("call ptr @str_append_inplace(").count(), 1);
+    // Binding the result to a different name keeps the copying form.
+    assert_eq!(ir.matches("call ptr @str_concat(").count(), 1);
+}
+
+#[test]
+fn test_string_builder_methods() {
+    // var sb := StringBuilder(); sb.append("x"); sb.append_int(1); var s := sb.build()
+    let sb_call = |field: &str, args: Vec<Expr>| {
+        Expr::dummy(ExprKind::Call {
+            func: Box::new(Expr::dummy(ExprKind::FieldAccess {
+                target: Box::new(Expr::dummy(ExprKind::Identifier("sb".to_string()))),
+                field: field.to_string(),
+            })),
+            args,
+        })
+    };
+    let program = Program {
+        statements: vec![
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "sb".to_string(),
+                type_hint: None,
+                value: Expr::dummy(ExprKind::Call {
+                    func: Box::new(Expr::dummy(ExprKind::Identifier(
+                        "StringBuilder".to_string(),
+                    ))),
+                    args: vec![],
+                }),
+                is_const: false,
+            }),
+            Stmt::dummy(StmtKind::Expr(sb_call(
+                "append",
+                vec![Expr::dummy(ExprKind::Literal(Literal::String(
+                    "x".to_string(),
+                )))],
+            ))),
+            Stmt::dummy(StmtKind::Expr(sb_call(
+                "append_int",
+                vec![Expr::dummy(ExprKind::Literal(Literal::Int(1)))],
+            ))),
+            Stmt::dummy(StmtKind::VariableDecl {
+                name: "s".to_string(),
+                type_hint: None,
+                value: sb_call("build", vec![]),
+                is_const: false,
+            }),
+        ],
+    };
+    let ir = compile_program(program).unwrap();
+    assert!(ir.contains("call ptr @brix_sb_new(i64 64)"));
+    assert!(ir.contains("call void @brix_sb_append("));
+    assert!(ir.contains("call void @brix_sb_append_int("));
+    assert!(ir.contains("call ptr @brix_sb_build("));
+    assert!(ir.contains("@stringbuilder_release"));
+}
+
+#[test]
+fn test_c_string_apis_go_through_cstr() {
+    // int("42"): atoi needs a NUL-terminated buffer, which a slice is not
+    let program = Program {
+        statements: vec![Stmt::dummy(StmtKind::Expr(Expr::dummy(ExprKind::Call {
+            func: Box::new(Expr::dummy(ExprKind::Identifier("int".to_string()))),
+            args: vec![Expr::dummy(ExprKind::Literal(Literal::String(
+                "42".to_string(),
+            )))],
+        })))],
+    };
+    let ir = compile_program(program).unwrap();
+    assert!(ir.contains("call ptr @brix_str_cstr("));
+    assert!(ir.contains("@atoi"));
+}
+
+fn string_for(vars: &[&str], iterable: Expr) -> Stmt {
+    Stmt::dummy(StmtKind::For {
+        var_names: vars.iter().map(|v| v.to_string()).collect(),
+        iterable,
+        body: Box::new(Stmt::dummy(StmtKind::Expr(Expr::dummy(
+            ExprKind::Identifier(vars[vars.len() - 1].to_string()),
+        )))),
+    })
+}
+
+fn string_units_call(text: &str, unit: &str) -> Expr {
+    Expr::dummy(ExprKind::Call {
+        func: Box::new(Expr::dummy(ExprKind::FieldAccess {
+            target: Box::new(Expr::dummy(ExprKind::Literal(Literal::String(
+                text.to_string(),
+            )))),
+            field: unit.to_string(),
+        })),
+        args: vec![],
+    })
+}
+
+#[test]
+fn test_string_units_iteration_is_inline() {
+    // .chars()/.bytes()/.char_indices() walk the bytes in place: no per-char string
+    let program = Program {
+        statements: vec![
+            string_for(&["c"], string_units_call("héllo", "chars")),
+            string_for(&["b"], string_units_call("héllo", "bytes")),
+            string_for(&["i", "c"], string_units_call("héllo", "char_indices")),
+        ],
+    };
+    let ir = compile_program(program).unwrap();
+    assert!(ir.contains("call i64 @brix_utf8_decode("));
+    assert!(ir.contains("units_is_ascii"));
+    assert!(!ir.contains("@brix_str_char_at"));
+    assert!(!ir.contains("@brix_str_next_char"));
+}
+
+#[test]
+fn test_string_for_in_walks_code_points() {
+    // for ch in s: one string per code point, advanced by its byte width
+    let program = Program {
+        statements: vec![string_for(
+            &["ch"],
+            Expr::dummy(ExprKind::Literal(Literal::String("héllo".to_string()))),
+        )],
+    };
+    let ir = compile_program(program).unwrap();
+    assert!(ir.contains("call ptr @brix_str_next_char("));
+    assert!(ir.contains("@brix_byte_size"));
+    assert!(!ir.contains("@brix_str_char_at"));
+}
+
+#[test]
+fn test_string_hash_matches_runtime() {
+    // Reference values from str_hash_bytes in runtime.c: literal headers carry a
+    // precomputed hash, so the two must agree bit for bit.
+    use crate::brix_string_hash;
+    assert_eq!(brix_string_hash(b""), 16261760798612848148);
+    assert_eq!(brix_string_hash(b"hello"), 8050885537779380620);
+    assert_eq!(brix_string_hash(b"abcdefghij"), 11161417121656765815);
+    assert_eq!(
+        brix_string_hash(b"the quick brown fox jumps over the lazy dog"),
+        5324157864866804002
+    );
+}
+
+fn regex_call(module: &str, func: &str, args: &[&str]) -> Stmt {
+    Stmt::dummy(StmtKind::Expr(Expr::dummy(ExprKind::Call {
+        func: Box::new(Expr::dummy(ExprKind::FieldAccess {
+            target: Box::new(Expr::dummy(ExprKind::Identifier(module.to_string()))),
+            field: func.to_string(),
+        })),
+        args: args
+            .iter()
+            .map(|a| Expr::dummy(ExprKind::Literal(Literal::String(a.to_string()))))
+            .collect(),
+    })))
+}
+
+#[test]
+fn test_regex_module_calls_runtime() {
+    // Each regex.* function is one runtime call; the pattern is compiled there
+    let program = Program {
+        statements: vec![
+            Stmt::dummy(StmtKind::Import {
+                module: "regex".to_string(),
+                alias: None,
+            }),
+            regex_call("regex", "is_match", &["\\d+", "abc 42"]),
+            regex_call("regex", "find_all", &["\\d+", "abc 42"]),
+            regex_call("regex", "replace_all", &["(\\w+)@", "ana@x", "$1 at "]),
+        ],
+    };
+    let ir = compile_program(program).unwrap();
+    assert!(ir.contains("call i64 @brix_regex_is_match("));
+    assert!(ir.contains("call ptr @brix_regex_find_all("));
+    assert!(ir.contains("call ptr @brix_regex_replace_all("));
+}
+
+#[test]
+fn test_regex_module_alias() {
+    // import regex as re: calls go through the alias
+    let program = Program {
+        statements: vec![
+            Stmt::dummy(StmtKind::Import {
+                module: "regex".to_string(),
+                alias: Some("re".to_string()),
+            }),
+            regex_call("re", "captures", &["(a)(b)?", "ab"]),
+            regex_call("re", "split", &["\\s*,\\s*", "a , b"]),
+        ],
+    };
+    let ir = compile_program(program).unwrap();
+    assert!(ir.contains("call ptr @brix_regex_captures("));
+    assert!(ir.contains("call ptr @brix_regex_split("));
+}
+
+fn segments_call(target: Expr, method: &str, args: Vec<Expr>) -> Expr {
+    Expr::dummy(ExprKind::Call {
+        func: Box::new(Expr::dummy(ExprKind::FieldAccess {
+            target: Box::new(target),
+            field: method.to_string(),
+        })),
+        args,
+    })
+}
+
+fn str_lit(s: &str) -> Expr {
+    Expr::dummy(ExprKind::Literal(Literal::String(s.to_string())))
+}
+
+#[test]
+fn test_split_iter_and_lines_are_lazy() {
+    // for-in over split_iter()/lines() fetches one segment per iteration
+    let program = Program {
+        statements: vec![
+            string_for(
+                &["part"],
+                segments_call(str_lit("a,b,c"), "split_iter", vec![str_lit(",")]),
+            ),
+            string_for(
+                &["line"],
+                segments_call(str_lit("x\r\ny\n"), "lines", vec![]),
+            ),
+        ],
+    };
+    let ir = compile_program(program).unwrap();
+    assert!(ir.contains("call i64 @brix_str_segment_begin("));
+    assert!(ir.contains("call ptr @brix_str_next_segment("));
+    assert!(ir.contains("call void @string_release("));
+    assert!(!ir.contains("@brix_str_split("));
+}
+
+#[test]
+fn test_split_iter_methods_stop_early() {
+    // nth()/count() walk segments; only a bare split_iter() value collects them
+    let fields = || segments_call(str_lit("a b c"), "split_iter", vec![str_lit(" ")]);
+    let program = Program {
+        statements: vec![
+            Stmt::dummy(StmtKind::Expr(segments_call(
+                fields(),
+                "nth",
+                vec![Expr::dummy(ExprKind::Literal(Literal::Int(1)))],
+            ))),
+            Stmt::dummy(StmtKind::Expr(segments_call(
+                segments_call(str_lit("x\ny"), "lines", vec![]),
+                "count",
+                vec![],
+            ))),
+        ],
+    };
+    let ir = compile_program(program).unwrap();
+    assert!(ir.contains("nth_hit"));
+    assert!(ir.contains("call ptr @brix_str_next_segment("));
+    assert!(!ir.contains("@brix_str_matrix_push"));
+    assert!(!ir.contains("@brix_str_split("));
+
+    let program = Program {
+        statements: vec![Stmt::dummy(StmtKind::Expr(fields()))],
+    };
+    let ir = compile_program(program).unwrap();
+    assert!(ir.contains("call void @brix_str_matrix_push("));
+}
@@ -15,12 +15,18 @@ pub enum BrixType {
     Int,
     Float,
     String,
-    Matrix,        // Matrix of f64 (double*)
-    IntMatrix,     // Matrix of i64 (long*)
-    StringMatrix,  // Array of BrixString* ({ ref_count, len, BrixString** data }) (v1.7)
-    Complex,       // Complex number (struct { f64 real, f64 imag })
-    ComplexArray,  // Array of Complex (1D)
-    ComplexMatrix, // Matrix of Complex (2D)
+    Matrix,         // Matrix of f64 (double*)
+    IntMatrix,      // Matrix of i64 (long*)
+    StringMatrix,   // Array of BrixString* ({ ref_count, len, BrixString** data }) (v1.7)
+    Complex,        // Complex number (struct { f64 real, f64 imag })
+    ComplexArray,   // Array of Complex (1D)
+    ComplexMatrix,  // Matrix of Complex (2D)
+    SparseMatrix,   // CSR sparse matrix of f64 (SparseMatrix*), v1.9
+    Matrix32,       // Matrix of f32 (Matrix32*, float* data), v1.9
+    LUFactor,       // LAPACK LU factors + pivots (Factorization*), v1.9
+    CholeskyFactor, // LAPACK Cholesky factor (Factorization*), v1.9
+    QRFactor,       // LAPACK QR reflectors + tau (Factorization*), v1.9
+    StringBuilder,  // Growable string buffer (BrixStringBuilder*), v1.9
     FloatPtr,
     Void,
     Tuple(Vec<BrixType>),                  // Multiple returns (stored as struct)
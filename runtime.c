@@ -394,32 +394,47 @@ typedef struct {
   long rows;
   long cols;
   double *data;
+  // Spare room (v1.9): the allocation starts `head` elements before data and
+  // holds `capacity` elements in total. Only the in-place append/prepend
+  // paths leave slack; everything else is tight (head 0, capacity
+  // rows * cols).
+  long capacity;
+  long head;
 } Matrix;
 
+// Static arrays (v1.9): array literals made only of constants are emitted by
+// the compiler as global data behind a header whose ref_count is
+// BRIX_RC_STATIC, so evaluating one allocates nothing. retain/release leave
+// such headers alone; code about to write through one first swaps it for a
+// private heap copy with matrix_unshare / intmatrix_unshare.
+#define BRIX_RC_STATIC (-1L)
+
 Matrix *matrix_new(long rows, long cols) {
   Matrix *m = (Matrix *)malloc(sizeof(Matrix));
   m->ref_count = 1;  // Initialize ARC
   m->rows = rows;
   m->cols = cols;
   m->data = (double *)malloc(rows * cols * sizeof(double));
+  m->capacity = rows * cols;
+  m->head = 0;
   return m;
 }
 
 // ARC: Increment reference count
 void* matrix_retain(Matrix* m) {
-    if (!m) return NULL;
+    if (!m || m->ref_count == BRIX_RC_STATIC) return m;
     m->ref_count++;
     return m;
 }
 
 // ARC: Decrement reference count and free if zero
 void matrix_release(Matrix* m) {
-    if (!m) return;
+    if (!m || m->ref_count == BRIX_RC_STATIC) return;
     m->ref_count--;
 
     if (m->ref_count == 0) {
         if (m->data) {
-            free(m->data);
+            free(m->data - m->head);
         }
         free(m);
     }
@@ -482,6 +497,8 @@ typedef struct {
   long rows;
   long cols;
   long *data;  // i64* instead of double*
+  long capacity;  // spare room, as in Matrix (v1.9)
+  long head;
 } IntMatrix;
 
 IntMatrix *intmatrix_new(long rows, long cols) {
@@ -490,29 +507,48 @@ IntMatrix *intmatrix_new(long rows, long cols) {
   m->rows = rows;
   m->cols = cols;
   m->data = (long *)calloc(rows * cols, sizeof(long));  // calloc zeros memory
+  m->capacity = rows * cols;
+  m->head = 0;
   return m;
 }
 
 // ARC: Increment reference count
 void* intmatrix_retain(IntMatrix* m) {
-    if (!m) return NULL;
+    if (!m || m->ref_count == BRIX_RC_STATIC) return m;
     m->ref_count++;
     return m;
 }
 
 // ARC: Decrement reference count and free if zero
 void intmatrix_release(IntMatrix* m) {
-    if (!m) return;
+    if (!m || m->ref_count == BRIX_RC_STATIC) return;
     m->ref_count--;
 
     if (m->ref_count == 0) {
         if (m->data) {
-            free(m->data);
+            free(m->data - m->head);
         }
         free(m);
     }
 }
 
+// Copy-on-write for static arrays: a static header comes back as a fresh
+// heap copy (ref_count 1, owned by the caller); any other array is
+// returned unchanged.
+Matrix *matrix_unshare(Matrix *m) {
+  if (!m || m->ref_count != BRIX_RC_STATIC) return m;
+  Matrix *copy = matrix_new(m->rows, m->cols);
+  memcpy(copy->data, m->data, m->rows * m->cols * sizeof(double));
+  return copy;
+}
+
+IntMatrix *intmatrix_unshare(IntMatrix *m) {
+  if (!m || m->ref_count != BRIX_RC_STATIC) return m;
+  IntMatrix *copy = intmatrix_new(m->rows, m->cols);
+  memcpy(copy->data, m->data, m->rows * m->cols * sizeof(long));
+  return copy;
+}
+
 // Convert IntMatrix to Matrix (automatic promotion for mixed operations)
 // Used when IntMatrix operates with Float or Matrix
 Matrix *intmatrix_to_matrix(IntMatrix *im) {
@@ -1042,17 +1078,533 @@ void complexmatrix_release(ComplexMatrix* m) {
     }
 }
 
+// --- Element access (v1.9) ---
+
+static long complexmatrix_flat_index(ComplexMatrix *m, long i) {
+  long total = m->rows * m->cols;
+  if (i < 0) i += total;
+  if (i < 0 || i >= total) {
+    fprintf(stderr, "Error: ComplexMatrix index %ld out of bounds (size %ld)\n",
+            i, total);
+    exit(1);
+  }
+  return i;
+}
+
+Complex complexmatrix_get(ComplexMatrix *m, long i) {
+  return m->data[complexmatrix_flat_index(m, i)];
+}
+
+Complex complexmatrix_get2(ComplexMatrix *m, long r, long c) {
+  return m->data[complexmatrix_flat_index(m, r * m->cols + c)];
+}
+
+// --- Split real/imag parts (v1.9) ---
+// complex(re, im) with two Matrix arguments builds a ComplexMatrix from split
+// (SoA) storage; real(cm) / imag(cm) split it back into plain Matrix arrays.
+
+ComplexMatrix *complexmatrix_from_parts(Matrix *re, Matrix *im) {
+  if (re->rows != im->rows || re->cols != im->cols) {
+    fprintf(stderr,
+            "Error: complex() real/imag shape mismatch: %ldx%ld vs %ldx%ld\n",
+            re->rows, re->cols, im->rows, im->cols);
+    exit(1);
+  }
+  ComplexMatrix *m = complexmatrix_new(re->rows, re->cols);
+  long n = re->rows * re->cols;
+  for (long i = 0; i < n; i++) {
+    m->data[i].real = re->data[i];
+    m->data[i].imag = im->data[i];
+  }
+  return m;
+}
+
+Matrix *complexmatrix_real(ComplexMatrix *m) {
+  Matrix *r = matrix_new(m->rows, m->cols);
+  long n = m->rows * m->cols;
+  for (long i = 0; i < n; i++) r->data[i] = m->data[i].real;
+  return r;
+}
+
+Matrix *complexmatrix_imag(ComplexMatrix *m) {
+  Matrix *r = matrix_new(m->rows, m->cols);
+  long n = m->rows * m->cols;
+  for (long i = 0; i < n; i++) r->data[i] = m->data[i].imag;
+  return r;
+}
+
+// --- Elementwise kernels (v1.9) ---
+// Storage stays interleaved (LAPACK and println expect Complex pairs), but
+// the arithmetic runs on split tiles: each block of up to CM_TILE elements is
+// copied into separate re[]/im[] arrays, computed four lanes at a time with
+// no cross-lane shuffles (re/im never share a vector), and interleaved back.
+// Tiles stay in L1, so the copy costs far less than scalar Complex calls.
+
+#define CM_TILE 256
+
+typedef double brix_f64x4 __attribute__((vector_size(32)));
+
+enum { CM_ADD, CM_SUB, CM_MUL, CM_DIV };
+
+typedef struct {
+  double re[CM_TILE] __attribute__((aligned(32)));
+  double im[CM_TILE] __attribute__((aligned(32)));
+} ComplexTile;
+
+// Split src[0..n) into t, zero-padding up to the next multiple of 4.
+static long cm_split(const Complex *src, long n, ComplexTile *t) {
+  long k = 0;
+  for (; k < n; k++) {
+    t->re[k] = src[k].real;
+    t->im[k] = src[k].imag;
+  }
+  for (; k & 3; k++) {
+    t->re[k] = 0.0;
+    t->im[k] = 0.0;
+  }
+  return k;
+}
+
+static void cm_fill(ComplexTile *t, double re, double im) {
+  for (long k = 0; k < CM_TILE; k++) {
+    t->re[k] = re;
+    t->im[k] = im;
+  }
+}
+
+static void cm_join(Complex *dst, long n, const ComplexTile *t) {
+  for (long k = 0; k < n; k++) {
+    dst[k].real = t->re[k];
+    dst[k].imag = t->im[k];
+  }
+}
+
+static void cm_check_divisor(const ComplexTile *t, long n) {
+  for (long k = 0; k < n; k++) {
+    if (t->re[k] == 0.0 && t->im[k] == 0.0) {
+      fprintf(stderr, "Error: Division by zero (complex)\n");
+      exit(1);
+    }
+  }
+}
+
+// z = x op y over the first n (multiple of 4) lanes of a tile.
+static void cm_tile_op(int op, long n, const ComplexTile *x, const ComplexTile *y,
+                       ComplexTile *z) {
+  for (long k = 0; k < n; k += 4) {
+    brix_f64x4 xr = *(const brix_f64x4 *)(x->re + k);
+    brix_f64x4 xi = *(const brix_f64x4 *)(x->im + k);
+    brix_f64x4 yr = *(const brix_f64x4 *)(y->re + k);
+    brix_f64x4 yi = *(const brix_f64x4 *)(y->im + k);
+    brix_f64x4 zr, zi;
+    switch (op) {
+    case CM_ADD:
+      zr = xr + yr;
+      zi = xi + yi;
+      break;
+    case CM_SUB:
+      zr = xr - yr;
+      zi = xi - yi;
+      break;
+    case CM_MUL:
+      zr = xr * yr - xi * yi;
+      zi = xr * yi + xi * yr;
+      break;
+    default: {
+      brix_f64x4 d = yr * yr + yi * yi;
+      zr = (xr * yr + xi * yi) / d;
+      zi = (xi * yr - xr * yi) / d;
+      break;
+    }
+    }
+    *(brix_f64x4 *)(z->re + k) = zr;
+    *(brix_f64x4 *)(z->im + k) = zi;
+  }
+}
+
+// Shared driver. With b == NULL the other operand is the scalar s, on the
+// left when scalar_first is set (s - m, s / m), on the right otherwise.
+static ComplexMatrix *cm_elementwise(int op, ComplexMatrix *a, ComplexMatrix *b,
+                                     Complex s, int scalar_first) {
+  if (b && (a->rows != b->rows || a->cols != b->cols)) {
+    fprintf(stderr,
+            "Error: ComplexMatrix dimensions mismatch: %ldx%ld vs %ldx%ld\n",
+            a->rows, a->cols, b->rows, b->cols);
+    exit(1);
+  }
+  if (!b && op == CM_DIV && !scalar_first && s.real == 0.0 && s.imag == 0.0) {
+    fprintf(stderr, "Error: Division by zero (complex)\n");
+    exit(1);
+  }
+
+  ComplexMatrix *result = complexmatrix_new(a->rows, a->cols);
+  long n = a->rows * a->cols;
+  ComplexTile *tiles = (ComplexTile *)aligned_alloc(32, 3 * sizeof(ComplexTile));
+  ComplexTile *x = &tiles[0], *y = &tiles[1], *z = &tiles[2];
+  if (!b) cm_fill(scalar_first ? x : y, s.real, s.imag);
+
+  for (long base = 0; base < n; base += CM_TILE) {
+    long t = n - base < CM_TILE ? n - base : CM_TILE;
+    long lanes;
+    if (b) {
+      lanes = cm_split(a->data + base, t, x);
+      cm_split(b->data + base, t, y);
+    } else {
+      lanes = cm_split(a->data + base, t, scalar_first ? y : x);
+    }
+    if (op == CM_DIV && (b || scalar_first)) cm_check_divisor(y, t);
+    cm_tile_op(op, lanes, x, y, z);
+    cm_join(result->data + base, t, z);
+  }
+
+  free(tiles);
+  return result;
+}
+
+ComplexMatrix *complexmatrix_add_complexmatrix(ComplexMatrix *a, ComplexMatrix *b) {
+  return cm_elementwise(CM_ADD, a, b, (Complex){0.0, 0.0}, 0);
+}
+
+ComplexMatrix *complexmatrix_sub_complexmatrix(ComplexMatrix *a, ComplexMatrix *b) {
+  return cm_elementwise(CM_SUB, a, b, (Complex){0.0, 0.0}, 0);
+}
+
+ComplexMatrix *complexmatrix_mul_complexmatrix(ComplexMatrix *a, ComplexMatrix *b) {
+  return cm_elementwise(CM_MUL, a, b, (Complex){0.0, 0.0}, 0);
+}
+
+ComplexMatrix *complexmatrix_div_complexmatrix(ComplexMatrix *a, ComplexMatrix *b) {
+  return cm_elementwise(CM_DIV, a, b, (Complex){0.0, 0.0}, 0);
+}
+
+// cm op (re + im*i); real scalars arrive with im = 0.
+ComplexMatrix *complexmatrix_add_scalar(ComplexMatrix *a, double re, double im) {
+  return cm_elementwise(CM_ADD, a, NULL, (Complex){re, im}, 0);
+}
+
+ComplexMatrix *complexmatrix_sub_scalar(ComplexMatrix *a, double re, double im) {
+  return cm_elementwise(CM_SUB, a, NULL, (Complex){re, im}, 0);
+}
+
+ComplexMatrix *complexmatrix_mul_scalar(ComplexMatrix *a, double re, double im) {
+  return cm_elementwise(CM_MUL, a, NULL, (Complex){re, im}, 0);
+}
+
+ComplexMatrix *complexmatrix_div_scalar(ComplexMatrix *a, double re, double im) {
+  return cm_elementwise(CM_DIV, a, NULL, (Complex){re, im}, 0);
+}
+
+// (re + im*i) - cm and (re + im*i) / cm (non-commutative)
+ComplexMatrix *scalar_sub_complexmatrix(double re, double im, ComplexMatrix *a) {
+  return cm_elementwise(CM_SUB, a, NULL, (Complex){re, im}, 1);
+}
+
+ComplexMatrix *scalar_div_complexmatrix(double re, double im, ComplexMatrix *a) {
+  return cm_elementwise(CM_DIV, a, NULL, (Complex){re, im}, 1);
+}
+
+ComplexMatrix *complexmatrix_conj(ComplexMatrix *a) {
+  ComplexMatrix *result = complexmatrix_new(a->rows, a->cols);
+  long n = a->rows * a->cols;
+  for (long i = 0; i < n; i++) {
+    result->data[i].real = a->data[i].real;
+    result->data[i].imag = -a->data[i].imag;
+  }
+  return result;
+}
+
+// abs(cm) -> Matrix of magnitudes; the squares are summed on split tiles.
+Matrix *complexmatrix_abs(ComplexMatrix *a) {
+  Matrix *result = matrix_new(a->rows, a->cols);
+  long n = a->rows * a->cols;
+  ComplexTile *x = (ComplexTile *)aligned_alloc(32, sizeof(ComplexTile));
+  for (long base = 0; base < n; base += CM_TILE) {
+    long t = n - base < CM_TILE ? n - base : CM_TILE;
+    long lanes = cm_split(a->data + base, t, x);
+    for (long k = 0; k < lanes; k += 4) {
+      brix_f64x4 r = *(brix_f64x4 *)(x->re + k);
+      brix_f64x4 i = *(brix_f64x4 *)(x->im + k);
+      *(brix_f64x4 *)(x->re + k) = r * r + i * i;
+    }
+    for (long k = 0; k < t; k++) result->data[base + k] = sqrt(x->re[k]);
+  }
+  free(x);
+  return result;
+}
+
+// exp(cm): e^re * (cos im + i sin im)
+ComplexMatrix *complexmatrix_exp(ComplexMatrix *a) {
+  ComplexMatrix *result = complexmatrix_new(a->rows, a->cols);
+  long n = a->rows * a->cols;
+  for (long i = 0; i < n; i++) {
+    double mag = exp(a->data[i].real);
+    result->data[i].real = mag * cos(a->data[i].imag);
+    result->data[i].imag = mag * sin(a->data[i].imag);
+  }
+  return result;
+}
+
 // ==========================================
 // SECTION 1.7: LINEAR ALGEBRA - LAPACK (v1.0)
 // ==========================================
 
+// Layout note (v1.9): a row-major m x n buffer is, read column-major, the
+// n x m matrix A^T. Where a routine has a transposed counterpart (eig of A^T,
+// LQ for QR, SVD of A^T, dgetrs 'T', symmetric Cholesky) the wrappers hand
+// LAPACK the row-major data as-is and read the factors back in the right
+// orientation, instead of building a transposed copy first. Only LU (whose
+// row pivoting has no transposed equivalent) and multi-column right-hand
+// sides still go through matrix_to_colmajor.
+
+// --- Transpose kernel (v1.9) ---
+// dst (cols x rows) = src (rows x cols)^T. The naive double loop writes one
+// element per destination cache line and misses on every store once the
+// matrix outgrows the cache. Instead the source is walked in
+// TRANSPOSE_BLOCK x TRANSPOSE_BLOCK tiles (both tiles stay resident), each
+// tile is transposed in 2x2 register blocks (SSE2 unpacks on x86-64), and
+// large matrices split their tile bands across threads.
+
+#include <pthread.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define TRANSPOSE_BLOCK 32
+#define TRANSPOSE_PARALLEL_MIN (1L << 20)  // elements before threading
+#define TRANSPOSE_MAX_THREADS 8
+
+typedef struct {
+  const double *src;
+  double *dst;
+  long rows, cols;
+  long r0, r1, c0, c1;  // source sub-range handled by this job
+} TransposeJob;
+
+static void transpose_tile(const double *src, double *dst, long rows,
+                           long cols, long r0, long r1, long c0, long c1) {
+  long i = r0;
+  for (; i + 1 < r1; i += 2) {
+    const double *s0 = src + i * cols;
+    const double *s1 = s0 + cols;
+    long j = c0;
+    for (; j + 1 < c1; j += 2) {
+      double *d0 = dst + j * rows + i;
+      double *d1 = d0 + rows;
+#if defined(__SSE2__)
+      __m128d a = _mm_loadu_pd(s0 + j);
+      __m128d b = _mm_loadu_pd(s1 + j);
+      _mm_storeu_pd(d0, _mm_unpacklo_pd(a, b));
+      _mm_storeu_pd(d1, _mm_unpackhi_pd(a, b));
+#else
+      d0[0] = s0[j];
+      d0[1] = s1[j];
+      d1[0] = s0[j + 1];
+      d1[1] = s1[j + 1];
+#endif
+    }
+    if (j < c1) {
+      dst[j * rows + i] = s0[j];
+      dst[j * rows + i + 1] = s1[j];
+    }
+  }
+  if (i < r1) {
+    for (long j = c0; j < c1; j++) dst[j * rows + i] = src[i * cols + j];
+  }
+}
+
+static void *transpose_worker(void *arg) {
+  TransposeJob *t = (TransposeJob *)arg;
+  for (long ib = t->r0; ib < t->r1; ib += TRANSPOSE_BLOCK) {
+    long ie = ib + TRANSPOSE_BLOCK < t->r1 ? ib + TRANSPOSE_BLOCK : t->r1;
+    for (long jb = t->c0; jb < t->c1; jb += TRANSPOSE_BLOCK) {
+      long je = jb + TRANSPOSE_BLOCK < t->c1 ? jb + TRANSPOSE_BLOCK : t->c1;
+      transpose_tile(t->src, t->dst, t->rows, t->cols, ib, ie, jb, je);
+    }
+  }
+  return NULL;
+}
+
+static void transpose_f64(const double *src, double *dst, long rows,
+                          long cols) {
+  long size = rows * cols;
+  if (size == 0) return;
+  // A row or column vector has the same memory layout as its transpose.
+  if (rows == 1 || cols == 1) {
+    memcpy(dst, src, size * sizeof(double));
+    return;
+  }
+
+  TransposeJob base = {src, dst, rows, cols, 0, rows, 0, cols};
+  // Bands run along the longer side, in whole tiles.
+  int split_rows = rows >= cols;
+  long tiles = ((split_rows ? rows : cols) + TRANSPOSE_BLOCK - 1) /
+               TRANSPOSE_BLOCK;
+  long nthreads = 1;
+  if (size >= TRANSPOSE_PARALLEL_MIN) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = ncpu < 1 ? 1 : ncpu;
+    if (nthreads > TRANSPOSE_MAX_THREADS) nthreads = TRANSPOSE_MAX_THREADS;
+    if (nthreads > tiles) nthreads = tiles;
+  }
+  if (nthreads == 1) {
+    transpose_worker(&base);
+    return;
+  }
+
+  TransposeJob jobs[TRANSPOSE_MAX_THREADS];
+  pthread_t threads[TRANSPOSE_MAX_THREADS];
+  int started[TRANSPOSE_MAX_THREADS] = {0};
+  long extent = split_rows ? rows : cols;
+  for (long t = 0; t < nthreads; t++) {
+    long lo = tiles * t / nthreads * TRANSPOSE_BLOCK;
+    long hi = tiles * (t + 1) / nthreads * TRANSPOSE_BLOCK;
+    if (hi > extent) hi = extent;
+    jobs[t] = base;
+    if (split_rows) {
+      jobs[t].r0 = lo;
+      jobs[t].r1 = hi;
+    } else {
+      jobs[t].c0 = lo;
+      jobs[t].c1 = hi;
+    }
+  }
+  for (long t = 1; t < nthreads; t++) {
+    started[t] =
+        pthread_create(&threads[t], NULL, transpose_worker, &jobs[t]) == 0;
+    if (!started[t]) transpose_worker(&jobs[t]);
+  }
+  transpose_worker(&jobs[0]);
+  for (long t = 1; t < nthreads; t++) {
+    if (started[t]) pthread_join(threads[t], NULL);
+  }
+}
+
 // Helper: Convert Matrix to column-major format for LAPACK
 void matrix_to_colmajor(Matrix *m, double *output) {
-  for (long j = 0; j < m->cols; j++) {
-    for (long i = 0; i < m->rows; i++) {
-      output[j * m->rows + i] = m->data[i * m->cols + j];
+  transpose_f64(m->data, output, m->rows, m->cols);
+}
+
+// Per-thread LAPACK scratch (v1.9). Each slot is a grow-only buffer kept
+// for the life of the thread, so repeated decompositions of similar sizes
+// reuse the same input copy / work / pivot storage instead of hitting
+// malloc and free on every call. A wrapper may hold every slot at once.
+enum {
+  LAPACK_A,      // working copy of the input (destroyed by LAPACK)
+  LAPACK_B,      // second n x n buffer (eigenvectors, RHS)
+  LAPACK_AUX,    // short vectors: tau, eigenvalue parts
+  LAPACK_WORK,   // lwork-sized workspace
+  LAPACK_IWORK,  // integer pivots / iwork (stored in double units)
+  LAPACK_SLOTS
+};
+
+static __thread double *lapack_slot_buf[LAPACK_SLOTS];
+static __thread long lapack_slot_cap[LAPACK_SLOTS];
+
+static double *lapack_scratch(int slot, long count) {
+  if (count < 1) count = 1;
+  if (count > lapack_slot_cap[slot]) {
+    free(lapack_slot_buf[slot]);
+    lapack_slot_buf[slot] = (double *)malloc(count * sizeof(double));
+    lapack_slot_cap[slot] = count;
+  }
+  return lapack_slot_buf[slot];
+}
+
+static int *lapack_iscratch(long count) {
+  return (int *)lapack_scratch(LAPACK_IWORK, (count + 1) / 2);
+}
+
+// Workspace for an lwork = -1 query result.
+static double *lapack_work(double query, int *lwork) {
+  *lwork = (int)query > 0 ? (int)query : 1;
+  return lapack_scratch(LAPACK_WORK, *lwork);
+}
+
+// Exact symmetry test (v1.9): covariance / Gram matrices built by the
+// runtime are bitwise symmetric, so no tolerance is needed.
+static int matrix_is_symmetric(Matrix *A) {
+  long n = A->rows;
+  if (n != A->cols) return 0;
+  for (long i = 0; i < n; i++) {
+    for (long j = 0; j < i; j++) {
+      if (A->data[i * n + j] != A->data[j * n + i]) return 0;
     }
   }
+  return 1;
+}
+
+// Symmetric eigensolver core (v1.9). A symmetric row-major buffer is its own
+// column-major image, so LAPACK gets a straight copy. k <= 0 (or k >= n)
+// computes the full spectrum with divide-and-conquer dsyevd; otherwise only
+// the k largest eigenpairs are found with dsyevr (range 'I'), which skips
+// the work for the rest of the spectrum. Only the lower triangle is read.
+//
+// On return *w holds the eigenvalues in ascending order and, when vectors
+// are requested, *z the matching eigenvectors as the columns of a
+// column-major n x m array. Both point into the LAPACK scratch slots.
+// Returns m, the number of eigenpairs.
+static long lapack_syev(Matrix *A, long k, int vectors, double **w,
+                        double **z, const char *who) {
+  extern void dsyevd_(char *jobz, char *uplo, int *n, double *a, int *lda,
+                      double *w, double *work, int *lwork, int *iwork,
+                      int *liwork, int *info);
+  extern void dsyevr_(char *jobz, char *range, char *uplo, int *n, double *a,
+                      int *lda, double *vl, double *vu, int *il, int *iu,
+                      double *abstol, int *m, double *w, double *z, int *ldz,
+                      int *isuppz, double *work, int *lwork, int *iwork,
+                      int *liwork, int *info);
+
+  long n = A->rows;
+  if (n != A->cols || n == 0) {
+    fprintf(stderr, "Error: %s() requires a non-empty square matrix\n", who);
+    exit(1);
+  }
+  if (k <= 0 || k > n) k = n;
+
+  double *a = lapack_scratch(LAPACK_A, n * n);
+  memcpy(a, A->data, n * n * sizeof(double));
+  // w needs room for n values even when fewer are returned; dsyevr's
+  // 2k isuppz ints ride behind it in the same slot.
+  *w = lapack_scratch(LAPACK_AUX, n + k);
+
+  char jobz = vectors ? 'V' : 'N';
+  char uplo = 'L';
+  int n_int = (int)n, info, lwork = -1, liwork = -1, iwq, m_int = n_int;
+  double wq;
+
+  if (k == n) {
+    dsyevd_(&jobz, &uplo, &n_int, a, &n_int, *w, &wq, &lwork, &iwq, &liwork,
+            &info);
+    double *work = lapack_work(wq, &lwork);
+    liwork = iwq > 0 ? iwq : 1;
+    int *iwork = lapack_iscratch(liwork);
+    dsyevd_(&jobz, &uplo, &n_int, a, &n_int, *w, work, &lwork, iwork,
+            &liwork, &info);
+    if (z) *z = a;  // dsyevd overwrites A with the eigenvectors
+  } else {
+    char range = 'I';
+    int il = n_int - (int)k + 1, iu = n_int;
+    double vl = 0.0, vu = 0.0, abstol = 0.0;
+    double *zbuf = vectors ? lapack_scratch(LAPACK_B, n * k) : NULL;
+    int *isuppz = (int *)(*w + n);
+    dsyevr_(&jobz, &range, &uplo, &n_int, a, &n_int, &vl, &vu, &il, &iu,
+            &abstol, &m_int, *w, zbuf, &n_int, isuppz, &wq, &lwork, &iwq,
+            &liwork, &info);
+    double *work = lapack_work(wq, &lwork);
+    liwork = iwq > 0 ? iwq : 1;
+    int *iwork = lapack_iscratch(liwork);
+    dsyevr_(&jobz, &range, &uplo, &n_int, a, &n_int, &vl, &vu, &il, &iu,
+            &abstol, &m_int, *w, zbuf, &n_int, isuppz, work, &lwork, iwork,
+            &liwork, &info);
+    if (z) *z = zbuf;
+  }
+
+  if (info != 0) {
+    fprintf(stderr, "Error: %s() failed to converge (LAPACK info=%d)\n", who,
+            info);
+    exit(1);
+  }
+  return m_int;
 }
 
 // LAPACK eigenvalue computation wrapper
@@ -1065,13 +1617,21 @@ ComplexMatrix *brix_eigvals(Matrix *A) {
 
   long n = A->rows;
 
-  // Convert to column-major format (LAPACK requirement)
-  double *a = (double *)malloc(n * n * sizeof(double));
-  matrix_to_colmajor(A, a);
+  // Symmetric input has a real spectrum: take the dsyevd fast path.
+  if (matrix_is_symmetric(A)) {
+    double *w;
+    lapack_syev(A, 0, 0, &w, NULL, "eigvals");
+    ComplexMatrix *result = complexmatrix_new(n, 1);
+    for (long i = 0; i < n; i++) result->data[i].real = w[i];
+    return result;
+  }
 
-  // Allocate output arrays
-  double *wr = (double *)malloc(n * sizeof(double));  // Real parts
-  double *wi = (double *)malloc(n * sizeof(double));  // Imaginary parts
+  // eig(A^T) == eig(A): factor a straight copy of the row-major buffer.
+  double *a = lapack_scratch(LAPACK_A, n * n);
+  memcpy(a, A->data, n * n * sizeof(double));
+
+  double *wr = lapack_scratch(LAPACK_AUX, 2 * n);  // Real parts
+  double *wi = wr + n;                               // Imaginary parts
 
   // Dummy arrays for eigenvectors (not computed)
   double vl_dummy = 0;
@@ -1094,9 +1654,7 @@ ComplexMatrix *brix_eigvals(Matrix *A) {
   int lwork = -1;
   dgeev_(&jobvl, &jobvr, &n_int, a, &n_int, wr, wi, &vl_dummy, &n_int,
          &vr_dummy, &n_int, &work_query, &lwork, &info);
-
-  lwork = (int)work_query;
-  double *work = (double *)malloc(lwork * sizeof(double));
+  double *work = lapack_work(work_query, &lwork);
 
   // Compute eigenvalues
   dgeev_(&jobvl, &jobvr, &n_int, a, &n_int, wr, wi, &vl_dummy, &n_int,
@@ -1114,12 +1672,6 @@ ComplexMatrix *brix_eigvals(Matrix *A) {
     result->data[i].imag = wi[i];
   }
 
-  // Cleanup
-  free(a);
-  free(wr);
-  free(wi);
-  free(work);
-
   return result;
 }
 
@@ -1133,22 +1685,36 @@ ComplexMatrix *brix_eigvecs(Matrix *A) {
 
   long n = A->rows;
 
-  // Convert to column-major format
-  double *a = (double *)malloc(n * n * sizeof(double));
-  matrix_to_colmajor(A, a);
+  // Symmetric input: real orthonormal eigenvectors from dsyevd, in the same
+  // ascending eigenvalue order eigvals() uses.
+  if (matrix_is_symmetric(A)) {
+    double *w, *z;
+    lapack_syev(A, 0, 1, &w, &z, "eigvecs");
+    ComplexMatrix *result = complexmatrix_new(n, n);
+    for (long row = 0; row < n; row++) {
+      for (long col = 0; col < n; col++) {
+        result->data[row * n + col].real = z[col * n + row];
+      }
+    }
+    return result;
+  }
 
-  // Allocate output arrays
-  double *wr = (double *)malloc(n * sizeof(double));  // Real parts of eigenvalues
-  double *wi = (double *)malloc(n * sizeof(double));  // Imaginary parts of eigenvalues
-  double *vr = (double *)malloc(n * n * sizeof(double));  // Right eigenvectors
+  // LAPACK sees A^T. A left eigenvector u of A^T (u^H A^T = λ u^H) gives
+  // A conj(u) = λ conj(u), so we ask for left vectors and conjugate them.
+  double *a = lapack_scratch(LAPACK_A, n * n);
+  memcpy(a, A->data, n * n * sizeof(double));
 
-  // Dummy for left eigenvectors
-  double vl_dummy = 0;
+  double *wr = lapack_scratch(LAPACK_AUX, 2 * n);  // Real parts of eigenvalues
+  double *wi = wr + n;                               // Imaginary parts
+  double *vl = lapack_scratch(LAPACK_B, n * n);      // Left eigenvectors of A^T
+
+  // Dummy for right eigenvectors
+  double vr_dummy = 0;
 
   // Call LAPACK dgeev
   int info;
-  char jobvl = 'N';  // Don't compute left eigenvectors
-  char jobvr = 'V';  // Compute right eigenvectors
+  char jobvl = 'V';  // Compute left eigenvectors (of A^T)
+  char jobvr = 'N';  // Don't compute right eigenvectors
   int n_int = (int)n;
 
   extern void dgeev_(char *jobvl, char *jobvr, int *n, double *a, int *lda,
@@ -1158,15 +1724,13 @@ ComplexMatrix *brix_eigvecs(Matrix *A) {
   // Query optimal work array size
   double work_query;
   int lwork = -1;
-  dgeev_(&jobvl, &jobvr, &n_int, a, &n_int, wr, wi, &vl_dummy, &n_int,
-         vr, &n_int, &work_query, &lwork, &info);
-
-  lwork = (int)work_query;
-  double *work = (double *)malloc(lwork * sizeof(double));
+  dgeev_(&jobvl, &jobvr, &n_int, a, &n_int, wr, wi, vl, &n_int,
+         &vr_dummy, &n_int, &work_query, &lwork, &info);
+  double *work = lapack_work(work_query, &lwork);
 
   // Compute eigenvectors
-  dgeev_(&jobvl, &jobvr, &n_int, a, &n_int, wr, wi, &vl_dummy, &n_int,
-         vr, &n_int, work, &lwork, &info);
+  dgeev_(&jobvl, &jobvr, &n_int, a, &n_int, wr, wi, vl, &n_int,
+         &vr_dummy, &n_int, work, &lwork, &info);
 
   if (info != 0) {
     fprintf(stderr, "Error: LAPACK dgeev failed with info=%d\n", info);
@@ -1182,33 +1746,72 @@ ComplexMatrix *brix_eigvecs(Matrix *A) {
     if (wi[col] == 0.0) {
       // Real eigenvalue - eigenvector is real
       for (long row = 0; row < n; row++) {
-        result->data[row * n + col].real = vr[col * n + row];
+        result->data[row * n + col].real = vl[col * n + row];
         result->data[row * n + col].imag = 0.0;
       }
       col++;
     } else {
       // Complex conjugate pair of eigenvalues
-      // LAPACK stores: v[col] = real part, v[col+1] = imaginary part
+      // LAPACK stores u[col] = vl[col] + i*vl[col+1] and u[col+1] = its
+      // conjugate; the eigenvectors of A are the conjugates of those.
       for (long row = 0; row < n; row++) {
-        // First eigenvector: real + i*imag
-        result->data[row * n + col].real = vr[col * n + row];
-        result->data[row * n + col].imag = vr[(col + 1) * n + row];
+        // First eigenvector: real - i*imag
+        result->data[row * n + col].real = vl[col * n + row];
+        result->data[row * n + col].imag = -vl[(col + 1) * n + row];
 
-        // Second eigenvector: real - i*imag (complex conjugate)
-        result->data[row * n + (col + 1)].real = vr[col * n + row];
-        result->data[row * n + (col + 1)].imag = -vr[(col + 1) * n + row];
+        // Second eigenvector: real + i*imag (complex conjugate)
+        result->data[row * n + (col + 1)].real = vl[col * n + row];
+        result->data[row * n + (col + 1)].imag = vl[(col + 1) * n + row];
       }
       col += 2;
     }
   }
 
-  // Cleanup
-  free(a);
-  free(wr);
-  free(wi);
-  free(vr);
-  free(work);
+  return result;
+}
+
+// ------------------------------------------------------------------
+// Symmetric eigendecomposition (v1.9): math.eigh(A) / math.eigh(A, k)
+//   w : m x 1 real eigenvalues
+//   V : n x m orthonormal eigenvectors as columns (V[:, j] pairs with w[j])
+//
+// The full spectrum (k omitted) comes back in ascending order, like
+// eigvals() on a symmetric matrix. With k, only the k largest eigenpairs
+// are computed and they are returned largest first — the order PCA wants.
+// math.eigvalsh(A[, k]) is the same without the vectors.
+// ------------------------------------------------------------------
+typedef struct {
+  Matrix *w;
+  Matrix *V;
+} EighResult;
+
+// Position of the j-th returned eigenpair within LAPACK's ascending output.
+static long eigh_src_index(long j, long m, long k) {
+  return k > 0 ? m - 1 - j : j;
+}
 
+EighResult *math_eigh(Matrix *A, long k) {
+  double *w, *z;
+  long n = A->rows;
+  long m = lapack_syev(A, k, 1, &w, &z, "eigh");
+
+  EighResult *res = (EighResult *)malloc(sizeof(EighResult));
+  res->w = matrix_new(m, 1);
+  res->V = matrix_new(n, m);
+  for (long j = 0; j < m; j++) {
+    long src = eigh_src_index(j, m, k);
+    res->w->data[j] = w[src];
+    const double *col = z + src * n;
+    for (long i = 0; i < n; i++) res->V->data[i * m + j] = col[i];
+  }
+  return res;
+}
+
+Matrix *math_eigvalsh(Matrix *A, long k) {
+  double *w;
+  long m = lapack_syev(A, k, 0, &w, NULL, "eigvalsh");
+  Matrix *result = matrix_new(m, 1);
+  for (long j = 0; j < m; j++) result->data[j] = w[eigh_src_index(j, m, k)];
   return result;
 }
 
@@ -1240,11 +1843,12 @@ LUResult *math_lu(Matrix *A) {
 
   long n = A->rows;
 
-  // Column-major copy for LAPACK (factored in place).
-  double *a = (double *)malloc(n * n * sizeof(double));
+  // Column-major copy for LAPACK (factored in place). Factoring A^T would
+  // pivot columns rather than rows, so LU keeps the transposing copy.
+  double *a = lapack_scratch(LAPACK_A, n * n);
   matrix_to_colmajor(A, a);
 
-  int *ipiv = (int *)malloc(n * sizeof(int));
+  int *ipiv = lapack_iscratch(n);
   int n_int = (int)n;
   int info;
 
@@ -1296,9 +1900,6 @@ LUResult *math_lu(Matrix *A) {
     }
   }
 
-  free(a);
-  free(ipiv);
-
   LUResult *res = (LUResult *)malloc(sizeof(LUResult));
   res->L = L;
   res->U = U;
@@ -1307,10 +1908,15 @@ LUResult *math_lu(Matrix *A) {
 }
 
 // ------------------------------------------------------------------
-// QR decomposition (v1.8 Grupo B): A = Q * R  (full, dgeqrf + dorgqr)
+// QR decomposition (v1.8 Grupo B): A = Q * R  (full, dgelqf + dorglq)
 //   Q : m x m orthogonal
 //   R : m x n upper-triangular
 // Same container convention as LUResult (a plain struct of Matrix pointers).
+//
+// LAPACK factors the row-major buffer, i.e. A^T (n x m), as A^T = L * Q0 —
+// which is A = Q0^T * L^T, a QR of A. Read back row-major, the factored
+// buffer holds R in its upper triangle and dorglq's output is Q itself, so
+// both results are written in place with no transposes.
 // ------------------------------------------------------------------
 typedef struct {
   Matrix *Q;
@@ -1329,67 +1935,52 @@ QRResult *math_qr(Matrix *A) {
   int m_int = (int)m, n_int = (int)n, k_int = (int)k;
   int info;
 
-  extern void dgeqrf_(int *m, int *n, double *a, int *lda, double *tau,
+  extern void dgelqf_(int *m, int *n, double *a, int *lda, double *tau,
                       double *work, int *lwork, int *info);
-  extern void dorgqr_(int *m, int *n, int *k, double *a, int *lda, double *tau,
+  extern void dorglq_(int *m, int *n, int *k, double *a, int *lda, double *tau,
                       double *work, int *lwork, int *info);
 
-  // Column-major copy of A (m x n).
-  double *a = (double *)malloc(m * n * sizeof(double));
-  matrix_to_colmajor(A, a);
-  double *tau = (double *)malloc((k > 0 ? k : 1) * sizeof(double));
+  // Factorize A^T (n x m, lda = n) in R's own storage: L^T = R lands in the
+  // upper triangle, the reflectors below it.
+  Matrix *R = matrix_new(m, n);
+  memcpy(R->data, A->data, m * n * sizeof(double));
+  double *tau = lapack_scratch(LAPACK_AUX, k);
 
-  // Factorize: R + reflectors stored in `a`.
   double wq;
   int lwork = -1;
-  dgeqrf_(&m_int, &n_int, a, &m_int, tau, &wq, &lwork, &info);
-  lwork = (int)wq;
-  double *work = (double *)malloc((lwork > 0 ? lwork : 1) * sizeof(double));
-  dgeqrf_(&m_int, &n_int, a, &m_int, tau, work, &lwork, &info);
+  dgelqf_(&n_int, &m_int, R->data, &n_int, tau, &wq, &lwork, &info);
+  double *work = lapack_work(wq, &lwork);
+  dgelqf_(&n_int, &m_int, R->data, &n_int, tau, work, &lwork, &info);
   if (info < 0) {
-    fprintf(stderr, "Error: LAPACK dgeqrf illegal argument (info=%d)\n", info);
+    fprintf(stderr, "Error: LAPACK dgelqf illegal argument (info=%d)\n", info);
     exit(1);
   }
 
-  // R (m x n, upper-triangular) — extract before dorgqr overwrites `a`.
-  Matrix *R = matrix_new(m, n);
+  // Full Q (m x m): dorglq wants reflector j as row j of an m x m
+  // column-major array. Row j of A^T is column j of the row-major buffer,
+  // so the first k columns of R are copied into the first k columns of Q.
+  Matrix *Q = matrix_new(m, m);
   for (long i = 0; i < m; i++) {
-    for (long j = 0; j < n; j++) {
-      R->data[i * n + j] = (i <= j) ? a[j * m + i] : 0.0;
+    for (long j = 0; j < k; j++) {
+      Q->data[i * m + j] = R->data[i * n + j];
     }
   }
-
-  // Full Q (m x m): copy the k reflector columns into an m x m buffer and let
-  // dorgqr build the m orthonormal columns.
-  double *q = (double *)malloc(m * m * sizeof(double));
-  for (long j = 0; j < m; j++) {
-    for (long i = 0; i < m; i++) {
-      q[j * m + i] = (j < n) ? a[j * m + i] : 0.0;
+  for (long i = 1; i < m; i++) {
+    long end = (i < n) ? i : n;
+    for (long j = 0; j < end; j++) {
+      R->data[i * n + j] = 0.0; // clear the reflectors below the diagonal
     }
   }
-  free(work);
+
   lwork = -1;
-  dorgqr_(&m_int, &m_int, &k_int, q, &m_int, tau, &wq, &lwork, &info);
-  lwork = (int)wq;
-  work = (double *)malloc((lwork > 0 ? lwork : 1) * sizeof(double));
-  dorgqr_(&m_int, &m_int, &k_int, q, &m_int, tau, work, &lwork, &info);
+  dorglq_(&m_int, &m_int, &k_int, Q->data, &m_int, tau, &wq, &lwork, &info);
+  work = lapack_work(wq, &lwork);
+  dorglq_(&m_int, &m_int, &k_int, Q->data, &m_int, tau, work, &lwork, &info);
   if (info < 0) {
-    fprintf(stderr, "Error: LAPACK dorgqr illegal argument (info=%d)\n", info);
+    fprintf(stderr, "Error: LAPACK dorglq illegal argument (info=%d)\n", info);
     exit(1);
   }
 
-  Matrix *Q = matrix_new(m, m);
-  for (long i = 0; i < m; i++) {
-    for (long j = 0; j < m; j++) {
-      Q->data[i * m + j] = q[j * m + i];
-    }
-  }
-
-  free(a);
-  free(tau);
-  free(work);
-  free(q);
-
   QRResult *res = (QRResult *)malloc(sizeof(QRResult));
   res->Q = Q;
   res->R = R;
@@ -1401,6 +1992,10 @@ QRResult *math_qr(Matrix *A) {
 //   U  : m x m orthogonal
 //   S  : min(m,n) x 1 column vector of singular values (descending)
 //   Vt : n x n orthogonal (V transposed)
+//
+// dgesdd runs on A^T = U' S V'^T, so A = V' S U'^T: its column-major V'^T
+// output is U in row-major order and U' is Vt. LAPACK writes both straight
+// into the result matrices.
 // ------------------------------------------------------------------
 typedef struct {
   Matrix *U;
@@ -1423,22 +2018,21 @@ SVDResult *math_svd(Matrix *A) {
                       double *s, double *u, int *ldu, double *vt, int *ldvt,
                       double *work, int *lwork, int *iwork, int *info);
 
-  double *a = (double *)malloc(m * n * sizeof(double));
-  matrix_to_colmajor(A, a);
-  double *s = (double *)malloc((k > 0 ? k : 1) * sizeof(double));
-  double *u = (double *)malloc(m * m * sizeof(double));
-  double *vt = (double *)malloc(n * n * sizeof(double));
-  int *iwork = (int *)malloc(8 * (k > 0 ? k : 1) * sizeof(int));
+  double *a = lapack_scratch(LAPACK_A, m * n);
+  memcpy(a, A->data, m * n * sizeof(double));
+  Matrix *U = matrix_new(m, m);
+  Matrix *S = matrix_new(k, 1);
+  Matrix *Vt = matrix_new(n, n);
+  int *iwork = lapack_iscratch(8 * k);
   char jobz = 'A'; // full U (m x m) and Vt (n x n)
 
   double wq;
   int lwork = -1;
-  dgesdd_(&jobz, &m_int, &n_int, a, &m_int, s, u, &m_int, vt, &n_int, &wq,
-          &lwork, iwork, &info);
-  lwork = (int)wq;
-  double *work = (double *)malloc((lwork > 0 ? lwork : 1) * sizeof(double));
-  dgesdd_(&jobz, &m_int, &n_int, a, &m_int, s, u, &m_int, vt, &n_int, work,
-          &lwork, iwork, &info);
+  dgesdd_(&jobz, &n_int, &m_int, a, &n_int, S->data, Vt->data, &n_int,
+          U->data, &m_int, &wq, &lwork, iwork, &info);
+  double *work = lapack_work(wq, &lwork);
+  dgesdd_(&jobz, &n_int, &m_int, a, &n_int, S->data, Vt->data, &n_int,
+          U->data, &m_int, work, &lwork, iwork, &info);
   // info < 0: illegal argument; info > 0: DBDSDC did not converge. Both are
   // genuine failures for SVD (unlike LU, there is no useful partial result).
   if (info != 0) {
@@ -1446,30 +2040,6 @@ SVDResult *math_svd(Matrix *A) {
     exit(1);
   }
 
-  Matrix *U = matrix_new(m, m);
-  for (long i = 0; i < m; i++) {
-    for (long j = 0; j < m; j++) {
-      U->data[i * m + j] = u[j * m + i];
-    }
-  }
-  Matrix *S = matrix_new(k, 1);
-  for (long i = 0; i < k; i++) {
-    S->data[i] = s[i];
-  }
-  Matrix *Vt = matrix_new(n, n);
-  for (long i = 0; i < n; i++) {
-    for (long j = 0; j < n; j++) {
-      Vt->data[i * n + j] = vt[j * n + i];
-    }
-  }
-
-  free(a);
-  free(s);
-  free(u);
-  free(vt);
-  free(iwork);
-  free(work);
-
   SVDResult *res = (SVDResult *)malloc(sizeof(SVDResult));
   res->U = U;
   res->S = S;
@@ -1479,8 +2049,10 @@ SVDResult *math_svd(Matrix *A) {
 
 // ------------------------------------------------------------------
 // Cholesky (v1.8 Grupo B): A = L * L^T for symmetric positive-definite A.
-// dpotrf('L'); the upper triangle of the working copy keeps the original
-// input, so we zero it explicitly when extracting the lower-triangular L.
+// A symmetric A reads the same in either layout, so dpotrf('U') factors a
+// straight copy held in L itself: the column-major upper factor U = L^T is,
+// read row-major, L in the lower triangle. The strict upper triangle keeps
+// the original input, so it is zeroed explicitly.
 // ------------------------------------------------------------------
 Matrix *math_cholesky(Matrix *A) {
   if (A->rows <= 0 || A->cols <= 0) {
@@ -1492,13 +2064,13 @@ Matrix *math_cholesky(Matrix *A) {
     exit(1);
   }
   long n = A->rows;
-  double *a = (double *)malloc(n * n * sizeof(double));
-  matrix_to_colmajor(A, a);
+  Matrix *L = matrix_new(n, n);
+  memcpy(L->data, A->data, n * n * sizeof(double));
 
-  char uplo = 'L';
+  char uplo = 'U';
   int n_int = (int)n, info;
   extern void dpotrf_(char *uplo, int *n, double *a, int *lda, int *info);
-  dpotrf_(&uplo, &n_int, a, &n_int, &info);
+  dpotrf_(&uplo, &n_int, L->data, &n_int, &info);
   if (info != 0) {
     fprintf(stderr,
             "Error: cholesky() failed (matrix not positive definite or "
@@ -1507,24 +2079,24 @@ Matrix *math_cholesky(Matrix *A) {
     exit(1);
   }
 
-  // Lower-triangular L in the lower triangle of column-major `a`; zero the
-  // strict upper triangle (dpotrf leaves the original values there).
-  Matrix *L = matrix_new(n, n);
   for (long i = 0; i < n; i++) {
-    for (long j = 0; j < n; j++) {
-      L->data[i * n + j] = (i >= j) ? a[j * n + i] : 0.0;
+    for (long j = i + 1; j < n; j++) {
+      L->data[i * n + j] = 0.0;
     }
   }
-  free(a);
   return L;
 }
 
 // ------------------------------------------------------------------
-// Solve (v1.8 Grupo B): x such that A*x = b, via LAPACK dgesv (LU + solve).
+// Solve (v1.8 Grupo B): x such that A*x = b, via LAPACK dgetrf + dgetrs.
 // A is n x n. b may be an n x nrhs matrix, or a length-n vector in either
 // orientation (Brix 1-D literals are 1 x n); x is returned in b's shape.
-// A singular A makes dgesv report info > 0 — solve rejects it (fatal), unlike
-// math.lu which returns the factors regardless.
+// A singular A makes dgetrf report info > 0 — solve rejects it (fatal),
+// unlike math.lu which returns the factors regardless.
+//
+// The row-major A is factored as A^T and dgetrs('T') solves with its
+// transpose, so A itself is never transposed. A vector RHS is contiguous in
+// either layout and is solved in the result's own storage.
 // ------------------------------------------------------------------
 Matrix *math_solve(Matrix *A, Matrix *b) {
   if (A->rows <= 0 || A->cols <= 0) {
@@ -1538,32 +2110,24 @@ Matrix *math_solve(Matrix *A, Matrix *b) {
   long n = A->rows;
 
   long nrhs;
-  int b_is_row = 0;
   if (b->rows == n) {
     nrhs = b->cols; // n x nrhs (includes n x 1 column vector)
   } else if (b->rows == 1 && b->cols == n) {
-    nrhs = 1;
-    b_is_row = 1; // 1 x n row vector → single RHS
+    nrhs = 1; // 1 x n row vector → single RHS
   } else {
     fprintf(stderr, "Error: solve() RHS dimension mismatch\n");
     exit(1);
   }
 
-  double *a = (double *)malloc(n * n * sizeof(double));
-  matrix_to_colmajor(A, a);
-  double *bmat = (double *)malloc(n * nrhs * sizeof(double));
-  if (b_is_row) {
-    for (long i = 0; i < n; i++)
-      bmat[i] = b->data[i]; // 1 x n → n x 1 (contiguous)
-  } else {
-    matrix_to_colmajor(b, bmat);
-  }
-
-  int *ipiv = (int *)malloc(n * sizeof(int));
+  double *a = lapack_scratch(LAPACK_A, n * n);
+  memcpy(a, A->data, n * n * sizeof(double));
+  int *ipiv = lapack_iscratch(n);
   int n_int = (int)n, nrhs_int = (int)nrhs, info;
-  extern void dgesv_(int *n, int *nrhs, double *a, int *lda, int *ipiv,
-                     double *b, int *ldb, int *info);
-  dgesv_(&n_int, &nrhs_int, a, &n_int, ipiv, bmat, &n_int, &info);
+  extern void dgetrf_(int *m, int *n, double *a, int *lda, int *ipiv,
+                      int *info);
+  extern void dgetrs_(char *trans, int *n, int *nrhs, double *a, int *lda,
+                      int *ipiv, double *b, int *ldb, int *info);
+  dgetrf_(&n_int, &n_int, a, &n_int, ipiv, &info);
   if (info != 0) {
     fprintf(stderr,
             "Error: solve() failed (singular matrix or illegal argument, "
@@ -1572,36 +2136,542 @@ Matrix *math_solve(Matrix *A, Matrix *b) {
     exit(1);
   }
 
-  Matrix *x;
-  if (b_is_row) {
-    x = matrix_new(1, n);
-    for (long i = 0; i < n; i++)
-      x->data[i] = bmat[i]; // n x 1 → 1 x n
+  Matrix *x = matrix_new(b->rows, b->cols);
+  double *bmat = x->data;
+  if (nrhs == 1) {
+    memcpy(bmat, b->data, n * sizeof(double));
   } else {
-    x = matrix_new(n, nrhs);
+    bmat = lapack_scratch(LAPACK_B, n * nrhs);
+    matrix_to_colmajor(b, bmat);
+  }
+
+  char trans = 'T';
+  dgetrs_(&trans, &n_int, &nrhs_int, a, &n_int, ipiv, bmat, &n_int, &info);
+  if (info != 0) {
+    fprintf(stderr, "Error: LAPACK dgetrs illegal argument (info=%d)\n", info);
+    exit(1);
+  }
+
+  if (nrhs > 1) {
     for (long i = 0; i < n; i++)
       for (long j = 0; j < nrhs; j++)
         x->data[i * nrhs + j] = bmat[j * n + i];
   }
+  return x;
+}
 
-  free(a);
-  free(bmat);
-  free(ipiv);
+// ------------------------------------------------------------------
+// Factorization objects (v1.9): factor once, solve many.
+//   math.lu_factor(A)       — dgetrf, square A
+//   math.cholesky_factor(A) — dpotrf, symmetric positive-definite A
+//   math.qr_factor(A)       — dgelqf, m x n with m >= n; solve() is the
+//                             least-squares solution for tall A
+// Methods: solve(b) (dgetrs / dpotrs / dormlq + dtrtrs), det(), inv().
+// As in the wrappers above, LAPACK factors the row-major buffer read as
+// A^T and every method uses the matching transposed call, so A is copied
+// once at factor time and never transposed.
+// ------------------------------------------------------------------
+enum { FACTOR_LU, FACTOR_CHOLESKY, FACTOR_QR };
+
+typedef struct {
+  long ref_count;  // ARC reference counting
+  long rows;
+  long cols;
+  long kind;       // FACTOR_LU / FACTOR_CHOLESKY / FACTOR_QR
+  double *a;       // LAPACK factors, rows * cols
+  int *ipiv;       // LU pivots
+  double *tau;     // QR reflector scales
+  long singular;   // LU: 1-based index of the first zero pivot, 0 if none
+} Factorization;
+
+static const char *factorization_name(Factorization *f) {
+  switch (f->kind) {
+    case FACTOR_LU: return "LUFactor";
+    case FACTOR_CHOLESKY: return "CholeskyFactor";
+    default: return "QRFactor";
+  }
+}
+
+void *factorization_retain(Factorization *f) {
+  if (!f) return NULL;
+  f->ref_count++;
+  return f;
+}
+
+void factorization_release(Factorization *f) {
+  if (!f) return;
+  f->ref_count--;
+  if (f->ref_count == 0) {
+    free(f->a);
+    free(f->ipiv);
+    free(f->tau);
+    free(f);
+  }
+}
+
+static Factorization *factorization_new(Matrix *A, long kind) {
+  Factorization *f = (Factorization *)calloc(1, sizeof(Factorization));
+  f->ref_count = 1;
+  f->rows = A->rows;
+  f->cols = A->cols;
+  f->kind = kind;
+  f->a = (double *)malloc(A->rows * A->cols * sizeof(double));
+  memcpy(f->a, A->data, A->rows * A->cols * sizeof(double));
+  return f;
+}
+
+static void factorization_check_square(Matrix *A, const char *who) {
+  if (A->rows <= 0 || A->cols <= 0) {
+    fprintf(stderr, "Error: %s() requires a non-empty matrix\n", who);
+    exit(1);
+  }
+  if (A->rows != A->cols) {
+    fprintf(stderr, "Error: %s() requires a square matrix\n", who);
+    exit(1);
+  }
+}
+
+Factorization *math_lu_factor(Matrix *A) {
+  factorization_check_square(A, "lu_factor");
+  Factorization *f = factorization_new(A, FACTOR_LU);
+  int n_int = (int)A->rows, info;
+  f->ipiv = (int *)malloc(A->rows * sizeof(int));
+
+  extern void dgetrf_(int *m, int *n, double *a, int *lda, int *ipiv,
+                      int *info);
+  dgetrf_(&n_int, &n_int, f->a, &n_int, f->ipiv, &info);
+  if (info < 0) {
+    fprintf(stderr, "Error: LAPACK dgetrf illegal argument (info=%d)\n", info);
+    exit(1);
+  }
+  // A singular A still factors (det() is 0); solve()/inv() reject it.
+  f->singular = info;
+  return f;
+}
+
+Factorization *math_cholesky_factor(Matrix *A) {
+  factorization_check_square(A, "cholesky_factor");
+  Factorization *f = factorization_new(A, FACTOR_CHOLESKY);
+  char uplo = 'U';
+  int n_int = (int)A->rows, info;
+
+  extern void dpotrf_(char *uplo, int *n, double *a, int *lda, int *info);
+  dpotrf_(&uplo, &n_int, f->a, &n_int, &info);
+  if (info != 0) {
+    fprintf(stderr,
+            "Error: cholesky_factor() failed (matrix not positive definite "
+            "or illegal argument, info=%d)\n",
+            info);
+    exit(1);
+  }
+  return f;
+}
+
+Factorization *math_qr_factor(Matrix *A) {
+  long m = A->rows, n = A->cols;
+  if (m <= 0 || n <= 0) {
+    fprintf(stderr, "Error: qr_factor() requires a non-empty matrix\n");
+    exit(1);
+  }
+  if (m < n) {
+    fprintf(stderr,
+            "Error: qr_factor() requires rows >= cols (got %ldx%ld)\n", m, n);
+    exit(1);
+  }
+  Factorization *f = factorization_new(A, FACTOR_QR);
+  f->tau = (double *)malloc(n * sizeof(double));
+  int m_int = (int)m, n_int = (int)n, info;
+
+  extern void dgelqf_(int *m, int *n, double *a, int *lda, double *tau,
+                      double *work, int *lwork, int *info);
+  double wq;
+  int lwork = -1;
+  dgelqf_(&n_int, &m_int, f->a, &n_int, f->tau, &wq, &lwork, &info);
+  double *work = lapack_work(wq, &lwork);
+  dgelqf_(&n_int, &m_int, f->a, &n_int, f->tau, work, &lwork, &info);
+  if (info < 0) {
+    fprintf(stderr, "Error: LAPACK dgelqf illegal argument (info=%d)\n", info);
+    exit(1);
+  }
+  return f;
+}
+
+// x such that A*x = b (least squares for a tall QR). b is rows x nrhs or a
+// length-rows vector in either orientation; x comes back in b's
+// orientation with cols rows.
+Matrix *factorization_solve(Factorization *f, Matrix *b) {
+  long m = f->rows, n = f->cols;
+  long nrhs;
+  int b_is_row = 0;
+  if (b->rows == m) {
+    nrhs = b->cols;
+  } else if (b->rows == 1 && b->cols == m) {
+    nrhs = 1;
+    b_is_row = 1;
+  } else {
+    fprintf(stderr,
+            "Error: %s.solve() RHS dimension mismatch (expected %ld rows, "
+            "got %ldx%ld)\n",
+            factorization_name(f), m, b->rows, b->cols);
+    exit(1);
+  }
+  if (f->kind == FACTOR_LU && f->singular) {
+    fprintf(stderr, "Error: LUFactor.solve() on a singular matrix\n");
+    exit(1);
+  }
+
+  // Column-major m x nrhs right-hand side; a single vector is contiguous.
+  double *c = lapack_scratch(LAPACK_B, m * nrhs);
+  if (nrhs == 1) {
+    memcpy(c, b->data, m * sizeof(double));
+  } else {
+    matrix_to_colmajor(b, c);
+  }
+
+  int m_int = (int)m, n_int = (int)n, nrhs_int = (int)nrhs, info = 0;
+  if (f->kind == FACTOR_LU) {
+    extern void dgetrs_(char *trans, int *n, int *nrhs, double *a, int *lda,
+                        int *ipiv, double *b, int *ldb, int *info);
+    char trans = 'T';
+    dgetrs_(&trans, &n_int, &nrhs_int, f->a, &n_int, f->ipiv, c, &m_int,
+            &info);
+  } else if (f->kind == FACTOR_CHOLESKY) {
+    extern void dpotrs_(char *uplo, int *n, int *nrhs, double *a, int *lda,
+                        double *b, int *ldb, int *info);
+    char uplo = 'U';
+    dpotrs_(&uplo, &n_int, &nrhs_int, f->a, &n_int, c, &m_int, &info);
+  } else {
+    // A^T = L * Q0, so A = Q0^T * L^T: apply Q0, then solve L^T x = (Q0 b).
+    extern void dormlq_(char *side, char *trans, int *m, int *n, int *k,
+                        double *a, int *lda, double *tau, double *c, int *ldc,
+                        double *work, int *lwork, int *info);
+    extern void dtrtrs_(char *uplo, char *trans, char *diag, int *n,
+                        int *nrhs, double *a, int *lda, double *b, int *ldb,
+                        int *info);
+    char side = 'L', notrans = 'N', uplo = 'L', trans = 'T', diag = 'N';
+    double wq;
+    int lwork = -1;
+    dormlq_(&side, &notrans, &m_int, &nrhs_int, &n_int, f->a, &n_int, f->tau,
+            c, &m_int, &wq, &lwork, &info);
+    double *work = lapack_work(wq, &lwork);
+    dormlq_(&side, &notrans, &m_int, &nrhs_int, &n_int, f->a, &n_int, f->tau,
+            c, &m_int, work, &lwork, &info);
+    if (info == 0) {
+      dtrtrs_(&uplo, &trans, &diag, &n_int, &nrhs_int, f->a, &n_int, c, &m_int,
+              &info);
+    }
+    if (info > 0) {
+      fprintf(stderr, "Error: QRFactor.solve() on a rank-deficient matrix\n");
+      exit(1);
+    }
+  }
+  if (info != 0) {
+    fprintf(stderr, "Error: %s.solve() failed (info=%d)\n",
+            factorization_name(f), info);
+    exit(1);
+  }
+
+  Matrix *x = b_is_row ? matrix_new(1, n) : matrix_new(n, nrhs);
+  if (nrhs == 1) {
+    memcpy(x->data, c, n * sizeof(double));
+  } else {
+    for (long i = 0; i < n; i++)
+      for (long j = 0; j < nrhs; j++)
+        x->data[i * nrhs + j] = c[j * m + i];
+  }
+  return x;
+}
+
+double factorization_det(Factorization *f) {
+  long n = f->cols;
+  if (f->rows != n) {
+    fprintf(stderr, "Error: QRFactor.det() requires a square matrix\n");
+    exit(1);
+  }
+  // The triangular factor's diagonal sits on the diagonal of `a` for all
+  // three kinds; only the sign bookkeeping differs.
+  double det = 1.0;
+  for (long i = 0; i < n; i++) det *= f->a[i * n + i];
+  if (f->kind == FACTOR_CHOLESKY) return det * det;
+  for (long i = 0; i < n; i++) {
+    int flips = (f->kind == FACTOR_LU) ? (f->ipiv[i] != i + 1)
+                                       : (f->tau[i] != 0.0);  // det(H) = -1
+    if (flips) det = -det;
+  }
+  return det;
+}
+
+Matrix *factorization_inv(Factorization *f) {
+  long n = f->cols;
+  if (f->rows != n) {
+    fprintf(stderr, "Error: QRFactor.inv() requires a square matrix\n");
+    exit(1);
+  }
+  if (f->kind == FACTOR_QR) {
+    Matrix *eye = matrix_new(n, n);
+    memset(eye->data, 0, n * n * sizeof(double));
+    for (long i = 0; i < n; i++) eye->data[i * n + i] = 1.0;
+    Matrix *x = factorization_solve(f, eye);
+    matrix_release(eye);
+    return x;
+  }
+
+  // dgetri/dpotri invert the factored A^T in place; (A^T)^-1 read
+  // row-major is A^-1.
+  Matrix *x = matrix_new(n, n);
+  memcpy(x->data, f->a, n * n * sizeof(double));
+  int n_int = (int)n, info;
+  if (f->kind == FACTOR_LU) {
+    if (f->singular) {
+      fprintf(stderr, "Error: LUFactor.inv() on a singular matrix\n");
+      exit(1);
+    }
+    extern void dgetri_(int *n, double *a, int *lda, int *ipiv, double *work,
+                        int *lwork, int *info);
+    double wq;
+    int lwork = -1;
+    dgetri_(&n_int, x->data, &n_int, f->ipiv, &wq, &lwork, &info);
+    double *work = lapack_work(wq, &lwork);
+    dgetri_(&n_int, x->data, &n_int, f->ipiv, work, &lwork, &info);
+  } else {
+    extern void dpotri_(char *uplo, int *n, double *a, int *lda, int *info);
+    char uplo = 'U';
+    dpotri_(&uplo, &n_int, x->data, &n_int, &info);
+    // dpotri fills one triangle (the lower one, read row-major); mirror it.
+    for (long i = 0; i < n; i++)
+      for (long j = i + 1; j < n; j++)
+        x->data[i * n + j] = x->data[j * n + i];
+  }
+  if (info != 0) {
+    fprintf(stderr, "Error: %s.inv() failed (info=%d)\n",
+            factorization_name(f), info);
+    exit(1);
+  }
   return x;
 }
 
+// ------------------------------------------------------------------
+// Least squares (v1.9): math.lstsq(A, b) -> (x, residuals, rank)
+//   x         : n x k minimum-norm solution of min ||A x - b||
+//               (1 x n when b is a 1D vector, like solve())
+//   residuals : 1 x k sum of squared residuals, one per column of b
+//   rank      : effective rank of A
+//
+// LAPACK dgelsd (SVD by divide and conquer) covers over- and
+// underdetermined systems and rank-deficient A alike. Singular values
+// below eps * max(m, n) * s_max count as zero, as in NumPy.
+//
+// math.linreg(X, Y) -> (coef, intercept, r2) fits Y = X * coef + intercept
+// for every column of Y at once: X is m x p (rows are observations), Y is
+// m x k or a 1D vector of length m. The columns are centered first, so the
+// intercept falls out of the means and the solve sees a better-conditioned
+// system; r2 is 1 x k.
+// ------------------------------------------------------------------
+typedef struct {
+  Matrix *x;
+  Matrix *residuals;
+  long rank;
+} LstsqResult;
+
+typedef struct {
+  Matrix *coef;
+  Matrix *intercept;
+  Matrix *r2;
+} LinregResult;
+
+// Rows of a least-squares operand: a 1D vector (1 x m) counts as m x 1.
+static long lstsq_rows(Matrix *M, long *cols) {
+  if (M->rows == 1) {
+    *cols = 1;
+    return M->cols;
+  }
+  *cols = M->cols;
+  return M->rows;
+}
+
+// Run dgelsd on a column-major m x n `a` and an ldb x k `b` (both scratch,
+// both overwritten; the solution lands in the first n rows of b).
+static long lstsq_dgelsd(double *a, long m, long n, double *b, long ldb,
+                         long k, const char *who) {
+  extern void dgelsd_(int *m, int *n, int *nrhs, double *a, int *lda,
+                      double *b, int *ldb, double *s, double *rcond,
+                      int *rank, double *work, int *lwork, int *iwork,
+                      int *info);
+  long mn = m < n ? m : n;
+  double *sv = lapack_scratch(LAPACK_AUX, mn);
+  int m_int = (int)m, n_int = (int)n, k_int = (int)k, ldb_int = (int)ldb;
+  int lda = m_int > 1 ? m_int : 1, rank = 0, info, lwork = -1, iwq = 0;
+  double rcond = 2.220446049250313e-16 * (double)(m > n ? m : n), wq;
+  dgelsd_(&m_int, &n_int, &k_int, a, &lda, b, &ldb_int, sv, &rcond, &rank,
+          &wq, &lwork, &iwq, &info);
+  double *work = lapack_work(wq, &lwork);
+  // Older LAPACKs do not report LIWORK on a query; use the documented bound.
+  long nlvl = 1;
+  while ((mn >> nlvl) > 26) nlvl++;
+  long liwork = 3 * mn * nlvl + 11 * mn;
+  if (iwq > liwork) liwork = iwq;
+  int *iwork = lapack_iscratch(liwork);
+  dgelsd_(&m_int, &n_int, &k_int, a, &lda, b, &ldb_int, sv, &rcond, &rank,
+          work, &lwork, iwork, &info);
+  if (info != 0) {
+    fprintf(stderr, "Error: %s() failed (LAPACK dgelsd info=%d)\n", who,
+            info);
+    exit(1);
+  }
+  return rank;
+}
+
+// Per-column sum of squared residuals of Y - X * coef, read back from the
+// original row-major data (centered by xmean / ymean when given). Used when
+// dgelsd does not leave the residuals in the tail of b.
+static void lstsq_ssr(Matrix *X, long m, long p, const double *xmean,
+                      Matrix *Y, long k, const double *ymean,
+                      const double *coef, long ldc, double *out) {
+  for (long j = 0; j < k; j++) out[j] = 0.0;
+  for (long i = 0; i < m; i++) {
+    const double *xrow = X->data + i * p;
+    const double *yrow = Y->data + i * k;
+    for (long j = 0; j < k; j++) {
+      double fit = 0.0;
+      for (long l = 0; l < p; l++)
+        fit += (xrow[l] - (xmean ? xmean[l] : 0.0)) * coef[j * ldc + l];
+      double r = yrow[j] - (ymean ? ymean[j] : 0.0) - fit;
+      out[j] += r * r;
+    }
+  }
+}
+
+// Solve the prepared system and fill `ssr` (k values); returns the rank.
+static long lstsq_solve(Matrix *X, long m, long p, const double *xmean,
+                        Matrix *Y, long k, const double *ymean, double *a,
+                        double *b, long ldb, double *ssr, const char *who) {
+  long rank = lstsq_dgelsd(a, m, p, b, ldb, k, who);
+  if (m > p && rank == p) {
+    // Full column rank: the residual components are rows p..m-1 of b.
+    for (long j = 0; j < k; j++) {
+      double acc = 0.0;
+      for (long i = p; i < m; i++) acc += b[j * ldb + i] * b[j * ldb + i];
+      ssr[j] = acc;
+    }
+  } else {
+    lstsq_ssr(X, m, p, xmean, Y, k, ymean, b, ldb, ssr);
+  }
+  return rank;
+}
+
+LstsqResult *math_lstsq(Matrix *A, Matrix *b) {
+  long m = A->rows, n = A->cols, k;
+  long bm = lstsq_rows(b, &k);
+  if (m <= 0 || n <= 0 || bm != m) {
+    fprintf(stderr,
+            "Error: lstsq() dimension mismatch (A is %ldx%ld, b is %ldx%ld)\n",
+            A->rows, A->cols, b->rows, b->cols);
+    exit(1);
+  }
+
+  double *a = lapack_scratch(LAPACK_A, m * n);
+  matrix_to_colmajor(A, a);
+  long ldb = m > n ? m : n;
+  double *c = lapack_scratch(LAPACK_B, ldb * k);
+  for (long i = 0; i < m; i++)
+    for (long j = 0; j < k; j++) c[j * ldb + i] = b->data[i * k + j];
+
+  LstsqResult *res = (LstsqResult *)malloc(sizeof(LstsqResult));
+  res->residuals = matrix_new(1, k);
+  res->rank = lstsq_solve(A, m, n, NULL, b, k, NULL, a, c, ldb,
+                          res->residuals->data, "lstsq");
+  res->x = b->rows == 1 ? matrix_new(1, n) : matrix_new(n, k);
+  for (long i = 0; i < n; i++)
+    for (long j = 0; j < k; j++) res->x->data[i * k + j] = c[j * ldb + i];
+  return res;
+}
+
+LinregResult *math_linreg(Matrix *X, Matrix *Y) {
+  long p, k;
+  long m = lstsq_rows(X, &p);
+  long ym = lstsq_rows(Y, &k);
+  if (ym != m) {
+    fprintf(stderr,
+            "Error: linreg() needs one response row per observation "
+            "(X has %ld, Y has %ld)\n",
+            m, ym);
+    exit(1);
+  }
+  if (m < 2) {
+    fprintf(stderr, "Error: linreg() needs at least 2 observations\n");
+    exit(1);
+  }
+
+  // Column means, accumulated row by row.
+  double *xmean = (double *)calloc(p + k, sizeof(double));
+  double *ymean = xmean + p;
+  for (long i = 0; i < m; i++) {
+    for (long l = 0; l < p; l++) xmean[l] += X->data[i * p + l];
+    for (long j = 0; j < k; j++) ymean[j] += Y->data[i * k + j];
+  }
+  for (long l = 0; l < p + k; l++) xmean[l] /= (double)m;
+
+  // Centered, column-major copies; SStot comes for free on the way.
+  double *a = lapack_scratch(LAPACK_A, m * p);
+  long ldb = m > p ? m : p;
+  double *c = lapack_scratch(LAPACK_B, ldb * k);
+  LinregResult *res = (LinregResult *)malloc(sizeof(LinregResult));
+  res->coef = matrix_new(p, k);
+  res->intercept = matrix_new(1, k);
+  res->r2 = matrix_new(1, k);
+  double *sstot = res->r2->data;
+  for (long j = 0; j < k; j++) sstot[j] = 0.0;
+  for (long i = 0; i < m; i++) {
+    for (long l = 0; l < p; l++) a[l * m + i] = X->data[i * p + l] - xmean[l];
+    for (long j = 0; j < k; j++) {
+      double yc = Y->data[i * k + j] - ymean[j];
+      c[j * ldb + i] = yc;
+      sstot[j] += yc * yc;
+    }
+  }
+
+  double *ssr = (double *)malloc(k * sizeof(double));
+  lstsq_solve(X, m, p, xmean, Y, k, ymean, a, c, ldb, ssr, "linreg");
+
+  for (long j = 0; j < k; j++) {
+    double icpt = ymean[j];
+    for (long l = 0; l < p; l++) {
+      double coef = c[j * ldb + l];
+      res->coef->data[l * k + j] = coef;
+      icpt -= xmean[l] * coef;
+    }
+    res->intercept->data[j] = icpt;
+    // A constant response has nothing to explain: r2 is 1 if it is fitted
+    // exactly, 0 otherwise.
+    sstot[j] = sstot[j] > 0.0 ? 1.0 - ssr[j] / sstot[j]
+                              : (ssr[j] == 0.0 ? 1.0 : 0.0);
+  }
+  free(ssr);
+  free(xmean);
+  return res;
+}
+
+// ------------------------------------------------------------------
+// Reference BLAS (Fortran ABI), linked alongside LAPACK (v1.9).
+// ------------------------------------------------------------------
+extern double ddot_(int *n, double *x, int *incx, double *y, int *incy);
+extern double dnrm2_(int *n, double *x, int *incx);
+extern void daxpy_(int *n, double *alpha, double *x, int *incx, double *y,
+                   int *incy);
+extern void dsyrk_(char *uplo, char *trans, int *n, int *k, double *alpha,
+                   double *a, int *lda, double *beta, double *c, int *ldc);
+
 // ------------------------------------------------------------------
 // Norms (v1.8 Grupo B).
 //   math_norm_vec: L2 (Euclidean) norm of a vector (any shape, flattened).
 //   math_norm_mat: 0 = Frobenius, 1 = 1-norm (max column sum),
 //                  2 = inf-norm (max row sum).
+// The L2/Frobenius norms go through dnrm2, which also scales to avoid
+// overflow on large entries (v1.9).
 // ------------------------------------------------------------------
 double math_norm_vec(Matrix *v) {
-  long total = v->rows * v->cols;
-  double sum = 0.0;
-  for (long i = 0; i < total; i++)
-    sum += v->data[i] * v->data[i];
-  return sqrt(sum);
+  int n = (int)(v->rows * v->cols), one = 1;
+  return n > 0 ? dnrm2_(&n, v->data, &one) : 0.0;
 }
 
 double math_norm_mat(Matrix *A, long norm_type) {
@@ -1614,14 +2684,19 @@ double math_norm_mat(Matrix *A, long norm_type) {
   }
   long m = A->rows, n = A->cols;
   if (norm_type == 1) {
-    double maxcol = 0.0;
-    for (long j = 0; j < n; j++) {
-      double col = 0.0;
-      for (long i = 0; i < m; i++)
-        col += fabs(A->data[i * n + j]);
-      if (col > maxcol)
-        maxcol = col;
+    // Column sums accumulated row by row, so the row-major data is read
+    // sequentially instead of with a stride of n.
+    double *colsum = (double *)calloc(n > 0 ? n : 1, sizeof(double));
+    for (long i = 0; i < m; i++) {
+      const double *row = A->data + i * n;
+      for (long j = 0; j < n; j++)
+        colsum[j] += fabs(row[j]);
     }
+    double maxcol = 0.0;
+    for (long j = 0; j < n; j++)
+      if (colsum[j] > maxcol)
+        maxcol = colsum[j];
+    free(colsum);
     return maxcol;
   } else if (norm_type == 2) {
     double maxrow = 0.0;
@@ -1635,10 +2710,106 @@ double math_norm_mat(Matrix *A, long norm_type) {
     return maxrow;
   }
   // Frobenius (default / norm_type == 0)
-  double sum = 0.0;
-  for (long i = 0; i < m * n; i++)
-    sum += A->data[i] * A->data[i];
-  return sqrt(sum);
+  return math_norm_vec(A);
+}
+
+// ------------------------------------------------------------------
+// BLAS kernels (v1.9): dot, axpy, cov, corrcoef.
+//   math_dot(a, b)           : sum a[i] * b[i] over the flattened data
+//   math_axpy(alpha, x, y)   : new matrix alpha * x + y (shape of y)
+//   math_axpy_inplace(...)   : y += alpha * x, in place
+//   math_cov(X)              : sample covariance (n - 1 denominator)
+//   math_corrcoef(X)         : Pearson correlation matrix
+// For cov/corrcoef each row of X is an observation and each column a
+// variable, so an m x p X gives a p x p result. A single row (a 1D array)
+// is one variable and gives a 1 x 1 variance.
+// ------------------------------------------------------------------
+static void blas_check_len(Matrix *x, Matrix *y, const char *who) {
+  if (x->rows * x->cols != y->rows * y->cols) {
+    fprintf(stderr, "Error: %s() length mismatch (%ld vs %ld elements)\n",
+            who, x->rows * x->cols, y->rows * y->cols);
+    exit(1);
+  }
+}
+
+double math_dot(Matrix *a, Matrix *b) {
+  blas_check_len(a, b, "dot");
+  int n = (int)(a->rows * a->cols), one = 1;
+  return n > 0 ? ddot_(&n, a->data, &one, b->data, &one) : 0.0;
+}
+
+void math_axpy_inplace(double alpha, Matrix *x, Matrix *y) {
+  blas_check_len(x, y, "axpy");
+  int n = (int)(y->rows * y->cols), one = 1;
+  if (n > 0) daxpy_(&n, &alpha, x->data, &one, y->data, &one);
+}
+
+Matrix *math_axpy(double alpha, Matrix *x, Matrix *y) {
+  blas_check_len(x, y, "axpy");
+  Matrix *result = matrix_new(y->rows, y->cols);
+  memcpy(result->data, y->data, y->rows * y->cols * sizeof(double));
+  math_axpy_inplace(alpha, x, result);
+  return result;
+}
+
+Matrix *math_cov(Matrix *X) {
+  long m = X->rows, p = X->cols;
+  if (m == 1) {  // 1D input: one variable, p observations
+    m = p;
+    p = 1;
+  }
+  if (m < 2) {
+    fprintf(stderr, "Error: cov() needs at least 2 observations, got %ld\n",
+            m);
+    exit(1);
+  }
+
+  // Column means, then a centered copy (row-major m x p).
+  double *mean = (double *)calloc(p, sizeof(double));
+  for (long i = 0; i < m; i++) {
+    const double *row = X->data + i * p;
+    for (long j = 0; j < p; j++) mean[j] += row[j];
+  }
+  for (long j = 0; j < p; j++) mean[j] /= (double)m;
+  double *xc = (double *)malloc(m * p * sizeof(double));
+  for (long i = 0; i < m; i++) {
+    const double *row = X->data + i * p;
+    double *out = xc + i * p;
+    for (long j = 0; j < p; j++) out[j] = row[j] - mean[j];
+  }
+  free(mean);
+
+  // Read column-major, xc is the p x m matrix Xc^T, so dsyrk('N') forms
+  // Xc^T * Xc directly. Only the upper triangle is written; mirroring it
+  // leaves the result exactly symmetric (eigvals/eigh take the fast path).
+  Matrix *C = matrix_new(p, p);
+  char uplo = 'U', trans = 'N';
+  int p_int = (int)p, m_int = (int)m;
+  double alpha = 1.0 / (double)(m - 1), beta = 0.0;
+  dsyrk_(&uplo, &trans, &p_int, &m_int, &alpha, xc, &p_int, &beta, C->data,
+         &p_int);
+  free(xc);
+  for (long c = 0; c < p; c++)
+    for (long r = 0; r < c; r++) C->data[r * p + c] = C->data[c * p + r];
+  return C;
+}
+
+Matrix *math_corrcoef(Matrix *X) {
+  Matrix *C = math_cov(X);
+  long p = C->rows;
+  double *sd = (double *)malloc(p * sizeof(double));
+  for (long i = 0; i < p; i++) sd[i] = sqrt(C->data[i * p + i]);
+  // A constant column has zero variance; its row/column becomes NaN.
+  for (long i = 0; i < p; i++) {
+    for (long j = 0; j < p; j++) {
+      double r = C->data[i * p + j] / (sd[i] * sd[j]);
+      if (r > 1.0) r = 1.0;
+      if (r < -1.0) r = -1.0;
+      C->data[i * p + j] = i == j && sd[i] > 0.0 ? 1.0 : r;
+    }
+  }
+  free(sd);
+  return C;
 }
 
 // ==========================================
@@ -1868,6 +3039,114 @@ IntMatrix* intmatrix_prepend(IntMatrix* m, long val) {
   return result;
 }
 
+// --- In-place Append/Prepend (v1.9) ---
+// `x := x.append(v)` / `x := x.prepend(v)` compile to the *_inplace variants,
+// which take over the variable's reference to m. When that reference is
+// the only one, the element is written into spare room at the back (or
+// front) of m's own buffer, and the buffer doubles when the room runs out,
+// so building an array one element at a time is amortized O(1) per call.
+// A shared m is copied exactly like append/prepend and the variable's
+// reference is dropped, so other holders never see the change.
+
+// Make room for one more element behind (front == 0) or ahead of (front == 1)
+// the `total` live elements at *data. Returns the new data pointer.
+static void *array_reserve(void *data, long *head, long *capacity, long total,
+                           size_t elem, int front) {
+  char *base = (char *)data - *head * elem;
+  long back = *capacity - *head - total;
+  if (!front && back > 0) return data;
+  if (front && *head > 0) return data;
+
+  if (!front) {
+    long grow = total > 4 ? total : 4;
+    *capacity += grow;
+    base = (char *)realloc(base, *capacity * elem);
+    if (!base) {
+      fprintf(stderr, "Error: out of memory growing array to %ld elements\n",
+              *capacity);
+      exit(1);
+    }
+    return base + *head * elem;
+  }
+
+  long new_head = total > 4 ? total : 4;
+  char *fresh = (char *)malloc((new_head + total + back) * elem);
+  if (!fresh) {
+    fprintf(stderr, "Error: out of memory growing array to %ld elements\n",
+            new_head + total + back);
+    exit(1);
+  }
+  if (total > 0) memcpy(fresh + new_head * elem, data, total * elem);
+  free(base);
+  *head = new_head;
+  *capacity = new_head + total + back;
+  return fresh + new_head * elem;
+}
+
+Matrix *matrix_append_inplace(Matrix *m, double val) {
+  if (m->ref_count != 1) {
+    Matrix *result = matrix_append(m, val);
+    matrix_release(m);
+    return result;
+  }
+  long total = m->rows * m->cols;
+  m->data = array_reserve(m->data, &m->head, &m->capacity, total,
+                          sizeof(double), 0);
+  m->data[total] = val;
+  m->rows = 1;
+  m->cols = total + 1;
+  return m;
+}
+
+IntMatrix *intmatrix_append_inplace(IntMatrix *m, long val) {
+  if (m->ref_count != 1) {
+    IntMatrix *result = intmatrix_append(m, val);
+    intmatrix_release(m);
+    return result;
+  }
+  long total = m->rows * m->cols;
+  m->data = array_reserve(m->data, &m->head, &m->capacity, total,
+                          sizeof(long), 0);
+  m->data[total] = val;
+  m->rows = 1;
+  m->cols = total + 1;
+  return m;
+}
+
+Matrix *matrix_prepend_inplace(Matrix *m, double val) {
+  if (m->ref_count != 1) {
+    Matrix *result = matrix_prepend(m, val);
+    matrix_release(m);
+    return result;
+  }
+  long total = m->rows * m->cols;
+  m->data = array_reserve(m->data, &m->head, &m->capacity, total,
+                          sizeof(double), 1);
+  m->data--;
+  m->head--;
+  m->data[0] = val;
+  m->rows = 1;
+  m->cols = total + 1;
+  return m;
+}
+
+IntMatrix *intmatrix_prepend_inplace(IntMatrix *m, long val) {
+  if (m->ref_count != 1) {
+    IntMatrix *result = intmatrix_prepend(m, val);
+    intmatrix_release(m);
+    return result;
+  }
+  long total = m->rows * m->cols;
+  m->data = array_reserve(m->data, &m->head, &m->capacity, total,
+                          sizeof(long), 1);
+  m->data--;
+  m->head--;
+  m->data[0] = val;
+  m->rows = 1;
+  m->cols = total + 1;
+  return m;
+}
+
 // --- Slicing (v1.7 Grupo C) ---
 // start/end are flat element indices, start inclusive, end exclusive.
 // Result is always a 1-row array (element slicing only, no 2D row
@@ -1906,15 +3185,1064 @@ IntMatrix* intmatrix_slice(IntMatrix* m, long start, long end) {
 }
 
 // ==========================================
-// SECTION 1: ERROR HANDLING (v1.1)
+// SECTION 1.9: SPARSE MATRIX (v1.9)
 // ==========================================
+//
+// Compressed Sparse Row storage: the non-zeros of row i live in
+// col_idx[row_ptr[i] .. row_ptr[i+1]) / vals[...], columns ascending and
+// unique. Only nnz entries are ever allocated, so a 1e6 x 1e6 matrix with a
+// few million non-zeros costs tens of MB instead of terabytes.
 
 typedef struct {
-    char* message;
-} BrixError;
+  long ref_count;  // ARC reference counting
+  long rows;
+  long cols;
+  long nnz;
+  long *row_ptr;   // rows + 1 offsets into col_idx / vals
+  long *col_idx;
+  double *vals;
+} SparseMatrix;
+
+static SparseMatrix *sparsematrix_alloc(long rows, long cols, long nnz) {
+  SparseMatrix *s = (SparseMatrix *)malloc(sizeof(SparseMatrix));
+  s->ref_count = 1;  // Initialize ARC
+  s->rows = rows;
+  s->cols = cols;
+  s->nnz = nnz;
+  s->row_ptr = (long *)calloc(rows + 1, sizeof(long));
+  s->col_idx = (long *)malloc((nnz > 0 ? nnz : 1) * sizeof(long));
+  s->vals = (double *)malloc((nnz > 0 ? nnz : 1) * sizeof(double));
+  return s;
+}
 
-// Create a new error with a message
-BrixError* brix_error_new(char* msg) {
+// ARC: Increment reference count
+void* sparsematrix_retain(SparseMatrix* s) {
+    if (!s) return NULL;
+    s->ref_count++;
+    return s;
+}
+
+// ARC: Decrement reference count and free if zero
+void sparsematrix_release(SparseMatrix* s) {
+    if (!s) return;
+    s->ref_count--;
+
+    if (s->ref_count == 0) {
+        free(s->row_ptr);
+        free(s->col_idx);
+        free(s->vals);
+        free(s);
+    }
+}
+
+// sparse(rows, cols, row_idx, col_idx, vals) — build CSR from COO triplets.
+// Two counting-sort passes (COO -> by column -> by row) leave every row's
+// columns sorted in O(nnz + rows + cols); duplicate (i, j) entries are then
+// summed in place, matching the usual COO assembly semantics.
+SparseMatrix *brix_sparse_from_coo(long rows, long cols, IntMatrix *ri,
+                                   IntMatrix *ci, Matrix *v) {
+  long n = ri->rows * ri->cols;
+  if (ci->rows * ci->cols != n || v->rows * v->cols != n) {
+    fprintf(stderr,
+            "Error: sparse() row, column and value arrays must have the same "
+            "length (got %ld, %ld, %ld)\n",
+            n, ci->rows * ci->cols, v->rows * v->cols);
+    exit(1);
+  }
+  if (rows < 0 || cols < 0) {
+    fprintf(stderr, "Error: sparse() dimensions must be non-negative\n");
+    exit(1);
+  }
+  for (long k = 0; k < n; k++) {
+    if (ri->data[k] < 0 || ri->data[k] >= rows || ci->data[k] < 0 ||
+        ci->data[k] >= cols) {
+      fprintf(stderr,
+              "Error: sparse() entry (%ld, %ld) out of bounds for %ldx%ld "
+              "matrix\n",
+              ri->data[k], ci->data[k], rows, cols);
+      exit(1);
+    }
+  }
+
+  // Pass 1: bucket the triplets by column.
+  long *cptr = (long *)calloc(cols + 1, sizeof(long));
+  long *trow = (long *)malloc((n > 0 ? n : 1) * sizeof(long));
+  double *tval = (double *)malloc((n > 0 ? n : 1) * sizeof(double));
+  for (long k = 0; k < n; k++) cptr[ci->data[k] + 1]++;
+  for (long j = 0; j < cols; j++) cptr[j + 1] += cptr[j];
+  long *next = (long *)malloc(((cols > rows ? cols : rows) + 1) * sizeof(long));
+  memcpy(next, cptr, cols * sizeof(long));
+  for (long k = 0; k < n; k++) {
+    long dst = next[ci->data[k]]++;
+    trow[dst] = ri->data[k];
+    tval[dst] = v->data[k];
+  }
+
+  // Pass 2: bucket by row, walking columns in ascending order.
+  SparseMatrix *s = sparsematrix_alloc(rows, cols, n);
+  for (long k = 0; k < n; k++) s->row_ptr[trow[k] + 1]++;
+  for (long i = 0; i < rows; i++) s->row_ptr[i + 1] += s->row_ptr[i];
+  memcpy(next, s->row_ptr, rows * sizeof(long));
+  for (long j = 0; j < cols; j++) {
+    for (long p = cptr[j]; p < cptr[j + 1]; p++) {
+      long dst = next[trow[p]]++;
+      s->col_idx[dst] = j;
+      s->vals[dst] = tval[p];
+    }
+  }
+  free(cptr);
+  free(trow);
+  free(tval);
+  free(next);
+
+  // Sum duplicates (adjacent after sorting) and compact.
+  long out = 0;
+  for (long i = 0; i < rows; i++) {
+    long start = s->row_ptr[i], end = s->row_ptr[i + 1];
+    s->row_ptr[i] = out;
+    for (long p = start; p < end; p++) {
+      if (out > s->row_ptr[i] && s->col_idx[out - 1] == s->col_idx[p]) {
+        s->vals[out - 1] += s->vals[p];
+      } else {
+        s->col_idx[out] = s->col_idx[p];
+        s->vals[out] = s->vals[p];
+        out++;
+      }
+    }
+  }
+  s->row_ptr[rows] = out;
+  s->nnz = out;
+  return s;
+}
+
+// sparse(m) — compress a dense Matrix, dropping exact zeros.
+SparseMatrix *brix_sparse_from_dense(Matrix *m) {
+  long rows = m->rows, cols = m->cols;
+  long nnz = 0;
+  for (long k = 0; k < rows * cols; k++)
+    if (m->data[k] != 0.0) nnz++;
+
+  SparseMatrix *s = sparsematrix_alloc(rows, cols, nnz);
+  long out = 0;
+  for (long i = 0; i < rows; i++) {
+    const double *row = m->data + i * cols;
+    for (long j = 0; j < cols; j++) {
+      if (row[j] != 0.0) {
+        s->col_idx[out] = j;
+        s->vals[out] = row[j];
+        out++;
+      }
+    }
+    s->row_ptr[i + 1] = out;
+  }
+  return s;
+}
+
+// s.to_dense() — expand back to a rows x cols Matrix.
+Matrix *brix_sparse_to_dense(SparseMatrix *s) {
+  Matrix *m = matrix_new(s->rows, s->cols);
+  memset(m->data, 0, s->rows * s->cols * sizeof(double));
+  for (long i = 0; i < s->rows; i++) {
+    double *row = m->data + i * s->cols;
+    for (long p = s->row_ptr[i]; p < s->row_ptr[i + 1]; p++)
+      row[s->col_idx[p]] = s->vals[p];
+  }
+  return m;
+}
+
+// s.transpose() — CSR of the transpose (one counting-sort pass).
+SparseMatrix *brix_sparse_transpose(SparseMatrix *s) {
+  SparseMatrix *t = sparsematrix_alloc(s->cols, s->rows, s->nnz);
+  for (long p = 0; p < s->nnz; p++) t->row_ptr[s->col_idx[p] + 1]++;
+  for (long j = 0; j < s->cols; j++) t->row_ptr[j + 1] += t->row_ptr[j];
+  long *next = (long *)malloc((s->cols > 0 ? s->cols : 1) * sizeof(long));
+  memcpy(next, t->row_ptr, s->cols * sizeof(long));
+  for (long i = 0; i < s->rows; i++) {
+    for (long p = s->row_ptr[i]; p < s->row_ptr[i + 1]; p++) {
+      long dst = next[s->col_idx[p]]++;
+      t->col_idx[dst] = i;
+      t->vals[dst] = s->vals[p];
+    }
+  }
+  free(next);
+  return t;
+}
+
+// y = A * x on raw vectors (x has A->cols entries, y has A->rows).
+static void sparse_spmv(const SparseMatrix *A, const double *x, double *y) {
+  for (long i = 0; i < A->rows; i++) {
+    double sum = 0.0;
+    for (long p = A->row_ptr[i]; p < A->row_ptr[i + 1]; p++)
+      sum += A->vals[p] * x[A->col_idx[p]];
+    y[i] = sum;
+  }
+}
+
+// s.mul(x) — sparse * dense product.
+//   x is cols x k  -> rows x k (SpMM; k == 1 is a column-vector SpMV)
+//   x is 1 x cols  -> 1 x rows (row-vector SpMV, the shape of [..] literals)
+// SpMM accumulates whole rows of x so the inner loop is a contiguous axpy.
+Matrix *brix_sparse_mul(SparseMatrix *A, Matrix *x) {
+  if (x->rows == A->cols) {
+    long k = x->cols;
+    Matrix *y = matrix_new(A->rows, k);
+    if (k == 1) {
+      sparse_spmv(A, x->data, y->data);
+      return y;
+    }
+    memset(y->data, 0, A->rows * k * sizeof(double));
+    for (long i = 0; i < A->rows; i++) {
+      double *yrow = y->data + i * k;
+      for (long p = A->row_ptr[i]; p < A->row_ptr[i + 1]; p++) {
+        double a = A->vals[p];
+        const double *xrow = x->data + A->col_idx[p] * k;
+        for (long c = 0; c < k; c++) yrow[c] += a * xrow[c];
+      }
+    }
+    return y;
+  }
+  if (x->rows == 1 && x->cols == A->cols) {
+    Matrix *y = matrix_new(1, A->rows);
+    sparse_spmv(A, x->data, y->data);
+    return y;
+  }
+  fprintf(stderr,
+          "Error: sparse mul() dimension mismatch: %ldx%ld * %ldx%ld\n",
+          A->rows, A->cols, x->rows, x->cols);
+  exit(1);
+}
+
+// ------------------------------------------------------------------
+// Krylov solvers (v1.9): math.cg / math.bicgstab / math.gmres
+//
+//   math.<method>(A, b[, tol[, max_iter[, precond]]])
+//
+// A is the operator: a SparseMatrix, a dense Matrix, or a Brix closure
+// `(v: matrix) -> matrix` returning A*v — only the product is ever needed,
+// so matrix-free operators never materialize A. precond is an optional
+// closure applying M^-1 to a vector; without one, explicit operators use
+// Jacobi (inverse diagonal) preconditioning and closures none.
+//
+//   cg       : symmetric positive-definite A (preconditioned CG)
+//   bicgstab : general square A (right-preconditioned BiCGSTAB)
+//   gmres    : general square A (right-preconditioned GMRES(30), restarted)
+//
+// All three start from x = 0 and stop when ||b - A x|| <= tol * ||b||;
+// tol <= 0 selects 1e-10 and max_iter <= 0 selects 10 * n (counted in
+// operator applications per iteration, inner steps for GMRES). The result
+// has the shape of b; failing to converge is a runtime error.
+// ------------------------------------------------------------------
+enum { KRYLOV_CG, KRYLOV_BICGSTAB, KRYLOV_GMRES };
+enum { KRYLOV_SPARSE, KRYLOV_DENSE, KRYLOV_CLOSURE };
+
+#define KRYLOV_GMRES_RESTART 30
+
+// Closure operator / preconditioner: Matrix* fn(env, Matrix* v).
+typedef Matrix *(*BrixMatrixFn)(void *env, Matrix *v);
+
+typedef struct {
+  const char *who;  // "cg" / "bicgstab" / "gmres" (diagnostics)
+  long n;
+  int kind;
+  void *A;          // SparseMatrix* or Matrix* (KRYLOV_SPARSE / _DENSE)
+  void *op_fn, *op_env;
+  void *pc_fn, *pc_env;
+  double *inv_diag; // Jacobi preconditioner, NULL when unused
+  Matrix *arg;      // vector handed to closures, shaped like b
+} KrylovOp;
+
+// y = fn(x) through a Brix closure. The closure gets `arg` (owned by the
+// solver and refilled each call); its result is an owned temporary,
+// released after copying unless the closure handed `arg` straight back.
+static void krylov_call(KrylovOp *op, void *fn, void *env, const double *x,
+                        double *y) {
+  memcpy(op->arg->data, x, op->n * sizeof(double));
+  Matrix *r = ((BrixMatrixFn)fn)(env, op->arg);
+  if (!r || r->rows * r->cols != op->n) {
+    fprintf(stderr,
+            "Error: %s() operator returned %ld elements, expected %ld\n",
+            op->who, r ? r->rows * r->cols : 0, op->n);
+    exit(1);
+  }
+  memcpy(y, r->data, op->n * sizeof(double));
+  if (r != op->arg) matrix_release(r);
+}
+
+// y = A x
+static void krylov_apply(KrylovOp *op, const double *x, double *y) {
+  if (op->kind == KRYLOV_SPARSE) {
+    sparse_spmv((SparseMatrix *)op->A, x, y);
+  } else if (op->kind == KRYLOV_DENSE) {
+    // The row-major A is the column-major A^T: y = A x is dgemv('T').
+    extern void dgemv_(char *trans, int *m, int *n, double *alpha, double *a,
+                       int *lda, double *x, int *incx, double *beta,
+                       double *y, int *incy);
+    char trans = 'T';
+    int n = (int)op->n, one = 1;
+    double alpha = 1.0, beta = 0.0;
+    dgemv_(&trans, &n, &n, &alpha, ((Matrix *)op->A)->data, &n, (double *)x,
+           &one, &beta, y, &one);
+  } else {
+    krylov_call(op, op->op_fn, op->op_env, x, y);
+  }
+}
+
+// z = M^-1 r
+static void krylov_precond(KrylovOp *op, const double *r, double *z) {
+  if (op->pc_fn) {
+    krylov_call(op, op->pc_fn, op->pc_env, r, z);
+  } else if (op->inv_diag) {
+    for (long i = 0; i < op->n; i++) z[i] = r[i] * op->inv_diag[i];
+  } else if (z != r) {
+    memcpy(z, r, op->n * sizeof(double));
+  }
+}
+
+static double krylov_dot(long n, const double *x, const double *y) {
+  double s = 0.0;
+  for (long i = 0; i < n; i++) s += x[i] * y[i];
+  return s;
+}
+
+// Jacobi preconditioner from the diagonal of an explicit operator. CG needs
+// a positive diagonal (a necessary condition for SPD A) and rejects
+// anything else; the general solvers fall back to no preconditioning when
+// a diagonal entry is zero.
+static double *krylov_jacobi(KrylovOp *op, int method) {
+  long n = op->n;
+  double *inv_diag = (double *)malloc((n > 0 ? n : 1) * sizeof(double));
+  for (long i = 0; i < n; i++) {
+    double d = 0.0;
+    if (op->kind == KRYLOV_SPARSE) {
+      SparseMatrix *A = (SparseMatrix *)op->A;
+      for (long p = A->row_ptr[i]; p < A->row_ptr[i + 1]; p++)
+        if (A->col_idx[p] == i) d = A->vals[p];
+    } else {
+      d = ((Matrix *)op->A)->data[i * n + i];
+    }
+    if (method == KRYLOV_CG && d <= 0.0) {
+      fprintf(stderr,
+              "Error: cg() requires a positive diagonal (A must be symmetric "
+              "positive-definite); A[%ld][%ld] = %g\n",
+              i, i, d);
+      exit(1);
+    }
+    if (d == 0.0) {
+      free(inv_diag);
+      return NULL;
+    }
+    inv_diag[i] = 1.0 / d;
+  }
+  return inv_diag;
+}
+
+static void krylov_cg(KrylovOp *op, const double *b, double *x, double tol,
+                      long max_iter, double *rnorm_out) {
+  long n = op->n;
+  double *r = (double *)malloc(4 * (n > 0 ? n : 1) * sizeof(double));
+  double *z = r + n, *p = z + n, *ap = p + n;
+
+  memcpy(r, b, n * sizeof(double));
+  krylov_precond(op, r, z);
+  memcpy(p, z, n * sizeof(double));
+  double bnorm = sqrt(krylov_dot(n, b, b)), rz = krylov_dot(n, r, z);
+  double rnorm = bnorm;
+  long it = 0;
+  while (rnorm > tol * bnorm && it < max_iter) {
+    krylov_apply(op, p, ap);
+    double pap = krylov_dot(n, p, ap);
+    if (pap <= 0.0) {
+      fprintf(stderr,
+              "Error: cg() breakdown: matrix is not positive-definite\n");
+      exit(1);
+    }
+    double alpha = rz / pap;
+    for (long i = 0; i < n; i++) {
+      x[i] += alpha * p[i];
+      r[i] -= alpha * ap[i];
+    }
+    krylov_precond(op, r, z);
+    rnorm = sqrt(krylov_dot(n, r, r));
+    double rz_new = krylov_dot(n, r, z);
+    double beta = rz_new / rz;
+    rz = rz_new;
+    for (long i = 0; i < n; i++) p[i] = z[i] + beta * p[i];
+    it++;
+  }
+  free(r);
+  *rnorm_out = rnorm;
+}
+
+static void krylov_bicgstab(KrylovOp *op, const double *b, double *x,
+                            double tol, long max_iter, double *rnorm_out) {
+  long n = op->n;
+  double *r = (double *)calloc(7 * (n > 0 ? n : 1), sizeof(double));
+  double *rhat = r + n, *p = rhat + n, *v = p + n, *phat = v + n;
+  double *shat = phat + n, *t = shat + n;
+
+  memcpy(r, b, n * sizeof(double));
+  memcpy(rhat, b, n * sizeof(double));
+  double bnorm = sqrt(krylov_dot(n, b, b)), rnorm = bnorm;
+  double rho = 1.0, alpha = 1.0, omega = 1.0;
+  long it = 0;
+  while (rnorm > tol * bnorm && it < max_iter) {
+    double rho_new = krylov_dot(n, rhat, r);
+    if (rho_new == 0.0 || omega == 0.0) {
+      fprintf(stderr, "Error: bicgstab() breakdown (rho = %g, omega = %g)\n",
+              rho_new, omega);
+      exit(1);
+    }
+    double beta = (rho_new / rho) * (alpha / omega);
+    for (long i = 0; i < n; i++) p[i] = r[i] + beta * (p[i] - omega * v[i]);
+    krylov_precond(op, p, phat);
+    krylov_apply(op, phat, v);
+    alpha = rho_new / krylov_dot(n, rhat, v);
+    // s = r - alpha v, kept in r.
+    for (long i = 0; i < n; i++) r[i] -= alpha * v[i];
+    it++;
+    double snorm = sqrt(krylov_dot(n, r, r));
+    if (snorm <= tol * bnorm) {
+      for (long i = 0; i < n; i++) x[i] += alpha * phat[i];
+      rnorm = snorm;
+      break;
+    }
+    krylov_precond(op, r, shat);
+    krylov_apply(op, shat, t);
+    double tt = krylov_dot(n, t, t);
+    omega = tt > 0.0 ? krylov_dot(n, t, r) / tt : 0.0;
+    for (long i = 0; i < n; i++) {
+      x[i] += alpha * phat[i] + omega * shat[i];
+      r[i] -= omega * t[i];
+    }
+    rnorm = sqrt(krylov_dot(n, r, r));
+    rho = rho_new;
+  }
+  free(r);
+  *rnorm_out = rnorm;
+}
+
+static void krylov_gmres(KrylovOp *op, const double *b, double *x,
+                         double tol, long max_iter, double *rnorm_out) {
+  long n = op->n;
+  long m = n < KRYLOV_GMRES_RESTART ? n : KRYLOV_GMRES_RESTART;
+  if (m < 1) m = 1;
+  // Krylov basis V (m + 1 vectors), Hessenberg H ((m + 1) x m, column j
+  // at H + j * (m + 1)), Givens rotations (cs, sn), rhs g and a work vector.
+  double *V = (double *)malloc((m + 1) * n * sizeof(double));
+  double *H = (double *)malloc((m + 1) * m * sizeof(double));
+  double *cs = (double *)malloc((3 * m + 1) * sizeof(double));
+  double *sn = cs + m, *g = sn + m;
+  double *w = (double *)malloc(2 * (n > 0 ? n : 1) * sizeof(double));
+  double *u = w + n;
+
+  double bnorm = sqrt(krylov_dot(n, b, b)), rnorm = bnorm;
+  long it = 0;
+  while (it < max_iter) {
+    // r = b - A x
+    krylov_apply(op, x, w);
+    for (long i = 0; i < n; i++) w[i] = b[i] - w[i];
+    rnorm = sqrt(krylov_dot(n, w, w));
+    if (rnorm <= tol * bnorm) break;
+    for (long i = 0; i < n; i++) V[i] = w[i] / rnorm;
+    for (long i = 0; i <= m; i++) g[i] = 0.0;
+    g[0] = rnorm;
+
+    long k = 0;
+    while (k < m && it < max_iter) {
+      double *hk = H + k * (m + 1);
+      krylov_precond(op, V + k * n, u);
+      krylov_apply(op, u, w);
+      // Modified Gram-Schmidt against the basis so far.
+      for (long i = 0; i <= k; i++) {
+        hk[i] = krylov_dot(n, w, V + i * n);
+        for (long l = 0; l < n; l++) w[l] -= hk[i] * V[i * n + l];
+      }
+      hk[k + 1] = sqrt(krylov_dot(n, w, w));
+      if (hk[k + 1] > 0.0)
+        for (long l = 0; l < n; l++) V[(k + 1) * n + l] = w[l] / hk[k + 1];
+      // Apply the earlier rotations, then zero hk[k + 1] with a new one.
+      for (long i = 0; i < k; i++) {
+        double t = cs[i] * hk[i] + sn[i] * hk[i + 1];
+        hk[i + 1] = -sn[i] * hk[i] + cs[i] * hk[i + 1];
+        hk[i] = t;
+      }
+      double d = hypot(hk[k], hk[k + 1]);
+      cs[k] = d > 0.0 ? hk[k] / d : 1.0;
+      sn[k] = d > 0.0 ? hk[k + 1] / d : 0.0;
+      hk[k] = d;
+      hk[k + 1] = 0.0;
+      g[k + 1] = -sn[k] * g[k];
+      g[k] = cs[k] * g[k];
+      rnorm = fabs(g[k + 1]);
+      k++;
+      it++;
+      if (rnorm <= tol * bnorm || d == 0.0) break;
+    }
+
+    // y = H^-1 g (upper triangular, k x k), then x += M^-1 (V y).
+    for (long i = k - 1; i >= 0; i--) {
+      double acc = g[i];
+      for (long j = i + 1; j < k; j++) acc -= H[j * (m + 1) + i] * g[j];
+      g[i] = H[i * (m + 1) + i] != 0.0 ? acc / H[i * (m + 1) + i] : 0.0;
+    }
+    for (long l = 0; l < n; l++) w[l] = 0.0;
+    for (long j = 0; j < k; j++)
+      for (long l = 0; l < n; l++) w[l] += g[j] * V[j * n + l];
+    krylov_precond(op, w, u);
+    for (long l = 0; l < n; l++) x[l] += u[l];
+    if (rnorm <= tol * bnorm) {
+      // The Givens estimate can drift from the true residual; recheck it.
+      krylov_apply(op, x, w);
+      for (long i = 0; i < n; i++) w[i] = b[i] - w[i];
+      rnorm = sqrt(krylov_dot(n, w, w));
+      if (rnorm <= tol * bnorm) break;
+    }
+  }
+  free(V);
+  free(H);
+  free(cs);
+  free(w);
+  *rnorm_out = rnorm;
+}
+
+Matrix *math_krylov(long method, long kind, void *A, void *op_fn,
+                    void *op_env, Matrix *b, double tol, long max_iter,
+                    void *pc_fn, void *pc_env) {
+  static const char *names[] = {"cg", "bicgstab", "gmres"};
+  KrylovOp op = {names[method], b->rows * b->cols, (int)kind, A, op_fn,
+                 op_env, pc_fn, pc_env, NULL, NULL};
+  long n = op.n;
+  if (b->rows != 1 && b->cols != 1) {
+    fprintf(stderr, "Error: %s() RHS must be a vector, got %ldx%ld\n",
+            op.who, b->rows, b->cols);
+    exit(1);
+  }
+  if (kind != KRYLOV_CLOSURE) {
+    long rows = kind == KRYLOV_SPARSE ? ((SparseMatrix *)A)->rows
+                                      : ((Matrix *)A)->rows;
+    long cols = kind == KRYLOV_SPARSE ? ((SparseMatrix *)A)->cols
+                                      : ((Matrix *)A)->cols;
+    if (rows != cols) {
+      fprintf(stderr, "Error: %s() requires a square matrix, got %ldx%ld\n",
+              op.who, rows, cols);
+      exit(1);
+    }
+    if (rows != n) {
+      fprintf(stderr, "Error: %s() RHS must be a vector of length %ld\n",
+              op.who, rows);
+      exit(1);
+    }
+    if (!pc_fn) op.inv_diag = krylov_jacobi(&op, (int)method);
+  }
+  if (op_fn || pc_fn) op.arg = matrix_new(b->rows, b->cols);
+  if (tol <= 0.0) tol = 1e-10;
+  if (max_iter <= 0) max_iter = 10 * (n > 0 ? n : 1);
+
+  Matrix *x = matrix_new(b->rows, b->cols);
+  memset(x->data, 0, n * sizeof(double));
+  double rnorm;
+  if (method == KRYLOV_CG) {
+    krylov_cg(&op, b->data, x->data, tol, max_iter, &rnorm);
+  } else if (method == KRYLOV_BICGSTAB) {
+    krylov_bicgstab(&op, b->data, x->data, tol, max_iter, &rnorm);
+  } else {
+    krylov_gmres(&op, b->data, x->data, tol, max_iter, &rnorm);
+  }
+  free(op.inv_diag);
+  if (op.arg) matrix_release(op.arg);
+
+  double bnorm = sqrt(krylov_dot(n, b->data, b->data));
+  if (rnorm > tol * bnorm) {
+    fprintf(stderr,
+            "Error: %s() did not converge in %ld iterations (relative "
+            "residual %g)\n",
+            op.who, max_iter, bnorm > 0.0 ? rnorm / bnorm : rnorm);
+    exit(1);
+  }
+  return x;
+}
+
+// ==========================================
+// SECTION 1.10: FFT (v1.9)
+// ==========================================
+//
+// Mixed-radix Cooley-Tukey (decimation in time) with dedicated radix-2/3/4
+// butterflies and a generic butterfly for other small primes. Lengths with a
+// prime factor above FFT_MAX_RADIX go through Bluestein's chirp-z algorithm
+// on a power-of-two length, so every n is O(n log n).
+//
+// Plans (factorization + twiddles) are built once per (n, direction) and
+// cached for the life of the process; the cache is mutex-protected so the
+// row/column workers of a threaded 2D transform can share it.
+
+#include <pthread.h>
+
+#define FFT_MAX_RADIX 64
+#define FFT_MAX_FACTORS 64
+#define FFT_PARALLEL_MIN (1L << 15)  // elements before a batch is threaded
+#define FFT_MAX_THREADS 8
+
+typedef struct FftPlan {
+  long n;
+  int inverse;
+  long factors[2 * FFT_MAX_FACTORS];  // (radix, remaining length) pairs
+  Complex *twiddles;                  // exp(∓2πik/n), k < n
+  Complex *rtw;       // forward plans: exp(-πik/n), k <= n (rfft of 2n reals)
+  long bm;            // Bluestein: padded power-of-two length, 0 if unused
+  Complex *chirp;     // Bluestein: exp(∓πik²/n), k < n
+  Complex *chirp_fft; // Bluestein: FFT_bm of the conjugate chirp, scaled 1/bm
+  struct FftPlan *sub_fwd;
+  struct FftPlan *sub_inv;
+  struct FftPlan *next;
+} FftPlan;
+
+static FftPlan *fft_plan_cache = NULL;
+static pthread_mutex_t fft_plan_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static inline Complex fft_cmul(Complex a, Complex b) {
+  Complex r = {a.real * b.real - a.imag * b.imag,
+               a.real * b.imag + a.imag * b.real};
+  return r;
+}
+
+static inline Complex fft_cadd(Complex a, Complex b) {
+  Complex r = {a.real + b.real, a.imag + b.imag};
+  return r;
+}
+
+static inline Complex fft_csub(Complex a, Complex b) {
+  Complex r = {a.real - b.real, a.imag - b.imag};
+  return r;
+}
+
+// Split n into radices, 4s first, then 2, 3, 5, ... Returns 0 when a prime
+// factor is too large for the direct butterflies.
+static int fft_factor(long n, long *factors) {
+  long p = 4;
+  double floor_sqrt = floor(sqrt((double)n));
+  int count = 0;
+  do {
+    while (n % p) {
+      switch (p) {
+        case 4: p = 2; break;
+        case 2: p = 3; break;
+        default: p += 2; break;
+      }
+      if (p > floor_sqrt) p = n;  // no more factors, n is prime
+    }
+    if (p > FFT_MAX_RADIX || count == FFT_MAX_FACTORS) return 0;
+    n /= p;
+    *factors++ = p;
+    *factors++ = n;
+    count++;
+  } while (n > 1);
+  return 1;
+}
+
+static FftPlan *fft_plan_locked(long n, int inverse);
+static void fft_exec(const FftPlan *p, Complex *data, Complex *work);
+
+static void fft_plan_bluestein(FftPlan *p) {
+  long n = p->n;
+  long m = 1;
+  while (m < 2 * n - 1) m <<= 1;
+  p->bm = m;
+  p->sub_fwd = fft_plan_locked(m, 0);
+  p->sub_inv = fft_plan_locked(m, 1);
+
+  double sign = p->inverse ? 1.0 : -1.0;
+  p->chirp = (Complex *)malloc(n * sizeof(Complex));
+  for (long k = 0; k < n; k++) {
+    // k² mod 2n keeps the angle small, so large k do not lose precision.
+    long k2 = (long)(((unsigned long long)k * k) % (2ULL * n));
+    double phase = sign * M_PI * (double)k2 / (double)n;
+    p->chirp[k].real = cos(phase);
+    p->chirp[k].imag = sin(phase);
+  }
+
+  p->chirp_fft = (Complex *)calloc(m, sizeof(Complex));
+  double scale = 1.0 / (double)m;
+  for (long k = 0; k < n; k++) {
+    Complex c = {p->chirp[k].real * scale, -p->chirp[k].imag * scale};
+    p->chirp_fft[k] = c;
+    if (k > 0) p->chirp_fft[m - k] = c;
+  }
+  Complex *work = (Complex *)malloc(m * sizeof(Complex));
+  fft_exec(p->sub_fwd, p->chirp_fft, work);
+  free(work);
+}
+
+// Caller holds fft_plan_lock.
+static FftPlan *fft_plan_locked(long n, int inverse) {
+  for (FftPlan *p = fft_plan_cache; p; p = p->next) {
+    if (p->n == n && p->inverse == inverse) return p;
+  }
+
+  FftPlan *p = (FftPlan *)calloc(1, sizeof(FftPlan));
+  p->n = n;
+  p->inverse = inverse;
+
+  double sign = inverse ? 1.0 : -1.0;
+  p->twiddles = (Complex *)malloc(n * sizeof(Complex));
+  for (long k = 0; k < n; k++) {
+    double phase = sign * 2.0 * M_PI * (double)k / (double)n;
+    p->twiddles[k].real = cos(phase);
+    p->twiddles[k].imag = sin(phase);
+  }
+  if (!inverse) {
+    p->rtw = (Complex *)malloc((n + 1) * sizeof(Complex));
+    for (long k = 0; k <= n; k++) {
+      double phase = -M_PI * (double)k / (double)n;
+      p->rtw[k].real = cos(phase);
+      p->rtw[k].imag = sin(phase);
+    }
+  }
+
+  if (!fft_factor(n, p->factors)) fft_plan_bluestein(p);
+
+  p->next = fft_plan_cache;
+  fft_plan_cache = p;
+  return p;
+}
+
+static FftPlan *fft_get_plan(long n, int inverse) {
+  pthread_mutex_lock(&fft_plan_lock);
+  FftPlan *p = fft_plan_locked(n, inverse);
+  pthread_mutex_unlock(&fft_plan_lock);
+  return p;
+}
+
+// Scratch elements fft_exec needs for a plan.
+static long fft_work_size(const FftPlan *p) {
+  return p->bm ? 2 * p->bm : p->n;
+}
+
+static void fft_bfly2(Complex *f, long fstride, const FftPlan *p, long m) {
+  Complex *f2 = f + m;
+  const Complex *tw = p->twiddles;
+  for (long k = 0; k < m; k++) {
+    Complex t = fft_cmul(f2[k], tw[k * fstride]);
+    f2[k] = fft_csub(f[k], t);
+    f[k] = fft_cadd(f[k], t);
+  }
+}
+
+static void fft_bfly3(Complex *f, long fstride, const FftPlan *p, long m) {
+  const Complex *tw = p->twiddles;
+  double epi3 = tw[fstride * m].imag;
+  for (long k = 0; k < m; k++) {
+    Complex s1 = fft_cmul(f[k + m], tw[k * fstride]);
+    Complex s2 = fft_cmul(f[k + 2 * m], tw[2 * k * fstride]);
+    Complex s3 = fft_cadd(s1, s2);
+    Complex s0 = fft_csub(s1, s2);
+    Complex a = {f[k].real - 0.5 * s3.real, f[k].imag - 0.5 * s3.imag};
+    s0.real *= epi3;
+    s0.imag *= epi3;
+    f[k] = fft_cadd(f[k], s3);
+    f[k + 2 * m].real = a.real + s0.imag;
+    f[k + 2 * m].imag = a.imag - s0.real;
+    f[k + m].real = a.real - s0.imag;
+    f[k + m].imag = a.imag + s0.real;
+  }
+}
+
+static void fft_bfly4(Complex *f, long fstride, const FftPlan *p, long m) {
+  const Complex *tw = p->twiddles;
+  for (long k = 0; k < m; k++) {
+    Complex s0 = fft_cmul(f[k + m], tw[k * fstride]);
+    Complex s1 = fft_cmul(f[k + 2 * m], tw[2 * k * fstride]);
+    Complex s2 = fft_cmul(f[k + 3 * m], tw[3 * k * fstride]);
+    Complex s5 = fft_csub(f[k], s1);
+    Complex f0 = fft_cadd(f[k], s1);
+    Complex s3 = fft_cadd(s0, s2);
+    Complex s4 = fft_csub(s0, s2);
+    f[k + 2 * m] = fft_csub(f0, s3);
+    f[k] = fft_cadd(f0, s3);
+    if (p->inverse) {
+      f[k + m].real = s5.real - s4.imag;
+      f[k + m].imag = s5.imag + s4.real;
+      f[k + 3 * m].real = s5.real + s4.imag;
+      f[k + 3 * m].imag = s5.imag - s4.real;
+    } else {
+      f[k + m].real = s5.real + s4.imag;
+      f[k + m].imag = s5.imag - s4.real;
+      f[k + 3 * m].real = s5.real - s4.imag;
+      f[k + 3 * m].imag = s5.imag + s4.real;
+    }
+  }
+}
+
+static void fft_bfly_generic(Complex *f, long fstride, const FftPlan *p,
+                             long m, long radix) {
+  const Complex *tw = p->twiddles;
+  Complex scratch[FFT_MAX_RADIX];
+  for (long u = 0; u < m; u++) {
+    for (long q = 0; q < radix; q++) scratch[q] = f[u + q * m];
+    for (long q1 = 0; q1 < radix; q1++) {
+      long k = u + q1 * m;
+      long step = fstride * k % p->n;
+      long twidx = 0;
+      Complex acc = scratch[0];
+      for (long q = 1; q < radix; q++) {
+        twidx += step;
+        if (twidx >= p->n) twidx -= p->n;
+        acc = fft_cadd(acc, fft_cmul(scratch[q], tw[twidx]));
+      }
+      f[k] = acc;
+    }
+  }
+}
+
+// Out-of-place recursive pass: out[0..n) = DFT of in[0], in[s], in[2s], ...
+static void fft_work(const FftPlan *p, Complex *out, const Complex *in,
+                     long fstride, const long *factors) {
+  long radix = factors[0];
+  long m = factors[1];
+  if (m == 1) {
+    for (long k = 0; k < radix; k++) out[k] = in[k * fstride];
+  } else {
+    for (long q = 0; q < radix; q++) {
+      fft_work(p, out + q * m, in + q * fstride, fstride * radix, factors + 2);
+    }
+  }
+  switch (radix) {
+    case 2: fft_bfly2(out, fstride, p, m); break;
+    case 3: fft_bfly3(out, fstride, p, m); break;
+    case 4: fft_bfly4(out, fstride, p, m); break;
+    default: fft_bfly_generic(out, fstride, p, m, radix); break;
+  }
+}
+
+// Unscaled transform of data[0..n) in place; work holds fft_work_size(p).
+static void fft_exec(const FftPlan *p, Complex *data, Complex *work) {
+  long n = p->n;
+  if (n <= 1) return;
+
+  if (!p->bm) {
+    memcpy(work, data, n * sizeof(Complex));
+    fft_work(p, data, work, 1, p->factors);
+    return;
+  }
+
+  // Bluestein: X = chirp · IFFT(FFT(x · chirp) · FFT(conj chirp))
+  long m = p->bm;
+  Complex *a = work;
+  Complex *inner = work + m;
+  for (long k = 0; k < n; k++) a[k] = fft_cmul(data[k], p->chirp[k]);
+  memset(a + n, 0, (m - n) * sizeof(Complex));
+  fft_exec(p->sub_fwd, a, inner);
+  for (long k = 0; k < m; k++) a[k] = fft_cmul(a[k], p->chirp_fft[k]);
+  fft_exec(p->sub_inv, a, inner);
+  for (long k = 0; k < n; k++) data[k] = fft_cmul(a[k], p->chirp[k]);
+}
+
+// --- Batched row / column passes ---
+
+typedef struct {
+  const FftPlan *plan;
+  Complex *data;
+  long rows;
+  long cols;
+  int along_cols;  // 0: transform each row, 1: transform each column
+  double scale;
+  long begin;      // first row (or column) of this worker's slice
+  long end;
+} FftBatch;
+
+static void *fft_batch_worker(void *arg) {
+  FftBatch *b = (FftBatch *)arg;
+  long len = b->plan->n;
+  Complex *work = (Complex *)malloc(fft_work_size(b->plan) * sizeof(Complex));
+  Complex *line = b->along_cols ? (Complex *)malloc(len * sizeof(Complex)) : NULL;
+
+  for (long i = b->begin; i < b->end; i++) {
+    Complex *v;
+    if (b->along_cols) {
+      for (long r = 0; r < len; r++) line[r] = b->data[r * b->cols + i];
+      v = line;
+    } else {
+      v = b->data + i * b->cols;
+    }
+    fft_exec(b->plan, v, work);
+    if (b->scale != 1.0) {
+      for (long k = 0; k < len; k++) {
+        v[k].real *= b->scale;
+        v[k].imag *= b->scale;
+      }
+    }
+    if (b->along_cols) {
+      for (long r = 0; r < len; r++) b->data[r * b->cols + i] = line[r];
+    }
+  }
+
+  free(line);
+  free(work);
+  return NULL;
+}
+
+// Transform every row (or column) of a rows × cols buffer, splitting the
+// lines across threads once the batch is large enough to pay for them.
+static void fft_batch(Complex *data, long rows, long cols, int along_cols,
+                      int inverse) {
+  long len = along_cols ? rows : cols;
+  long count = along_cols ? cols : rows;
+  if (len <= 1 || count == 0) return;
+
+  FftBatch base = {fft_get_plan(len, inverse), data, rows, cols, along_cols,
+                   inverse ? 1.0 / (double)len : 1.0, 0, count};
+
+  long nthreads = 1;
+  if (rows * cols >= FFT_PARALLEL_MIN) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = ncpu < 1 ? 1 : ncpu;
+    if (nthreads > FFT_MAX_THREADS) nthreads = FFT_MAX_THREADS;
+    if (nthreads > count) nthreads = count;
+  }
+  if (nthreads == 1) {
+    fft_batch_worker(&base);
+    return;
+  }
+
+  FftBatch slices[FFT_MAX_THREADS];
+  pthread_t threads[FFT_MAX_THREADS];
+  int started[FFT_MAX_THREADS] = {0};
+  for (long t = 0; t < nthreads; t++) {
+    slices[t] = base;
+    slices[t].begin = count * t / nthreads;
+    slices[t].end = count * (t + 1) / nthreads;
+  }
+  for (long t = 1; t < nthreads; t++) {
+    started[t] =
+        pthread_create(&threads[t], NULL, fft_batch_worker, &slices[t]) == 0;
+    if (!started[t]) fft_batch_worker(&slices[t]);
+  }
+  fft_batch_worker(&slices[0]);
+  for (long t = 1; t < nthreads; t++) {
+    if (started[t]) pthread_join(threads[t], NULL);
+  }
+}
+
+static ComplexMatrix *complexmatrix_copy(ComplexMatrix *m) {
+  ComplexMatrix *out = complexmatrix_new(m->rows, m->cols);
+  memcpy(out->data, m->data, m->rows * m->cols * sizeof(Complex));
+  return out;
+}
+
+// --- Public API ---
+
+// Promote a real Matrix / IntMatrix to complex (imaginary parts zero).
+ComplexMatrix *complexmatrix_from_real(Matrix *m) {
+  ComplexMatrix *out = complexmatrix_new(m->rows, m->cols);
+  long n = m->rows * m->cols;
+  for (long i = 0; i < n; i++) out->data[i].real = m->data[i];
+  return out;
+}
+
+ComplexMatrix *complexmatrix_from_intmatrix(IntMatrix *m) {
+  ComplexMatrix *out = complexmatrix_new(m->rows, m->cols);
+  long n = m->rows * m->cols;
+  for (long i = 0; i < n; i++) out->data[i].real = (double)m->data[i];
+  return out;
+}
+
+// fft/ifft transform each row, so a 1×n vector is a plain 1D transform
+// and an r×n matrix is r independent signals. ifft scales by 1/n.
+ComplexMatrix *math_fft(ComplexMatrix *x) {
+  ComplexMatrix *out = complexmatrix_copy(x);
+  fft_batch(out->data, out->rows, out->cols, 0, 0);
+  return out;
+}
+
+ComplexMatrix *math_ifft(ComplexMatrix *x) {
+  ComplexMatrix *out = complexmatrix_copy(x);
+  fft_batch(out->data, out->rows, out->cols, 0, 1);
+  return out;
+}
+
+// In-place variants overwrite x instead of allocating a result.
+void math_fft_inplace(ComplexMatrix *x) {
+  fft_batch(x->data, x->rows, x->cols, 0, 0);
+}
+
+void math_ifft_inplace(ComplexMatrix *x) {
+  fft_batch(x->data, x->rows, x->cols, 0, 1);
+}
+
+// 2D transforms: every row, then every column.
+ComplexMatrix *math_fft2(ComplexMatrix *x) {
+  ComplexMatrix *out = complexmatrix_copy(x);
+  fft_batch(out->data, out->rows, out->cols, 0, 0);
+  fft_batch(out->data, out->rows, out->cols, 1, 0);
+  return out;
+}
+
+ComplexMatrix *math_ifft2(ComplexMatrix *x) {
+  ComplexMatrix *out = complexmatrix_copy(x);
+  fft_batch(out->data, out->rows, out->cols, 0, 1);
+  fft_batch(out->data, out->rows, out->cols, 1, 1);
+  return out;
+}
+
+// Real-input FFT of each row: the n/2+1 non-redundant bins. Even lengths
+// pack the row into an n/2-point complex transform and untangle the
+// even/odd halves; odd lengths fall back to a full complex transform.
+ComplexMatrix *math_rfft(Matrix *x) {
+  long n = x->cols;
+  long bins = n / 2 + 1;
+  ComplexMatrix *out = complexmatrix_new(x->rows, n > 0 ? bins : 0);
+  if (n == 0) return out;
+
+  long half = n / 2;
+  int packed = n % 2 == 0;
+  FftPlan *p = fft_get_plan(packed ? half : n, 0);
+  long buf_len = packed ? half : n;
+  Complex *z = (Complex *)malloc(buf_len * sizeof(Complex));
+  Complex *work = (Complex *)malloc(fft_work_size(p) * sizeof(Complex));
+
+  for (long r = 0; r < x->rows; r++) {
+    const double *row = x->data + r * n;
+    Complex *dst = out->data + r * bins;
+    if (!packed) {
+      for (long k = 0; k < n; k++) {
+        z[k].real = row[k];
+        z[k].imag = 0.0;
+      }
+      fft_exec(p, z, work);
+      memcpy(dst, z, bins * sizeof(Complex));
+      continue;
+    }
+
+    for (long k = 0; k < half; k++) {
+      z[k].real = row[2 * k];
+      z[k].imag = row[2 * k + 1];
+    }
+    fft_exec(p, z, work);
+    for (long k = 0; k <= half; k++) {
+      Complex zk = z[k % half];
+      Complex zc = z[(half - k) % half];
+      zc.imag = -zc.imag;
+      Complex even = {0.5 * (zk.real + zc.real), 0.5 * (zk.imag + zc.imag)};
+      // odd = (zk - zc) / 2i
+      Complex odd = {0.5 * (zk.imag - zc.imag), -0.5 * (zk.real - zc.real)};
+      dst[k] = fft_cadd(even, fft_cmul(p->rtw[k], odd));
+    }
+  }
+
+  free(work);
+  free(z);
+  return out;
+}
+
+// ==========================================
+// SECTION 1: ERROR HANDLING (v1.1)
+// ==========================================
+
+typedef struct {
+    char* message;
+} BrixError;
+
+// Create a new error with a message
+BrixError* brix_error_new(char* msg) {
     if (msg == NULL) {
         return NULL;  // nil error
     }
@@ -1963,74 +4291,688 @@ void brix_error_free(BrixError* err) {
 // SECTION 2: STRINGS (v0.4)
 // ==========================================
 
-typedef struct {
+struct BrixSliceSet;
+
+typedef struct BrixString {
   long ref_count;  // ARC reference counting
   long len;
   char *data;
+  long capacity;   // bytes allocated at data (v1.9); 0 if data is not owned
+  // Slices (v1.9): a slice's data points into its owner's buffer and is
+  // not NUL-terminated; see "String slices" below.
+  struct BrixString *owner;  // NULL unless this string is a slice
+  union {
+    struct BrixSliceSet *slices;  // owner: live slices of this buffer, or NULL
+    long slot;                    // slice: its index in owner->slices
+  };
+  long hash;  // cached str_hash (v1.9); 0 until first computed
+  struct BrixStrIndex *cps;  // code-point index (v1.9), built lazily; or NULL
 } BrixString;
 
+// Inline data (v1.9): a string whose length is known when it is created is
+// one allocation, the header immediately followed by its len + 1 bytes, and
+// data points just past the header. Only buffers adopted from a builder or
+// the f-string formatter, and strings grown by str_append_inplace, keep a
+// separate heap buffer. Everything reads the bytes through data, so the two
+// layouts look the same to callers and to compiled code.
+static BrixString *str_alloc(long len) {
+  BrixString *s = (BrixString *)malloc(sizeof(BrixString) + len + 1);
+  s->ref_count = 1;  // Initialize ARC
+  s->len = len;
+  s->data = (char *)(s + 1);
+  s->capacity = len + 1;
+  s->owner = NULL;
+  s->slices = NULL;
+  s->hash = 0;
+  s->cps = NULL;
+  s->data[len] = '\0';
+  return s;
+}
+
+static int str_is_inline(const BrixString *s) {
+  return s->data == (const char *)(s + 1);
+}
+
 // Create a new string copying a C literal (e.g: "ola")
 BrixString *str_new(char *raw_text) {
-  BrixString *s = (BrixString *)malloc(sizeof(BrixString));
-  s->ref_count = 1;  // Initialize ARC
-  if (raw_text == NULL) {
-    s->len = 0;
-    s->data = (char *)malloc(1);
-    s->data[0] = '\0';
-  } else {
-    s->len = strlen(raw_text);
-    s->data = (char *)malloc(s->len + 1); // +1 para o \0
-    strcpy(s->data, raw_text);
-  }
+  long len = raw_text ? (long)strlen(raw_text) : 0;
+  BrixString *s = str_alloc(len);
+  if (len > 0) memcpy(s->data, raw_text, len);
   return s;
 }
 
 // Concatenate two strings (a + b)
 BrixString *str_concat(BrixString *a, BrixString *b) {
-  BrixString *s = (BrixString *)malloc(sizeof(BrixString));
-  s->ref_count = 1;  // Initialize ARC
-  s->len = a->len + b->len;
+  BrixString *s = str_alloc(a->len + b->len);
 
-  // Allocate space for both strings
-  s->data = (char *)malloc(s->len + 1);
-
-  strcpy(s->data, a->data);
-  strcat(s->data, b->data);
+  memcpy(s->data, a->data, a->len);
+  memcpy(s->data + a->len, b->data, b->len);
+  s->data[s->len] = '\0';
 
   return s;
 }
 
+// String literals (v1.9) are compiled to constant global BrixStrings with
+// ref_count BRIX_RC_STATIC: they are never freed, and retain/release skip
+// them. No runtime function writes into its argument strings, so sharing the
+// one constant across every evaluation of the literal is safe.
+
+// ==========================================
+// String slices (v1.9)
+// ==========================================
+// substring, trim/ltrim/rtrim, char_at and split return slices: a
+// BrixString whose data points into another string's buffer (its owner)
+// instead of a fresh copy. Slices of slices point into the same owner, and
+// slices of static literals just reference the literal.
+//
+// A heap owner keeps a set of its live slices (the slices hold no ref_count
+// on it). When the owner's last reference goes away while slices are still
+// alive, it is freed only if it is much larger than what they still use:
+// each slice then copies its bytes out ("compaction"). Otherwise the buffer
+// stays until the last slice is released. Splitting a big file into fields
+// therefore shares the file's buffer, and keeping a few fields of a dropped
+// file does not pin all of it.
+//
+// Slice data is not NUL-terminated. Runtime functions use len; code that
+// needs a C string calls brix_str_cstr, which compacts a slice in place.
+//
+// Results of at most STR_SLICE_MIN_COPY bytes are plain copies instead: a
+// copy with inline data is a single allocation, just like a slice header,
+// but needs no set bookkeeping and never pins its source. Most CSV fields
+// and tokens fall in this range.
+
+#define STR_SLICE_COMPACT_RATIO 4  // owner bytes per live slice byte
+#define STR_SLICE_MIN_COPY 15      // shorter results are copied, not sliced
+
+typedef struct BrixSliceSet {
+  long len, cap;
+  long live_bytes;  // sum of the slices' lengths
+  BrixString **items;
+} BrixSliceSet;
+
+static void str_owner_free(BrixString *owner) {
+  if (owner->slices) {
+    free(owner->slices->items);
+    free(owner->slices);
+  }
+  if (!str_is_inline(owner)) free(owner->data);
+  free(owner->cps);
+  free(owner);
+}
+
+// Give a slice its own NUL-terminated copy of its bytes (no set bookkeeping).
+static void str_slice_copy_out(BrixString *slice) {
+  char *copy = (char *)malloc(slice->len + 1);
+  memcpy(copy, slice->data, slice->len);
+  copy[slice->len] = '\0';
+  slice->data = copy;
+  slice->capacity = slice->len + 1;
+  slice->owner = NULL;
+  slice->slices = NULL;
+}
+
+// An owner nothing else references: free it unless its live slices still
+// use a fair share of the buffer, compacting them first.
+static void str_owner_settle(BrixString *owner) {
+  BrixSliceSet *set = owner->slices;
+  if (set && set->len > 0) {
+    if (owner->len <= STR_SLICE_COMPACT_RATIO * set->live_bytes) return;
+    for (long i = 0; i < set->len; i++) str_slice_copy_out(set->items[i]);
+  }
+  str_owner_free(owner);
+}
+
+// Unlink a slice from its owner's set; its data must not be used afterwards.
+static void str_slice_detach(BrixString *slice) {
+  BrixString *owner = slice->owner;
+  long slot = slice->slot;
+  slice->owner = NULL;
+  slice->slices = NULL;
+  if (owner->ref_count == BRIX_RC_STATIC) return;
+  BrixSliceSet *set = owner->slices;
+  BrixString *moved = set->items[--set->len];
+  set->items[slot] = moved;
+  moved->slot = slot;
+  set->live_bytes -= slice->len;
+  if (owner->ref_count == 0) str_owner_settle(owner);
+}
+
+static void str_slice_compact(BrixString *slice) {
+  char *copy = (char *)malloc(slice->len + 1);
+  memcpy(copy, slice->data, slice->len);
+  copy[slice->len] = '\0';
+  str_slice_detach(slice);
+  slice->data = copy;
+  slice->capacity = slice->len + 1;
+}
+
+// New string for bytes [start, start + len) of s, sharing s's buffer
+// unless it is short.
+static BrixString *str_slice(BrixString *s, long start, long len) {
+  if (start == 0 && len == s->len) {
+    // The whole string: share the object itself.
+    if (s->ref_count != BRIX_RC_STATIC) s->ref_count++;
+    return s;
+  }
+  if (len <= STR_SLICE_MIN_COPY) {
+    BrixString *copy = str_alloc(len);
+    memcpy(copy->data, s->data + start, len);
+    return copy;
+  }
+  BrixString *owner = s->owner ? s->owner : s;
+  BrixString *r = (BrixString *)malloc(sizeof(BrixString));
+  r->ref_count = 1;
+  r->len = len;
+  r->data = s->data + start;
+  r->capacity = 0;
+  r->owner = owner;
+  r->slot = 0;
+  r->hash = 0;
+  r->cps = NULL;
+  if (owner->ref_count != BRIX_RC_STATIC) {
+    BrixSliceSet *set = owner->slices;
+    if (set == NULL) {
+      set = (BrixSliceSet *)malloc(sizeof(BrixSliceSet));
+      set->len = 0;
+      set->cap = 4;
+      set->live_bytes = 0;
+      set->items = (BrixString **)malloc(set->cap * sizeof(BrixString *));
+      owner->slices = set;
+    }
+    if (set->len == set->cap) {
+      set->cap *= 2;
+      set->items = (BrixString **)realloc(set->items, set->cap * sizeof(BrixString *));
+    }
+    r->slot = set->len;
+    set->items[set->len++] = r;
+    set->live_bytes += len;
+  }
+  return r;
+}
+
+// NUL-terminated bytes of s, for C APIs (printf, atoi, ...). Compacts a
+// slice first; any other string already ends in a NUL.
+char *brix_str_cstr(BrixString *s) {
+  if (s->owner) str_slice_compact(s);
+  return s->data;
+}
+
 // ARC: Increment reference count
 void* string_retain(BrixString* str) {
-    if (!str) return NULL;
+    if (!str || str->ref_count == BRIX_RC_STATIC) return str;
     str->ref_count++;
     return str;
 }
 
 // ARC: Decrement reference count and free if zero
 void string_release(BrixString* str) {
-    if (!str) return;
+    if (!str || str->ref_count == BRIX_RC_STATIC) return;
     str->ref_count--;
 
     if (str->ref_count == 0) {
-        if (str->data) {
-            free(str->data);
+        if (str->owner) {
+            str_slice_detach(str);
+            free(str->cps);
+            free(str);
+        } else {
+            str_owner_settle(str);
         }
-        free(str);
     }
 }
 
-// Compare equality (a == b) -> Returns 1 (true) or 0 (false)
+// ==========================================
+// String hashing (v1.9)
+// ==========================================
+// A wyhash-style hash: 16 bytes per step, each folded through a
+// 64x64->128-bit multiply. A string caches its hash in s->hash the first
+// time it is asked for. Strings never change after creation, except through
+// str_append_inplace, which clears the cache. Literal headers are read-only
+// constants, so the compiler precomputes their hash with an identical
+// function (brix_string_hash in crates/codegen); keep the two in sync.
+
+#include <stdint.h>
+
+static inline uint64_t str_hash_read64(const char *p) {
+  uint64_t v;
+  memcpy(&v, p, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap64(v);
+#endif
+  return v;
+}
+
+static inline uint64_t str_hash_mum(uint64_t a, uint64_t b) {
+  __uint128_t r = (__uint128_t)a * b;
+  return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+static uint64_t str_hash_bytes(const char *p, long n) {
+  const uint64_t k0 = 0xa0761d6478bd642fULL, k1 = 0xe7037ed1a0b428dbULL;
+  const uint64_t k2 = 0x8ebc6af09c88c6e3ULL, k3 = 0x589965cc75374cc3ULL;
+  uint64_t h = k0 ^ (uint64_t)n;
+  long i = 0;
+  for (; i + 16 <= n; i += 16) {
+    h = str_hash_mum(str_hash_read64(p + i) ^ k1, str_hash_read64(p + i + 8) ^ h);
+  }
+  // 0..15 trailing bytes; 8..15 are read as two overlapping words.
+  uint64_t a = 0, b = 0;
+  long rem = n - i;
+  if (rem >= 8) {
+    a = str_hash_read64(p + i);
+    b = str_hash_read64(p + n - 8);
+  } else {
+    for (long j = 0; j < rem; j++) a |= (uint64_t)(unsigned char)p[i + j] << (8 * j);
+  }
+  h = str_hash_mum(a ^ k2, b ^ h);
+  h = str_hash_mum(h ^ k3, (uint64_t)n ^ k1);
+  return h ? h : 1;  // 0 is reserved for "not computed"
+}
+
+static long str_hash(BrixString *s) {
+  if (s->hash == 0) s->hash = (long)str_hash_bytes(s->data, s->len);
+  return s->hash;
+}
+
+// Compare equality (a == b) -> Returns 1 (true) or 0 (false). Length first,
+// then any already-cached hashes, then the bytes.
 long str_eq(BrixString *a, BrixString *b) {
+  if (a == b) return 1;
   if (a->len != b->len)
     return 0; // Tamanhos diferentes = diferente
-  return (strcmp(a->data, b->data) == 0) ? 1 : 0;
+  if (a->hash && b->hash && a->hash != b->hash) return 0;
+  return (memcmp(a->data, b->data, a->len) == 0) ? 1 : 0;
+}
+
+// ==========================================
+// F-strings (v1.9)
+// ==========================================
+// brix_fstring builds a whole f-string in one buffer: text and string parts
+// are copied once, integers go through a two-digits-per-step formatter, and
+// floats take an exact fast path for the common shapes before falling back
+// to snprintf written straight into the buffer. The compiler passes one
+// BrixFmtPart per piece, laid out as four i64 so codegen can fill them with
+// plain stores.
+
+enum {
+  FMT_STR = 0,        // value: BrixString*, borrowed
+  FMT_STR_OWNED = 1,  // value: BrixString*, released once copied
+  FMT_INT = 2,        // conv: 'd' 'x' 'X' 'o'
+  FMT_FLOAT = 3       // conv: 'g' 'G' 'f' 'e' 'E'; prec < 0 means default (6)
+};
+
+typedef struct {
+  long kind;
+  long conv;
+  long prec;
+  long value;  // int, bits of a double, or a BrixString*
+} BrixFmtPart;
+
+static const char fmt_digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Write the decimal digits of u ending just before `end`; returns the start.
+static char *fmt_u64_dec(char *end, unsigned long long u) {
+  while (u >= 100) {
+    unsigned long long q = u / 100;
+    end -= 2;
+    memcpy(end, fmt_digit_pairs + 2 * (u - q * 100), 2);
+    u = q;
+  }
+  if (u >= 10) {
+    end -= 2;
+    memcpy(end, fmt_digit_pairs + 2 * u, 2);
+  } else {
+    *--end = (char)('0' + u);
+  }
+  return end;
+}
+
+static long fmt_int(char *out, long v, long conv) {
+  char tmp[24];
+  char *end = tmp + sizeof(tmp);
+  char *p;
+  if (conv == 'x' || conv == 'X' || conv == 'o') {
+    const char *hex = (conv == 'X') ? "0123456789ABCDEF" : "0123456789abcdef";
+    unsigned long long u = (unsigned long long)v;
+    int shift = (conv == 'o') ? 3 : 4;
+    unsigned long long mask = (conv == 'o') ? 7 : 15;
+    p = end;
+    do {
+      *--p = hex[u & mask];
+      u >>= shift;
+    } while (u);
+  } else {
+    unsigned long long u = (v < 0) ? 0ULL - (unsigned long long)v : (unsigned long long)v;
+    p = fmt_u64_dec(end, u);
+    if (v < 0) *--p = '-';
+  }
+  long n = (long)(end - p);
+  memcpy(out, p, n);
+  return n;
+}
+
+// Write m as a decimal with `frac` digits after the point (frac <= 15).
+static long fmt_fixed_digits(char *out, int neg, unsigned long long m, int frac) {
+  static const unsigned long long pow10[16] = {
+      1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+      100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+      1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL};
+  char *o = out;
+  if (neg) *o++ = '-';
+  char tmp[24];
+  char *end = tmp + sizeof(tmp);
+  char *p = fmt_u64_dec(end, m / pow10[frac]);
+  memcpy(o, p, end - p);
+  o += end - p;
+  if (frac > 0) {
+    *o++ = '.';
+    unsigned long long f = m % pow10[frac];
+    for (int i = frac - 1; i >= 0; i--) {
+      o[i] = (char)('0' + f % 10);
+      f /= 10;
+    }
+    o += frac;
+  }
+  return (long)(o - out);
+}
+
+// %g with the default 6 significant digits, exactly, for values that are a
+// short decimal in [1e-4, 1e6): x * 10^k lands on an integer m < 10^6, and
+// since x is then within 2^-33 of m / 10^k - far inside half a unit of the
+// sixth digit - printf would print those same digits. Returns -1 otherwise.
+static long fmt_g6_fast(char *out, double x) {
+  if (x == 0.0) {
+    if (signbit(x)) {
+      memcpy(out, "-0", 2);
+      return 2;
+    }
+    out[0] = '0';
+    return 1;
+  }
+  double ax = fabs(x);
+  if (!(ax >= 1e-4 && ax < 1e6)) return -1;
+  double scale = 1.0;
+  for (int k = 0; k <= 9; k++, scale *= 10.0) {
+    double y = ax * scale;
+    if (y >= 1e6) return -1;
+    if (y == (double)(long)y) {
+      unsigned long long m = (unsigned long long)y;
+      while (k > 0 && m % 10 == 0) {
+        m /= 10;
+        k--;
+      }
+      return fmt_fixed_digits(out, x < 0, m, k);
+    }
+  }
+  return -1;
+}
+
+// %.Nf, exactly, when x * 10^N is below 2^50 and not within rounding error
+// of a .5 tie: the correctly rounded result is then nearest(x * 10^N).
+static long fmt_f_fast(char *out, double x, int prec) {
+  static const double pow10[16] = {1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                   1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+  if (prec > 15) return -1;
+  double y = fabs(x) * pow10[prec];
+  if (!(y < 0x1p50)) return -1;
+  double whole = floor(y);
+  double frac = y - whole;
+  if (fabs(frac - 0.5) <= y * 0x1p-52) return -1;
+  unsigned long long m = (unsigned long long)whole + (frac > 0.5);
+  return fmt_fixed_digits(out, signbit(x) != 0, m, prec);
+}
+
+static void fmt_reserve(char **buf, long *cap, long len, long need) {
+  if (len + need <= *cap) return;
+  long new_cap = *cap * 2;
+  if (new_cap < len + need) new_cap = len + need;
+  *buf = (char *)realloc(*buf, new_cap);
+  *cap = new_cap;
+}
+
+// Format x with printf conversion `conv` and precision `prec` at buf + len,
+// growing the buffer if needed; returns the number of chars written.
+static long fmt_float(char **buf, long *cap, long len, double x, long conv, int prec) {
+  long w = -1;
+  fmt_reserve(buf, cap, len, 32);
+  if (conv == 'g' && prec == 6) {
+    w = fmt_g6_fast(*buf + len, x);
+  } else if (conv == 'f') {
+    w = fmt_f_fast(*buf + len, x, prec);
+  }
+  if (w < 0) {
+    char spec[5] = {'%', '.', '*', (char)conv, '\0'};
+    w = snprintf(*buf + len, *cap - len, spec, prec, x);
+    if (w >= *cap - len) {
+      fmt_reserve(buf, cap, len, w + 1);
+      snprintf(*buf + len, *cap - len, spec, prec, x);
+    }
+  }
+  return w;
+}
+
+BrixString *brix_fstring(BrixFmtPart *parts, long n) {
+  // Strings are measured exactly; numbers get a guess that covers anything
+  // the fast paths produce, so the buffer normally never grows.
+  long cap = 1;
+  for (long i = 0; i < n; i++) {
+    if (parts[i].kind == FMT_STR || parts[i].kind == FMT_STR_OWNED) {
+      cap += ((BrixString *)parts[i].value)->len;
+    } else {
+      cap += 32;
+    }
+  }
+  char *buf = (char *)malloc(cap);
+  long len = 0;
+
+  for (long i = 0; i < n; i++) {
+    BrixFmtPart *p = &parts[i];
+    if (p->kind == FMT_STR || p->kind == FMT_STR_OWNED) {
+      BrixString *s = (BrixString *)p->value;
+      memcpy(buf + len, s->data, s->len);
+      len += s->len;
+      if (p->kind == FMT_STR_OWNED) string_release(s);
+    } else if (p->kind == FMT_INT) {
+      fmt_reserve(&buf, &cap, len, 24);
+      len += fmt_int(buf + len, p->value, p->conv);
+    } else {
+      double x;
+      memcpy(&x, &p->value, sizeof(x));
+      int prec = (p->prec < 0) ? 6 : (int)p->prec;
+      len += fmt_float(&buf, &cap, len, x, p->conv, prec);
+    }
+  }
+  buf[len] = '\0';
+
+  BrixString *s = (BrixString *)malloc(sizeof(BrixString));
+  s->ref_count = 1;
+  s->len = len;
+  s->data = buf;
+  s->capacity = cap;
+  s->owner = NULL;
+  s->slices = NULL;
+  s->hash = 0;
+  s->cps = NULL;
+  return s;
+}
+
+// s := s + x (v1.9). The compiler hands over its reference to s; when it is
+// the only one, x is appended into s's own buffer, which grows geometrically,
+// so a loop of self-appends is amortized O(total length). A shared s (or a
+// static literal, or a buffer that live slices point into) is left alone:
+// the result is a fresh copy with room to grow, and the caller's reference
+// to s is dropped.
+BrixString *str_append_inplace(BrixString *s, BrixString *x) {
+  long need = s->len + x->len + 1;
+  // capacity > 0 rules out slices, whose union holds a slot, not a set.
+  if (s->ref_count == 1 && s->capacity > 0 && !(s->slices && s->slices->len > 0)) {
+    if (need > s->capacity) {
+      long new_cap = s->capacity * 2;
+      if (new_cap < need) new_cap = need;
+      if (str_is_inline(s)) {
+        // Inline data is part of the header's block: move to a heap buffer.
+        char *grown = (char *)malloc(new_cap);
+        memcpy(grown, s->data, s->len);
+        s->data = grown;
+      } else {
+        s->data = (char *)realloc(s->data, new_cap);
+      }
+      s->capacity = new_cap;
+    }
+    memmove(s->data + s->len, x->data, x->len);
+    s->len += x->len;
+    s->data[s->len] = '\0';
+    s->hash = 0;
+    free(s->cps);
+    s->cps = NULL;
+    return s;
+  }
+
+  BrixString *r = (BrixString *)malloc(sizeof(BrixString));
+  r->ref_count = 1;
+  r->len = s->len + x->len;
+  r->capacity = need < 16 ? 16 : need * 2;
+  r->owner = NULL;
+  r->slices = NULL;
+  r->hash = 0;
+  r->cps = NULL;
+  r->data = (char *)malloc(r->capacity);
+  memcpy(r->data, s->data, s->len);
+  memcpy(r->data + s->len, x->data, x->len);
+  r->data[r->len] = '\0';
+  string_release(s);
+  return r;
+}
+
+// ==========================================
+// StringBuilder (v1.9)
+// ==========================================
+// A growable byte buffer for building strings piece by piece. Appends write
+// into spare capacity (doubling when full), numbers are formatted in place
+// with the f-string formatters, and build() hands the buffer itself to a new
+// BrixString - no copy - leaving the builder empty for reuse. The header
+// mirrors BrixString's { ref_count, len, data, capacity }.
+
+typedef struct {
+  long ref_count;
+  long len;
+  char *data;
+  long capacity;
+} BrixStringBuilder;
+
+BrixStringBuilder *brix_sb_new(long capacity) {
+  if (capacity < 0) {
+    fprintf(stderr, "Error: StringBuilder capacity must be non-negative, got %ld\n", capacity);
+    exit(1);
+  }
+  BrixStringBuilder *sb = (BrixStringBuilder *)malloc(sizeof(BrixStringBuilder));
+  sb->ref_count = 1;
+  sb->len = 0;
+  sb->capacity = capacity + 1;  // room for the NUL build() writes
+  sb->data = (char *)malloc(sb->capacity);
+  return sb;
+}
+
+void *stringbuilder_retain(BrixStringBuilder *sb) {
+  if (!sb) return NULL;
+  sb->ref_count++;
+  return sb;
+}
+
+void stringbuilder_release(BrixStringBuilder *sb) {
+  if (!sb) return;
+  sb->ref_count--;
+  if (sb->ref_count == 0) {
+    free(sb->data);
+    free(sb);
+  }
+}
+
+// Make room for `extra` more bytes plus the terminating NUL.
+void brix_sb_reserve(BrixStringBuilder *sb, long extra) {
+  if (extra < 0) {
+    fprintf(stderr, "Error: StringBuilder.reserve() expects a non-negative size, got %ld\n",
+            extra);
+    exit(1);
+  }
+  fmt_reserve(&sb->data, &sb->capacity, sb->len, extra + 1);
+}
+
+void brix_sb_append(BrixStringBuilder *sb, BrixString *s) {
+  fmt_reserve(&sb->data, &sb->capacity, sb->len, s->len + 1);
+  memcpy(sb->data + sb->len, s->data, s->len);
+  sb->len += s->len;
+}
+
+void brix_sb_append_int(BrixStringBuilder *sb, long v) {
+  fmt_reserve(&sb->data, &sb->capacity, sb->len, 25);
+  sb->len += fmt_int(sb->data + sb->len, v, 'd');
+}
+
+// Same text as f"{x}" (%g).
+void brix_sb_append_float(BrixStringBuilder *sb, double x) {
+  sb->len += fmt_float(&sb->data, &sb->capacity, sb->len, x, 'g', 6);
+}
+
+// Append a Unicode code point, UTF-8 encoded.
+void brix_sb_append_char(BrixStringBuilder *sb, long cp) {
+  if (cp < 0 || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+    fprintf(stderr, "Error: StringBuilder.append_char(): invalid code point %ld\n", cp);
+    exit(1);
+  }
+  fmt_reserve(&sb->data, &sb->capacity, sb->len, 5);
+  unsigned char *o = (unsigned char *)sb->data + sb->len;
+  if (cp < 0x80) {
+    o[0] = (unsigned char)cp;
+    sb->len += 1;
+  } else if (cp < 0x800) {
+    o[0] = (unsigned char)(0xC0 | (cp >> 6));
+    o[1] = (unsigned char)(0x80 | (cp & 0x3F));
+    sb->len += 2;
+  } else if (cp < 0x10000) {
+    o[0] = (unsigned char)(0xE0 | (cp >> 12));
+    o[1] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+    o[2] = (unsigned char)(0x80 | (cp & 0x3F));
+    sb->len += 3;
+  } else {
+    o[0] = (unsigned char)(0xF0 | (cp >> 18));
+    o[1] = (unsigned char)(0x80 | ((cp >> 12) & 0x3F));
+    o[2] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+    o[3] = (unsigned char)(0x80 | (cp & 0x3F));
+    sb->len += 4;
+  }
+}
+
+long brix_sb_len(BrixStringBuilder *sb) {
+  return sb->len;
+}
+
+BrixString *brix_sb_build(BrixStringBuilder *sb) {
+  fmt_reserve(&sb->data, &sb->capacity, sb->len, 1);
+  sb->data[sb->len] = '\0';
+
+  BrixString *s = (BrixString *)malloc(sizeof(BrixString));
+  s->ref_count = 1;
+  s->len = sb->len;
+  s->data = sb->data;
+  s->capacity = sb->capacity;
+  s->owner = NULL;
+  s->slices = NULL;
+  s->hash = 0;
+  s->cps = NULL;
+
+  sb->len = 0;
+  sb->data = NULL;
+  sb->capacity = 0;
+  return s;
 }
 
 // Helper to print Brix string (since printf expects char*, not struct)
 void print_brix_string(BrixString *s) {
   if (s && s->data) {
-    printf("%s", s->data);
+    fwrite(s->data, 1, s->len, stdout);
   } else {
     printf("(null)");
   }
@@ -2055,9 +4997,7 @@ BrixString* brix_uppercase(BrixString* str) {
         return str_new("");
     }
 
-    BrixString* result = (BrixString*)malloc(sizeof(BrixString));
-    result->len = str->len;
-    result->data = (char*)malloc(result->len + 1);
+    BrixString* result = str_alloc(str->len);
 
     for (long i = 0; i < str->len; i++) {
         result->data[i] = toupper((unsigned char)str->data[i]);
@@ -2074,9 +5014,7 @@ BrixString* brix_lowercase(BrixString* str) {
         return str_new("");
     }
 
-    BrixString* result = (BrixString*)malloc(sizeof(BrixString));
-    result->len = str->len;
-    result->data = (char*)malloc(result->len + 1);
+    BrixString* result = str_alloc(str->len);
 
     for (long i = 0; i < str->len; i++) {
         result->data[i] = tolower((unsigned char)str->data[i]);
@@ -2093,12 +5031,11 @@ BrixString* brix_capitalize(BrixString* str) {
         return str_new("");
     }
 
-    BrixString* result = (BrixString*)malloc(sizeof(BrixString));
-    result->len = str->len;
-    result->data = (char*)malloc(result->len + 1);
+    BrixString* result = str_alloc(str->len);
 
     // Copy string
-    strcpy(result->data, str->data);
+    memcpy(result->data, str->data, str->len);
+    result->data[str->len] = '\0';
 
     // Capitalize first character
     result->data[0] = toupper((unsigned char)result->data[0]);
@@ -2112,26 +5049,502 @@ long brix_byte_size(BrixString* str) {
     if (str == NULL) {
         return 0;
     }
-    return str->len;
+    return str->len;
+}
+
+// ==========================================
+// Substring search (v1.9)
+// ==========================================
+// One length-based search engine behind contains, index_of, replace,
+// replace_all and split. It never reads past the haystack length, so it
+// also finds needles across embedded NULs (strstr stopped at them).
+// - 1-byte needles use memchr.
+// - Longer needles scan 16 (SSE2) or 32 (AVX2, picked at run time)
+//   candidate positions at a time: compare the first and last needle bytes
+//   against two overlapping loads, then verify survivors with memcmp.
+// - If verification work outgrows the bytes scanned (inputs like
+//   "aaaa...b" that defeat the filter), the rest of the search switches to
+//   Two-Way (Crochemore-Perrin), which is linear in the worst case.
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define STR_FIND_AVX2 1
+#endif
+
+#define STR_FIND_GAVE_UP (-2)  // filter hit its verification budget
+
+// Two-Way critical factorization: start of the maximal suffix of x under
+// the byte order (rev = 0) or its reverse (rev = 1), plus its period.
+static long str_maximal_suffix(const unsigned char *x, long m, long *period, int rev) {
+  long ms = -1, j = 0, k = 1, p = 1;
+  while (j + k < m) {
+    unsigned char a = x[j + k], b = x[ms + k];
+    if (rev ? a > b : a < b) {
+      j += k;
+      k = 1;
+      p = j - ms;
+    } else if (a == b) {
+      if (k != p) {
+        k++;
+      } else {
+        j += p;
+        k = 1;
+      }
+    } else {
+      ms = j;
+      j = ms + 1;
+      k = p = 1;
+    }
+  }
+  *period = p;
+  return ms;
+}
+
+static long str_find_twoway(const unsigned char *h, long n, const unsigned char *x, long m) {
+  long p, q;
+  long i = str_maximal_suffix(x, m, &p, 0);
+  long j = str_maximal_suffix(x, m, &q, 1);
+  long ell = i > j ? i : j;
+  long per = i > j ? p : q;
+
+  if (memcmp(x, x + per, ell + 1) == 0) {
+    // Periodic needle: remember how much of the last window already matched.
+    long memory = -1;
+    for (long pos = 0; pos <= n - m;) {
+      long k = (ell > memory ? ell : memory) + 1;
+      while (k < m && x[k] == h[pos + k]) k++;
+      if (k < m) {
+        pos += k - ell;
+        memory = -1;
+        continue;
+      }
+      k = ell;
+      while (k > memory && x[k] == h[pos + k]) k--;
+      if (k <= memory) return pos;
+      pos += per;
+      memory = m - per - 1;
+    }
+  } else {
+    per = (ell + 1 > m - ell - 1 ? ell + 1 : m - ell - 1) + 1;
+    for (long pos = 0; pos <= n - m;) {
+      long k = ell + 1;
+      while (k < m && x[k] == h[pos + k]) k++;
+      if (k < m) {
+        pos += k - ell;
+        continue;
+      }
+      k = ell;
+      while (k >= 0 && x[k] == h[pos + k]) k--;
+      if (k < 0) return pos;
+      pos += per;
+    }
+  }
+  return -1;
+}
+
+#if defined(__SSE2__)
+// First/last-byte filter over candidate starts [*at, last]. Returns the
+// match offset, -1 with *at at the first unscanned start (fewer than 16
+// remain), or STR_FIND_GAVE_UP with *at where Two-Way should resume.
+static long str_find_sse2(const char *hay, long last, const char *needle, long m, long *at) {
+  __m128i first_b = _mm_set1_epi8(needle[0]);
+  __m128i last_b = _mm_set1_epi8(needle[m - 1]);
+  long budget = 4096;
+  long i = *at;
+  for (; i + 15 <= last; i += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(hay + i));
+    __m128i b = _mm_loadu_si128((const __m128i *)(hay + i + m - 1));
+    unsigned mask = (unsigned)_mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(a, first_b), _mm_cmpeq_epi8(b, last_b)));
+    while (mask) {
+      long pos = i + __builtin_ctz(mask);
+      if (memcmp(hay + pos + 1, needle + 1, m - 2) == 0) return pos;
+      mask &= mask - 1;
+      budget -= m;
+    }
+    budget += 16;
+    if (budget < 0) {
+      *at = i;
+      return STR_FIND_GAVE_UP;
+    }
+  }
+  *at = i;
+  return -1;
+}
+#endif
+
+#ifdef STR_FIND_AVX2
+// Same as str_find_sse2, 32 candidates per step.
+__attribute__((target("avx2"))) static long str_find_avx2(const char *hay, long last,
+                                                          const char *needle, long m,
+                                                          long *at) {
+  __m256i first_b = _mm256_set1_epi8(needle[0]);
+  __m256i last_b = _mm256_set1_epi8(needle[m - 1]);
+  long budget = 4096;
+  long i = *at;
+  for (; i + 31 <= last; i += 32) {
+    // Skip 64-byte stretches with no candidate at all.
+    while (i + 63 <= last) {
+      __m256i a0 = _mm256_loadu_si256((const __m256i *)(hay + i));
+      __m256i b0 = _mm256_loadu_si256((const __m256i *)(hay + i + m - 1));
+      __m256i a1 = _mm256_loadu_si256((const __m256i *)(hay + i + 32));
+      __m256i b1 = _mm256_loadu_si256((const __m256i *)(hay + i + m + 31));
+      __m256i hit = _mm256_or_si256(
+          _mm256_and_si256(_mm256_cmpeq_epi8(a0, first_b), _mm256_cmpeq_epi8(b0, last_b)),
+          _mm256_and_si256(_mm256_cmpeq_epi8(a1, first_b), _mm256_cmpeq_epi8(b1, last_b)));
+      if (!_mm256_testz_si256(hit, hit)) break;
+      i += 64;
+      budget += 64;
+    }
+    if (i + 31 > last) break;
+    __m256i a = _mm256_loadu_si256((const __m256i *)(hay + i));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(hay + i + m - 1));
+    unsigned mask = (unsigned)_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(a, first_b), _mm256_cmpeq_epi8(b, last_b)));
+    while (mask) {
+      long pos = i + __builtin_ctz(mask);
+      if (memcmp(hay + pos + 1, needle + 1, m - 2) == 0) return pos;
+      mask &= mask - 1;
+      budget -= m;
+    }
+    budget += 32;
+    if (budget < 0) {
+      *at = i;
+      return STR_FIND_GAVE_UP;
+    }
+  }
+  *at = i;
+  return -1;
+}
+#endif
+
+// Offset of the first occurrence of needle[0..m) in hay[0..n), or -1.
+static long str_find(const char *hay, long n, const char *needle, long m) {
+  if (m == 0) return 0;
+  if (m > n) return -1;
+  if (m == 1) {
+    const char *p = (const char *)memchr(hay, needle[0], n);
+    return p ? (long)(p - hay) : -1;
+  }
+
+  long last = n - m;  // last candidate start
+  long i = 0;
+  long r = -1;
+#ifdef STR_FIND_AVX2
+  static int has_avx2 = -1;
+  if (has_avx2 < 0) has_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+  if (has_avx2) r = str_find_avx2(hay, last, needle, m, &i);
+#endif
+#if defined(__SSE2__)
+  if (r == -1) r = str_find_sse2(hay, last, needle, m, &i);
+#endif
+  if (r == STR_FIND_GAVE_UP) {
+    long pos = str_find_twoway((const unsigned char *)hay + i, n - i,
+                               (const unsigned char *)needle, m);
+    return pos < 0 ? -1 : i + pos;
+  }
+  if (r >= 0) return r;
+
+  // Tail (or no SIMD): memchr for the first byte, then check the rest.
+  long work = 0;
+  while (i <= last) {
+    const char *p = (const char *)memchr(hay + i, needle[0], last - i + 1);
+    if (p == NULL) return -1;
+    i = p - hay;
+    if (hay[i + m - 1] == needle[m - 1] && memcmp(hay + i + 1, needle + 1, m - 2) == 0) return i;
+    work += m;
+    if (work > 4096 + 4 * i) {
+      long pos = str_find_twoway((const unsigned char *)hay + i, n - i,
+                                 (const unsigned char *)needle, m);
+      return pos < 0 ? -1 : i + pos;
+    }
+    i++;
+  }
+  return -1;
+}
+
+// New string holding a copy of bytes[0..len).
+static BrixString *str_from_bytes(const char *bytes, long len) {
+  BrixString *s = str_alloc(len);
+  if (len > 0) memcpy(s->data, bytes, len);
+  return s;
+}
+
+// ==========================================
+// Code points (v1.9)
+// ==========================================
+// length(), substring(), char_at(), reverse() and index_of() count in code
+// points, the same units `for ch in s` and .chars() step through. In
+// well-formed UTF-8 that is the number of non-continuation bytes, which is
+// counted 16 bytes at a time with SSE2. A malformed byte counts as one code
+// point (U+FFFD), exactly as brix_utf8_decode steps over it, so a validation
+// pass picks between the two rules: Keiser-Lemire lookup tables over 32
+// bytes at a time when AVX2 is available, otherwise a scalar decoder that
+// skips ASCII a word at a time.
+//
+// A string of STR_CP_INDEX_MIN bytes or more gets a BrixStrIndex the first
+// time a code-point operation runs on it. The index holds the length, an
+// all-ASCII flag and the byte offset of every STR_CP_STRIDE-th code point.
+// After that, length() is O(1), and mapping a code-point position to a byte
+// offset, or back, is a table lookup (or binary search) plus a scan of
+// fewer than STR_CP_STRIDE code points. str_append_inplace drops the index.
+// Literal headers are read-only, so literals are always scanned directly.
+
+#define STR_CP_STRIDE 64       // code points between index entries
+#define STR_CP_INDEX_MIN 256   // shorter strings are scanned directly
+
+typedef struct BrixStrIndex {
+  long cp_len;    // code points, as iteration counts them
+  int ascii;      // every byte < 0x80: code point i is byte i
+  int valid;      // well-formed UTF-8
+  long noffsets;  // entries in offsets (0 when ascii)
+  long offsets[];  // offsets[k]: byte offset of code point k * STR_CP_STRIDE
+} BrixStrIndex;
+
+long brix_utf8_decode(const char* p, long n, long* width);
+
+static int str_utf8_valid_scalar(const char *p, long n) {
+  long i = 0, w;
+  while (i < n) {
+    uint64_t word;
+    if (i + 8 <= n && (memcpy(&word, p + i, 8), (word & 0x8080808080808080ULL) == 0)) {
+      i += 8;
+      continue;
+    }
+    if ((unsigned char)p[i] < 0x80) {
+      i++;
+      continue;
+    }
+    // brix_utf8_decode reports malformed input as U+FFFD of width 1 (a real
+    // U+FFFD is 3 bytes wide).
+    if (brix_utf8_decode(p + i, n - i, &w) == 0xFFFD && w == 1) return 0;
+    i += w;
+  }
+  return 1;
+}
+
+#ifdef STR_FIND_AVX2
+// One 32-byte block of the lookup validator. prev1..prev3 are the input
+// shifted right by 1..3 bytes (carrying in the previous block's tail). Three
+// nibble lookups flag every bad two-byte pattern; lead bytes that demand a
+// third or fourth byte are cross-checked against the continuation flags.
+#define STR_U8(x) ((char)(x))
+__attribute__((target("avx2"))) static __m256i str_utf8_check_block(__m256i in,
+                                                                     __m256i prev) {
+  const __m256i byte_1_high_tab = _mm256_setr_epi8(
+      2, 2, 2, 2, 2, 2, 2, 2, STR_U8(0x80), STR_U8(0x80), STR_U8(0x80), STR_U8(0x80),
+      33, 1, 21, 73,
+      2, 2, 2, 2, 2, 2, 2, 2, STR_U8(0x80), STR_U8(0x80), STR_U8(0x80), STR_U8(0x80),
+      33, 1, 21, 73);
+  const __m256i byte_1_low_tab = _mm256_setr_epi8(
+      STR_U8(0xE7), STR_U8(0xA3), STR_U8(0x83), STR_U8(0x83), STR_U8(0x8B), STR_U8(0xCB),
+      STR_U8(0xCB), STR_U8(0xCB), STR_U8(0xCB), STR_U8(0xCB), STR_U8(0xCB), STR_U8(0xCB),
+      STR_U8(0xCB), STR_U8(0xDB), STR_U8(0xCB), STR_U8(0xCB),
+      STR_U8(0xE7), STR_U8(0xA3), STR_U8(0x83), STR_U8(0x83), STR_U8(0x8B), STR_U8(0xCB),
+      STR_U8(0xCB), STR_U8(0xCB), STR_U8(0xCB), STR_U8(0xCB), STR_U8(0xCB), STR_U8(0xCB),
+      STR_U8(0xCB), STR_U8(0xDB), STR_U8(0xCB), STR_U8(0xCB));
+  const __m256i byte_2_high_tab = _mm256_setr_epi8(
+      1, 1, 1, 1, 1, 1, 1, 1, STR_U8(0xE6), STR_U8(0xAE), STR_U8(0xBA), STR_U8(0xBA),
+      1, 1, 1, 1,
+      1, 1, 1, 1, 1, 1, 1, 1, STR_U8(0xE6), STR_U8(0xAE), STR_U8(0xBA), STR_U8(0xBA),
+      1, 1, 1, 1);
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+  __m256i carry = _mm256_permute2x128_si256(prev, in, 0x21);
+  __m256i prev1 = _mm256_alignr_epi8(in, carry, 15);
+  __m256i prev2 = _mm256_alignr_epi8(in, carry, 14);
+  __m256i prev3 = _mm256_alignr_epi8(in, carry, 13);
+
+  __m256i b1h = _mm256_shuffle_epi8(byte_1_high_tab,
+                                    _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+  __m256i b1l = _mm256_shuffle_epi8(byte_1_low_tab, _mm256_and_si256(prev1, nibble));
+  __m256i b2h = _mm256_shuffle_epi8(byte_2_high_tab,
+                                    _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble));
+  __m256i special = _mm256_and_si256(_mm256_and_si256(b1h, b1l), b2h);
+
+  __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(STR_U8(0xE0 - 0x80)));
+  __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(STR_U8(0xF0 - 0x80)));
+  __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth),
+                                    _mm256_set1_epi8(STR_U8(0x80)));
+  return _mm256_xor_si256(must23, special);
+}
+
+__attribute__((target("avx2"))) static int str_utf8_valid_avx2(const char *p, long n) {
+  // Nonzero where a block's last bytes start a sequence it does not finish.
+  const __m256i incomplete_max = _mm256_setr_epi8(
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      STR_U8(0xF0 - 1), STR_U8(0xE0 - 1), STR_U8(0xC0 - 1));
+  __m256i error = _mm256_setzero_si256();
+  __m256i prev = _mm256_setzero_si256();
+  __m256i prev_incomplete = _mm256_setzero_si256();
+  char tail[32];
+  for (long i = 0;; i += 32) {
+    __m256i in;
+    int last = i + 32 > n;
+    if (!last) {
+      in = _mm256_loadu_si256((const __m256i *)(p + i));
+    } else {
+      // Zero padding (at least one whole block when n % 32 == 0) catches a
+      // sequence cut off by the end of the string.
+      memset(tail, 0, sizeof(tail));
+      memcpy(tail, p + i, n - i);
+      in = _mm256_loadu_si256((const __m256i *)tail);
+    }
+    if (_mm256_movemask_epi8(in) == 0) {
+      error = _mm256_or_si256(error, prev_incomplete);
+    } else {
+      error = _mm256_or_si256(error, str_utf8_check_block(in, prev));
+    }
+    prev_incomplete = _mm256_subs_epu8(in, incomplete_max);
+    prev = in;
+    if (last) break;
+  }
+  return _mm256_testz_si256(error, error);
+}
+#undef STR_U8
+#endif
+
+static int str_utf8_valid(const char *p, long n) {
+#ifdef STR_FIND_AVX2
+  static int has_avx2 = -1;
+  if (has_avx2 < 0) has_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+  if (has_avx2) return str_utf8_valid_avx2(p, n);
+#endif
+  return str_utf8_valid_scalar(p, n);
+}
+
+// Code points in well-formed p[0..n): its non-continuation bytes. With
+// offsets, also records where every STR_CP_STRIDE-th one starts.
+static long str_cp_scan_valid(const char *p, long n, long *offsets) {
+  long count = 0, i = 0;
+#if defined(__SSE2__)
+  const __m128i cont_max = _mm_set1_epi8((char)0xBF);  // -65: 10xxxxxx is below
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+    unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(v, cont_max));
+    long c = __builtin_popcount(mask);
+    if (offsets) {
+      // At most one entry per block (16 < STR_CP_STRIDE): the r-th lead here.
+      long r = (STR_CP_STRIDE - count % STR_CP_STRIDE) % STR_CP_STRIDE;
+      if (r < c) {
+        for (long k = 0; k < r; k++) mask &= mask - 1;
+        offsets[(count + r) / STR_CP_STRIDE] = i + __builtin_ctz(mask);
+      }
+    }
+    count += c;
+  }
+#endif
+  for (; i < n; i++) {
+    if ((signed char)p[i] > -65) {
+      if (offsets && count % STR_CP_STRIDE == 0) offsets[count / STR_CP_STRIDE] = i;
+      count++;
+    }
+  }
+  return count;
+}
+
+// Code points in malformed p[0..n), stepping as brix_utf8_decode does.
+static long str_cp_scan_decode(const char *p, long n, long *offsets) {
+  long count = 0, i = 0, w;
+  while (i < n) {
+    if (offsets && count % STR_CP_STRIDE == 0) offsets[count / STR_CP_STRIDE] = i;
+    if ((unsigned char)p[i] < 0x80) {
+      w = 1;
+    } else {
+      brix_utf8_decode(p + i, n - i, &w);
+    }
+    i += w;
+    count++;
+  }
+  return count;
+}
+
+// Length and classification of s, plus the offset table for long strings.
+// Returns s's cached index, or fills *scratch (no offsets) for strings that
+// are short or read-only.
+static BrixStrIndex *str_cp_index(BrixString *s, BrixStrIndex *scratch) {
+  if (s->cps) return s->cps;
+  int valid = str_utf8_valid(s->data, s->len);
+  long cp_len = valid ? str_cp_scan_valid(s->data, s->len, NULL)
+                      : str_cp_scan_decode(s->data, s->len, NULL);
+  int ascii = valid && cp_len == s->len;
+  if (s->len < STR_CP_INDEX_MIN || s->ref_count == BRIX_RC_STATIC) {
+    scratch->cp_len = cp_len;
+    scratch->ascii = ascii;
+    scratch->valid = valid;
+    scratch->noffsets = 0;
+    return scratch;
+  }
+  long noffsets = ascii ? 0 : (cp_len + STR_CP_STRIDE - 1) / STR_CP_STRIDE;
+  BrixStrIndex *ix = (BrixStrIndex *)malloc(sizeof(BrixStrIndex) + noffsets * sizeof(long));
+  ix->cp_len = cp_len;
+  ix->ascii = ascii;
+  ix->valid = valid;
+  ix->noffsets = noffsets;
+  if (noffsets > 0) {
+    if (valid) {
+      str_cp_scan_valid(s->data, s->len, ix->offsets);
+    } else {
+      str_cp_scan_decode(s->data, s->len, ix->offsets);
+    }
+  }
+  s->cps = ix;
+  return ix;
+}
+
+// Byte width of the code point starting at p (n > 0 bytes left).
+static long str_cp_width(const char *p, long n, int valid) {
+  unsigned char b0 = (unsigned char)p[0];
+  if (b0 < 0x80) return 1;
+  if (valid) return b0 >= 0xF0 ? 4 : b0 >= 0xE0 ? 3 : 2;
+  long w;
+  brix_utf8_decode(p, n, &w);
+  return w;
+}
+
+// Byte offset of code point cp (clamped to [0, cp_len]).
+static long str_cp_to_byte(BrixString *s, BrixStrIndex *ix, long cp) {
+  if (cp <= 0) return 0;
+  if (cp >= ix->cp_len) return s->len;
+  if (ix->ascii) return cp;
+  long pos = 0, at = 0;
+  if (ix->noffsets > 0) {
+    pos = ix->offsets[cp / STR_CP_STRIDE];
+    at = cp / STR_CP_STRIDE * STR_CP_STRIDE;
+  }
+  for (; at < cp; at++) pos += str_cp_width(s->data + pos, s->len - pos, ix->valid);
+  return pos;
+}
+
+// Code-point position of byte offset pos (a code-point boundary).
+static long str_byte_to_cp(BrixString *s, BrixStrIndex *ix, long pos) {
+  if (ix->ascii) return pos;
+  long from = 0, base = 0;
+  if (ix->noffsets > 0) {
+    long lo = 0, hi = ix->noffsets - 1;  // last entry at or before pos
+    while (lo < hi) {
+      long mid = (lo + hi + 1) / 2;
+      if (ix->offsets[mid] <= pos) lo = mid; else hi = mid - 1;
+    }
+    from = ix->offsets[lo];
+    base = lo * STR_CP_STRIDE;
+  }
+  return base + (ix->valid ? str_cp_scan_valid(s->data + from, pos - from, NULL)
+                           : str_cp_scan_decode(s->data + from, pos - from, NULL));
 }
 
-// length(str) - Get number of characters (UTF-8 aware)
+// length(str) - Number of characters (UTF-8 code points)
 // For ASCII this is the same as byte_size
-// For UTF-8, counts actual characters not bytes
 long brix_length(BrixString* str) {
     if (str == NULL || str->data == NULL) {
         return 0;
     }
-
-    long count = 0;
-    for (long i = 0; i < str->len; i++) {
-        // UTF-8: Count bytes that don't start with 10xxxxxx
-        // This correctly counts multi-byte characters as 1 character
-        if ((str->data[i] & 0xC0) != 0x80) {
-            count++;
-        }
-    }
-    return count;
+    BrixStrIndex scratch;
+    return str_cp_index(str, &scratch)->cp_len;
 }
 
 // replace(str, old, new) - Replace first occurrence
@@ -2141,87 +5554,64 @@ BrixString* brix_replace(BrixString* str, BrixString* old, BrixString* new) {
         return str;
     }
 
-    if (old->len == 0) {
-        return str;  // Can't replace empty string
-    }
-
-    // Find first occurrence
-    char* pos = strstr(str->data, old->data);
-    if (pos == NULL) {
-        // Not found, return copy of original
-        return str_new(str->data);
+    long pos = old->len == 0 ? -1 : str_find(str->data, str->len, old->data, old->len);
+    if (pos < 0) {
+        // Not found (or empty pattern), return copy of original
+        return str_from_bytes(str->data, str->len);
     }
 
-    // Calculate new length
     long new_len = str->len - old->len + new->len;
-    BrixString* result = (BrixString*)malloc(sizeof(BrixString));
-    result->len = new_len;
-    result->data = (char*)malloc(new_len + 1);
-
-    // Copy before match
-    long before_len = pos - str->data;
-    strncpy(result->data, str->data, before_len);
+    BrixString* result = str_alloc(new_len);
 
-    // Copy replacement
-    strcpy(result->data + before_len, new->data);
-
-    // Copy after match
-    strcpy(result->data + before_len + new->len, pos + old->len);
+    long tail = str->len - pos - old->len;
+    memcpy(result->data, str->data, pos);
+    memcpy(result->data + pos, new->data, new->len);
+    memcpy(result->data + pos + new->len, str->data + pos + old->len, tail);
+    result->data[new_len] = '\0';
 
     return result;
 }
 
 // replace_all(str, old, new) - Replace all occurrences
-// Returns new string with all occurrences of old replaced by new
+// Returns new string with all occurrences of old replaced by new. Matches
+// are found and copied out in one pass; the output buffer starts at the
+// input size and doubles if replacements make it grow.
 BrixString* brix_replace_all(BrixString* str, BrixString* old, BrixString* new) {
     if (str == NULL || old == NULL || new == NULL) {
         return str;
     }
 
     if (old->len == 0) {
-        return str;  // Can't replace empty string
-    }
-
-    // Count occurrences
-    long count = 0;
-    char* pos = str->data;
-    while ((pos = strstr(pos, old->data)) != NULL) {
-        count++;
-        pos += old->len;
-    }
-
-    if (count == 0) {
-        // Not found, return copy of original
-        return str_new(str->data);
-    }
+        return str_from_bytes(str->data, str->len);  // Can't replace empty string
+    }
+
+    long cap = str->len + 1;
+    char* buf = (char*)malloc(cap);
+    long len = 0;
+    long src = 0;
+    long pos;
+    while ((pos = str_find(str->data + src, str->len - src, old->data, old->len)) >= 0) {
+        fmt_reserve(&buf, &cap, len, pos + new->len + 1);
+        memcpy(buf + len, str->data + src, pos);
+        memcpy(buf + len + pos, new->data, new->len);
+        len += pos + new->len;
+        src += pos + old->len;
+    }
+    long rest = str->len - src;
+    fmt_reserve(&buf, &cap, len, rest + 1);
+    memcpy(buf + len, str->data + src, rest);
+    len += rest;
+    buf[len] = '\0';
 
-    // Calculate new length
-    long new_len = str->len - (count * old->len) + (count * new->len);
     BrixString* result = (BrixString*)malloc(sizeof(BrixString));
-    result->len = new_len;
-    result->data = (char*)malloc(new_len + 1);
-
-    // Build result with all replacements
-    char* src = str->data;
-    char* dest = result->data;
-
-    while ((pos = strstr(src, old->data)) != NULL) {
-        // Copy before match
-        long before_len = pos - src;
-        strncpy(dest, src, before_len);
-        dest += before_len;
-
-        // Copy replacement
-        strcpy(dest, new->data);
-        dest += new->len;
-
-        // Move source pointer
-        src = pos + old->len;
-    }
-
-    // Copy remaining
-    strcpy(dest, src);
-
+    result->ref_count = 1;
+    result->len = len;
+    result->data = buf;
+    result->capacity = cap;
+    result->owner = NULL;
+    result->slices = NULL;
+    result->hash = 0;
+    result->cps = NULL;
     return result;
 }
 
@@ -2229,7 +5619,7 @@ BrixString* brix_replace_all(BrixString* str, BrixString* old, BrixString* new)
 // SECTION 2.2: STRING METHODS (v1.6)
 // ==========================================
 
-// trim(str) - Remove leading and trailing whitespace
+// trim(str) - Remove leading and trailing whitespace (a slice of str)
 BrixString* brix_str_trim(BrixString* str) {
     if (str == NULL || str->data == NULL || str->len == 0) {
         return str_new("");
@@ -2239,49 +5629,28 @@ BrixString* brix_str_trim(BrixString* str) {
     while (start <= end && isspace((unsigned char)str->data[start])) start++;
     while (end > start && isspace((unsigned char)str->data[end])) end--;
     if (start > end) return str_new("");
-    long new_len = end - start + 1;
-    BrixString* result = (BrixString*)malloc(sizeof(BrixString));
-    result->ref_count = 1;
-    result->len = new_len;
-    result->data = (char*)malloc(new_len + 1);
-    strncpy(result->data, str->data + start, new_len);
-    result->data[new_len] = '\0';
-    return result;
+    return str_slice(str, start, end - start + 1);
 }
 
-// ltrim(str) - Remove leading whitespace
+// ltrim(str) - Remove leading whitespace (a slice of str)
 BrixString* brix_str_ltrim(BrixString* str) {
     if (str == NULL || str->data == NULL || str->len == 0) {
         return str_new("");
     }
     long start = 0;
     while (start < str->len && isspace((unsigned char)str->data[start])) start++;
-    long new_len = str->len - start;
-    BrixString* result = (BrixString*)malloc(sizeof(BrixString));
-    result->ref_count = 1;
-    result->len = new_len;
-    result->data = (char*)malloc(new_len + 1);
-    strncpy(result->data, str->data + start, new_len);
-    result->data[new_len] = '\0';
-    return result;
+    return str_slice(str, start, str->len - start);
 }
 
-// rtrim(str) - Remove trailing whitespace
+// rtrim(str) - Remove trailing whitespace (a slice of str)
 BrixString* brix_str_rtrim(BrixString* str) {
     if (str == NULL || str->data == NULL || str->len == 0) {
         return str_new("");
     }
     long end = str->len - 1;
     while (end >= 0 && isspace((unsigned char)str->data[end])) end--;
-    long new_len = end + 1;
-    if (new_len <= 0) return str_new("");
-    BrixString* result = (BrixString*)malloc(sizeof(BrixString));
-    result->ref_count = 1;
-    result->len = new_len;
-    result->data = (char*)malloc(new_len + 1);
-    strncpy(result->data, str->data, new_len);
-    result->data[new_len] = '\0';
-    return result;
+    if (end < 0) return str_new("");
+    return str_slice(str, 0, end + 1);
 }
 
 // starts_with(str, prefix) - Returns 1 if str starts with prefix, 0 otherwise
@@ -2289,7 +5658,7 @@ long brix_str_starts_with(BrixString* str, BrixString* prefix) {
     if (str == NULL || prefix == NULL) return 0;
     if (prefix->len > str->len) return 0;
     if (prefix->len == 0) return 1;
-    return strncmp(str->data, prefix->data, prefix->len) == 0 ? 1 : 0;
+    return memcmp(str->data, prefix->data, prefix->len) == 0 ? 1 : 0;
 }
 
 // ends_with(str, suffix) - Returns 1 if str ends with suffix, 0 otherwise
@@ -2298,44 +5667,41 @@ long brix_str_ends_with(BrixString* str, BrixString* suffix) {
     if (suffix->len > str->len) return 0;
     if (suffix->len == 0) return 1;
     long offset = str->len - suffix->len;
-    return strncmp(str->data + offset, suffix->data, suffix->len) == 0 ? 1 : 0;
+    return memcmp(str->data + offset, suffix->data, suffix->len) == 0 ? 1 : 0;
 }
 
 // contains(str, sub) - Returns 1 if str contains sub, 0 otherwise
 long brix_str_contains(BrixString* str, BrixString* sub) {
     if (str == NULL || sub == NULL) return 0;
-    if (sub->len == 0) return 1;
-    return strstr(str->data, sub->data) != NULL ? 1 : 0;
+    return str_find(str->data, str->len, sub->data, sub->len) >= 0 ? 1 : 0;
 }
 
-// substring(str, start, end) - Returns substring [start, end) exclusive end
+// substring(str, start, end) - Returns substring [start, end) exclusive end,
+// in code points, as a slice of str
 BrixString* brix_str_substring(BrixString* str, long start, long end_idx) {
     if (str == NULL || str->data == NULL) return str_new("");
-    long len = str->len;
+    BrixStrIndex scratch;
+    BrixStrIndex* ix = str_cp_index(str, &scratch);
     if (start < 0) start = 0;
-    if (end_idx > len) end_idx = len;
+    if (end_idx > ix->cp_len) end_idx = ix->cp_len;
     if (start >= end_idx) return str_new("");
-    long new_len = end_idx - start;
-    BrixString* result = (BrixString*)malloc(sizeof(BrixString));
-    result->ref_count = 1;
-    result->len = new_len;
-    result->data = (char*)malloc(new_len + 1);
-    strncpy(result->data, str->data + start, new_len);
-    result->data[new_len] = '\0';
-    return result;
+    long from = str_cp_to_byte(str, ix, start);
+    long to = str_cp_to_byte(str, ix, end_idx);
+    return str_slice(str, from, to - from);
 }
 
-// reverse(str) - Returns reversed string
+// reverse(str) - Returns the code points of str in reverse order
 BrixString* brix_str_reverse(BrixString* str) {
     if (str == NULL || str->data == NULL || str->len == 0) {
         return str_new("");
     }
-    BrixString* result = (BrixString*)malloc(sizeof(BrixString));
-    result->ref_count = 1;
-    result->len = str->len;
-    result->data = (char*)malloc(str->len + 1);
-    for (long i = 0; i < str->len; i++) {
-        result->data[i] = str->data[str->len - 1 - i];
+    BrixString* result = str_alloc(str->len);
+    int valid = str->cps ? str->cps->valid : str_utf8_valid(str->data, str->len);
+    long i = 0;
+    while (i < str->len) {
+        long w = str_cp_width(str->data + i, str->len - i, valid);
+        memcpy(result->data + str->len - i - w, str->data + i, w);
+        i += w;
     }
     result->data[str->len] = '\0';
     return result;
@@ -2347,39 +5713,122 @@ BrixString* brix_str_repeat(BrixString* str, long n) {
         return str_new("");
     }
     long new_len = str->len * n;
-    BrixString* result = (BrixString*)malloc(sizeof(BrixString));
-    result->ref_count = 1;
-    result->len = new_len;
-    result->data = (char*)malloc(new_len + 1);
+    BrixString* result = str_alloc(new_len);
     for (long i = 0; i < n; i++) {
-        strncpy(result->data + i * str->len, str->data, str->len);
+        memcpy(result->data + i * str->len, str->data, str->len);
     }
     result->data[new_len] = '\0';
     return result;
 }
 
-// index_of(str, sub) - Returns index of first occurrence, -1 if not found
+// index_of(str, sub) - Returns code-point index of first occurrence, -1 if
+// not found
 long brix_str_index_of(BrixString* str, BrixString* sub) {
     if (str == NULL || sub == NULL) return -1;
-    if (sub->len == 0) return 0;
-    if (sub->len > str->len) return -1;
-    char* pos = strstr(str->data, sub->data);
-    if (pos == NULL) return -1;
-    return (long)(pos - str->data);
+    long pos = str_find(str->data, str->len, sub->data, sub->len);
+    if (pos <= 0) return pos;
+    BrixStrIndex scratch;
+    return str_byte_to_cp(str, str_cp_index(str, &scratch), pos);
 }
 
-// char_at(str, idx) - Returns single-character string at position idx
+// char_at(str, idx) - Returns the character (code point) at position idx
 BrixString* brix_str_char_at(BrixString* str, long idx) {
-    if (str == NULL || str->data == NULL || idx < 0 || idx >= str->len) {
+    if (str == NULL || str->data == NULL || idx < 0) {
         return str_new("");
     }
-    BrixString* result = (BrixString*)malloc(sizeof(BrixString));
-    result->ref_count = 1;
-    result->len = 1;
-    result->data = (char*)malloc(2);
-    result->data[0] = str->data[idx];
-    result->data[1] = '\0';
-    return result;
+    BrixStrIndex scratch;
+    BrixStrIndex* ix = str_cp_index(str, &scratch);
+    if (idx >= ix->cp_len) {
+        return str_new("");
+    }
+    long pos = str_cp_to_byte(str, ix, idx);
+    return str_slice(str, pos, str_cp_width(str->data + pos, str->len - pos, ix->valid));
+}
+
+// ==========================================
+// String iteration (v1.9)
+// ==========================================
+// `for c in s.chars()` / `.bytes()` / `.char_indices()` are lowered by the
+// compiler to an inline loop over s->data: ASCII bytes are handled in the
+// loop itself and only multi-byte sequences call brix_utf8_decode.
+// `for ch in s` still yields strings, one per code point, through
+// brix_str_next_char: ASCII characters come from a table of immortal
+// one-byte strings, others are small single-allocation copies.
+
+static BrixString str_ascii_chars[128];
+static char str_ascii_bytes[256];
+
+__attribute__((constructor)) static void str_init_ascii_chars(void) {
+    for (int c = 0; c < 128; c++) {
+        str_ascii_bytes[2 * c] = (char)c;
+        str_ascii_bytes[2 * c + 1] = '\0';
+        str_ascii_chars[c].ref_count = BRIX_RC_STATIC;
+        str_ascii_chars[c].len = 1;
+        str_ascii_chars[c].data = &str_ascii_bytes[2 * c];
+        str_ascii_chars[c].capacity = 0;
+        str_ascii_chars[c].owner = NULL;
+        str_ascii_chars[c].slices = NULL;
+        str_ascii_chars[c].hash = 0;
+        str_ascii_chars[c].cps = NULL;
+    }
+}
+
+// Decode the UTF-8 sequence at p (n > 0 bytes available). Returns the code
+// point and stores its byte width in *width. A malformed, overlong or
+// truncated sequence decodes as U+FFFD with width 1, so iteration always
+// makes progress and visits every byte exactly once.
+long brix_utf8_decode(const char* p, long n, long* width) {
+    const unsigned char* s = (const unsigned char*)p;
+    unsigned char b0 = s[0];
+    long cp, w, min;
+
+    if (b0 < 0x80) {
+        *width = 1;
+        return b0;
+    } else if (b0 >= 0xC2 && b0 <= 0xDF) {
+        cp = b0 & 0x1F; w = 2; min = 0x80;
+    } else if (b0 >= 0xE0 && b0 <= 0xEF) {
+        cp = b0 & 0x0F; w = 3; min = 0x800;
+    } else if (b0 >= 0xF0 && b0 <= 0xF4) {
+        cp = b0 & 0x07; w = 4; min = 0x10000;
+    } else {
+        *width = 1;
+        return 0xFFFD;
+    }
+
+    if (w > n) {
+        *width = 1;
+        return 0xFFFD;
+    }
+    for (long i = 1; i < w; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            *width = 1;
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        *width = 1;
+        return 0xFFFD;
+    }
+    *width = w;
+    return cp;
+}
+
+// next_char(str, pos) - The character starting at byte offset pos, as a
+// string; its len is the byte width to advance by. Never allocates for
+// ASCII.
+BrixString* brix_str_next_char(BrixString* str, long pos) {
+    if (str == NULL || pos < 0 || pos >= str->len) {
+        return &str_ascii_chars[0];
+    }
+    unsigned char b0 = (unsigned char)str->data[pos];
+    if (b0 < 0x80) {
+        return &str_ascii_chars[b0];
+    }
+    long width;
+    brix_utf8_decode(str->data + pos, str->len - pos, &width);
+    return str_slice(str, pos, width);
 }
 
 // ==========================================
@@ -2444,119 +5893,1412 @@ void string_matrix_release(BrixStringMatrix* m) {
             }
             free(m->data);
         }
-        free(m);
+        free(m);
+    }
+}
+
+// split(str, delim) - Splits str by delim, returning a BrixStringMatrix.
+// - If delim->len == 0, each character of str becomes its own element.
+// - Consecutive delimiters produce empty strings between them (no collapsing).
+// - Empty str with non-empty delim -> StringMatrix of 1 element: [""]
+// - Elements are slices of str (v1.9).
+BrixStringMatrix* brix_str_split(BrixString* s, BrixString* delim) {
+    if (s == NULL || s->data == NULL) {
+        return string_matrix_new(0);
+    }
+
+    // Case: split into individual characters
+    if (delim == NULL || delim->len == 0) {
+        long count = s->len;
+        BrixStringMatrix* result = string_matrix_new(count);
+        for (long i = 0; i < count; i++) {
+            result->data[i] = str_slice(s, i, 1);  // already ref_count 1, no need to retain again
+        }
+        return result;
+    }
+
+    // Single pass: segments are slices of s, collected into a growing array
+    // that becomes the result's storage.
+    long cap = 8;
+    long count = 0;
+    BrixString** segs = (BrixString**)malloc(cap * sizeof(BrixString*));
+    long start = 0;
+    for (;;) {
+        long found = str_find(s->data + start, s->len - start, delim->data, delim->len);
+        long seg_len = found < 0 ? s->len - start : found;
+        if (count == cap) {
+            cap *= 2;
+            segs = (BrixString**)realloc(segs, cap * sizeof(BrixString*));
+        }
+        segs[count++] = str_slice(s, start, seg_len);
+        if (found < 0) break;
+        start += found + delim->len;
+    }
+
+    BrixStringMatrix* result = (BrixStringMatrix*)malloc(sizeof(BrixStringMatrix));
+    result->ref_count = 1;
+    result->len = count;
+    result->data = segs;
+    return result;
+}
+
+// join(m, sep) - Concatenates all elements of m with sep between them.
+// Returns empty string if m is empty (len == 0).
+BrixString* brix_str_join(BrixStringMatrix* m, BrixString* sep) {
+    if (m == NULL || m->len == 0) {
+        return str_new("");
+    }
+
+    long sep_len = (sep != NULL) ? sep->len : 0;
+    const char* sep_data = (sep != NULL && sep->data != NULL) ? sep->data : "";
+
+    // Compute total length: sum of element lengths + sep_len * (n - 1)
+    long total_len = 0;
+    for (long i = 0; i < m->len; i++) {
+        BrixString* elem = m->data[i];
+        if (elem != NULL && elem->data != NULL) {
+            total_len += elem->len;
+        }
+    }
+    total_len += sep_len * (m->len - 1);
+
+    BrixString* result = str_alloc(total_len);
+
+    char* dest = result->data;
+    for (long i = 0; i < m->len; i++) {
+        BrixString* elem = m->data[i];
+        if (elem != NULL && elem->data != NULL && elem->len > 0) {
+            memcpy(dest, elem->data, elem->len);
+            dest += elem->len;
+        }
+        if (i < m->len - 1 && sep_len > 0) {
+            memcpy(dest, sep_data, sep_len);
+            dest += sep_len;
+        }
+    }
+    *dest = '\0';
+
+    return result;
+}
+
+// ==========================================
+// Lazy splitting (v1.9)
+// ==========================================
+// `s.split_iter(delim)` and `s.lines()` never build a StringMatrix up front.
+// The compiler lowers them to a loop that fetches one segment at a time:
+//
+//     long pos = brix_str_segment_begin(s, delim);
+//     while (pos >= 0) {
+//         BrixString* seg = brix_str_next_segment(s, delim, &pos);
+//         ...  // body; seg is released before the next fetch
+//     }
+//
+// Segments are slices of s, so stopping after the first field of a huge
+// line scans only the bytes up to it and allocates nothing proportional to
+// the line. delim == NULL selects lines(): split on "\n", drop a "\r"
+// before it, and yield no empty line after a trailing newline. Any other
+// delim yields exactly the elements split() would.
+
+// segment_begin(s, delim) - Initial position for brix_str_next_segment, or
+// -1 if there are no segments at all.
+long brix_str_segment_begin(BrixString* s, BrixString* delim) {
+    if (s == NULL || s->data == NULL) return -1;
+    if ((delim == NULL || delim->len == 0) && s->len == 0) return -1;
+    return 0;
+}
+
+// next_segment(s, delim, &pos) - The segment starting at byte offset pos.
+// Advances pos to the start of the next segment, or sets it to -1 after
+// the last one.
+BrixString* brix_str_next_segment(BrixString* s, BrixString* delim, long* pos) {
+    long start = *pos;
+
+    if (delim == NULL) {
+        const char* nl = (const char*)memchr(s->data + start, '\n', s->len - start);
+        long end = nl ? nl - s->data : s->len;
+        long len = end - start;
+        *pos = (nl && end + 1 < s->len) ? end + 1 : -1;
+        if (nl && len > 0 && s->data[end - 1] == '\r') len--;
+        return str_slice(s, start, len);
+    }
+
+    if (delim->len == 0) {
+        *pos = start + 1 < s->len ? start + 1 : -1;
+        return str_slice(s, start, 1);
+    }
+
+    long found = str_find(s->data + start, s->len - start, delim->data, delim->len);
+    if (found < 0) {
+        *pos = -1;
+        return str_slice(s, start, s->len - start);
+    }
+    *pos = start + found + delim->len;
+    return str_slice(s, start, found);
+}
+
+// segment_count(s, delim) - How many segments next_segment would yield,
+// without creating any (sizes the result of .map()).
+long brix_str_segment_count(BrixString* s, BrixString* delim) {
+    if (brix_str_segment_begin(s, delim) < 0) return 0;
+
+    if (delim == NULL) {
+        long count = 0;
+        const char* p = s->data;
+        const char* end = s->data + s->len;
+        while ((p = (const char*)memchr(p, '\n', end - p)) != NULL) {
+            count++;
+            p++;
+        }
+        return s->data[s->len - 1] == '\n' ? count : count + 1;
+    }
+
+    if (delim->len == 0) return s->len;
+
+    long count = 1;
+    long start = 0;
+    long found;
+    while ((found = str_find(s->data + start, s->len - start, delim->data, delim->len)) >= 0) {
+        count++;
+        start += found + delim->len;
+    }
+    return count;
+}
+
+// matrix_push(m, s) - Appends s (retained) to m, growing the storage at
+// power-of-two lengths. Builds .filter() results whose size is unknown
+// until the loop ends.
+void brix_str_matrix_push(BrixStringMatrix* m, BrixString* s) {
+    if ((m->len & (m->len - 1)) == 0) {
+        long cap = m->len == 0 ? 1 : m->len * 2;
+        m->data = (BrixString**)realloc(m->data, cap * sizeof(BrixString*));
+    }
+    m->data[m->len++] = (BrixString*)string_retain(s);
+}
+
+// ==========================================
+// Regular expressions (v1.9)
+// ==========================================
+// The `regex` module: is_match, find, find_all, captures, replace_all and
+// split, each taking the pattern first. A pattern is parsed once into a
+// Thompson NFA program and kept in a small per-thread cache keyed by the
+// pattern text, so a pattern used in a loop compiles on the first call only.
+//
+// Nothing backtracks. "Is there a match at or after here?" runs on a DFA
+// whose states (sets of NFA instructions) are built on first use and kept
+// with the program, so a warm pattern costs one table lookup per code point.
+// That answers is_match on its own, and lets the other functions skip a
+// text (or the rest of one) with no match without starting the NFA. Match
+// bounds and capture groups come from a Pike VM, which advances every NFA
+// thread in lockstep. Both are O(text * pattern). Patterns using \b / \B,
+// and searches that would grow the DFA past its state budget, run on the
+// Pike VM alone.
+//
+// Syntax: literals; escapes \n \t \r \f \v \xHH and \ before punctuation;
+// . (any code point but \n); [...] and [^...] with ranges; \d \w \s and
+// \D \W \S (ASCII classes); (...) and (?:...); |; * + ? {m} {m,} {m,n} and
+// their non-greedy forms; ^ and $ (start and end of the text); \b \B.
+// Text is matched by code point (a malformed byte reads as U+FFFD) with
+// leftmost-first semantics, as in Go and RE2. An invalid pattern is a
+// runtime error.
+
+#define RX_MAX_INSTS 20000      // compiled program size limit
+#define RX_MAX_REPEAT 1000      // largest count in {m,n}
+#define RX_MAX_DEPTH 500        // group nesting limit
+#define RX_DFA_MAX_STATES 4096  // lazy DFA states kept per pattern
+#define RX_DFA_MAX_CELLS (1L << 22)  // bound on states * classes (ints)
+#define RX_CACHE_SLOTS 64       // compiled patterns cached per thread
+
+enum {
+  // Instructions that consume a code point, or stop a thread.
+  RX_CHAR,    // code point c
+  RX_ANY,     // any code point but '\n'
+  RX_CLASS,   // code point in class x
+  RX_MATCH,
+  RX_EOL,     // $: end of text
+  // Empty-width instructions, followed while adding a thread.
+  RX_JMP,     // continue at x
+  RX_SPLIT,   // continue at x, then (lower priority) at y
+  RX_SAVE,    // capture slot x = current position
+  RX_BOL,     // ^: start of text
+  RX_WORDB,   // \b
+  RX_NWORDB,  // \B
+};
+
+typedef struct {
+  int op;
+  int x, y;
+  long c;
+} RxInst;
+
+typedef struct {
+  long lo, hi;  // inclusive code point range
+} RxRange;
+
+typedef struct {
+  int first, count;  // sorted, disjoint ranges[first .. first + count)
+} RxClass;
+
+typedef struct {
+  int first, n;      // instruction set: dfa_pcs[first .. first + n), sorted
+  int at_start;      // built for position 0, where ^ holds
+  int match;         // a match ends here
+  int match_at_end;  // a match ends here if the text ends here ($)
+} RxDState;
+
+typedef struct {
+  int *dense, *sparse, n;  // sparse set of pcs, dense in priority order
+  long *caps;              // nslots capture positions per pc
+} RxThreads;
+
+typedef struct {
+  int pc;
+  int slot;  // >= 0: restore caps[slot] = val instead of visiting pc
+  long val;
+} RxFrame;
+
+typedef struct Rx {
+  char *pattern;
+  long plen, hash;
+  RxInst *insts;
+  int ninst, icap;
+  RxRange *ranges;
+  RxClass *classes;
+  int nranges, nclasses;
+  int ngroups;  // capture groups, not counting the whole match
+  int nslots;   // 2 * (ngroups + 1)
+  int use_dfa;  // 0 when the pattern uses \b / \B
+
+  // Pike VM scratch.
+  RxThreads threads[2];
+  long *work;
+  RxFrame *frames;
+
+  // Lazy DFA. Code points fall into classes split at `bounds`; every code
+  // point in a class steps every instruction the same way.
+  long *bounds;
+  int nbounds;
+  int ascii_class[128];
+  RxDState *states;
+  int nstates, scap, max_states;
+  int *trans;  // nstates * nbounds next states, -1 not built yet
+  int *dfa_pcs;
+  long npcs, pcap;
+  int *table;  // open addressing over states, entries are index + 1
+  int tcap;
+  int start[2];  // start state for position 0 / elsewhere, -1 not built yet
+  unsigned *mark;
+  unsigned gen;
+  int *dfa_stack, *dfa_buf, *dfa_end_buf;
+} Rx;
+
+// ---- Parser: pattern -> syntax tree ----
+
+enum { RXN_EMPTY, RXN_CHAR, RXN_ANY, RXN_CLASS, RXN_ASSERT, RXN_GROUP, RXN_CAT, RXN_ALT, RXN_REPEAT };
+
+typedef struct {
+  int kind;
+  int a, b;      // children
+  long c;        // code point, class, assertion op or capture group
+  int min, max;  // RXN_REPEAT bounds (max -1: unbounded)
+  int greedy;
+} RxNode;
+
+typedef struct {
+  RxRange *r;
+  int n, cap;
+} RxSet;
+
+typedef struct {
+  const char *p;
+  long n, i;
+  int depth;
+  RxNode *nodes;
+  int nnodes, ncap;
+  Rx *rx;
+  int rcap, ccap;
+} RxParser;
+
+static void rx_error(RxParser *ps, const char *msg) {
+  fprintf(stderr, "Error: invalid regex \"%.*s\": %s (at offset %ld)\n", (int)ps->n, ps->p, msg,
+          ps->i);
+  exit(1);
+}
+
+static int rx_node(RxParser *ps, int kind, int a, int b, long c) {
+  if (ps->nnodes == ps->ncap) {
+    ps->ncap = ps->ncap ? ps->ncap * 2 : 64;
+    ps->nodes = (RxNode *)realloc(ps->nodes, ps->ncap * sizeof(RxNode));
+  }
+  RxNode *nd = &ps->nodes[ps->nnodes];
+  nd->kind = kind;
+  nd->a = a;
+  nd->b = b;
+  nd->c = c;
+  nd->min = nd->max = 0;
+  nd->greedy = 1;
+  return ps->nnodes++;
+}
+
+static int rx_peek(RxParser *ps) {
+  return ps->i < ps->n ? (unsigned char)ps->p[ps->i] : -1;
+}
+
+// Next literal code point of the pattern.
+static long rx_literal(RxParser *ps) {
+  unsigned char b = (unsigned char)ps->p[ps->i];
+  if (b < 0x80) {
+    ps->i++;
+    return b;
+  }
+  long w;
+  long cp = brix_utf8_decode(ps->p + ps->i, ps->n - ps->i, &w);
+  ps->i += w;
+  return cp;
+}
+
+static void rx_set_add(RxSet *set, long lo, long hi) {
+  if (set->n == set->cap) {
+    set->cap = set->cap ? set->cap * 2 : 8;
+    set->r = (RxRange *)realloc(set->r, set->cap * sizeof(RxRange));
+  }
+  set->r[set->n].lo = lo;
+  set->r[set->n].hi = hi;
+  set->n++;
+}
+
+static int rx_range_cmp(const void *a, const void *b) {
+  long x = ((const RxRange *)a)->lo, y = ((const RxRange *)b)->lo;
+  return x < y ? -1 : x > y;
+}
+
+// Sort and merge overlapping or adjacent ranges.
+static void rx_set_normalize(RxSet *set) {
+  if (set->n == 0) return;
+  qsort(set->r, set->n, sizeof(RxRange), rx_range_cmp);
+  int out = 0;
+  for (int k = 1; k < set->n; k++) {
+    if (set->r[k].lo <= set->r[out].hi + 1) {
+      if (set->r[k].hi > set->r[out].hi) set->r[out].hi = set->r[k].hi;
+    } else {
+      set->r[++out] = set->r[k];
+    }
+  }
+  set->n = out + 1;
+}
+
+// Replace a normalized set by its complement in [0, 0x10FFFF].
+static void rx_set_negate(RxSet *set) {
+  RxSet neg = {0};
+  long next = 0;
+  for (int k = 0; k < set->n; k++) {
+    if (set->r[k].lo > next) rx_set_add(&neg, next, set->r[k].lo - 1);
+    next = set->r[k].hi + 1;
+  }
+  if (next <= 0x10FFFF) rx_set_add(&neg, next, 0x10FFFF);
+  free(set->r);
+  *set = neg;
+}
+
+// \d \w \s, or the complement for \D \W \S.
+static void rx_set_add_named(RxSet *set, int letter) {
+  RxSet named = {0};
+  switch (letter | 0x20) {
+    case 'd':
+      rx_set_add(&named, '0', '9');
+      break;
+    case 'w':
+      rx_set_add(&named, '0', '9');
+      rx_set_add(&named, 'A', 'Z');
+      rx_set_add(&named, '_', '_');
+      rx_set_add(&named, 'a', 'z');
+      break;
+    default:  // 's'
+      rx_set_add(&named, '\t', '\r');
+      rx_set_add(&named, ' ', ' ');
+      break;
+  }
+  if (letter >= 'A' && letter <= 'Z') rx_set_negate(&named);
+  for (int k = 0; k < named.n; k++) rx_set_add(set, named.r[k].lo, named.r[k].hi);
+  free(named.r);
+}
+
+// Store a set as a class of the program; takes ownership of set->r.
+static int rx_class_from_set(RxParser *ps, RxSet *set, int negate) {
+  Rx *rx = ps->rx;
+  rx_set_normalize(set);
+  if (negate) rx_set_negate(set);
+  if (rx->nranges + set->n > ps->rcap) {
+    while (rx->nranges + set->n > ps->rcap) ps->rcap = ps->rcap ? ps->rcap * 2 : 16;
+    rx->ranges = (RxRange *)realloc(rx->ranges, ps->rcap * sizeof(RxRange));
+  }
+  if (rx->nclasses == ps->ccap) {
+    ps->ccap = ps->ccap ? ps->ccap * 2 : 8;
+    rx->classes = (RxClass *)realloc(rx->classes, ps->ccap * sizeof(RxClass));
+  }
+  if (set->n > 0) memcpy(rx->ranges + rx->nranges, set->r, set->n * sizeof(RxRange));
+  rx->classes[rx->nclasses].first = rx->nranges;
+  rx->classes[rx->nclasses].count = set->n;
+  rx->nranges += set->n;
+  free(set->r);
+  return rx->nclasses++;
+}
+
+// The escape after a backslash. \d \w \s \D \W \S set *named and return -1;
+// anything else returns the escaped code point.
+static long rx_escape(RxParser *ps, int *named) {
+  if (ps->i >= ps->n) rx_error(ps, "trailing backslash");
+  unsigned char e = (unsigned char)ps->p[ps->i++];
+  switch (e) {
+    case 'd': case 'w': case 's': case 'D': case 'W': case 'S':
+      *named = e;
+      return -1;
+    case 'n': return '\n';
+    case 't': return '\t';
+    case 'r': return '\r';
+    case 'f': return '\f';
+    case 'v': return '\v';
+    case 'x': {
+      long v = 0;
+      for (int k = 0; k < 2; k++) {
+        int h = rx_peek(ps);
+        int d = h >= '0' && h <= '9' ? h - '0'
+              : (h | 0x20) >= 'a' && (h | 0x20) <= 'f' ? (h | 0x20) - 'a' + 10 : -1;
+        if (d < 0) rx_error(ps, "\\x needs two hex digits");
+        v = v * 16 + d;
+        ps->i++;
+      }
+      return v;
+    }
+  }
+  int alnum = (e >= '0' && e <= '9') || ((e | 0x20) >= 'a' && (e | 0x20) <= 'z');
+  if (e < 0x80 && !alnum) return e;
+  ps->i--;
+  rx_error(ps, "unknown escape");
+  return -1;
+}
+
+// One member of a bracket class: a code point, or -1 after adding \d etc.
+static long rx_class_member(RxParser *ps, RxSet *set) {
+  if (ps->p[ps->i] != '\\') return rx_literal(ps);
+  ps->i++;
+  int named = 0;
+  long cp = rx_escape(ps, &named);
+  if (named) rx_set_add_named(set, named);
+  return cp;
+}
+
+static int rx_parse_class(RxParser *ps) {
+  ps->i++;  // '['
+  int negate = 0;
+  if (rx_peek(ps) == '^') {
+    negate = 1;
+    ps->i++;
+  }
+  RxSet set = {0};
+  for (int first = 1;; first = 0) {
+    if (ps->i >= ps->n) rx_error(ps, "missing ]");
+    if (ps->p[ps->i] == ']' && !first) {
+      ps->i++;
+      break;
+    }
+    long lo = rx_class_member(ps, &set);
+    if (lo < 0) continue;
+    if (rx_peek(ps) == '-' && ps->i + 1 < ps->n && ps->p[ps->i + 1] != ']') {
+      ps->i++;
+      long hi = rx_class_member(ps, &set);
+      if (hi < 0 || hi < lo) rx_error(ps, "invalid class range");
+      rx_set_add(&set, lo, hi);
+    } else {
+      rx_set_add(&set, lo, lo);
+    }
+  }
+  return rx_node(ps, RXN_CLASS, -1, -1, rx_class_from_set(ps, &set, negate));
+}
+
+static int rx_parse_alt(RxParser *ps);
+
+static int rx_parse_atom(RxParser *ps) {
+  int ch = rx_peek(ps);
+  switch (ch) {
+    case '(': {
+      ps->i++;
+      if (++ps->depth > RX_MAX_DEPTH) rx_error(ps, "groups nested too deeply");
+      long group = -1;
+      if (rx_peek(ps) == '?') {
+        if (ps->i + 1 >= ps->n || ps->p[ps->i + 1] != ':') rx_error(ps, "unsupported group syntax");
+        ps->i += 2;
+      } else {
+        group = ++ps->rx->ngroups;
+      }
+      int inner = rx_parse_alt(ps);
+      if (rx_peek(ps) != ')') rx_error(ps, "missing )");
+      ps->i++;
+      ps->depth--;
+      return group < 0 ? inner : rx_node(ps, RXN_GROUP, inner, -1, group);
+    }
+    case '[':
+      return rx_parse_class(ps);
+    case '.':
+      ps->i++;
+      return rx_node(ps, RXN_ANY, -1, -1, 0);
+    case '^':
+      ps->i++;
+      return rx_node(ps, RXN_ASSERT, -1, -1, RX_BOL);
+    case '$':
+      ps->i++;
+      return rx_node(ps, RXN_ASSERT, -1, -1, RX_EOL);
+    case '*': case '+': case '?':
+      rx_error(ps, "missing argument to repetition operator");
+      return -1;
+    case '\\': {
+      ps->i++;
+      int b = rx_peek(ps);
+      if (b == 'b' || b == 'B') {
+        ps->i++;
+        ps->rx->use_dfa = 0;
+        return rx_node(ps, RXN_ASSERT, -1, -1, b == 'b' ? RX_WORDB : RX_NWORDB);
+      }
+      int named = 0;
+      long cp = rx_escape(ps, &named);
+      if (!named) return rx_node(ps, RXN_CHAR, -1, -1, cp);
+      RxSet set = {0};
+      rx_set_add_named(&set, named);
+      return rx_node(ps, RXN_CLASS, -1, -1, rx_class_from_set(ps, &set, 0));
+    }
+    default:
+      return rx_node(ps, RXN_CHAR, -1, -1, rx_literal(ps));
+  }
+}
+
+static long rx_parse_int(RxParser *ps) {
+  long v = 0;
+  while (rx_peek(ps) >= '0' && rx_peek(ps) <= '9') {
+    if (v <= RX_MAX_REPEAT) v = v * 10 + (ps->p[ps->i] - '0');
+    ps->i++;
+  }
+  return v;
+}
+
+// {m}, {m,} or {m,n} at ps->i. Anything else leaves the '{' as a literal.
+static int rx_parse_count(RxParser *ps, int *min, int *max) {
+  long start = ps->i++;
+  int ch = rx_peek(ps);
+  if (ch < '0' || ch > '9') {
+    ps->i = start;
+    return 0;
+  }
+  long lo = rx_parse_int(ps), hi = lo;
+  if (rx_peek(ps) == ',') {
+    ps->i++;
+    ch = rx_peek(ps);
+    hi = ch >= '0' && ch <= '9' ? rx_parse_int(ps) : -1;
+  }
+  if (rx_peek(ps) != '}') {
+    ps->i = start;
+    return 0;
+  }
+  ps->i++;
+  if (lo > RX_MAX_REPEAT || hi > RX_MAX_REPEAT) rx_error(ps, "repeat count too large");
+  if (hi >= 0 && hi < lo) rx_error(ps, "invalid repeat count");
+  *min = (int)lo;
+  *max = (int)hi;
+  return 1;
+}
+
+static int rx_parse_repeat(RxParser *ps) {
+  int atom = rx_parse_atom(ps);
+  int ch = rx_peek(ps), min, max;
+  if (ch == '*') {
+    min = 0, max = -1;
+  } else if (ch == '+') {
+    min = 1, max = -1;
+  } else if (ch == '?') {
+    min = 0, max = 1;
+  } else if (ch != '{' || !rx_parse_count(ps, &min, &max)) {
+    return atom;
+  }
+  if (ch != '{') ps->i++;
+  int greedy = 1;
+  if (rx_peek(ps) == '?') {
+    greedy = 0;
+    ps->i++;
+  }
+  ch = rx_peek(ps);
+  if (ch == '*' || ch == '+' || ch == '?') rx_error(ps, "nested repetition operator");
+  int r = rx_node(ps, RXN_REPEAT, atom, -1, 0);
+  ps->nodes[r].min = min;
+  ps->nodes[r].max = max;
+  ps->nodes[r].greedy = greedy;
+  return r;
+}
+
+static int rx_parse_cat(RxParser *ps) {
+  int node = -1;
+  while (ps->i < ps->n && rx_peek(ps) != '|' && rx_peek(ps) != ')') {
+    int r = rx_parse_repeat(ps);
+    node = node < 0 ? r : rx_node(ps, RXN_CAT, node, r, 0);
+  }
+  return node < 0 ? rx_node(ps, RXN_EMPTY, -1, -1, 0) : node;
+}
+
+static int rx_parse_alt(RxParser *ps) {
+  int node = rx_parse_cat(ps);
+  while (rx_peek(ps) == '|') {
+    ps->i++;
+    node = rx_node(ps, RXN_ALT, node, rx_parse_cat(ps), 0);
+  }
+  return node;
+}
+
+// ---- Code generation: syntax tree -> NFA program ----
+
+static int rx_emit(RxParser *ps, int op, int x, int y, long c) {
+  Rx *rx = ps->rx;
+  if (rx->ninst >= RX_MAX_INSTS) rx_error(ps, "pattern too large");
+  if (rx->ninst == rx->icap) {
+    rx->icap = rx->icap ? rx->icap * 2 : 32;
+    rx->insts = (RxInst *)realloc(rx->insts, rx->icap * sizeof(RxInst));
+  }
+  RxInst *in = &rx->insts[rx->ninst];
+  in->op = op;
+  in->x = x;
+  in->y = y;
+  in->c = c;
+  return rx->ninst++;
+}
+
+// Whether node can match the empty string.
+static int rx_nullable(RxParser *ps, int node) {
+  for (;;) {
+    RxNode *nd = &ps->nodes[node];
+    switch (nd->kind) {
+      case RXN_CHAR: case RXN_ANY: case RXN_CLASS:
+        return 0;
+      case RXN_GROUP:
+        node = nd->a;
+        continue;
+      case RXN_CAT:  // nests to the left: walk the spine
+        if (!rx_nullable(ps, nd->b)) return 0;
+        node = nd->a;
+        continue;
+      case RXN_ALT:
+        return rx_nullable(ps, nd->a) || rx_nullable(ps, nd->b);
+      case RXN_REPEAT:
+        if (nd->min == 0) return 1;
+        node = nd->a;
+        continue;
+      default:  // RXN_EMPTY, RXN_ASSERT
+        return 1;
+    }
+  }
+}
+
+static void rx_split_to(Rx *rx, int split, int body, int out, int greedy) {
+  rx->insts[split].x = greedy ? body : out;
+  rx->insts[split].y = greedy ? out : body;
+}
+
+static void rx_gen(RxParser *ps, int node) {
+  Rx *rx = ps->rx;
+  RxNode nd = ps->nodes[node];
+  switch (nd.kind) {
+    case RXN_EMPTY:
+      break;
+    case RXN_CHAR:
+      rx_emit(ps, RX_CHAR, 0, 0, nd.c);
+      break;
+    case RXN_ANY:
+      rx_emit(ps, RX_ANY, 0, 0, 0);
+      break;
+    case RXN_CLASS:
+      rx_emit(ps, RX_CLASS, (int)nd.c, 0, 0);
+      break;
+    case RXN_ASSERT:
+      rx_emit(ps, (int)nd.c, 0, 0, 0);
+      break;
+    case RXN_GROUP:
+      rx_emit(ps, RX_SAVE, (int)(2 * nd.c), 0, 0);
+      rx_gen(ps, nd.a);
+      rx_emit(ps, RX_SAVE, (int)(2 * nd.c + 1), 0, 0);
+      break;
+    case RXN_CAT: {
+      // Concatenations nest to the left; walk the spine so long literals
+      // don't recurse once per character.
+      int depth = 0;
+      for (int k = node; ps->nodes[k].kind == RXN_CAT; k = ps->nodes[k].a) depth++;
+      int *rights = (int *)malloc(depth * sizeof(int));
+      int k = node;
+      for (int d = depth - 1; d >= 0; d--, k = ps->nodes[k].a) rights[d] = ps->nodes[k].b;
+      rx_gen(ps, k);
+      for (int d = 0; d < depth; d++) rx_gen(ps, rights[d]);
+      free(rights);
+      break;
+    }
+    case RXN_ALT: {
+      int split = rx_emit(ps, RX_SPLIT, 0, 0, 0);
+      rx->insts[split].x = rx->ninst;
+      rx_gen(ps, nd.a);
+      int jmp = rx_emit(ps, RX_JMP, 0, 0, 0);
+      rx->insts[split].y = rx->ninst;
+      rx_gen(ps, nd.b);
+      rx->insts[jmp].x = rx->ninst;
+      break;
+    }
+    case RXN_REPEAT: {
+      int copies = nd.max < 0 && nd.min > 0 ? nd.min - 1 : nd.min;
+      for (int k = 0; k < copies; k++) rx_gen(ps, nd.a);
+      if (nd.max < 0 && nd.min > 0) {  // x+: x, then loop back
+        int loop = rx->ninst;
+        rx_gen(ps, nd.a);
+        int split = rx_emit(ps, RX_SPLIT, 0, 0, 0);
+        rx_split_to(rx, split, loop, rx->ninst, nd.greedy);
+      } else if (nd.max < 0 && rx_nullable(ps, nd.a)) {
+        // x* with an x that can match empty is compiled as (x+)?, as Go
+        // does. In the x* loop, an x that matched empty jumps back to the
+        // visited split and dies, so an empty alternative inside x lost its
+        // priority over the alternatives after it ((|a)* took "aa").
+        int opt = rx_emit(ps, RX_SPLIT, 0, 0, 0);
+        int loop = rx->ninst;
+        rx_gen(ps, nd.a);
+        int split = rx_emit(ps, RX_SPLIT, 0, 0, 0);
+        rx_split_to(rx, split, loop, rx->ninst, nd.greedy);
+        rx_split_to(rx, opt, loop, rx->ninst, nd.greedy);
+      } else if (nd.max < 0) {  // x*
+        int split = rx_emit(ps, RX_SPLIT, 0, 0, 0);
+        rx_gen(ps, nd.a);
+        rx_emit(ps, RX_JMP, split, 0, 0);
+        rx_split_to(rx, split, split + 1, rx->ninst, nd.greedy);
+      } else if (nd.max > nd.min) {  // up to max - min optional copies
+        int n = nd.max - nd.min;
+        int *splits = (int *)malloc(n * sizeof(int));
+        for (int k = 0; k < n; k++) {
+          splits[k] = rx_emit(ps, RX_SPLIT, 0, 0, 0);
+          rx_gen(ps, nd.a);
+        }
+        for (int k = 0; k < n; k++) rx_split_to(rx, splits[k], splits[k] + 1, rx->ninst, nd.greedy);
+        free(splits);
+      }
+      break;
     }
+  }
 }
 
-// split(str, delim) - Splits str by delim, returning a BrixStringMatrix.
-// - If delim->len == 0, each character of str becomes its own element.
-// - Consecutive delimiters produce empty strings between them (no collapsing).
-// - Empty str with non-empty delim -> StringMatrix of 1 element: [""]
-BrixStringMatrix* brix_str_split(BrixString* s, BrixString* delim) {
-    if (s == NULL || s->data == NULL) {
-        return string_matrix_new(0);
+static void rx_free(Rx *rx) {
+  free(rx->pattern);
+  free(rx->insts);
+  free(rx->ranges);
+  free(rx->classes);
+  for (int k = 0; k < 2; k++) {
+    free(rx->threads[k].dense);
+    free(rx->threads[k].sparse);
+    free(rx->threads[k].caps);
+  }
+  free(rx->work);
+  free(rx->frames);
+  free(rx->bounds);
+  free(rx->states);
+  free(rx->trans);
+  free(rx->dfa_pcs);
+  free(rx->table);
+  free(rx->mark);
+  free(rx->dfa_stack);
+  free(rx->dfa_buf);
+  free(rx->dfa_end_buf);
+  free(rx);
+}
+
+static int rx_long_cmp(const void *a, const void *b) {
+  long x = *(const long *)a, y = *(const long *)b;
+  return x < y ? -1 : x > y;
+}
+
+static int rx_cp_class(Rx *rx, long cp) {
+  int lo = 0, hi = rx->nbounds - 1;  // last bound <= cp
+  while (lo < hi) {
+    int mid = (lo + hi + 1) / 2;
+    if (rx->bounds[mid] <= cp) lo = mid; else hi = mid - 1;
+  }
+  return lo;
+}
+
+// Split the code points into classes that every instruction treats alike.
+static void rx_build_classes(Rx *rx) {
+  long cap = 4, n = 0;
+  long *b = (long *)malloc(cap * sizeof(long));
+#define RX_BOUND(v)                                   \
+  do {                                                \
+    if (n == cap) {                                   \
+      cap *= 2;                                       \
+      b = (long *)realloc(b, cap * sizeof(long));     \
+    }                                                 \
+    b[n++] = (v);                                     \
+  } while (0)
+  RX_BOUND(0);
+  RX_BOUND('\n');
+  RX_BOUND('\n' + 1);
+  for (int k = 0; k < rx->ninst; k++) {
+    RxInst *in = &rx->insts[k];
+    if (in->op == RX_CHAR) {
+      RX_BOUND(in->c);
+      RX_BOUND(in->c + 1);
+    } else if (in->op == RX_CLASS) {
+      RxClass *cl = &rx->classes[in->x];
+      for (int r = 0; r < cl->count; r++) {
+        RX_BOUND(rx->ranges[cl->first + r].lo);
+        RX_BOUND(rx->ranges[cl->first + r].hi + 1);
+      }
+    }
+  }
+#undef RX_BOUND
+  qsort(b, n, sizeof(long), rx_long_cmp);
+  long out = 0;
+  for (long k = 1; k < n; k++) {
+    if (b[k] != b[out]) b[++out] = b[k];
+  }
+  rx->bounds = b;
+  rx->nbounds = (int)(out + 1);
+  for (int c = 0; c < 128; c++) rx->ascii_class[c] = rx_cp_class(rx, c);
+}
+
+static Rx *rx_compile(const char *pattern, long plen) {
+  Rx *rx = (Rx *)calloc(1, sizeof(Rx));
+  rx->pattern = (char *)malloc(plen + 1);
+  memcpy(rx->pattern, pattern, plen);
+  rx->pattern[plen] = '\0';
+  rx->plen = plen;
+  rx->use_dfa = 1;
+
+  RxParser ps = {0};
+  ps.p = rx->pattern;
+  ps.n = plen;
+  ps.rx = rx;
+  int root = rx_parse_alt(&ps);
+  if (ps.i < ps.n) rx_error(&ps, "unmatched )");
+  rx_emit(&ps, RX_SAVE, 0, 0, 0);
+  rx_gen(&ps, root);
+  rx_emit(&ps, RX_SAVE, 1, 0, 0);
+  rx_emit(&ps, RX_MATCH, 0, 0, 0);
+  free(ps.nodes);
+  rx->nslots = 2 * (rx->ngroups + 1);
+
+  int n = rx->ninst;
+  for (int k = 0; k < 2; k++) {
+    rx->threads[k].dense = (int *)malloc(n * sizeof(int));
+    rx->threads[k].sparse = (int *)calloc(n, sizeof(int));
+    rx->threads[k].caps = (long *)malloc((long)n * rx->nslots * sizeof(long));
+  }
+  rx->work = (long *)malloc(rx->nslots * sizeof(long));
+  rx->frames = (RxFrame *)malloc((2 * n + 2) * sizeof(RxFrame));
+
+  rx_build_classes(rx);
+  long by_cells = RX_DFA_MAX_CELLS / rx->nbounds;
+  rx->max_states = by_cells < RX_DFA_MAX_STATES ? (int)by_cells : RX_DFA_MAX_STATES;
+  rx->start[0] = rx->start[1] = -1;
+  rx->mark = (unsigned *)calloc(n, sizeof(unsigned));
+  rx->dfa_stack = (int *)malloc((3 * n + 2) * sizeof(int));
+  rx->dfa_buf = (int *)malloc((n + 1) * sizeof(int));
+  rx->dfa_end_buf = (int *)malloc((n + 1) * sizeof(int));
+  return rx;
+}
+
+// ---- Matching ----
+
+static int rx_is_word(long cp) {
+  return (cp >= '0' && cp <= '9') || (cp >= 'A' && cp <= 'Z') || (cp >= 'a' && cp <= 'z') ||
+         cp == '_';
+}
+
+static int rx_consumes(Rx *rx, const RxInst *in, long cp) {
+  switch (in->op) {
+    case RX_CHAR:
+      return in->c == cp;
+    case RX_ANY:
+      return cp != '\n';
+    case RX_CLASS: {
+      const RxClass *cl = &rx->classes[in->x];
+      const RxRange *r = rx->ranges + cl->first;
+      int lo = 0, hi = cl->count - 1;
+      while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (cp < r[mid].lo) hi = mid - 1;
+        else if (cp > r[mid].hi) lo = mid + 1;
+        else return 1;
+      }
+      return 0;
     }
+    default:
+      return 0;
+  }
+}
 
-    // Case: split into individual characters
-    if (delim == NULL || delim->len == 0) {
-        long count = s->len;
-        BrixStringMatrix* result = string_matrix_new(count);
-        for (long i = 0; i < count; i++) {
-            BrixString* ch = (BrixString*)malloc(sizeof(BrixString));
-            ch->ref_count = 1;
-            ch->len = 1;
-            ch->data = (char*)malloc(2);
-            ch->data[0] = s->data[i];
-            ch->data[1] = '\0';
-            result->data[i] = ch;  // already ref_count 1, no need to retain again
-        }
-        return result;
+// Code point at t[pos] (pos < n) and its width.
+static long rx_decode(const char *t, long n, long pos, long *w) {
+  unsigned char b = (unsigned char)t[pos];
+  if (b < 0x80) {
+    *w = 1;
+    return b;
+  }
+  return brix_utf8_decode(t + pos, n - pos, w);
+}
+
+// Code point ending at code-point boundary pos (pos > 0), for \b.
+static long rx_decode_before(const char *t, long pos) {
+  long i = pos - 1;
+  while (i > 0 && pos - i < 4 && ((unsigned char)t[i] & 0xC0) == 0x80) i--;
+  long w;
+  long cp = brix_utf8_decode(t + i, pos - i, &w);
+  return i + w == pos ? cp : 0xFFFD;
+}
+
+static int rx_int_cmp(const void *a, const void *b) {
+  int x = *(const int *)a, y = *(const int *)b;
+  return x < y ? -1 : x > y;
+}
+
+// Instructions reachable from seeds through empty-width steps: the ones that
+// consume, MATCH, and (unless at_end) pending EOLs. Sorted into out.
+static int rx_dfa_closure(Rx *rx, const int *seeds, int nseeds, int at_start, int at_end,
+                          int *out) {
+  if (++rx->gen == 0) {
+    memset(rx->mark, 0, rx->ninst * sizeof(unsigned));
+    rx->gen = 1;
+  }
+  int *stack = rx->dfa_stack;
+  int sp = 0, n = 0;
+  for (int k = nseeds - 1; k >= 0; k--) stack[sp++] = seeds[k];
+  while (sp > 0) {
+    int pc = stack[--sp];
+    if (rx->mark[pc] == rx->gen) continue;
+    rx->mark[pc] = rx->gen;
+    const RxInst *in = &rx->insts[pc];
+    switch (in->op) {
+      case RX_JMP:
+        stack[sp++] = in->x;
+        break;
+      case RX_SPLIT:
+        stack[sp++] = in->y;
+        stack[sp++] = in->x;
+        break;
+      case RX_SAVE:
+        stack[sp++] = pc + 1;
+        break;
+      case RX_BOL:
+        if (at_start) stack[sp++] = pc + 1;
+        break;
+      case RX_EOL:
+        if (at_end) stack[sp++] = pc + 1; else out[n++] = pc;
+        break;
+      default:
+        out[n++] = pc;
+        break;
+    }
+  }
+  qsort(out, n, sizeof(int), rx_int_cmp);
+  return n;
+}
+
+static unsigned rx_dfa_hash(const int *pcs, int n, int at_start) {
+  unsigned h = 2166136261u ^ (unsigned)at_start;
+  for (int k = 0; k < n; k++) h = (h ^ (unsigned)pcs[k]) * 16777619u;
+  return h;
+}
+
+static void rx_dfa_insert(Rx *rx, int s) {
+  RxDState *st = &rx->states[s];
+  unsigned mask = rx->tcap - 1;
+  unsigned i = rx_dfa_hash(rx->dfa_pcs + st->first, st->n, st->at_start) & mask;
+  while (rx->table[i]) i = (i + 1) & mask;
+  rx->table[i] = s + 1;
+}
+
+// The state for instruction set pcs[0..n), built if new; -1 when the DFA
+// is full.
+static int rx_dfa_state(Rx *rx, const int *pcs, int n, int at_start) {
+  if (rx->tcap > 0) {
+    unsigned mask = rx->tcap - 1;
+    unsigned i = rx_dfa_hash(pcs, n, at_start) & mask;
+    for (; rx->table[i]; i = (i + 1) & mask) {
+      RxDState *st = &rx->states[rx->table[i] - 1];
+      if (st->n == n && st->at_start == at_start &&
+          memcmp(rx->dfa_pcs + st->first, pcs, n * sizeof(int)) == 0) {
+        return rx->table[i] - 1;
+      }
+    }
+  }
+  if (rx->nstates >= rx->max_states) return -1;
+
+  if (rx->nstates == rx->scap) {
+    rx->scap = rx->scap ? rx->scap * 2 : 16;
+    rx->states = (RxDState *)realloc(rx->states, rx->scap * sizeof(RxDState));
+    rx->trans = (int *)realloc(rx->trans, (long)rx->scap * rx->nbounds * sizeof(int));
+  }
+  if (rx->npcs + n > rx->pcap) {
+    while (rx->npcs + n > rx->pcap) rx->pcap = rx->pcap ? rx->pcap * 2 : 256;
+    rx->dfa_pcs = (int *)realloc(rx->dfa_pcs, rx->pcap * sizeof(int));
+  }
+  int s = rx->nstates++;
+  RxDState *st = &rx->states[s];
+  st->first = (int)rx->npcs;
+  st->n = n;
+  st->at_start = at_start;
+  st->match = 0;
+  st->match_at_end = 0;
+  memcpy(rx->dfa_pcs + rx->npcs, pcs, n * sizeof(int));
+  rx->npcs += n;
+  for (int k = 0; k < n; k++) {
+    const RxInst *in = &rx->insts[pcs[k]];
+    if (in->op == RX_MATCH) st->match = 1;
+    if (in->op == RX_EOL && !st->match_at_end) {
+      int seed = pcs[k] + 1;
+      int m = rx_dfa_closure(rx, &seed, 1, at_start, 1, rx->dfa_end_buf);
+      for (int j = 0; j < m; j++) {
+        if (rx->insts[rx->dfa_end_buf[j]].op == RX_MATCH) st->match_at_end = 1;
+      }
     }
+  }
+  st->match_at_end |= st->match;
+  for (int c = 0; c < rx->nbounds; c++) rx->trans[(long)s * rx->nbounds + c] = -1;
 
-    // First pass: count how many segments we'll produce
-    long count = 1;
-    const char* cursor = s->data;
-    const char* found;
-    while ((found = strstr(cursor, delim->data)) != NULL) {
-        count++;
-        cursor = found + delim->len;
-    }
-
-    BrixStringMatrix* result = string_matrix_new(count);
-
-    // Second pass: fill segments
-    cursor = s->data;
-    long idx = 0;
-    while ((found = strstr(cursor, delim->data)) != NULL) {
-        long seg_len = (long)(found - cursor);
-        BrixString* seg = (BrixString*)malloc(sizeof(BrixString));
-        seg->ref_count = 1;
-        seg->len = seg_len;
-        seg->data = (char*)malloc(seg_len + 1);
-        if (seg_len > 0) {
-            memcpy(seg->data, cursor, seg_len);
+  if (2 * rx->nstates > rx->tcap) {
+    rx->tcap = rx->tcap ? rx->tcap * 2 : 64;
+    free(rx->table);
+    rx->table = (int *)calloc(rx->tcap, sizeof(int));
+    for (int k = 0; k < rx->nstates; k++) rx_dfa_insert(rx, k);
+  } else {
+    rx_dfa_insert(rx, s);
+  }
+  return s;
+}
+
+// Step state s over a code point of class cls. A new thread starts at every
+// position, so the DFA answers "does a match start anywhere before here".
+static int rx_dfa_step(Rx *rx, int s, int cls) {
+  long cp = rx->bounds[cls];
+  int *seeds = rx->dfa_end_buf;
+  int nseeds = 0;
+  const RxDState *st = &rx->states[s];
+  for (int k = 0; k < st->n; k++) {
+    int pc = rx->dfa_pcs[st->first + k];
+    if (rx_consumes(rx, &rx->insts[pc], cp)) seeds[nseeds++] = pc + 1;
+  }
+  seeds[nseeds++] = 0;
+  int n = rx_dfa_closure(rx, seeds, nseeds, 0, 0, rx->dfa_buf);
+  int next = rx_dfa_state(rx, rx->dfa_buf, n, 0);
+  if (next >= 0) rx->trans[(long)s * rx->nbounds + cls] = next;
+  return next;
+}
+
+// 1 if a match starts at or after start, 0 if none does, -1 if the DFA ran
+// out of states.
+static int rx_dfa_search(Rx *rx, const char *t, long n, long start) {
+  int at_start = start == 0;
+  int s = rx->start[at_start];
+  if (s < 0) {
+    int seed = 0;
+    int m = rx_dfa_closure(rx, &seed, 1, at_start, 0, rx->dfa_buf);
+    s = rx_dfa_state(rx, rx->dfa_buf, m, at_start);
+    if (s < 0) return -1;
+    rx->start[at_start] = s;
+  }
+  for (long pos = start;;) {
+    if (rx->states[s].match) return 1;
+    if (pos >= n) return rx->states[s].match_at_end;
+    unsigned char b = (unsigned char)t[pos];
+    int cls;
+    if (b < 0x80) {
+      cls = rx->ascii_class[b];
+      pos++;
+    } else {
+      long w;
+      cls = rx_cp_class(rx, brix_utf8_decode(t + pos, n - pos, &w));
+      pos += w;
+    }
+    int next = rx->trans[(long)s * rx->nbounds + cls];
+    if (next < 0 && (next = rx_dfa_step(rx, s, cls)) < 0) return -1;
+    s = next;
+  }
+}
+
+// Add the thread at pc0 to l, following empty-width instructions in
+// priority order. caps is the thread's capture array; SAVEs are undone on
+// the way back out, so it is unchanged on return.
+static void rx_pike_add(Rx *rx, RxThreads *l, int pc0, long *caps, int nslots, const char *t,
+                        long n, long pos) {
+  RxFrame *stack = rx->frames;
+  int sp = 0;
+  stack[sp++] = (RxFrame){pc0, -1, 0};
+  while (sp > 0) {
+    RxFrame f = stack[--sp];
+    if (f.slot >= 0) {
+      caps[f.slot] = f.val;
+      continue;
+    }
+    int pc = f.pc;
+    if (l->sparse[pc] < l->n && l->dense[l->sparse[pc]] == pc) continue;
+    l->sparse[pc] = l->n;
+    l->dense[l->n++] = pc;
+    const RxInst *in = &rx->insts[pc];
+    switch (in->op) {
+      case RX_JMP:
+        stack[sp++] = (RxFrame){in->x, -1, 0};
+        break;
+      case RX_SPLIT:
+        stack[sp++] = (RxFrame){in->y, -1, 0};
+        stack[sp++] = (RxFrame){in->x, -1, 0};
+        break;
+      case RX_SAVE:
+        if (in->x < nslots) {
+          stack[sp++] = (RxFrame){0, in->x, caps[in->x]};
+          caps[in->x] = pos;
         }
-        seg->data[seg_len] = '\0';
-        result->data[idx] = seg;
-        idx++;
-        cursor = found + delim->len;
+        stack[sp++] = (RxFrame){pc + 1, -1, 0};
+        break;
+      case RX_BOL:
+        if (pos == 0) stack[sp++] = (RxFrame){pc + 1, -1, 0};
+        break;
+      case RX_EOL:
+        if (pos == n) stack[sp++] = (RxFrame){pc + 1, -1, 0};
+        break;
+      case RX_WORDB:
+      case RX_NWORDB: {
+        long w;
+        int before = pos > 0 && rx_is_word(rx_decode_before(t, pos));
+        int after = pos < n && rx_is_word(rx_decode(t, n, pos, &w));
+        if ((before != after) == (in->op == RX_WORDB)) stack[sp++] = (RxFrame){pc + 1, -1, 0};
+        break;
+      }
+      default:
+        if (nslots > 0) memcpy(l->caps + (long)pc * nslots, caps, nslots * sizeof(long));
+        break;
+    }
+  }
+}
+
+// Leftmost-first match in t[0..n) starting at or after start. Fills
+// caps[0..nslots) with byte offsets (-1 for a group that did not take
+// part); slots past the first nslots are not tracked.
+static int rx_pike(Rx *rx, const char *t, long n, long start, long *caps, int nslots) {
+  RxThreads *cur = &rx->threads[0], *next = &rx->threads[1];
+  cur->n = next->n = 0;
+  int matched = 0;
+  for (long pos = start;;) {
+    if (!matched) {
+      for (int k = 0; k < nslots; k++) rx->work[k] = -1;
+      rx_pike_add(rx, cur, 0, rx->work, nslots, t, n, pos);
+    }
+    if (cur->n == 0) break;
+    long w = 0, cp = pos < n ? rx_decode(t, n, pos, &w) : -1;
+    for (int k = 0; k < cur->n; k++) {
+      int pc = cur->dense[k];
+      const RxInst *in = &rx->insts[pc];
+      long *tc = cur->caps + (long)pc * nslots;
+      if (in->op == RX_MATCH) {
+        if (nslots > 0) memcpy(caps, tc, nslots * sizeof(long));
+        matched = 1;
+        break;  // lower-priority threads lose to this match
+      }
+      if (cp >= 0 && rx_consumes(rx, in, cp)) rx_pike_add(rx, next, pc + 1, tc, nslots, t, n, pos + w);
     }
+    RxThreads *tmp = cur;
+    cur = next;
+    next = tmp;
+    next->n = 0;
+    if (cp < 0) break;
+    pos += w;
+  }
+  return matched;
+}
+
+static int rx_search(Rx *rx, const char *t, long n, long start, long *caps, int nslots) {
+  if (rx->use_dfa && rx_dfa_search(rx, t, n, start) == 0) return 0;
+  return rx_pike(rx, t, n, start, caps, nslots);
+}
 
-    // Final trailing segment (after the last delimiter, or the whole string if none found)
-    long seg_len = (long)strlen(cursor);
-    BrixString* seg = (BrixString*)malloc(sizeof(BrixString));
-    seg->ref_count = 1;
-    seg->len = seg_len;
-    seg->data = (char*)malloc(seg_len + 1);
-    if (seg_len > 0) {
-        memcpy(seg->data, cursor, seg_len);
+typedef struct {
+  long pos, prev_end;
+} RxIter;
+
+// Successive non-overlapping matches. An empty match right after the
+// previous match is skipped, so "a*" over "baaac" finds "", "aaa", "".
+static int rx_next(Rx *rx, BrixString *s, RxIter *it, long *caps, int nslots) {
+  while (it->pos <= s->len) {
+    if (!rx_search(rx, s->data, s->len, it->pos, caps, nslots)) return 0;
+    int accept = 1;
+    if (caps[1] == it->pos) {  // empty match at pos
+      accept = caps[0] != it->prev_end;
+      long w = 1;
+      if (it->pos < s->len) rx_decode(s->data, s->len, it->pos, &w);
+      it->pos += w;
+    } else {
+      it->pos = caps[1];
     }
-    seg->data[seg_len] = '\0';
-    result->data[idx] = seg;
+    it->prev_end = caps[1];
+    if (accept) return 1;
+  }
+  return 0;
+}
 
-    return result;
+static __thread Rx *rx_cache[RX_CACHE_SLOTS];
+
+// Compiled program for pattern, from this thread's cache when possible.
+static Rx *rx_get(BrixString *pattern) {
+  long h = str_hash(pattern);
+  Rx **slot = &rx_cache[(unsigned long)h % RX_CACHE_SLOTS];
+  Rx *rx = *slot;
+  if (rx && rx->hash == h && rx->plen == pattern->len &&
+      memcmp(rx->pattern, pattern->data, pattern->len) == 0) {
+    return rx;
+  }
+  rx = rx_compile(pattern->data, pattern->len);
+  rx->hash = h;
+  if (*slot) rx_free(*slot);
+  *slot = rx;
+  return rx;
 }
 
-// join(m, sep) - Concatenates all elements of m with sep between them.
-// Returns empty string if m is empty (len == 0).
-BrixString* brix_str_join(BrixStringMatrix* m, BrixString* sep) {
-    if (m == NULL || m->len == 0) {
-        return str_new("");
-    }
+static void rx_push(BrixString ***items, long *count, long *cap, BrixString *s) {
+  if (*count == *cap) {
+    *cap = *cap ? *cap * 2 : 8;
+    *items = (BrixString **)realloc(*items, *cap * sizeof(BrixString *));
+  }
+  (*items)[(*count)++] = s;
+}
 
-    long sep_len = (sep != NULL) ? sep->len : 0;
-    const char* sep_data = (sep != NULL && sep->data != NULL) ? sep->data : "";
+static BrixStringMatrix *rx_matrix(BrixString **items, long count) {
+  BrixStringMatrix *m = (BrixStringMatrix *)malloc(sizeof(BrixStringMatrix));
+  m->ref_count = 1;
+  m->len = count;
+  m->data = items;
+  return m;
+}
 
-    // Compute total length: sum of element lengths + sep_len * (n - 1)
-    long total_len = 0;
-    for (long i = 0; i < m->len; i++) {
-        BrixString* elem = m->data[i];
-        if (elem != NULL && elem->data != NULL) {
-            total_len += elem->len;
-        }
-    }
-    total_len += sep_len * (m->len - 1);
+// regex.is_match(pattern, text) - 1 if pattern matches anywhere in text.
+long brix_regex_is_match(BrixString *pattern, BrixString *text) {
+  Rx *rx = rx_get(pattern);
+  if (rx->use_dfa) {
+    int r = rx_dfa_search(rx, text->data, text->len, 0);
+    if (r >= 0) return r;
+  }
+  return rx_pike(rx, text->data, text->len, 0, NULL, 0);
+}
 
-    BrixString* result = (BrixString*)malloc(sizeof(BrixString));
-    result->ref_count = 1;
-    result->len = total_len;
-    result->data = (char*)malloc(total_len + 1);
+// regex.find(pattern, text) - The leftmost match, or "" when there is none.
+BrixString *brix_regex_find(BrixString *pattern, BrixString *text) {
+  Rx *rx = rx_get(pattern);
+  long caps[2];
+  if (!rx_search(rx, text->data, text->len, 0, caps, 2)) return str_new("");
+  return str_slice(text, caps[0], caps[1] - caps[0]);
+}
 
-    char* dest = result->data;
-    for (long i = 0; i < m->len; i++) {
-        BrixString* elem = m->data[i];
-        if (elem != NULL && elem->data != NULL && elem->len > 0) {
-            memcpy(dest, elem->data, elem->len);
-            dest += elem->len;
+// regex.find_all(pattern, text) - Every non-overlapping match, in order.
+// Matches are slices of text.
+BrixStringMatrix *brix_regex_find_all(BrixString *pattern, BrixString *text) {
+  Rx *rx = rx_get(pattern);
+  BrixString **items = NULL;
+  long count = 0, cap = 0;
+  long caps[2];
+  RxIter it = {0, -1};
+  while (rx_next(rx, text, &it, caps, 2)) {
+    rx_push(&items, &count, &cap, str_slice(text, caps[0], caps[1] - caps[0]));
+  }
+  return rx_matrix(items, count);
+}
+
+// regex.captures(pattern, text) - [whole match, group 1, group 2, ...] for
+// the leftmost match ("" for a group that did not take part), or an empty
+// array when there is no match.
+BrixStringMatrix *brix_regex_captures(BrixString *pattern, BrixString *text) {
+  Rx *rx = rx_get(pattern);
+  long *caps = (long *)malloc(rx->nslots * sizeof(long));
+  if (!rx_search(rx, text->data, text->len, 0, caps, rx->nslots)) {
+    free(caps);
+    return string_matrix_new(0);
+  }
+  BrixStringMatrix *m = string_matrix_new(rx->ngroups + 1);
+  for (int g = 0; g <= rx->ngroups; g++) {
+    long lo = caps[2 * g], hi = caps[2 * g + 1];
+    m->data[g] = lo >= 0 && hi >= lo ? str_slice(text, lo, hi - lo) : str_new("");
+  }
+  free(caps);
+  return m;
+}
+
+// regex.replace_all(pattern, text, repl) - Replaces every match. In repl,
+// $0..$9 stand for the match and its groups and $$ for a literal $.
+BrixString *brix_regex_replace_all(BrixString *pattern, BrixString *text, BrixString *repl) {
+  Rx *rx = rx_get(pattern);
+  int nslots = memchr(repl->data, '$', repl->len) ? rx->nslots : 2;
+  long *caps = (long *)malloc(nslots * sizeof(long));
+  char *out = NULL;
+  long len = 0, cap = 0, copied = 0, matches = 0;
+#define RX_APPEND(src, count)                            \
+  do {                                                   \
+    long n_ = (count);                                   \
+    if (len + n_ > cap) {                                \
+      while (len + n_ > cap) cap = cap ? cap * 2 : 64;   \
+      out = (char *)realloc(out, cap);                   \
+    }                                                    \
+    if (n_ > 0) memcpy(out + len, (src), n_);            \
+    len += n_;                                           \
+  } while (0)
+  RxIter it = {0, -1};
+  while (rx_next(rx, text, &it, caps, nslots)) {
+    matches++;
+    RX_APPEND(text->data + copied, caps[0] - copied);
+    for (long k = 0; k < repl->len; k++) {
+      char ch = repl->data[k];
+      if (ch == '$' && k + 1 < repl->len) {
+        char d = repl->data[k + 1];
+        if (d == '$') {
+          RX_APPEND("$", 1);
+          k++;
+          continue;
         }
-        if (i < m->len - 1 && sep_len > 0) {
-            memcpy(dest, sep_data, sep_len);
-            dest += sep_len;
+        if (d >= '0' && d <= '9') {
+          int g = d - '0';
+          if (g <= rx->ngroups && caps[2 * g] >= 0 && caps[2 * g + 1] >= caps[2 * g]) {
+            RX_APPEND(text->data + caps[2 * g], caps[2 * g + 1] - caps[2 * g]);
+          }
+          k++;
+          continue;
         }
+      }
+      RX_APPEND(&ch, 1);
     }
-    *dest = '\0';
+    copied = caps[1];
+  }
+  free(caps);
+  if (matches == 0) return string_retain(text);
+  RX_APPEND(text->data + copied, text->len - copied);
+#undef RX_APPEND
+  BrixString *result = str_from_bytes(out, len);
+  free(out);
+  return result;
+}
 
-    return result;
+// regex.split(pattern, text) - The pieces of text between matches, as
+// slices. As in Go's Regexp.Split, an empty match at the very start or end
+// of text adds no empty piece there, and "" splits to [""] unless the
+// pattern is empty too.
+BrixStringMatrix *brix_regex_split(BrixString *pattern, BrixString *text) {
+  Rx *rx = rx_get(pattern);
+  if (text->len == 0 && pattern->len > 0) {
+    BrixStringMatrix *m = string_matrix_new(1);
+    m->data[0] = str_new("");
+    return m;
+  }
+  BrixString **items = NULL;
+  long count = 0, cap = 0;
+  long caps[2];
+  long beg = 0, end = 0;
+  RxIter it = {0, -1};
+  while (rx_next(rx, text, &it, caps, 2)) {
+    end = caps[0];
+    if (caps[1] != 0) rx_push(&items, &count, &cap, str_slice(text, beg, end - beg));
+    beg = caps[1];
+  }
+  if (end != text->len) rx_push(&items, &count, &cap, str_slice(text, beg, text->len - beg));
+  return rx_matrix(items, count);
 }
 
 // ==========================================
@@ -2879,7 +7621,10 @@ static int brix_heap_compare(BrixVector *h, long i, long j) {
   } else { // BRIX_VEC_STRING
     BrixString *as = *(BrixString **)a;
     BrixString *bs = *(BrixString **)b;
-    return strcmp(as->data, bs->data);
+    long n = as->len < bs->len ? as->len : bs->len;
+    int c = memcmp(as->data, bs->data, n);
+    if (c != 0) return c;
+    return (as->len > bs->len) - (as->len < bs->len);
   }
 }
 
@@ -3010,34 +7755,28 @@ typedef struct {
 } BrixHashMap;
 
 // Hash de `key` (interpretado conforme m->key_kind). Int: multiplicative
-// hash (Knuth). String: FNV-1a sobre o conteúdo (não o ponteiro) — necessário
-// pra que duas BrixString* diferentes com o mesmo texto colidam no mesmo
-// bucket.
+// hash (Knuth). String: str_hash sobre o conteúdo (não o ponteiro) —
+// necessário pra que duas BrixString* diferentes com o mesmo texto colidam no
+// mesmo bucket. O hash fica cacheado na string (v1.9), então uma chave já
+// inserida ou reusada em vários lookups não é relida.
 static long brix_hashmap_hash(BrixHashMap *m, void *key) {
   if (m->key_kind == BRIX_VEC_INT) {
     unsigned long uk = (unsigned long)(*(long *)key);
     uk = uk * 2654435761UL; // Knuth multiplicative hash
     return (long)uk;
   } else { // BRIX_VEC_STRING
-    BrixString *s = *(BrixString **)key;
-    unsigned long h = 1469598103934665603UL; // FNV-1a offset basis
-    for (char *p = s->data; *p; p++) {
-      h ^= (unsigned char)*p;
-      h *= 1099511628211UL; // FNV prime
-    }
-    return (long)h;
+    return str_hash(*(BrixString **)key);
   }
 }
 
 // Igualdade de CONTEÚDO, não de ponteiro — crucial pra strings: duas
 // BrixString* diferentes com o mesmo texto devem contar como a mesma chave.
+// str_eq descarta pelo len e pelos hashes cacheados antes do memcmp.
 static int brix_hashmap_key_eq(BrixHashMap *m, long a, long b) {
   if (m->key_kind == BRIX_VEC_INT) {
     return a == b;
   } else {
-    BrixString *as = (BrixString *)a;
-    BrixString *bs = (BrixString *)b;
-    return strcmp(as->data, bs->data) == 0;
+    return str_eq((BrixString *)a, (BrixString *)b) != 0;
   }
 }
 
@@ -3273,6 +8012,299 @@ void brix_hashmap_release(BrixHashMap *m) {
   }
 }
 
+// ==========================================
+// SECTION 2.8: MATRIX32 (v1.9)
+// ==========================================
+//
+// Single-precision twin of Matrix: same { ref_count, rows, cols, data }
+// layout with float* data, so it halves memory and bandwidth. The hot
+// kernels work on 16-byte vectors (GCC/Clang vector extensions), i.e. four
+// floats per operation where a double kernel gets two. The `u` vector type
+// is 4-byte aligned so loads/stores straight from data are legal for any
+// element offset; scalar tails cover the remainder.
+
+typedef struct {
+  long ref_count;  // ARC reference counting
+  long rows;
+  long cols;
+  float *data;
+} Matrix32;
+
+typedef float brix_f32x4 __attribute__((vector_size(16)));
+typedef float brix_f32x4u __attribute__((vector_size(16), aligned(4), may_alias));
+typedef int brix_i32x4 __attribute__((vector_size(16)));
+
+Matrix32 *matrix32_new(long rows, long cols) {
+  Matrix32 *m = (Matrix32 *)malloc(sizeof(Matrix32));
+  m->ref_count = 1;  // Initialize ARC
+  m->rows = rows;
+  m->cols = cols;
+  m->data = (float *)calloc(rows * cols > 0 ? rows * cols : 1, sizeof(float));
+  return m;
+}
+
+// ARC: Increment reference count
+void* matrix32_retain(Matrix32* m) {
+    if (!m) return NULL;
+    m->ref_count++;
+    return m;
+}
+
+// ARC: Decrement reference count and free if zero
+void matrix32_release(Matrix32* m) {
+    if (!m) return;
+    m->ref_count--;
+
+    if (m->ref_count == 0) {
+        if (m->data) {
+            free(m->data);
+        }
+        free(m);
+    }
+}
+
+// zeros32(...) / ones32(...)
+Matrix32 *brix_zeros32(long rows, long cols) { return matrix32_new(rows, cols); }
+
+Matrix32 *brix_ones32(long rows, long cols) {
+  Matrix32 *m = matrix32_new(rows, cols);
+  long n = rows * cols;
+  for (long i = 0; i < n; i++) m->data[i] = 1.0f;
+  return m;
+}
+
+// matrix32(m) — narrow a Matrix (f64) / IntMatrix to f32
+Matrix32 *matrix32_from_matrix(Matrix *src) {
+  Matrix32 *m = matrix32_new(src->rows, src->cols);
+  long n = src->rows * src->cols;
+  for (long i = 0; i < n; i++) m->data[i] = (float)src->data[i];
+  return m;
+}
+
+Matrix32 *matrix32_from_intmatrix(IntMatrix *src) {
+  Matrix32 *m = matrix32_new(src->rows, src->cols);
+  long n = src->rows * src->cols;
+  for (long i = 0; i < n; i++) m->data[i] = (float)src->data[i];
+  return m;
+}
+
+// matrix(m32) — widen back to a Matrix (f64)
+Matrix *matrix32_to_matrix(Matrix32 *src) {
+  Matrix *m = matrix_new(src->rows, src->cols);
+  long n = src->rows * src->cols;
+  for (long i = 0; i < n; i++) m->data[i] = (double)src->data[i];
+  return m;
+}
+
+// Element access (flat index supports negative offsets, like Matrix).
+static long matrix32_flat_index(Matrix32 *m, long i) {
+  long total = m->rows * m->cols;
+  if (i < 0) i += total;
+  if (i < 0 || i >= total) {
+    fprintf(stderr, "Error: Matrix32 index %ld out of bounds (size %ld)\n", i,
+            total);
+    exit(1);
+  }
+  return i;
+}
+
+double matrix32_get(Matrix32 *m, long i) {
+  return (double)m->data[matrix32_flat_index(m, i)];
+}
+
+double matrix32_get2(Matrix32 *m, long r, long c) {
+  return (double)m->data[matrix32_flat_index(m, r * m->cols + c)];
+}
+
+void matrix32_set(Matrix32 *m, long i, double v) {
+  m->data[matrix32_flat_index(m, i)] = (float)v;
+}
+
+void matrix32_set2(Matrix32 *m, long r, long c, double v) {
+  m->data[matrix32_flat_index(m, r * m->cols + c)] = (float)v;
+}
+
+// Elementwise kernels: Matrix32 op Matrix32 and Matrix32 op scalar.
+static void matrix32_check_shape(Matrix32 *a, Matrix32 *b, const char *op) {
+  if (a->rows != b->rows || a->cols != b->cols) {
+    fprintf(stderr,
+            "Error: Matrix32 %s shape mismatch: %ldx%ld vs %ldx%ld\n", op,
+            a->rows, a->cols, b->rows, b->cols);
+    exit(1);
+  }
+}
+
+#define BRIX_M32_BINOP(NAME, OPSTR, EXPR)                                    \
+  Matrix32 *matrix32_##NAME##_matrix32(Matrix32 *a, Matrix32 *b) {           \
+    matrix32_check_shape(a, b, OPSTR);                                       \
+    Matrix32 *r = matrix32_new(a->rows, a->cols);                            \
+    long n = a->rows * a->cols, i = 0;                                       \
+    const float *pa = a->data, *pb = b->data;                                \
+    float *pr = r->data;                                                     \
+    for (; i + 4 <= n; i += 4) {                                             \
+      brix_f32x4 x = *(const brix_f32x4u *)(pa + i);                         \
+      brix_f32x4 y = *(const brix_f32x4u *)(pb + i);                         \
+      *(brix_f32x4u *)(pr + i) = EXPR;                                       \
+    }                                                                        \
+    for (; i < n; i++) {                                                     \
+      float x = pa[i], y = pb[i];                                            \
+      pr[i] = EXPR;                                                          \
+    }                                                                        \
+    return r;                                                                \
+  }                                                                          \
+  Matrix32 *matrix32_##NAME##_scalar(Matrix32 *a, double s) {                \
+    Matrix32 *r = matrix32_new(a->rows, a->cols);                            \
+    long n = a->rows * a->cols, i = 0;                                       \
+    const float *pa = a->data;                                               \
+    float *pr = r->data;                                                     \
+    float sf = (float)s;                                                     \
+    brix_f32x4 sv = {sf, sf, sf, sf};                                        \
+    for (; i + 4 <= n; i += 4) {                                             \
+      brix_f32x4 x = *(const brix_f32x4u *)(pa + i);                         \
+      brix_f32x4 y = sv;                                                     \
+      *(brix_f32x4u *)(pr + i) = EXPR;                                       \
+    }                                                                        \
+    for (; i < n; i++) {                                                     \
+      float x = pa[i], y = sf;                                               \
+      pr[i] = EXPR;                                                          \
+    }                                                                        \
+    return r;                                                                \
+  }
+
+BRIX_M32_BINOP(add, "+", x + y)
+BRIX_M32_BINOP(sub, "-", x - y)
+BRIX_M32_BINOP(mul, "*", x * y)
+BRIX_M32_BINOP(div, "/", x / y)
+
+#undef BRIX_M32_BINOP
+
+// scalar - m32 and scalar / m32 (non-commutative)
+Matrix32 *scalar_sub_matrix32(double s, Matrix32 *a) {
+  Matrix32 *r = matrix32_new(a->rows, a->cols);
+  long n = a->rows * a->cols;
+  float sf = (float)s;
+  for (long i = 0; i < n; i++) r->data[i] = sf - a->data[i];
+  return r;
+}
+
+Matrix32 *scalar_div_matrix32(double s, Matrix32 *a) {
+  Matrix32 *r = matrix32_new(a->rows, a->cols);
+  long n = a->rows * a->cols;
+  float sf = (float)s;
+  for (long i = 0; i < n; i++) r->data[i] = sf / a->data[i];
+  return r;
+}
+
+// Reductions. sum() keeps four float lanes per 1024-element block and folds
+// each block into a double, so long vectors do not lose float precision.
+double matrix32_sum(Matrix32 *m) {
+  long n = m->rows * m->cols, i = 0;
+  const float *p = m->data;
+  double total = 0.0;
+  while (i + 4 <= n) {
+    long block_end = i + 1024 < n ? i + 1024 : n;
+    brix_f32x4 acc = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (; i + 4 <= block_end; i += 4) acc += *(const brix_f32x4u *)(p + i);
+    total += (double)acc[0] + (double)acc[1] + (double)acc[2] + (double)acc[3];
+  }
+  for (; i < n; i++) total += p[i];
+  return total;
+}
+
+double matrix32_mean(Matrix32 *m) {
+  long n = m->rows * m->cols;
+  if (n == 0) return 0.0;
+  return matrix32_sum(m) / (double)n;
+}
+
+static double matrix32_extreme(Matrix32 *m, int want_max, const char *name) {
+  long n = m->rows * m->cols, i = 0;
+  if (n == 0) {
+    fprintf(stderr, "Error: %s() of an empty Matrix32\n", name);
+    exit(1);
+  }
+  const float *p = m->data;
+  float best = p[0];
+  if (n >= 4) {
+    brix_f32x4 acc = *(const brix_f32x4u *)p;
+    for (i = 4; i + 4 <= n; i += 4) {
+      brix_f32x4 x = *(const brix_f32x4u *)(p + i);
+      brix_i32x4 take = want_max ? (x > acc) : (x < acc);
+      acc = (brix_f32x4)(((brix_i32x4)x & take) | ((brix_i32x4)acc & ~take));
+    }
+    best = acc[0];
+    for (int k = 1; k < 4; k++)
+      if (want_max ? acc[k] > best : acc[k] < best) best = acc[k];
+  }
+  for (; i < n; i++)
+    if (want_max ? p[i] > best : p[i] < best) best = p[i];
+  return (double)best;
+}
+
+double matrix32_min(Matrix32 *m) { return matrix32_extreme(m, 0, "min"); }
+double matrix32_max(Matrix32 *m) { return matrix32_extreme(m, 1, "max"); }
+
+// map / filter / reduce with a Brix closure. Callbacks take and return
+// float (f64) like every other Brix closure; values are narrowed on store.
+typedef double (*BrixF64Map)(void *env, double x);
+typedef long (*BrixF64Pred)(void *env, double x);
+typedef double (*BrixF64Fold)(void *env, double acc, double x);
+
+Matrix32 *matrix32_map(Matrix32 *m, void *fn_ptr, void *env_ptr) {
+  Matrix32 *r = matrix32_new(m->rows, m->cols);
+  long n = m->rows * m->cols;
+  BrixF64Map fn = (BrixF64Map)fn_ptr;
+  for (long i = 0; i < n; i++) r->data[i] = (float)fn(env_ptr, m->data[i]);
+  return r;
+}
+
+Matrix32 *matrix32_filter(Matrix32 *m, void *fn_ptr, void *env_ptr) {
+  long n = m->rows * m->cols, count = 0;
+  BrixF64Pred fn = (BrixF64Pred)fn_ptr;
+  float *tmp = (float *)malloc((n > 0 ? n : 1) * sizeof(float));
+  for (long i = 0; i < n; i++)
+    if (fn(env_ptr, m->data[i])) tmp[count++] = m->data[i];
+  Matrix32 *r = matrix32_new(1, count);
+  if (count > 0) memcpy(r->data, tmp, count * sizeof(float));
+  free(tmp);
+  return r;
+}
+
+double matrix32_reduce(Matrix32 *m, double init, void *fn_ptr, void *env_ptr) {
+  long n = m->rows * m->cols;
+  BrixF64Fold fn = (BrixF64Fold)fn_ptr;
+  double acc = init;
+  for (long i = 0; i < n; i++) acc = fn(env_ptr, acc, m->data[i]);
+  return acc;
+}
+
+// println(m32) — "[1, 2.5, 3]" (flat, %g like Matrix)
+BrixString *matrix32_to_string(Matrix32 *m) {
+  long n = m->rows * m->cols;
+  size_t cap = 2 + (size_t)n * 18 + 1, len = 0;
+  char *buf = (char *)malloc(cap);
+  buf[len++] = '[';
+  for (long i = 0; i < n; i++) {
+    if (i > 0) {
+      buf[len++] = ',';
+      buf[len++] = ' ';
+    }
+    len += snprintf(buf + len, cap - len, "%g", (double)m->data[i]);
+  }
+  buf[len++] = ']';
+  buf[len] = '\0';
+  BrixString *s = (BrixString *)malloc(sizeof(BrixString));
+  s->ref_count = 1;
+  s->len = (long)len;
+  s->data = buf;
+  s->capacity = (long)cap;
+  s->owner = NULL;
+  s->slices = NULL;
+  s->hash = 0;
+  s->cps = NULL;
+  return s;
+}
+
 // ==========================================
 // SECTION 3: STATISTICS (v0.7)
 // ==========================================
@@ -3419,9 +8451,77 @@ Matrix *brix_arange(double start, double stop, double step) {
   return m;
 }
 
-// Seed rand() once at program startup
+// ------------------------------------------------------------------
+// Random number generation (v1.9): xoshiro256** replaces libc rand().
+//
+// rand()/irand() and every distribution kernel below draw from one global
+// 256-bit state, so rand_seed(n) makes a whole run reproducible. The state is
+// seeded from the clock at startup (splitmix64 expands the 64-bit seed into
+// the four state words, as recommended by the xoshiro authors).
+// ------------------------------------------------------------------
+#include <stdint.h>
+
+static uint64_t brix_rng_state[4];
+
+static uint64_t brix_splitmix64(uint64_t *x) {
+  uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static inline uint64_t brix_rotl64(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t brix_rng_next(void) {
+  uint64_t *s = brix_rng_state;
+  uint64_t result = brix_rotl64(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = brix_rotl64(s[3], 45);
+  return result;
+}
+
+// Uniform double in [0, 1) from the top 53 bits.
+static inline double brix_rng_uniform(void) {
+  return (double)(brix_rng_next() >> 11) * 0x1.0p-53;
+}
+
+// Uniform double in (0, 1) — safe to pass to log().
+static inline double brix_rng_uniform_pos(void) {
+  return ((double)(brix_rng_next() >> 11) + 0.5) * 0x1.0p-53;
+}
+
+// Unbiased integer in [0, bound) (Lemire's multiply-shift with rejection).
+static inline uint64_t brix_rng_bounded(uint64_t bound) {
+  __uint128_t m = (__uint128_t)brix_rng_next() * bound;
+  uint64_t low = (uint64_t)m;
+  if (low < bound) {
+    uint64_t threshold = -bound % bound;
+    while (low < threshold) {
+      m = (__uint128_t)brix_rng_next() * bound;
+      low = (uint64_t)m;
+    }
+  }
+  return (uint64_t)(m >> 64);
+}
+
+// rand_seed(n) — reseed the global generator (same seed => same stream)
+void brix_rand_seed(long seed) {
+  uint64_t x = (uint64_t)seed;
+  for (int i = 0; i < 4; i++) {
+    brix_rng_state[i] = brix_splitmix64(&x);
+  }
+}
+
+// Seed the generator once at program startup
 __attribute__((constructor)) static void brix_seed_rng(void) {
-  srand((unsigned int)time(NULL));
+  brix_rand_seed((long)time(NULL) ^ ((long)getpid() << 16));
 }
 
 // rand_matrix(rows, cols) — Matrix with random floats in [0.0, 1.0)
@@ -3429,7 +8529,7 @@ Matrix *brix_rand_matrix(long rows, long cols) {
   Matrix *m = matrix_new(rows, cols);
   long size = rows * cols;
   for (long i = 0; i < size; i++) {
-    m->data[i] = (double)rand() / ((double)RAND_MAX + 1.0);
+    m->data[i] = brix_rng_uniform();
   }
   return m;
 }
@@ -3439,21 +8539,243 @@ IntMatrix *brix_irand_matrix(long n, long max_val) {
   if (max_val <= 0) max_val = 1;
   IntMatrix *m = intmatrix_new(1, n);
   for (long i = 0; i < n; i++) {
-    m->data[i] = (long)(rand() % (int)max_val);
+    m->data[i] = (long)brix_rng_bounded((uint64_t)max_val);
   }
   return m;
 }
 
-// Transpose: swap rows and columns
-Matrix *brix_tr(Matrix *m) {
-  Matrix *result = matrix_new(m->cols, m->rows);
+// --- Ziggurat tables (Marsaglia & Tsang 2000): 128 layers for the normal,
+// 256 for the exponential. Built on first use. The layer index comes from the
+// low bits of a 64-bit draw and the 32-bit abscissa from the high bits, so the
+// two are independent (the original SHR3 version reused the same bits).
+static uint32_t brix_zig_kn[128], brix_zig_ke[256];
+static double brix_zig_wn[128], brix_zig_fn[128];
+static double brix_zig_we[256], brix_zig_fe[256];
+static int brix_zig_ready = 0;
+
+static void brix_zig_init(void) {
+  const double m1 = 2147483648.0, m2 = 4294967296.0;
+  double dn = 3.442619855899, tn = dn, vn = 9.91256303526217e-3;
+  double de = 7.697117470131487, te = de, ve = 3.949659822581572e-3;
+
+  double q = vn / exp(-0.5 * dn * dn);
+  brix_zig_kn[0] = (uint32_t)((dn / q) * m1);
+  brix_zig_kn[1] = 0;
+  brix_zig_wn[0] = q / m1;
+  brix_zig_wn[127] = dn / m1;
+  brix_zig_fn[0] = 1.0;
+  brix_zig_fn[127] = exp(-0.5 * dn * dn);
+  for (int i = 126; i >= 1; i--) {
+    dn = sqrt(-2.0 * log(vn / dn + exp(-0.5 * dn * dn)));
+    brix_zig_kn[i + 1] = (uint32_t)((dn / tn) * m1);
+    tn = dn;
+    brix_zig_fn[i] = exp(-0.5 * dn * dn);
+    brix_zig_wn[i] = dn / m1;
+  }
+
+  q = ve / exp(-de);
+  brix_zig_ke[0] = (uint32_t)((de / q) * m2);
+  brix_zig_ke[1] = 0;
+  brix_zig_we[0] = q / m2;
+  brix_zig_we[255] = de / m2;
+  brix_zig_fe[0] = 1.0;
+  brix_zig_fe[255] = exp(-de);
+  for (int i = 254; i >= 1; i--) {
+    de = -log(ve / de + exp(-de));
+    brix_zig_ke[i + 1] = (uint32_t)((de / te) * m2);
+    te = de;
+    brix_zig_fe[i] = exp(-de);
+    brix_zig_we[i] = de / m2;
+  }
+  brix_zig_ready = 1;
+}
+
+// Standard normal N(0, 1). ~99% of draws take the single-compare fast path.
+static double brix_rng_normal(void) {
+  for (;;) {
+    uint64_t u = brix_rng_next();
+    uint32_t iz = (uint32_t)(u & 127);
+    int32_t hz = (int32_t)(u >> 32);
+    uint32_t abs_hz = hz < 0 ? (uint32_t)(-(int64_t)hz) : (uint32_t)hz;
+    double x = hz * brix_zig_wn[iz];
+    if (abs_hz < brix_zig_kn[iz]) return x;
+
+    if (iz == 0) {
+      // Base layer: sample from the tail beyond r (Marsaglia 1964).
+      const double r = 3.442620;
+      double xt, yt;
+      do {
+        xt = -log(brix_rng_uniform_pos()) / r;
+        yt = -log(brix_rng_uniform_pos());
+      } while (yt + yt < xt * xt);
+      return (hz > 0) ? r + xt : -r - xt;
+    }
+    // Wedge: accept under the density, otherwise redraw.
+    if (brix_zig_fn[iz] + brix_rng_uniform() * (brix_zig_fn[iz - 1] - brix_zig_fn[iz]) <
+        exp(-0.5 * x * x)) {
+      return x;
+    }
+  }
+}
+
+// Standard exponential Exp(1).
+static double brix_rng_exponential(void) {
+  for (;;) {
+    uint64_t u = brix_rng_next();
+    uint32_t iz = (uint32_t)(u & 255);
+    uint32_t jz = (uint32_t)(u >> 32);
+    double x = jz * brix_zig_we[iz];
+    if (jz < brix_zig_ke[iz]) return x;
+
+    if (iz == 0) return 7.69711747013104972 - log(brix_rng_uniform_pos());
+    if (brix_zig_fe[iz] + brix_rng_uniform() * (brix_zig_fe[iz - 1] - brix_zig_fe[iz]) <
+        exp(-x)) {
+      return x;
+    }
+  }
+}
+
+// Gamma(shape, 1) — Marsaglia & Tsang squeeze; shape < 1 is boosted to
+// shape + 1 and scaled back by U^(1/shape).
+static double brix_rng_gamma(double shape) {
+  if (shape < 1.0) {
+    double g = brix_rng_gamma(shape + 1.0);
+    return g * pow(brix_rng_uniform_pos(), 1.0 / shape);
+  }
+  double d = shape - 1.0 / 3.0;
+  double c = 1.0 / sqrt(9.0 * d);
+  for (;;) {
+    double x, v;
+    do {
+      x = brix_rng_normal();
+      v = 1.0 + c * x;
+    } while (v <= 0.0);
+    v = v * v * v;
+    double u = brix_rng_uniform_pos();
+    double x2 = x * x;
+    if (u < 1.0 - 0.0331 * x2 * x2) return d * v;
+    if (log(u) < 0.5 * x2 + d * (1.0 - v + log(v))) return d * v;
+  }
+}
+
+// Poisson(lambda): multiplication method for small lambda, Hörmann's PTRS
+// transformed rejection (O(1) per draw) for lambda >= 10.
+static long brix_rng_poisson(double lam) {
+  if (lam <= 0.0) return 0;
+  if (lam < 10.0) {
+    double enlam = exp(-lam);
+    double prod = 1.0;
+    long k = 0;
+    for (;;) {
+      prod *= brix_rng_uniform();
+      if (prod <= enlam) return k;
+      k++;
+    }
+  }
+  double slam = sqrt(lam);
+  double loglam = log(lam);
+  double b = 0.931 + 2.53 * slam;
+  double a = -0.059 + 0.02483 * b;
+  double invalpha = 1.1239 + 1.1328 / (b - 3.4);
+  double vr = 0.9277 - 3.6224 / (b - 2.0);
+  for (;;) {
+    double u = brix_rng_uniform() - 0.5;
+    double v = brix_rng_uniform_pos();
+    double us = 0.5 - fabs(u);
+    long k = (long)floor((2.0 * a / us + b) * u + lam + 0.43);
+    if (us >= 0.07 && v <= vr) return k;
+    if (k < 0 || (us < 0.013 && v > us)) continue;
+    if (log(v) + log(invalpha) - log(a / (us * us) + b) <=
+        -lam + k * loglam - lgamma((double)k + 1.0)) {
+      return k;
+    }
+  }
+}
+
+// rand_uniform(lo, hi, ...) — Matrix with floats uniform in [lo, hi)
+Matrix *brix_rand_uniform_matrix(long rows, long cols, double lo, double hi) {
+  Matrix *m = matrix_new(rows, cols);
+  long size = rows * cols;
+  double span = hi - lo;
+  for (long i = 0; i < size; i++) {
+    m->data[i] = lo + span * brix_rng_uniform();
+  }
+  return m;
+}
 
-  for (long i = 0; i < m->rows; i++) {
-    for (long j = 0; j < m->cols; j++) {
-      result->data[j * m->rows + i] = m->data[i * m->cols + j];
-    }
+// randn(...) / rand_normal(mu, sigma, ...) — Matrix of N(mu, sigma^2) samples
+Matrix *brix_rand_normal_matrix(long rows, long cols, double mu, double sigma) {
+  if (!brix_zig_ready) brix_zig_init();
+  Matrix *m = matrix_new(rows, cols);
+  long size = rows * cols;
+  for (long i = 0; i < size; i++) {
+    m->data[i] = mu + sigma * brix_rng_normal();
+  }
+  return m;
+}
+
+// rand_exp(lambda, ...) — Matrix of Exp(lambda) samples (mean 1/lambda)
+Matrix *brix_rand_exp_matrix(long rows, long cols, double lambda) {
+  if (lambda <= 0.0) {
+    fprintf(stderr, "Error: rand_exp() rate must be positive, got %g\n", lambda);
+    exit(1);
+  }
+  if (!brix_zig_ready) brix_zig_init();
+  Matrix *m = matrix_new(rows, cols);
+  long size = rows * cols;
+  double scale = 1.0 / lambda;
+  for (long i = 0; i < size; i++) {
+    m->data[i] = scale * brix_rng_exponential();
+  }
+  return m;
+}
+
+// rand_gamma(shape, scale, ...) — Matrix of Gamma(shape, scale) samples
+Matrix *brix_rand_gamma_matrix(long rows, long cols, double shape, double scale) {
+  if (shape <= 0.0 || scale <= 0.0) {
+    fprintf(stderr,
+            "Error: rand_gamma() shape and scale must be positive, got %g, %g\n",
+            shape, scale);
+    exit(1);
+  }
+  if (!brix_zig_ready) brix_zig_init();
+  Matrix *m = matrix_new(rows, cols);
+  long size = rows * cols;
+  for (long i = 0; i < size; i++) {
+    m->data[i] = scale * brix_rng_gamma(shape);
+  }
+  return m;
+}
+
+// rand_poisson(lambda, ...) — IntMatrix of Poisson(lambda) counts
+IntMatrix *brix_rand_poisson_matrix(long rows, long cols, double lambda) {
+  if (lambda < 0.0) {
+    fprintf(stderr, "Error: rand_poisson() mean must be non-negative, got %g\n",
+            lambda);
+    exit(1);
+  }
+  IntMatrix *m = intmatrix_new(rows, cols);
+  long size = rows * cols;
+  for (long i = 0; i < size; i++) {
+    m->data[i] = brix_rng_poisson(lambda);
+  }
+  return m;
+}
+
+// rand32(...) — Matrix32 of uniform [0, 1) samples (24-bit mantissa draws)
+Matrix32 *brix_rand32(long rows, long cols) {
+  Matrix32 *m = matrix32_new(rows, cols);
+  long size = rows * cols;
+  for (long i = 0; i < size; i++) {
+    m->data[i] = (float)(brix_rng_next() >> 40) * 0x1.0p-24f;
   }
+  return m;
+}
 
+// Transpose: swap rows and columns
+Matrix *brix_tr(Matrix *m) {
+  Matrix *result = matrix_new(m->cols, m->rows);
+  transpose_f64(m->data, result->data, m->rows, m->cols);
   return result;
 }
 
@@ -160,6 +160,7 @@ fn compile_to_exe(file_path: &str, opt_level: u8, verbose: bool) -> String {
         .arg("-lm")
         .arg("-llapack")
         .arg("-lblas")
+        .arg("-lpthread")
         .arg("-o")
         .arg(&exe_name)
         .output()
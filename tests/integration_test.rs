@@ -1971,3 +1971,211 @@ fn test_223_hashmap_growth_rehash() {
         "12\n0\n5\n11\n-1",
     );
 }
+
+#[test]
+fn test_224_rand_distributions() {
+    // rand_seed() makes randn/rand_poisson reproducible; uniform/exponential
+    // samples stay inside their support.
+    assert_success(
+        "tests/integration/success/224_rand_distributions.bx",
+        "1\n1\n2\n3\n1\n1",
+    );
+}
+
+#[test]
+fn test_225_sparse_matrix() {
+    // SparseMatrix: COO assembly (duplicates summed), SpMV, conjugate gradient,
+    // dense round-trip and transpose.
+    assert_success(
+        "tests/integration/success/225_sparse_matrix.bx",
+        "3\n7\n0.0 0.0 4.0\n1.0000 1.0000 1.0000\n2.0 -1.0 0.0\n4\n7",
+    );
+}
+
+#[test]
+fn test_226_matrix32() {
+    // Matrix32: f32 constructors, SIMD elementwise kernels and reductions,
+    // map/filter/reduce, indexed stores and the round-trip through matrix().
+    assert_success(
+        "tests/integration/success/226_matrix32.bx",
+        "[3, 5, 7, 9, 11]\n5\n35\n7.0 3.0 11.0\n[1, 4, 9, 16, 25]\n[3, 4, 5]\n15\n[0.25, 0, 0, 0, 0, 7.5]\n7.5\n7.75\n0",
+    );
+}
+
+#[test]
+fn test_227_complexmatrix_ops() {
+    // ComplexMatrix: complex(re, im) from split arrays, elementwise + - * /
+    // against matrices and scalars, conj/abs/exp and real/imag extraction.
+    assert_success(
+        "tests/integration/success/227_complexmatrix_ops.bx",
+        "-1+2im\n-1+2im\n0.8+2.1im\n2+1im\n-3-2im\n1\n5\n2\n-1.0000\n5",
+    );
+}
+
+#[test]
+fn test_228_fft() {
+    // FFT module: mixed-radix fft/ifft, rfft (packed half-length transform),
+    // Bluestein for a prime length, fft2/ifft2 and the in-place variants.
+    assert_success(
+        "tests/integration/success/228_fft.bx",
+        "-2+2im\n3\n3\n-2+2im\n1.0000\n-4\n4\n4+0im\n1",
+    );
+}
+
+#[test]
+fn test_229_factor_objects() {
+    // Factorization objects: LU solve against two right-hand sides, det/inv
+    // from the stored factors, Cholesky, and a least-squares QR solve.
+    assert_success(
+        "tests/integration/success/229_factor_objects.bx",
+        "1\n2\n1\n10\n0.3\n2\n8\n1\n1.0000 2.0000",
+    );
+}
+
+#[test]
+fn test_230_eigh() {
+    // Symmetric eigensolver: full eigh (ascending), top-k eigh/eigvalsh
+    // (largest first) and the symmetric fast path of eigvals.
+    assert_success(
+        "tests/integration/success/230_eigh.bx",
+        "0.5858 2.0000 3.4142\n1\n1.0000\n2\n2\n3.4142 2.0000\n3.4142\n0.5858\n3.4142",
+    );
+}
+
+#[test]
+fn test_231_blas_kernels() {
+    // BLAS level-1/3 kernels: ddot, dnrm2, the row-wise 1-norm, daxpy
+    // (copying and in place) and dsyrk-based covariance/correlation.
+    assert_success(
+        "tests/integration/success/231_blas_kernels.bx",
+        "32\n5\n6\n12\n3\n1.6667 2.0000 1.3333\n1.0000 0.7303 1.0000",
+    );
+}
+
+#[test]
+fn test_232_lstsq_linreg() {
+    // dgelsd least squares: full-rank fit with residual and rank, a
+    // rank-deficient minimum-norm solution, and multi-response linreg.
+    assert_success(
+        "tests/integration/success/232_lstsq_linreg.bx",
+        "0.8000 2.3000\n0.3000\n2\n1.0000 1.0000\n1\n2.3000 0.8000 0.9888\n-1.0000 10.0000 1.0000",
+    );
+}
+
+#[test]
+fn test_233_krylov() {
+    // CG on a sparse SPD system, BiCGSTAB and preconditioned GMRES on a
+    // nonsymmetric dense one, and CG with a matrix-free closure operator.
+    assert_success(
+        "tests/integration/success/233_krylov.bx",
+        "0.0909 0.6364\n0.2000 0.4000\n0.2000 0.4000\n0.5000 0.5000 2.0000",
+    );
+}
+
+#[test]
+fn test_234_append_inplace() {
+    // Self-assigned append/prepend grow in place; a shared array is copied.
+    assert_success(
+        "tests/integration/success/234_append_inplace.bx",
+        "11\n100\n11\n12\n-1\n3.0 0.5 4",
+    );
+}
+
+#[test]
+fn test_235_static_array_literals() {
+    // Constant literals are shared static data; a write copies before mutating.
+    assert_success(
+        "tests/integration/success/235_static_array_literals.bx",
+        "875.0\n11\n11\n-1 3 3\n102\n9 102\n106",
+    );
+}
+
+#[test]
+fn test_236_static_string_literals() {
+    // Literals are immortal: reuse across calls, matches and concat stays valid.
+    assert_success(
+        "tests/integration/success/236_static_string_literals.bx",
+        "3000\nlog: info\nDEBUG\n4",
+    );
+}
+
+#[test]
+fn test_237_fstring_formatting() {
+    // Single-pass f-strings keep printf-compatible output for every format.
+    assert_success(
+        "tests/integration/success/237_fstring_formatting.bx",
+        "brix v42: 3.14159 3.14 3 3.141590e+00\n0.3 0.333333 1e-05 2.5e+06 -7.2\nff FF 10 -12 [1, 2, 3]\n18512",
+    );
+}
+
+#[test]
+fn test_238_string_builder() {
+    // StringBuilder appends/build and amortized `s += x` on a local string.
+    assert_success(
+        "tests/integration/success/238_string_builder.bx",
+        "14\n1,2,3,4,5,2.5!\n0\n2000\nx xy",
+    );
+}
+
+#[test]
+fn test_239_substring_search() {
+    // contains/index_of/split/replace on the shared search engine (v1.9).
+    assert_success(
+        "tests/integration/success/239_substring_search.bx",
+        "1\n0\n1\n0\n80\na||b|c|\na::b::c\na-bXc\n501\n3500",
+    );
+}
+
+#[test]
+fn test_240_string_slices() {
+    // Slices print, compare and convert like copies, and outlive their source.
+    assert_success(
+        "tests/integration/success/240_string_slices.bx",
+        "3\nbrix\nb.r.i.x.\n13\n195\ngamma\n[id=42]",
+    );
+}
+
+#[test]
+fn test_241_string_iteration() {
+    // for-in over code points, and int-valued .chars()/.bytes()/.char_indices().
+    assert_success(
+        "tests/integration/success/241_string_iteration.bx",
+        "5\nh é l l o \n664\n6 795\n2\n3\n14\nabcdefghijklmnopq\n17\n87",
+    );
+}
+
+#[test]
+fn test_242_small_strings() {
+    // Inline string data, short copies vs long slices, growth out of inline.
+    assert_success(
+        "tests/integration/success/242_small_strings.bx",
+        "42\nabz\nrather\n81\nyzyzyz",
+    );
+}
+
+#[test]
+fn test_243_utf8_indexing() {
+    // Code-point substring/reverse/index_of/char_indices, short and indexed.
+    assert_success(
+        "tests/integration/success/243_utf8_indexing.bx",
+        "4\nçã\noãça\n7\n603\n€fim\n600\n602",
+    );
+}
+
+#[test]
+fn test_244_regex() {
+    // regex module: is_match/find/find_all/captures/replace_all/split.
+    assert_success(
+        "tests/integration/success/244_regex.bx",
+        "1\n10.0.0.7\n1,22,333\n3\njoão 10.0.0.7\n0\nx:ana, y:bob\na|b|c\n0\n[] [aa]\n0",
+    );
+}
+
+#[test]
+fn test_245_split_iter() {
+    // split_iter()/lines(): for-in, early exit and the iterator methods.
+    assert_success(
+        "tests/integration/success/245_split_iter.bx",
+        "3\nid=8812\n3\n3\n1\n0\n12:00:04 INFO user=bob\nnone\n2\n8\nuser=ana|id=8812|user=bob\nx+y+z\n1",
+    );
+}